@@ -0,0 +1,171 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "audio_file.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+using namespace gdvosk::bench;
+
+namespace
+{
+    std::optional<std::vector<char>> read_file(const std::filesystem::path& path)
+    {
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream)
+        {
+            return std::nullopt;
+        }
+
+        return std::vector<char>(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    }
+
+    std::uint32_t read_u32(const char* data)
+    {
+        const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+        return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (std::uint32_t(bytes[3]) << 24);
+    }
+
+    std::uint16_t read_u16(const char* data)
+    {
+        const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+        return static_cast<std::uint16_t>(bytes[0] | (bytes[1] << 8));
+    }
+}
+
+std::size_t audio_clip::frames() const
+{
+    return channels > 0 ? samples.size() / channels : 0;
+}
+
+double audio_clip::duration() const
+{
+    return sample_rate > 0 ? static_cast<double>(frames()) / sample_rate : 0.0;
+}
+
+std::vector<float> audio_clip::to_mono() const
+{
+    if (channels == 1)
+    {
+        return samples;
+    }
+
+    std::vector<float> output(frames());
+    for (std::size_t frame = 0; frame < output.size(); ++frame)
+    {
+        auto sum = 0.0f;
+        for (auto channel = 0; channel < channels; ++channel)
+        {
+            sum += samples[frame * channels + channel];
+        }
+
+        output[frame] = sum / static_cast<float>(channels);
+    }
+
+    return output;
+}
+
+std::optional<audio_clip> gdvosk::bench::load_wav(const std::filesystem::path& path)
+{
+    auto contents = read_file(path);
+    if (!contents.has_value() || contents->size() < 12)
+    {
+        return std::nullopt;
+    }
+
+    const auto* data = contents->data();
+    if (std::memcmp(data, "RIFF", 4) != 0 || std::memcmp(data + 8, "WAVE", 4) != 0)
+    {
+        return std::nullopt;
+    }
+
+    audio_clip clip;
+    clip.name = path.filename().string();
+
+    auto bits_per_sample = 0;
+    std::size_t offset = 12;
+    while (offset + 8 <= contents->size())
+    {
+        const auto* chunk = data + offset;
+        const auto chunk_size = static_cast<std::size_t>(read_u32(chunk + 4));
+        const auto* body = chunk + 8;
+
+        if (offset + 8 + chunk_size > contents->size())
+        {
+            return std::nullopt;
+        }
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && chunk_size >= 16)
+        {
+            const auto format = read_u16(body);
+            if (format != 1)
+            {
+                // only plain PCM is supported
+                return std::nullopt;
+            }
+
+            clip.channels = read_u16(body + 2);
+            clip.sample_rate = static_cast<int>(read_u32(body + 4));
+            bits_per_sample = read_u16(body + 14);
+        }
+        else if (std::memcmp(chunk, "data", 4) == 0)
+        {
+            if (bits_per_sample != 16 || clip.channels < 1)
+            {
+                return std::nullopt;
+            }
+
+            clip.samples.resize(chunk_size / 2);
+            for (std::size_t i = 0; i < clip.samples.size(); ++i)
+            {
+                clip.samples[i] = static_cast<std::int16_t>(read_u16(body + i * 2));
+            }
+
+            return clip;
+        }
+
+        // chunks are padded to an even number of bytes
+        offset += 8 + chunk_size + (chunk_size & 1);
+    }
+
+    return std::nullopt;
+}
+
+std::optional<audio_clip> gdvosk::bench::load_raw_float
+(
+    const std::filesystem::path& path,
+    int sample_rate,
+    int channels
+)
+{
+    auto contents = read_file(path);
+    if (!contents.has_value())
+    {
+        return std::nullopt;
+    }
+
+    audio_clip clip;
+    clip.name = path.filename().string();
+    clip.sample_rate = sample_rate;
+    clip.channels = channels;
+
+    const auto sample_count = contents->size() / sizeof(float) / channels * channels;
+    clip.samples.resize(sample_count);
+
+    for (std::size_t i = 0; i < sample_count; ++i)
+    {
+        const auto bits = read_u32(contents->data() + i * sizeof(float));
+
+        float sample;
+        std::memcpy(&sample, &bits, sizeof(float));
+
+        // vosk expects -32768 to 32768, not -1 to 1
+        clip.samples[i] = std::clamp(sample, -1.0f, 1.0f) * 32768;
+    }
+
+    return clip;
+}
@@ -0,0 +1,77 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_BENCH_AUDIO_FILE_H
+#define GDVOSK_BENCH_AUDIO_FILE_H
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace gdvosk::bench
+{
+    /**
+     * Represents a decoded audio file, held as interleaved floating-point samples in the range Vosk expects
+     * (-32768 to 32767).
+     */
+    struct audio_clip
+    {
+        /**
+         * Holds the name of the file the clip was loaded from.
+         */
+        std::string name;
+
+        /**
+         * Holds the sample rate of the clip, in Hz.
+         */
+        int sample_rate = 0;
+
+        /**
+         * Holds the number of interleaved channels in the clip.
+         */
+        int channels = 0;
+
+        /**
+         * Holds the interleaved samples.
+         */
+        std::vector<float> samples;
+
+        /**
+         * Gets the number of frames (samples per channel) in the clip.
+         * @return The number of frames.
+         */
+        [[nodiscard]] std::size_t frames() const;
+
+        /**
+         * Gets the duration of the clip in seconds.
+         * @return The duration.
+         */
+        [[nodiscard]] double duration() const;
+
+        /**
+         * Mixes the clip down to a single channel by averaging the channels of each frame.
+         * @return The mono samples.
+         */
+        [[nodiscard]] std::vector<float> to_mono() const;
+    };
+
+    /**
+     * Loads a 16-bit PCM RIFF/WAVE file.
+     * @param path The path to the file.
+     * @return The clip, or nothing if the file could not be read or is in an unsupported format.
+     */
+    std::optional<audio_clip> load_wav(const std::filesystem::path& path);
+
+    /**
+     * Loads a headerless file of little-endian 32-bit floating-point samples in the range -1 to 1, as written by
+     * Godot's FileAccess.store_float.
+     * @param path The path to the file.
+     * @param sample_rate The sample rate of the data.
+     * @param channels The number of interleaved channels in the data.
+     * @return The clip, or nothing if the file could not be read.
+     */
+    std::optional<audio_clip> load_raw_float(const std::filesystem::path& path, int sample_rate, int channels);
+}
+
+#endif //GDVOSK_BENCH_AUDIO_FILE_H
@@ -0,0 +1,777 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "audio_file.h"
+
+#include "core/decoder_settings.h"
+#include "core/recognizer.h"
+#include "core/result.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <vosk_api.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#ifndef GDVOSK_BENCH_SAMPLE_DIR
+#define GDVOSK_BENCH_SAMPLE_DIR "sample"
+#endif
+
+#ifndef GDVOSK_BENCH_REVISION
+#define GDVOSK_BENCH_REVISION ""
+#endif
+
+using namespace std::chrono;
+using namespace gdvosk::bench;
+using namespace gdvosk::core;
+
+namespace
+{
+    /**
+     * Represents the command-line options of the benchmark.
+     */
+    struct options
+    {
+        std::filesystem::path model_path;
+        std::filesystem::path sample_dir = GDVOSK_BENCH_SAMPLE_DIR;
+        std::filesystem::path output_path;
+        std::filesystem::path reference_path;
+        std::vector<std::string> profiles = { "default" };
+        int max_concurrency = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        int chunk_ms = 100;
+    };
+
+    /**
+     * Represents the measurements taken while decoding a single clip on a single recognizer.
+     */
+    struct clip_metrics
+    {
+        std::string name;
+        int sample_rate = 0;
+        int channels = 0;
+        double audio_seconds = 0;
+        double decode_seconds = 0;
+        double first_partial_ms = -1;
+        double first_partial_audio_ms = -1;
+        double final_latency_ms = 0;
+        double time_to_final_ms = 0;
+        std::string text;
+    };
+
+    /**
+     * Represents the aggregate throughput of several recognizers decoding concurrently.
+     */
+    struct concurrency_metrics
+    {
+        int recognizers = 0;
+        double audio_seconds = 0;
+        double wall_seconds = 0;
+    };
+
+    /**
+     * Represents the speed and accuracy of the model when loaded with a decoder profile, over all clips.
+     */
+    struct profile_metrics
+    {
+        std::string name;
+        double model_load_seconds = 0;
+        double audio_seconds = 0;
+        double decode_seconds = 0;
+        std::size_t reference_words = 0;
+        std::size_t word_errors = 0;
+    };
+
+    /**
+     * Represents a clip prepared for decoding.
+     */
+    struct prepared_clip
+    {
+        audio_clip clip;
+        std::vector<float> mono;
+    };
+
+    void print_usage(const char* program)
+    {
+        std::cerr
+            << "usage: " << program << " <model-dir> [options]\n"
+            << "  --samples <dir>       directory holding the sample audio (default: " GDVOSK_BENCH_SAMPLE_DIR ")\n"
+            << "  --concurrency <n>     highest number of concurrent recognizers to measure\n"
+            << "  --chunk-ms <ms>       amount of audio passed to the recognizer per call (default: 100)\n"
+            << "  --output <file>       write the JSON report to a file instead of stdout\n"
+            << "  --profiles <list>     comma-separated decoder profiles to compare: default, fast, fastest or\n"
+            << "                        accurate (default: default); the clip and concurrency figures are for the\n"
+            << "                        first one\n"
+            << "  --reference <file>    reference transcripts to compute word error rates against, one per line as\n"
+            << "                        <clip name><tab><text>; a line without a clip name applies to every clip\n";
+    }
+
+    bool parse_options(int argc, char** argv, options& parsed)
+    {
+        for (auto i = 1; i < argc; ++i)
+        {
+            const std::string argument = argv[i];
+            const auto has_value = i + 1 < argc;
+
+            if (argument == "--samples" && has_value)
+            {
+                parsed.sample_dir = argv[++i];
+            }
+            else if (argument == "--concurrency" && has_value)
+            {
+                parsed.max_concurrency = std::max(1, std::atoi(argv[++i]));
+            }
+            else if (argument == "--chunk-ms" && has_value)
+            {
+                parsed.chunk_ms = std::max(1, std::atoi(argv[++i]));
+            }
+            else if (argument == "--output" && has_value)
+            {
+                parsed.output_path = argv[++i];
+            }
+            else if (argument == "--reference" && has_value)
+            {
+                parsed.reference_path = argv[++i];
+            }
+            else if (argument == "--profiles" && has_value)
+            {
+                parsed.profiles.clear();
+
+                std::istringstream list(argv[++i]);
+                std::string name;
+                while (std::getline(list, name, ','))
+                {
+                    if (!parse_decoder_profile(name).has_value())
+                    {
+                        return false;
+                    }
+
+                    parsed.profiles.push_back(name);
+                }
+
+                if (parsed.profiles.empty())
+                {
+                    return false;
+                }
+            }
+            else if (!argument.empty() && argument[0] != '-' && parsed.model_path.empty())
+            {
+                parsed.model_path = argument;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        return !parsed.model_path.empty();
+    }
+
+    std::string get_text(const char* json)
+    {
+        if (json == nullptr)
+        {
+            return { };
+        }
+
+        auto result = gdvosk::core::parse_result(json);
+        return result.has_value() ? result->text : std::string();
+    }
+
+    void append_text(std::string& transcript, const std::string& text)
+    {
+        if (text.empty())
+        {
+            return;
+        }
+
+        if (!transcript.empty())
+        {
+            transcript += ' ';
+        }
+
+        transcript += text;
+    }
+
+    /**
+     * Splits a transcript into words for scoring, ignoring case and punctuation.
+     */
+    std::vector<std::string> get_words(const std::string& text)
+    {
+        std::vector<std::string> words;
+        std::string word;
+
+        for (const auto c : text)
+        {
+            const auto byte = static_cast<unsigned char>(c);
+            if (byte >= 0x80 || std::isalnum(byte) || c == '\'')
+            {
+                word += static_cast<char>(std::tolower(byte));
+                continue;
+            }
+
+            if (!word.empty())
+            {
+                words.push_back(std::move(word));
+                word.clear();
+            }
+        }
+
+        if (!word.empty())
+        {
+            words.push_back(std::move(word));
+        }
+
+        return words;
+    }
+
+    /**
+     * Counts the word substitutions, deletions and insertions that turn the reference into the hypothesis.
+     */
+    std::size_t get_word_errors(const std::vector<std::string>& reference, const std::vector<std::string>& hypothesis)
+    {
+        std::vector<std::size_t> previous(hypothesis.size() + 1);
+        std::vector<std::size_t> current(hypothesis.size() + 1);
+
+        for (std::size_t j = 0; j <= hypothesis.size(); ++j)
+        {
+            previous[j] = j;
+        }
+
+        for (std::size_t i = 1; i <= reference.size(); ++i)
+        {
+            current[0] = i;
+            for (std::size_t j = 1; j <= hypothesis.size(); ++j)
+            {
+                const auto substitution = previous[j - 1] + (reference[i - 1] == hypothesis[j - 1] ? 0 : 1);
+                current[j] = std::min({ substitution, previous[j] + 1, current[j - 1] + 1 });
+            }
+
+            std::swap(previous, current);
+        }
+
+        return previous[hypothesis.size()];
+    }
+
+    /**
+     * Loads reference transcripts, keyed by clip name. Transcripts that apply to every clip are keyed by an empty
+     * name.
+     */
+    bool load_references(const std::filesystem::path& path, std::map<std::string, std::string>& references)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            return false;
+        }
+
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+
+            if (line.empty())
+            {
+                continue;
+            }
+
+            const auto separator = line.find('\t');
+            if (separator == std::string::npos)
+            {
+                references[{ }] = line;
+                continue;
+            }
+
+            references[line.substr(0, separator)] = line.substr(separator + 1);
+        }
+
+        return true;
+    }
+
+    const std::string* find_reference(const std::map<std::string, std::string>& references, const std::string& name)
+    {
+        auto reference = references.find(name);
+        if (reference == references.end())
+        {
+            reference = references.find({ });
+        }
+
+        return reference == references.end() ? nullptr : &reference->second;
+    }
+
+    std::size_t get_peak_rss_bytes()
+    {
+#if defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS counters;
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        {
+            return 0;
+        }
+
+        return counters.PeakWorkingSetSize;
+#else
+        rusage usage { };
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+        {
+            return 0;
+        }
+
+#if defined(__APPLE__)
+        return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+        return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+    }
+
+    std::vector<prepared_clip> load_clips(const std::filesystem::path& sample_dir)
+    {
+        std::vector<prepared_clip> clips;
+
+        for (const auto* name :
+            { "test-mono-16000.wav", "test-mono-44100.wav", "test-stereo-16000.wav", "test-stereo-44100.wav" })
+        {
+            auto clip = load_wav(sample_dir / name);
+            if (!clip.has_value())
+            {
+                std::cerr << "warning: could not load " << (sample_dir / name).string() << "\n";
+                continue;
+            }
+
+            clips.push_back({ *clip, clip->to_mono() });
+        }
+
+        auto raw = load_raw_float(sample_dir / "test-stereo-44100.raw", 44100, 2);
+        if (raw.has_value())
+        {
+            clips.push_back({ *raw, raw->to_mono() });
+        }
+        else
+        {
+            std::cerr << "warning: could not load " << (sample_dir / "test-stereo-44100.raw").string() << "\n";
+        }
+
+        return clips;
+    }
+
+    /**
+     * Loads a model with overridden search parameters. Vosk only reads them from the model's conf/model.conf while
+     * loading, so the model is loaded from a temporary overlay of it instead: a directory holding a rewritten
+     * configuration and links to the model's other files. The model itself is left untouched.
+     */
+    VoskModel* load_model(const std::filesystem::path& model_path, const decoder_settings& settings)
+    {
+        namespace fs = std::filesystem;
+
+        const auto config_path = model_path / "conf" / "model.conf";
+
+        std::error_code error;
+        if (!settings.is_overriding() || !fs::is_regular_file(config_path, error))
+        {
+            // models in the old layout take their search parameters from elsewhere, and can't be configured
+            return vosk_model_new(model_path.string().c_str());
+        }
+
+        std::ifstream config_file(config_path, std::ios::binary);
+        std::ostringstream config;
+        config << config_file.rdbuf();
+
+        const auto overlay_name = "gdvosk-bench-" + std::to_string(steady_clock::now().time_since_epoch().count());
+        const auto overlay_path = fs::temp_directory_path(error) / overlay_name;
+
+        auto is_complete = !error && fs::create_directories(overlay_path / "conf", error);
+        for (fs::recursive_directory_iterator entry(model_path, error), end; is_complete && entry != end; ++entry)
+        {
+            const auto target = overlay_path / entry->path().lexically_relative(model_path);
+            if (entry->is_directory(error))
+            {
+                fs::create_directories(target, error);
+            }
+            else if (entry->path() != config_path)
+            {
+                // temporary directories are often on a file system of their own, so links are symbolic
+                fs::create_symlink(fs::absolute(entry->path()), target, error);
+                if (error)
+                {
+                    fs::copy_file(entry->path(), target, error);
+                }
+            }
+
+            is_complete = !error;
+        }
+
+        if (is_complete)
+        {
+            std::ofstream overlay_config(overlay_path / "conf" / "model.conf", std::ios::binary | std::ios::trunc);
+            overlay_config << apply_decoder_settings(config.str(), settings);
+            overlay_config.close();
+
+            is_complete = !overlay_config.fail();
+        }
+
+        auto* model = is_complete ? vosk_model_new(overlay_path.string().c_str()) : nullptr;
+
+        fs::remove_all(overlay_path, error);
+        return model;
+    }
+
+    clip_metrics measure_clip(VoskModel* model, const prepared_clip& prepared, int chunk_ms)
+    {
+        clip_metrics metrics;
+        metrics.name = prepared.clip.name;
+        metrics.sample_rate = prepared.clip.sample_rate;
+        metrics.channels = prepared.clip.channels;
+        metrics.audio_seconds = prepared.clip.duration();
+
+        auto decoder = recognizer::create(model, static_cast<float>(prepared.clip.sample_rate));
+        if (decoder == nullptr)
+        {
+            return metrics;
+        }
+
+        const auto chunk_size = std::max<std::size_t>(1, prepared.clip.sample_rate * chunk_ms / 1000);
+        const auto samples = span<const float>(prepared.mono);
+
+        const auto start = steady_clock::now();
+        for (std::size_t offset = 0; offset < samples.size(); offset += chunk_size)
+        {
+            const auto chunk = samples.subspan(offset, chunk_size);
+            const auto accepted = decoder->accept(chunk);
+
+            std::string text;
+            if (accepted != accept_status::partial_ready)
+            {
+                // completed utterances have to be collected as they come, or the transcript only holds the last one
+                text = get_text(decoder->result_json());
+                append_text(metrics.text, text);
+            }
+            else if (metrics.first_partial_ms < 0)
+            {
+                text = get_text(decoder->partial_result_json());
+            }
+
+            if (metrics.first_partial_ms < 0 && !text.empty())
+            {
+                metrics.first_partial_ms = duration<double, std::milli>(steady_clock::now() - start).count();
+                metrics.first_partial_audio_ms = 1000.0 * (offset + chunk.size()) / prepared.clip.sample_rate;
+            }
+        }
+
+        const auto flush_start = steady_clock::now();
+        append_text(metrics.text, get_text(decoder->final_result_json()));
+        const auto end = steady_clock::now();
+
+        metrics.decode_seconds = duration<double>(end - start).count();
+        metrics.final_latency_ms = duration<double, std::milli>(end - flush_start).count();
+        metrics.time_to_final_ms = duration<double, std::milli>(end - start).count();
+
+        return metrics;
+    }
+
+    concurrency_metrics measure_concurrency
+    (
+        VoskModel* model,
+        const std::vector<prepared_clip>& clips,
+        int recognizer_count,
+        int chunk_ms
+    )
+    {
+        concurrency_metrics metrics;
+        metrics.recognizers = recognizer_count;
+
+        std::atomic_bool go = false;
+        std::atomic_int ready = 0;
+        std::vector<std::thread> threads;
+
+        for (auto i = 0; i < recognizer_count; ++i)
+        {
+            threads.emplace_back([&]
+            {
+                // recognizers are created up-front so that only decoding is measured
+                std::vector<std::unique_ptr<recognizer>> recognizers;
+                for (const auto& prepared : clips)
+                {
+                    recognizers.push_back(recognizer::create(model, static_cast<float>(prepared.clip.sample_rate)));
+                }
+
+                ready += 1;
+                while (!go)
+                {
+                    std::this_thread::yield();
+                }
+
+                for (std::size_t c = 0; c < clips.size(); ++c)
+                {
+                    auto& decoder = recognizers[c];
+                    if (decoder == nullptr)
+                    {
+                        continue;
+                    }
+
+                    const auto& prepared = clips[c];
+                    const auto chunk_size = std::max<std::size_t>(1, prepared.clip.sample_rate * chunk_ms / 1000);
+                    const auto samples = span<const float>(prepared.mono);
+
+                    for (std::size_t offset = 0; offset < samples.size(); offset += chunk_size)
+                    {
+                        decoder->accept(samples.subspan(offset, chunk_size));
+                    }
+
+                    decoder->final_result_json();
+                    decoder.reset();
+                }
+            });
+        }
+
+        while (ready < recognizer_count)
+        {
+            std::this_thread::yield();
+        }
+
+        const auto start = steady_clock::now();
+        go = true;
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        metrics.wall_seconds = duration<double>(steady_clock::now() - start).count();
+
+        for (const auto& prepared : clips)
+        {
+            metrics.audio_seconds += prepared.clip.duration() * recognizer_count;
+        }
+
+        return metrics;
+    }
+
+    std::string escape_json(const std::string& value)
+    {
+        std::string output;
+        for (const auto c : value)
+        {
+            switch (c)
+            {
+                case '"': output += "\\\""; break;
+                case '\\': output += "\\\\"; break;
+                default:
+                {
+                    if (static_cast<unsigned char>(c) >= 0x20)
+                    {
+                        output += c;
+                    }
+
+                    break;
+                }
+            }
+        }
+
+        return output;
+    }
+
+    std::string to_json
+    (
+        const options& parsed,
+        double model_load_seconds,
+        const std::vector<clip_metrics>& clips,
+        const std::vector<concurrency_metrics>& concurrency,
+        const std::vector<profile_metrics>& profiles
+    )
+    {
+        std::ostringstream json;
+        json.precision(6);
+
+        json << "{\n";
+        json << "  \"revision\": \"" << escape_json(GDVOSK_BENCH_REVISION) << "\",\n";
+        json << "  \"model\": \"" << escape_json(parsed.model_path.filename().string()) << "\",\n";
+        json << "  \"chunk_ms\": " << parsed.chunk_ms << ",\n";
+        json << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+        json << "  \"model_load_seconds\": " << model_load_seconds << ",\n";
+
+        json << "  \"clips\": [\n";
+        for (std::size_t i = 0; i < clips.size(); ++i)
+        {
+            const auto& clip = clips[i];
+            json << "    {\n";
+            json << "      \"name\": \"" << escape_json(clip.name) << "\",\n";
+            json << "      \"sample_rate\": " << clip.sample_rate << ",\n";
+            json << "      \"channels\": " << clip.channels << ",\n";
+            json << "      \"audio_seconds\": " << clip.audio_seconds << ",\n";
+            json << "      \"decode_seconds\": " << clip.decode_seconds << ",\n";
+            json << "      \"real_time_factor\": "
+                 << (clip.audio_seconds > 0 ? clip.decode_seconds / clip.audio_seconds : 0) << ",\n";
+            json << "      \"first_partial_ms\": " << clip.first_partial_ms << ",\n";
+            json << "      \"first_partial_audio_ms\": " << clip.first_partial_audio_ms << ",\n";
+            json << "      \"final_latency_ms\": " << clip.final_latency_ms << ",\n";
+            json << "      \"time_to_final_ms\": " << clip.time_to_final_ms << ",\n";
+            json << "      \"text\": \"" << escape_json(clip.text) << "\"\n";
+            json << "    }" << (i + 1 < clips.size() ? "," : "") << "\n";
+        }
+        json << "  ],\n";
+
+        json << "  \"concurrency\": [\n";
+        for (std::size_t i = 0; i < concurrency.size(); ++i)
+        {
+            const auto& run = concurrency[i];
+            const auto throughput = run.wall_seconds > 0 ? run.audio_seconds / run.wall_seconds : 0;
+
+            json << "    {\n";
+            json << "      \"recognizers\": " << run.recognizers << ",\n";
+            json << "      \"audio_seconds\": " << run.audio_seconds << ",\n";
+            json << "      \"wall_seconds\": " << run.wall_seconds << ",\n";
+            json << "      \"audio_seconds_per_second\": " << throughput << ",\n";
+            json << "      \"audio_seconds_per_second_per_core\": " << throughput / run.recognizers << "\n";
+            json << "    }" << (i + 1 < concurrency.size() ? "," : "") << "\n";
+        }
+        json << "  ],\n";
+
+        json << "  \"profiles\": [\n";
+        for (std::size_t i = 0; i < profiles.size(); ++i)
+        {
+            const auto& profile = profiles[i];
+            const auto has_reference = profile.reference_words > 0;
+
+            json << "    {\n";
+            json << "      \"name\": \"" << escape_json(profile.name) << "\",\n";
+            json << "      \"model_load_seconds\": " << profile.model_load_seconds << ",\n";
+            json << "      \"audio_seconds\": " << profile.audio_seconds << ",\n";
+            json << "      \"decode_seconds\": " << profile.decode_seconds << ",\n";
+            json << "      \"real_time_factor\": "
+                 << (profile.audio_seconds > 0 ? profile.decode_seconds / profile.audio_seconds : 0) << ",\n";
+            json << "      \"reference_words\": " << profile.reference_words << ",\n";
+            json << "      \"word_error_rate\": "
+                 << (has_reference ? static_cast<double>(profile.word_errors) / profile.reference_words : -1) << "\n";
+            json << "    }" << (i + 1 < profiles.size() ? "," : "") << "\n";
+        }
+        json << "  ],\n";
+
+        json << "  \"peak_rss_bytes\": " << get_peak_rss_bytes() << "\n";
+        json << "}\n";
+
+        return json.str();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    options parsed;
+    if (!parse_options(argc, argv, parsed))
+    {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    vosk_set_log_level(-1);
+
+    const auto clips = load_clips(parsed.sample_dir);
+    if (clips.empty())
+    {
+        std::cerr << "error: no sample audio found in " << parsed.sample_dir.string() << "\n";
+        return 1;
+    }
+
+    std::map<std::string, std::string> references;
+    if (!parsed.reference_path.empty() && !load_references(parsed.reference_path, references))
+    {
+        std::cerr << "error: could not read " << parsed.reference_path.string() << "\n";
+        return 1;
+    }
+
+    double model_load_seconds = 0;
+    std::vector<clip_metrics> clip_results;
+    std::vector<concurrency_metrics> concurrency_results;
+    std::vector<profile_metrics> profile_results;
+
+    for (const auto& profile_name : parsed.profiles)
+    {
+        const auto settings = get_decoder_settings(*parse_decoder_profile(profile_name));
+
+        const auto load_start = steady_clock::now();
+        auto* model = load_model(parsed.model_path, settings);
+        const auto load_seconds = duration<double>(steady_clock::now() - load_start).count();
+
+        if (model == nullptr)
+        {
+            std::cerr
+                << "error: could not load model from " << parsed.model_path.string()
+                << " with the " << profile_name << " profile\n";
+
+            return 1;
+        }
+
+        const auto is_first = profile_results.empty();
+
+        profile_metrics profile;
+        profile.name = profile_name;
+        profile.model_load_seconds = load_seconds;
+
+        for (const auto& clip : clips)
+        {
+            auto metrics = measure_clip(model, clip, parsed.chunk_ms);
+            profile.audio_seconds += metrics.audio_seconds;
+            profile.decode_seconds += metrics.decode_seconds;
+
+            const auto* reference = find_reference(references, metrics.name);
+            if (reference != nullptr)
+            {
+                const auto reference_words = get_words(*reference);
+                profile.reference_words += reference_words.size();
+                profile.word_errors += get_word_errors(reference_words, get_words(metrics.text));
+            }
+
+            if (is_first)
+            {
+                clip_results.push_back(std::move(metrics));
+            }
+        }
+
+        if (is_first)
+        {
+            model_load_seconds = load_seconds;
+            for (auto count = 1; count <= parsed.max_concurrency; ++count)
+            {
+                concurrency_results.push_back(measure_concurrency(model, clips, count, parsed.chunk_ms));
+            }
+        }
+
+        vosk_model_free(model);
+        profile_results.push_back(std::move(profile));
+    }
+
+    const auto report = to_json(parsed, model_load_seconds, clip_results, concurrency_results, profile_results);
+    if (parsed.output_path.empty())
+    {
+        std::cout << report;
+        return 0;
+    }
+
+    std::ofstream output(parsed.output_path);
+    if (!output)
+    {
+        std::cerr << "error: could not write " << parsed.output_path.string() << "\n";
+        return 1;
+    }
+
+    output << report;
+    return 0;
+}
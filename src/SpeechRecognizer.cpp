@@ -3,9 +3,26 @@
 
 
 #include "SpeechRecognizer.h"
-#include "helpers/semaphore_lock.h"
-#include "vosk/VoskRecognizer.h"
+#include "core/endpointer.h"
+#include "core/front_end.h"
+#include "core/load_monitor.h"
+#include "core/recognizer.h"
+#include "core/recognizer_pool.h"
+#include "core/result.h"
+#include "core/session_recorder.h"
+#include "core/thread_control.h"
+#include "core/trace.h"
+#include "core/wav.h"
+#include "helpers/frame_view.h"
+#include "helpers/result_conversion.h"
+#include "helpers/string_conversion.h"
 
+#include <algorithm>
+#include <deque>
+#include <future>
+
+#include <godot_cpp/classes/dir_access.hpp>
+#include <godot_cpp/classes/file_access.hpp>
 #include <godot_cpp/classes/time.hpp>
 #include <godot_cpp/classes/os.hpp>
 #include <godot_cpp/classes/project_settings.hpp>
@@ -15,15 +32,138 @@ using namespace std::chrono;
 using namespace godot;
 using namespace gdvosk;
 
+namespace
+{
+    /**
+     * Holds the rate audio is resampled to when several models decode it. Nearly every Vosk model is trained on 16 kHz
+     * audio, so most of them then don't have to resample it again.
+     */
+    constexpr int shared_sample_rate = 16000;
+
+    /**
+     * Gets the rate the audio server mixes at, which is the rate captured audio arrives at.
+     */
+    int get_mix_rate()
+    {
+        return ProjectSettings::get_singleton()->get_setting("audio/driver/mix_rate", 44100);
+    }
+
+    core::thread_priority to_core_priority(Thread::Priority priority)
+    {
+        switch (priority)
+        {
+            case Thread::PRIORITY_LOW:
+            {
+                return core::thread_priority::low;
+            }
+            case Thread::PRIORITY_HIGH:
+            {
+                return core::thread_priority::high;
+            }
+            case Thread::PRIORITY_NORMAL:
+            default:
+            {
+                return core::thread_priority::normal;
+            }
+        }
+    }
+}
+
 void SpeechRecognizer::_bind_methods()
 {
     REGISTER_GODOT_PROPERTY(Variant::STRING, recording_bus_name)
     REGISTER_GODOT_PROPERTY_WITH_HINT(Variant::OBJECT, vosk_model, PROPERTY_HINT_RESOURCE_TYPE, "VoskModel")
+    REGISTER_GODOT_PROPERTY_WITH_HINT(Variant::ARRAY, additional_models, PROPERTY_HINT_ARRAY_TYPE, "VoskModel")
+    REGISTER_GODOT_PROPERTY(Variant::BOOL, select_best_result)
+    REGISTER_GODOT_PROPERTY_WITH_HINT(Variant::OBJECT, wake_model, PROPERTY_HINT_RESOURCE_TYPE, "VoskModel")
+    REGISTER_GODOT_PROPERTY(Variant::PACKED_STRING_ARRAY, wake_phrases)
+    REGISTER_GODOT_PROPERTY(Variant::FLOAT, wake_pre_roll)
     REGISTER_GODOT_PROPERTY(Variant::FLOAT, silence_timeout)
+    REGISTER_GODOT_PROPERTY(Variant::PACKED_STRING_ARRAY, grammar)
+    REGISTER_GODOT_PROPERTY(Variant::INT, max_alternatives)
+    REGISTER_GODOT_PROPERTY(Variant::BOOL, include_words_in_output)
+    REGISTER_GODOT_PROPERTY(Variant::BOOL, include_words_in_partial_output)
+    REGISTER_GODOT_PROPERTY(Variant::FLOAT, max_capture_buffer_length)
+    REGISTER_GODOT_PROPERTY_WITH_HINT
+    (
+        Variant::INT,
+        overload_policy,
+        PROPERTY_HINT_ENUM,
+        "None,Drop Oldest,Skip Partials,Reduce Output,Fallback Model"
+    )
+    REGISTER_GODOT_PROPERTY(Variant::FLOAT, overload_threshold)
+    REGISTER_GODOT_PROPERTY_WITH_HINT(Variant::OBJECT, fallback_model, PROPERTY_HINT_RESOURCE_TYPE, "VoskModel")
+    REGISTER_GODOT_PROPERTY_WITH_HINT(Variant::INT, channel_mode, PROPERTY_HINT_ENUM, "Mix,Split")
+    REGISTER_GODOT_PROPERTY_WITH_HINT
+    (
+        Variant::INT,
+        decoder_profile,
+        PROPERTY_HINT_ENUM,
+        "Default,Fast,Fastest,Accurate"
+    )
+    REGISTER_GODOT_PROPERTY_WITH_HINT(Variant::OBJECT, speaker_model, PROPERTY_HINT_RESOURCE_TYPE, "VoskSpeakerModel")
+    REGISTER_GODOT_PROPERTY_WITH_HINT
+    (
+        Variant::OBJECT,
+        speaker_registry,
+        PROPERTY_HINT_RESOURCE_TYPE,
+        "VoskSpeakerRegistry"
+    )
+    REGISTER_GODOT_PROPERTY_WITH_HINT(Variant::FLOAT, speaker_match_threshold, PROPERTY_HINT_RANGE, "-1,1,0.01")
+    REGISTER_GODOT_PROPERTY_WITH_HINT(Variant::INT, thread_priority, PROPERTY_HINT_ENUM, "Low,Normal,High")
+    REGISTER_GODOT_PROPERTY(Variant::INT, cpu_affinity)
+    REGISTER_GODOT_PROPERTY_WITH_HINT(Variant::FLOAT, cpu_budget, PROPERTY_HINT_RANGE, "0,1,0.01")
+
+    ClassDB::bind_method
+    (
+        D_METHOD("replay_stream", "stream", "paced"),
+        &SpeechRecognizer::replay_stream,
+        DEFVAL(false)
+    );
+    ClassDB::bind_method(D_METHOD("replay_file", "path", "paced"), &SpeechRecognizer::replay_file, DEFVAL(false));
+    ClassDB::bind_method
+    (
+        D_METHOD("replay_pcm", "data", "sample_rate", "channels", "paced"),
+        &SpeechRecognizer::replay_pcm,
+        DEFVAL(1),
+        DEFVAL(false)
+    );
+    ClassDB::bind_method(D_METHOD("stop_replay"), &SpeechRecognizer::stop_replay);
+    ClassDB::bind_method(D_METHOD("is_replaying"), &SpeechRecognizer::is_replaying);
+    ClassDB::bind_method
+    (
+        D_METHOD("start_session_recording", "directory", "max_segment_size", "max_disk_usage"),
+        &SpeechRecognizer::start_session_recording,
+        DEFVAL("user://gdvosk/sessions"),
+        DEFVAL(64 * 1024 * 1024),
+        DEFVAL(1024 * 1024 * 1024)
+    );
+    ClassDB::bind_method(D_METHOD("stop_session_recording"), &SpeechRecognizer::stop_session_recording);
+    ClassDB::bind_method(D_METHOD("is_recording_session"), &SpeechRecognizer::is_recording_session);
+    ClassDB::bind_method(D_METHOD("get_dropped_session_records"), &SpeechRecognizer::get_dropped_session_records);
+    ClassDB::bind_method(D_METHOD("get_pipeline_statistics"), &SpeechRecognizer::get_pipeline_statistics);
+
+    BIND_ENUM_CONSTANT(OVERLOAD_POLICY_NONE)
+    BIND_ENUM_CONSTANT(OVERLOAD_POLICY_DROP_OLDEST)
+    BIND_ENUM_CONSTANT(OVERLOAD_POLICY_SKIP_PARTIALS)
+    BIND_ENUM_CONSTANT(OVERLOAD_POLICY_REDUCE_OUTPUT)
+    BIND_ENUM_CONSTANT(OVERLOAD_POLICY_FALLBACK_MODEL)
 
     ADD_SIGNAL(MethodInfo("partial_result", PropertyInfo(Variant::DICTIONARY, "data")));
     ADD_SIGNAL(MethodInfo("result", PropertyInfo(Variant::DICTIONARY, "data")));
     ADD_SIGNAL(MethodInfo("final_result", PropertyInfo(Variant::DICTIONARY, "data")));
+    ADD_SIGNAL(MethodInfo("audio_overrun", PropertyInfo(Variant::INT, "frames_lost")));
+    ADD_SIGNAL(MethodInfo("wake_word_detected", PropertyInfo(Variant::STRING, "phrase")));
+    ADD_SIGNAL(MethodInfo("replay_finished"));
+    ADD_SIGNAL
+    (
+        MethodInfo
+        (
+            "overload_changed",
+            PropertyInfo(Variant::BOOL, "is_overloaded"),
+            PropertyInfo(Variant::FLOAT, "real_time_factor")
+        )
+    );
 }
 
 void SpeechRecognizer::_exit_tree()
@@ -84,18 +224,195 @@ StringName SpeechRecognizer::get_recording_bus_name() const
 void SpeechRecognizer::set_silence_timeout(float silence_timeout)
 {
     _silence_timeout = round<microseconds>(duration<float>(silence_timeout));
+    publish_config();
 }
 
 float SpeechRecognizer::get_silence_timeout() const
 {
-    return duration_cast<duration<float>>(_silence_timeout.load()).count();
+    return duration_cast<duration<float>>(_silence_timeout).count();
 }
 
-void SpeechRecognizer::set_vosk_model(const godot::Ref<gdvosk::VoskModel>& vosk_model)
+void SpeechRecognizer::set_grammar(const PackedStringArray& grammar)
+{
+    _grammar = grammar;
+    _compiled_grammar = core::grammar_cache::shared().get(to_utf8(grammar));
+
+    publish_config();
+}
+
+PackedStringArray SpeechRecognizer::get_grammar() const
+{
+    return _grammar;
+}
+
+int SpeechRecognizer::get_max_alternatives() const
+{
+    return _max_alternatives;
+}
+
+void SpeechRecognizer::set_max_alternatives(int max_alternatives)
+{
+    _max_alternatives = max_alternatives;
+    publish_config();
+}
+
+bool SpeechRecognizer::get_include_words_in_output() const
+{
+    return _include_words_in_output;
+}
+
+void SpeechRecognizer::set_include_words_in_output(bool include_words_in_output)
+{
+    _include_words_in_output = include_words_in_output;
+    publish_config();
+}
+
+bool SpeechRecognizer::get_include_words_in_partial_output() const
+{
+    return _include_words_in_partial_output;
+}
+
+void SpeechRecognizer::set_include_words_in_partial_output(bool include_words_in_partial_output)
+{
+    _include_words_in_partial_output = include_words_in_partial_output;
+    publish_config();
+}
+
+float SpeechRecognizer::get_max_capture_buffer_length() const
+{
+    return _max_capture_buffer_length;
+}
+
+void SpeechRecognizer::set_max_capture_buffer_length(float max_capture_buffer_length)
+{
+    _max_capture_buffer_length = max_capture_buffer_length;
+}
+
+SpeechRecognizer::OverloadPolicy SpeechRecognizer::get_overload_policy() const
 {
-    semaphore_lock lock(_model_semaphore);
+    return _overload_policy;
+}
+
+void SpeechRecognizer::set_overload_policy(OverloadPolicy overload_policy)
+{
+    _overload_policy = overload_policy;
+    publish_config();
+}
+
+float SpeechRecognizer::get_overload_threshold() const
+{
+    return _overload_threshold;
+}
+
+void SpeechRecognizer::set_overload_threshold(float overload_threshold)
+{
+    _overload_threshold = overload_threshold;
+    publish_config();
+}
+
+Ref<gdvosk::VoskModel> SpeechRecognizer::get_fallback_model() const
+{
+    return _fallback_model;
+}
+
+void SpeechRecognizer::set_fallback_model(const Ref<gdvosk::VoskModel>& fallback_model)
+{
+    _fallback_model = fallback_model;
+    publish_config();
+}
+
+gdvosk::VoskRecognizer::ChannelMode SpeechRecognizer::get_channel_mode() const
+{
+    return _channel_mode;
+}
+
+void SpeechRecognizer::set_channel_mode(gdvosk::VoskRecognizer::ChannelMode channel_mode)
+{
+    _channel_mode = channel_mode;
+    publish_config();
+}
+
+gdvosk::VoskModel::DecoderProfile SpeechRecognizer::get_decoder_profile() const
+{
+    return _decoder_profile;
+}
+
+void SpeechRecognizer::set_decoder_profile(gdvosk::VoskModel::DecoderProfile decoder_profile)
+{
+    _decoder_profile = decoder_profile;
+    publish_config();
+}
+
+Ref<gdvosk::VoskSpeakerModel> SpeechRecognizer::get_speaker_model() const
+{
+    return _speaker_model;
+}
+
+void SpeechRecognizer::set_speaker_model(const Ref<gdvosk::VoskSpeakerModel>& speaker_model)
+{
+    _speaker_model = speaker_model;
+    publish_config();
+}
+
+Ref<gdvosk::VoskSpeakerRegistry> SpeechRecognizer::get_speaker_registry() const
+{
+    return _speaker_registry;
+}
+
+void SpeechRecognizer::set_speaker_registry(const Ref<gdvosk::VoskSpeakerRegistry>& speaker_registry)
+{
+    _speaker_registry = speaker_registry;
+    publish_config();
+}
+
+float SpeechRecognizer::get_speaker_match_threshold() const
+{
+    return _speaker_match_threshold;
+}
+
+void SpeechRecognizer::set_speaker_match_threshold(float speaker_match_threshold)
+{
+    _speaker_match_threshold = speaker_match_threshold;
+    publish_config();
+}
+
+Thread::Priority SpeechRecognizer::get_thread_priority() const
+{
+    return _thread_priority;
+}
+
+void SpeechRecognizer::set_thread_priority(Thread::Priority thread_priority)
+{
+    _thread_priority = thread_priority;
+}
+
+int64_t SpeechRecognizer::get_cpu_affinity() const
+{
+    return _cpu_affinity;
+}
+
+void SpeechRecognizer::set_cpu_affinity(int64_t cpu_affinity)
+{
+    _cpu_affinity = cpu_affinity;
+    publish_config();
+}
+
+float SpeechRecognizer::get_cpu_budget() const
+{
+    return _cpu_budget;
+}
+
+void SpeechRecognizer::set_cpu_budget(float cpu_budget)
+{
+    _cpu_budget = cpu_budget;
+    publish_config();
+}
 
+void SpeechRecognizer::set_vosk_model(const godot::Ref<gdvosk::VoskModel>& vosk_model)
+{
     _vosk_model = vosk_model;
+
+    publish_config();
     update_vosk_data();
 }
 
@@ -104,6 +421,68 @@ godot::Ref<gdvosk::VoskModel> SpeechRecognizer::get_vosk_model() const
     return _vosk_model;
 }
 
+TypedArray<gdvosk::VoskModel> SpeechRecognizer::get_additional_models() const
+{
+    return _additional_models;
+}
+
+void SpeechRecognizer::set_additional_models(const TypedArray<gdvosk::VoskModel>& additional_models)
+{
+    _additional_models = additional_models;
+    publish_config();
+}
+
+bool SpeechRecognizer::get_select_best_result() const
+{
+    return _select_best_result;
+}
+
+void SpeechRecognizer::set_select_best_result(bool select_best_result)
+{
+    _select_best_result = select_best_result;
+    publish_config();
+}
+
+Ref<gdvosk::VoskModel> SpeechRecognizer::get_wake_model() const
+{
+    return _wake_model;
+}
+
+void SpeechRecognizer::set_wake_model(const Ref<gdvosk::VoskModel>& wake_model)
+{
+    _wake_model = wake_model;
+    publish_config();
+}
+
+PackedStringArray SpeechRecognizer::get_wake_phrases() const
+{
+    return _wake_phrases;
+}
+
+void SpeechRecognizer::set_wake_phrases(const PackedStringArray& wake_phrases)
+{
+    _wake_phrases = wake_phrases;
+    _wake_phrases_utf8 = to_utf8(wake_phrases);
+
+    auto grammar_phrases = _wake_phrases_utf8;
+    grammar_phrases.emplace_back(core::unknown_word);
+
+    _wake_grammar = _wake_phrases_utf8.empty() ? nullptr : core::grammar_cache::shared().get(grammar_phrases);
+
+    publish_config();
+}
+
+float SpeechRecognizer::get_wake_pre_roll() const
+{
+    return _wake_pre_roll;
+}
+
+void SpeechRecognizer::set_wake_pre_roll(float wake_pre_roll)
+{
+    _wake_pre_roll = wake_pre_roll;
+    publish_config();
+}
+
 void SpeechRecognizer::update_bus_data()
 {
     auto* audio_server = AudioServer::get_singleton();
@@ -111,10 +490,7 @@ void SpeechRecognizer::update_bus_data()
     _recording_bus_index = audio_server->get_bus_index(_recording_bus_name);
     if (_recording_bus_index < 0)
     {
-        {
-            semaphore_lock lock(_bus_semaphore);
-            _effect.unref();
-        }
+        set_effect(nullptr);
 
         update_configuration_warnings();
         return;
@@ -122,10 +498,7 @@ void SpeechRecognizer::update_bus_data()
 
     if (audio_server->get_bus_effect_count(_recording_bus_index) < 1)
     {
-        {
-            semaphore_lock lock(_bus_semaphore);
-            _effect.unref();
-        }
+        set_effect(nullptr);
 
         update_configuration_warnings();
         return;
@@ -139,185 +512,1631 @@ void SpeechRecognizer::update_bus_data()
         auto capture_effect = cast_to<AudioEffectCapture>(effect.ptr());
         if (capture_effect != nullptr)
         {
-            {
-                semaphore_lock lock(_bus_semaphore);
-                _effect = effect;
-            }
+            set_effect(capture_effect);
 
             update_configuration_warnings();
             return;
         }
     }
 
+    set_effect(nullptr);
+
+    update_configuration_warnings();
+}
+
+void SpeechRecognizer::set_effect(const Ref<AudioEffectCapture>& effect)
+{
+    if (effect == _effect && (_capture != nullptr) == (effect != nullptr))
     {
-        semaphore_lock lock(_bus_semaphore);
-        _effect.unref();
+        return;
     }
 
-    update_configuration_warnings();
+    _effect = effect;
+
+    // every recognizer on the bus reads through the same hub, so they don't steal frames from each other
+    _capture = _effect != nullptr ? capture_hub::for_effect(_effect)->subscribe() : nullptr;
+
+    publish_config();
 }
 
-void SpeechRecognizer::update_vosk_data()
+void SpeechRecognizer::grow_capture_buffer()
 {
-    stop_voice_recognition();
+    _is_capture_growth_pending = false;
+
+    if (_effect == nullptr || _recording_bus_index < 0)
+    {
+        return;
+    }
+
+    auto buffer_length = _effect->get_buffer_length();
+    auto grown_buffer_length = Math::min(buffer_length * 2.0f, _max_capture_buffer_length);
+    if (grown_buffer_length <= buffer_length)
+    {
+        return;
+    }
+
+    _effect->set_buffer_length(grown_buffer_length);
+
+    // the capture buffer is only allocated when the effect is instantiated, which the audio server does for every
+    // effect on a bus whenever one of them is toggled
+    auto* audio_server = AudioServer::get_singleton();
+    for (auto i = 0; i < audio_server->get_bus_effect_count(_recording_bus_index); ++i)
+    {
+        if (audio_server->get_bus_effect(_recording_bus_index, i).ptr() != _effect.ptr())
+        {
+            continue;
+        }
 
+        auto is_enabled = audio_server->is_bus_effect_enabled(_recording_bus_index, i);
+        audio_server->set_bus_effect_enabled(_recording_bus_index, i, is_enabled);
+        break;
+    }
+}
+
+void SpeechRecognizer::update_vosk_data()
+{
+    // a running worker picks up the new model by itself, swapping it in at the next utterance boundary; without a
+    // model, it's stopped once nothing is left to decode, which a replay in progress still is
     if (_vosk_model != nullptr)
     {
         start_voice_recognition();
     }
+    else if (_replay == nullptr)
+    {
+        stop_voice_recognition();
+    }
 
     update_configuration_warnings();
 }
 
-void SpeechRecognizer::stop_voice_recognition()
+Error SpeechRecognizer::replay_stream(const Ref<AudioStreamWAV>& stream, bool paced)
 {
-    _should_worker_run = false;
-    if (_worker.is_valid())
+    if (stream.is_null())
     {
-        _worker->wait_to_finish();
-        _worker.unref();
+        return ERR_INVALID_PARAMETER;
     }
+
+    auto format = stream->get_format();
+    if (format != AudioStreamWAV::FORMAT_8_BITS && format != AudioStreamWAV::FORMAT_16_BITS)
+    {
+        return ERR_UNAVAILABLE;
+    }
+
+    auto data = stream->get_data();
+
+    std::vector<float> samples;
+    if (format == AudioStreamWAV::FORMAT_16_BITS)
+    {
+        core::decode_pcm16(core::span<const uint8_t>(data.ptr(), static_cast<std::size_t>(data.size())), samples);
+    }
+    else
+    {
+        // unlike in WAV files, Godot stores 8-bit samples as signed
+        samples.resize(static_cast<std::size_t>(data.size()));
+        for (std::size_t i = 0; i < samples.size(); ++i)
+        {
+            samples[i] = static_cast<float>(static_cast<int8_t>(data[static_cast<int64_t>(i)])) / 128.0f;
+        }
+    }
+
+    std::size_t channels = stream->is_stereo() ? 2 : 1;
+    return start_replay(replay_source::from_samples(samples, channels, stream->get_mix_rate(), get_mix_rate(), paced));
 }
 
-void SpeechRecognizer::start_voice_recognition()
+Error SpeechRecognizer::replay_file(const String& path, bool paced)
 {
-    if (_worker.is_valid() && _worker->is_alive())
+    auto file = FileAccess::open(path, FileAccess::READ);
+    if (file.is_null())
     {
-        // TODO: maybe raise an error here
-        return;
+        return FileAccess::get_open_error();
     }
 
-    _should_worker_run = true;
+    auto data = file->get_buffer(static_cast<int64_t>(file->get_length()));
 
-    _worker.instantiate();
+    auto audio = core::decode_wav(core::span<const uint8_t>(data.ptr(), static_cast<std::size_t>(data.size())));
+    if (!audio.has_value())
+    {
+        return ERR_FILE_UNRECOGNIZED;
+    }
 
-    auto callable = callable_mp(this, &SpeechRecognizer::worker_main).bind
+    return start_replay
     (
-        _bus_semaphore,
-        _model_semaphore
+        replay_source::from_samples(audio->samples, audio->channels, audio->sample_rate, get_mix_rate(), paced)
     );
+}
+
+Error SpeechRecognizer::replay_pcm(const PackedByteArray& data, int sample_rate, int channels, bool paced)
+{
+    if (sample_rate <= 0 || channels <= 0)
+    {
+        return ERR_INVALID_PARAMETER;
+    }
+
+    std::vector<float> samples;
+    core::decode_pcm16(core::span<const uint8_t>(data.ptr(), static_cast<std::size_t>(data.size())), samples);
+
+    auto channel_count = static_cast<std::size_t>(channels);
+    return start_replay(replay_source::from_samples(samples, channel_count, sample_rate, get_mix_rate(), paced));
+}
+
+void SpeechRecognizer::stop_replay()
+{
+    _replay = nullptr;
+    publish_config();
+
+    if (_vosk_model == nullptr)
+    {
+        stop_voice_recognition();
+    }
+}
 
-    _worker->start(callable);
+bool SpeechRecognizer::is_replaying() const
+{
+    return _replay != nullptr;
 }
 
-#pragma clang diagnostic push
-#pragma ide diagnostic ignored "performance-unnecessary-value-param"
-void SpeechRecognizer::worker_main
+Error SpeechRecognizer::start_session_recording
 (
-    godot::Ref<godot::Semaphore> bus_semaphore,
-    godot::Ref<godot::Semaphore> model_semaphore
+    const String& directory,
+    int64_t max_segment_size,
+    int64_t max_disk_usage
 )
 {
-    constexpr auto interval_usec = duration_cast<microseconds>(milliseconds(100));
+    if (max_segment_size <= 0 || max_disk_usage <= 0)
+    {
+        return ERR_INVALID_PARAMETER;
+    }
+
+    auto globalized_directory = ProjectSettings::get_singleton()->globalize_path(directory);
+    if (globalized_directory == "")
+    {
+        return ERR_FILE_BAD_PATH;
+    }
 
-    auto mix_rate = ProjectSettings::get_singleton()->get_setting("audio/driver/mix_rate", 44100);
+    auto directory_result = DirAccess::make_dir_recursive_absolute(globalized_directory);
+    if (directory_result != OK)
+    {
+        return directory_result;
+    }
 
-    std::optional<Dictionary> partial_result;
-    std::optional<steady_clock::time_point> no_change_time_start;
+    core::recorder_limits limits;
+    limits.max_segment_size = static_cast<std::uint64_t>(max_segment_size);
+    limits.max_disk_usage = static_cast<std::uint64_t>(max_disk_usage);
 
-    bool has_set_up = false;
-    Ref<gdvosk::VoskRecognizer> recognizer;
-    recognizer.instantiate();
+    auto started_at = static_cast<int64_t>(Time::get_singleton()->get_unix_time_from_system());
+    auto prefix = "session-" + std::to_string(started_at);
 
-    while (_should_worker_run)
+    auto recorder = core::session_recorder::open(to_utf8(globalized_directory), prefix, get_mix_rate(), limits);
+    if (recorder == nullptr)
     {
-        OS::get_singleton()->delay_usec(interval_usec.count());
+        return ERR_FILE_CANT_WRITE;
+    }
 
-        //
-        PackedVector2Array data;
-        {
-            semaphore_lock lock(bus_semaphore);
-            if (_effect == nullptr)
-            {
-                continue;
-            }
+    stop_session_recording();
 
-            auto samples = _effect->get_buffer(_effect->get_frames_available());
-            data = samples;
+    _recorder = std::move(recorder);
+    publish_config();
+
+    return OK;
+}
+
+void SpeechRecognizer::stop_session_recording()
+{
+    if (_recorder == nullptr)
+    {
+        return;
+    }
+
+    auto recorder = std::move(_recorder);
+    _recorder = nullptr;
+
+    publish_config();
+    recorder->close();
+}
+
+bool SpeechRecognizer::is_recording_session() const
+{
+    return _recorder != nullptr;
+}
+
+int64_t SpeechRecognizer::get_dropped_session_records() const
+{
+    return _recorder != nullptr ? static_cast<int64_t>(_recorder->get_dropped_records()) : 0;
+}
+
+Dictionary SpeechRecognizer::get_pipeline_statistics() const
+{
+    auto result_queue = _result_queue.get_statistics();
+
+    Dictionary statistics;
+    statistics["backlog_depth"] = static_cast<int64_t>(_backlog_depth.load());
+    statistics["backlog_peak_depth"] = static_cast<int64_t>(_peak_backlog_depth.load());
+    statistics["backlog_capacity"] = static_cast<int64_t>(capture_hub::max_pending_chunks);
+    statistics["result_queue_depth"] = static_cast<int64_t>(result_queue.depth);
+    statistics["result_queue_peak_depth"] = static_cast<int64_t>(result_queue.peak_depth);
+    statistics["result_queue_capacity"] = static_cast<int64_t>(result_queue.capacity);
+    statistics["result_queue_stalls"] = static_cast<int64_t>(result_queue.stalls);
+
+    return statistics;
+}
+
+Error SpeechRecognizer::start_replay(std::shared_ptr<replay_source> replay)
+{
+    if (replay == nullptr)
+    {
+        return ERR_INVALID_DATA;
+    }
+
+    if (_vosk_model == nullptr)
+    {
+        return ERR_UNCONFIGURED;
+    }
+
+    _replay = std::move(replay);
+
+    publish_config();
+    start_voice_recognition();
+
+    return OK;
+}
+
+void SpeechRecognizer::finish_replay()
+{
+    // a replay started in the meantime is left alone
+    if (_replay != nullptr && _replay->is_finished())
+    {
+        _replay = nullptr;
+        publish_config();
+
+        if (_vosk_model == nullptr)
+        {
+            stop_voice_recognition();
+        }
+    }
+
+    emit_signal("replay_finished");
+}
+
+void SpeechRecognizer::publish_config()
+{
+    auto config = std::make_shared<worker_config>();
+    config->capture = _capture;
+    config->replay = _replay;
+    config->recorder = _recorder;
+    config->model = _vosk_model;
+    config->select_best_result = _select_best_result;
+    config->wake_model = _wake_model;
+    config->wake_phrases = _wake_phrases_utf8;
+    config->wake_grammar = _wake_grammar;
+    config->wake_pre_roll = round<microseconds>(duration<float>(_wake_pre_roll));
+
+    for (int64_t i = 0; i < _additional_models.size(); ++i)
+    {
+        config->additional_models.emplace_back(_additional_models[i]);
+    }
+
+    config->grammar = _compiled_grammar;
+    config->silence_timeout = _silence_timeout;
+    config->options.max_alternatives = _max_alternatives;
+    config->options.words = _include_words_in_output;
+    config->options.partial_words = _include_words_in_partial_output;
+    config->overload_policy = _overload_policy;
+    config->overload_threshold = _overload_threshold;
+    config->fallback_model = _fallback_model;
+    config->cpu_affinity = _cpu_affinity;
+    config->cpu_budget = _cpu_budget;
+    config->channel_mode = _channel_mode;
+    config->decoder_profile = _decoder_profile;
+    config->speaker_model = _speaker_model;
+    config->speaker_registry = _speaker_registry.is_valid() ? _speaker_registry->get_registry() : nullptr;
+    config->speaker_threshold = _speaker_match_threshold;
+
+    std::atomic_store(&_config, std::shared_ptr<const worker_config>(std::move(config)));
+}
+
+void SpeechRecognizer::stop_voice_recognition()
+{
+    _should_worker_run = false;
+    if (_worker.is_valid())
+    {
+        _worker->wait_to_finish();
+        _worker.unref();
+    }
+
+    // the background thread closes the result queue on its way out, so the result thread is done once it has drained
+    if (_result_worker.is_valid())
+    {
+        _result_worker->wait_to_finish();
+        _result_worker.unref();
+    }
+}
+
+void SpeechRecognizer::start_voice_recognition()
+{
+    if (_worker.is_valid() && _worker->is_alive())
+    {
+        // TODO: maybe raise an error here
+        return;
+    }
+
+    _should_worker_run = true;
+    _worker_priority = to_core_priority(_thread_priority);
+
+    _result_queue.open();
+    _backlog_depth = 0;
+    _peak_backlog_depth = 0;
+
+    _result_worker.instantiate();
+    _result_worker->start(callable_mp(this, &SpeechRecognizer::result_main), _thread_priority);
+
+    _worker.instantiate();
+
+    _worker->start(callable_mp(this, &SpeechRecognizer::worker_main), _thread_priority);
+}
+
+void SpeechRecognizer::worker_main()
+{
+    GDVOSK_TRACE_THREAD_NAME("SpeechRecognizer worker");
+
+    constexpr auto max_interval = duration_cast<microseconds>(milliseconds(100));
+    constexpr auto min_interval = duration_cast<microseconds>(milliseconds(10));
+
+    auto interval = max_interval;
+
+    auto mix_rate = get_mix_rate();
+
+    // one lane per model, all fed from the same converted audio; lanes are never relocated, as they are not copyable
+    std::deque<recognizer_lane> lanes;
+    core::front_end front_end(mix_rate);
+    std::vector<core::decode_task> tasks;
+
+    // the recognizers beyond the first decode on helpers that are kept for as long as the worker runs
+    core::decode_helpers decode_helpers;
+
+    // where the results of each lane go
+    std::vector<result_target> lane_targets;
+
+    wake_gate gate;
+
+    core::load_monitor load_monitor;
+
+    // audio that has been read from the capture hub but not decoded yet, oldest first
+    std::vector<PackedVector2Array> backlog;
+
+    // results withheld on the result stage are only let through once every model has finished the utterance
+    auto select_best_results = [&]()
+    {
+        auto is_held = std::any_of
+        (
+            lane_targets.begin(),
+            lane_targets.end(),
+            [](const auto& lane_target) { return lane_target.is_held; }
+        );
+
+        if (!is_held)
+        {
+            return;
+        }
+
+        result_job job;
+        job.type = result_job::kind::select_best_results;
+        job.utterances = get_utterances(lanes);
+
+        queue_result_job(std::move(job));
+    };
+
+    // the replay being decoded in place of the captured audio, if any
+    std::shared_ptr<replay_source> active_replay;
+
+    // ends the utterances in progress and forgets the audio of the stream being decoded, so the next starts afresh
+    auto restart_stream = [&]()
+    {
+        for (std::size_t i = 0; i < lanes.size(); ++i)
+        {
+            auto& lane = lanes[i];
+
+            emit_final_results(lane.active, lane_targets[i]);
+            for (auto& channel : lane.channels)
+            {
+                channel.endpointer.reset();
+                channel.in_utterance = false;
+            }
+        }
+
+        gate.is_open = false;
+        gate.pre_roll.clear();
+        gate.pre_roll_frames = 0;
+
+        backlog.clear();
+        front_end.reset();
+
+        select_best_results();
+    };
+
+    std::optional<int64_t> applied_affinity;
+
+    // decoding time the CPU budget still allows
+    auto budget_credit = microseconds::zero();
+    auto last_tick = steady_clock::now();
+
+    while (_should_worker_run)
+    {
+        OS::get_singleton()->delay_usec(interval.count());
+
+        auto config = std::atomic_load(&_config);
+
+        auto tick = steady_clock::now();
+        auto elapsed = duration_cast<microseconds>(tick - last_tick);
+        last_tick = tick;
+
+        if (applied_affinity != config->cpu_affinity)
+        {
+            core::set_current_thread_affinity(static_cast<std::uint64_t>(config->cpu_affinity));
+            applied_affinity = config->cpu_affinity;
+
+            decode_helpers.configure({ static_cast<std::uint64_t>(config->cpu_affinity), _worker_priority });
+        }
+
+        // a finished replay is only forgotten once the main thread gets to it, and must not be picked up again
+        auto replay = config->replay != nullptr && !config->replay->is_finished() ? config->replay : nullptr;
+        if (replay != active_replay)
+        {
+            // a replay is a stream of its own, with its own clock; nothing carries over between it and live audio
+            restart_stream();
+            active_replay = replay;
+
+            if (replay == nullptr && config->capture != nullptr)
+            {
+                // whatever was captured during the replay is stale by now
+                config->capture->read();
+                config->capture->take_lost_frames();
+            }
+        }
+
+        if (replay == nullptr && config->capture == nullptr)
+        {
+            continue;
+        }
+
+        // a replay is read later on, once there is something to decode it with
+        auto chunks = replay == nullptr ? config->capture->read() : std::vector<PackedVector2Array>();
+        backlog.insert(backlog.end(), chunks.begin(), chunks.end());
+
+        auto lost_frames = replay == nullptr ? config->capture->take_lost_frames() : 0;
+        if (backlog.size() > capture_hub::max_pending_chunks)
+        {
+            // the budget kept decoding from catching up for too long
+            auto excess = backlog.size() - capture_hub::max_pending_chunks;
+            for (std::size_t i = 0; i < excess; ++i)
+            {
+                lost_frames += static_cast<std::uint64_t>(backlog[i].size());
+            }
+
+            backlog.erase(backlog.begin(), backlog.begin() + static_cast<std::ptrdiff_t>(excess));
+        }
+
+        _backlog_depth = backlog.size();
+        if (backlog.size() > _peak_backlog_depth)
+        {
+            _peak_backlog_depth = backlog.size();
+        }
+
+        if (lost_frames > 0)
+        {
+            interval = min_interval;
+
+            GDVOSK_TRACE_SCOPE("signal_dispatch");
+            call_deferred("emit_signal", "audio_overrun", static_cast<int64_t>(lost_frames));
+
+            if (!_is_capture_growth_pending.exchange(true))
+            {
+                callable_mp(this, &SpeechRecognizer::grow_capture_buffer).call_deferred();
+            }
+        }
+        else if (replay != nullptr)
+        {
+            // an unpaced replay is read as fast as it is decoded
+            interval = replay->is_paced() ? max_interval : microseconds::zero();
+        }
+        else
+        {
+            // poll more often while the capture buffer fills up quickly, and back off again once it doesn't
+            int64_t frames = 0;
+            for (const auto& chunk : chunks)
+            {
+                frames += chunk.size();
+            }
+
+            auto capacity = config->capture->get_effect()->get_buffer_length() * static_cast<float>(mix_rate);
+            auto fill = capacity > 0 ? static_cast<float>(frames) / capacity : 0.0f;
+
+            if (fill > 0.5f)
+            {
+                interval = std::max(interval / 2, min_interval);
+            }
+            else if (fill < 0.25f)
+            {
+                interval = std::min(interval + interval / 4, max_interval);
+            }
+        }
+
+        load_monitor.set_threshold(config->overload_threshold);
+
+        auto policy = load_monitor.is_overloaded() ? config->overload_policy : OVERLOAD_POLICY_NONE;
+
+        if (policy == OVERLOAD_POLICY_DROP_OLDEST)
+        {
+            // keep roughly one polling interval's worth of audio, so latency stays bounded
+            auto kept_seconds = duration<double>(max_interval).count();
+            auto kept_frames = static_cast<int64_t>(kept_seconds * static_cast<double>(mix_rate));
+            auto queued_frames = int64_t(0);
+            for (const auto& chunk : backlog)
+            {
+                queued_frames += chunk.size();
+            }
+
+            auto first = backlog.begin();
+            while (first != backlog.end() && queued_frames - first->size() >= kept_frames)
+            {
+                queued_frames -= first->size();
+                ++first;
+            }
+
+            if (first != backlog.end() && queued_frames > kept_frames)
+            {
+                *first = first->slice(queued_frames - kept_frames);
+            }
+
+            backlog.erase(backlog.begin(), first);
+        }
+
+        auto options = config->options;
+        if (policy == OVERLOAD_POLICY_REDUCE_OUTPUT)
+        {
+            // a single alternative keeps the shape of the output the same while skipping most of the n-best work
+            options.max_alternatives = std::min(options.max_alternatives, 1);
+            options.words = false;
+            options.partial_words = false;
+        }
+
+        auto use_fallback = policy == OVERLOAD_POLICY_FALLBACK_MODEL && config->fallback_model != nullptr;
+        const auto& primary_model = use_fallback ? config->fallback_model : config->model;
+
+        std::vector<Ref<VoskModel>> desired_models { primary_model };
+        if (primary_model != nullptr)
+        {
+            desired_models.insert
+            (
+                desired_models.end(),
+                config->additional_models.begin(),
+                config->additional_models.end()
+            );
+        }
+
+        auto model_count = std::count_if
+        (
+            desired_models.begin(),
+            desired_models.end(),
+            [](const auto& model) { return model != nullptr; }
+        );
+
+        // with several models, the audio is resampled once here instead of once inside every recognizer
+        auto is_multi_model = model_count > 1;
+        auto sample_rate = is_multi_model ? shared_sample_rate : mix_rate;
+        auto is_held = is_multi_model && config->select_best_result;
+
+        std::size_t desired_channels = config->channel_mode == gdvosk::VoskRecognizer::CHANNEL_MODE_SPLIT ? 2 : 1;
+
+        if (lanes.size() < desired_models.size())
+        {
+            lanes.resize(desired_models.size());
+        }
+
+        lane_targets.resize(lanes.size());
+        for (std::size_t i = 0; i < lanes.size(); ++i)
+        {
+            auto& lane_target = lane_targets[i];
+            lane_target.model_index = is_multi_model ? static_cast<int>(i) : -1;
+            lane_target.is_held = is_held;
+            lane_target.speakers = config->speaker_registry;
+            lane_target.speaker_threshold = config->speaker_threshold;
+            lane_target.recorder = config->recorder;
+
+            lane_config desired;
+            desired.model = i < desired_models.size() ? desired_models[i] : Ref<VoskModel>();
+            desired.channels = desired_channels;
+
+            if (desired.model != nullptr)
+            {
+                // evicted models and copies of models for other decoder profiles are loaded in the background, and
+                // the lane keeps decoding as it was until they're ready; a switch then waits for the utterance to end
+                desired.lease = desired.model->lease_if_ready(config->decoder_profile);
+                if (desired.lease.get() == nullptr && lanes[i].model != desired.model)
+                {
+                    // a model the lane doesn't decode with yet can start out on its own profile in the meantime
+                    desired.lease = desired.model->lease_if_ready(VoskModel::DECODER_PROFILE_DEFAULT);
+                }
+
+                if (desired.lease.get() == nullptr)
+                {
+                    desired.model = lanes[i].model;
+                    desired.lease = lanes[i].lease;
+                }
+            }
+
+            if (desired.model != nullptr)
+            {
+                desired.speaker_model = config->speaker_model;
+
+                desired.key.model = desired.lease.get();
+                if (desired.speaker_model != nullptr)
+                {
+                    desired.key.speaker_model = desired.speaker_model->get_ptr();
+                }
+
+                desired.key.sample_rate = static_cast<float>(sample_rate);
+
+                // a grammar is written for one language, so it only applies to the primary model
+                desired.key.grammar = i == 0 ? config->grammar : nullptr;
+            }
+
+            update_lane(lanes[i], desired, options, lane_target);
+
+            lanes[i].model = desired.model;
+            lanes[i].lease = std::move(desired.lease);
+        }
+
+        // lanes of models that were removed are dropped once the recognizers they were preparing have arrived
+        while (lanes.size() > desired_models.size() && lanes.back().pending_recognizers.empty())
+        {
+            lanes.pop_back();
+            lane_targets.pop_back();
+        }
+
+        // the wake listener reads the captured audio as-is, and leaves resampling to Vosk
+        auto is_gated = config->wake_model != nullptr && config->wake_grammar != nullptr && primary_model != nullptr;
+
+        core::recognizer_key wake_key;
+        core::model_lease wake_lease;
+        if (is_gated)
+        {
+            wake_lease = config->wake_model->lease_if_ready(VoskModel::DECODER_PROFILE_DEFAULT);
+            wake_key.model = wake_lease.get();
+            wake_key.sample_rate = static_cast<float>(mix_rate);
+            wake_key.grammar = config->wake_grammar;
+        }
+
+        // an evicted wake model is loaded in the background, and the gate is left as it is until it's back
+        if (!is_gated || wake_lease.get() != nullptr)
+        {
+            update_wake_gate(gate, is_gated ? config->wake_model : Ref<VoskModel>(), wake_key, wake_lease);
+        }
+
+        if (!is_gated)
+        {
+            gate.is_open = true;
+            gate.pre_roll.clear();
+            gate.pre_roll_frames = 0;
+        }
+
+        auto is_active = std::any_of
+        (
+            lanes.begin(),
+            lanes.end(),
+            [](const auto& lane) { return !lane.active.instances.empty(); }
+        );
+
+        if (!is_active)
+        {
+            // there is nothing to decode with until the first recognizer is ready
+            backlog.clear();
+            front_end.reset();
+
+            interval = std::max(interval, min_interval);
+            continue;
+        }
+
+        if (replay != nullptr)
+        {
+            auto chunk_frames = static_cast<int64_t>(duration<double>(max_interval).count() * mix_rate);
+
+            auto chunk = replay->read(steady_clock::now(), chunk_frames);
+            if (!chunk.is_empty())
+            {
+                backlog.push_back(std::move(chunk));
+            }
+        }
+
+        for (auto& lane : lanes)
+        {
+            for (auto& channel : lane.channels)
+            {
+                channel.endpointer.set_silence_timeout(config->silence_timeout);
+            }
+        }
+
+        auto decode_start = steady_clock::now();
+        auto decoded_frames = int64_t(0);
+
+        // decoding time spent on the helpers, which the wall time of the worker doesn't show
+        auto helper_time = microseconds::zero();
+
+        // a replay runs on its own clock, which stands at the end of the audio read from it so far
+        auto now = replay != nullptr
+            ? replay->get_audio_time()
+            : duration_cast<microseconds>(decode_start.time_since_epoch());
+
+        auto has_budget = config->cpu_budget > 0.0f && config->cpu_budget < 1.0f;
+        if (has_budget)
+        {
+            // accrue a share of the elapsed wall time, but don't let an idle stretch bank an unbounded burst
+            auto accrued = duration_cast<microseconds>(elapsed * config->cpu_budget);
+            auto max_credit = duration_cast<microseconds>(max_interval * config->cpu_budget);
+            budget_credit = std::min(budget_credit + accrued, max_credit);
+        }
+
+        auto skip_partials = policy == OVERLOAD_POLICY_SKIP_PARTIALS;
+
+        // every recognizer decodes the same chunk, each on its own thread, from audio converted once per format
+        auto decode = [&](const PackedVector2Array& data, bool is_recorded)
+        {
+            decoded_frames += data.size();
+
+            frame_view frames(data);
+            front_end.push(frames.samples());
+
+            if (is_recorded && config->recorder != nullptr)
+            {
+                config->recorder->record_audio(front_end.get(core::stream_format { 1, mix_rate }, 0));
+            }
+
+            tasks.clear();
+            for (auto& lane : lanes)
+            {
+                const auto& active = lane.active;
+                core::stream_format format { active.instances.size(), static_cast<int>(active.key.sample_rate) };
+
+                for (std::size_t c = 0; c < active.instances.size(); ++c)
+                {
+                    tasks.push_back({ active.instances[c].get(), front_end.get(format, c) });
+                }
+            }
+
+            helper_time += core::accept_all(decode_helpers, tasks);
+
+            auto task = tasks.begin();
+            for (std::size_t i = 0; i < lanes.size(); ++i)
+            {
+                auto& lane = lanes[i];
+                for (std::size_t c = 0; c < lane.active.instances.size(); ++c, ++task)
+                {
+                    handle_status
+                    (
+                        *task->target,
+                        task->status,
+                        lane.channels[c],
+                        get_result_target(lane.active, c, lane_targets[i]),
+                        skip_partials,
+                        now
+                    );
+                }
+            }
+        };
+
+        auto max_pre_roll_frames = static_cast<int64_t>
+        (
+            duration<double>(config->wake_pre_roll).count() * static_cast<double>(mix_rate)
+        );
+
+        std::size_t decoded_chunks = 0;
+        for (const auto& data : backlog)
+        {
+            if (has_budget && budget_credit <= microseconds::zero())
+            {
+                break;
+            }
+
+            auto chunk_start = steady_clock::now();
+            auto chunk_helper_time = helper_time;
+
+            ++decoded_chunks;
+
+            if (gate.is_open)
+            {
+                decode(data, true);
+            }
+            else
+            {
+                // only the wake listener runs, while the audio it hears is kept for the full recognizers
+                decoded_frames += data.size();
+
+                gate.pre_roll.push_back(data);
+                gate.pre_roll_frames += data.size();
+
+                // the newest chunk is always kept, since it's the one the wake phrase ends in
+                while (gate.pre_roll.size() > 1)
+                {
+                    if (gate.pre_roll_frames - gate.pre_roll.front().size() < max_pre_roll_frames)
+                    {
+                        break;
+                    }
+
+                    gate.pre_roll_frames -= gate.pre_roll.front().size();
+                    gate.pre_roll.pop_front();
+                }
+
+                frame_view frames(data);
+                front_end.push(frames.samples());
+
+                if (config->recorder != nullptr)
+                {
+                    config->recorder->record_audio(front_end.get(core::stream_format { 1, mix_rate }, 0));
+                }
+
+                auto phrase = listen_for_wake_phrase
+                (
+                    gate,
+                    front_end.get(core::stream_format { 1, mix_rate }, 0),
+                    config->wake_phrases
+                );
+
+                if (phrase.has_value())
+                {
+                    {
+                        GDVOSK_TRACE_SCOPE("signal_dispatch");
+
+                        auto wake_phrase = String::utf8(config->wake_phrases[*phrase].c_str());
+                        call_deferred("emit_signal", "wake_word_detected", wake_phrase);
+                    }
+
+                    gate.is_open = true;
+                    gate.opened_at = now;
+                    gate.has_heard_speech = false;
+
+                    for (const auto& buffered : gate.pre_roll)
+                    {
+                        // the pre-roll was recorded as it was heard
+                        decode(buffered, false);
+                    }
+
+                    gate.pre_roll.clear();
+                    gate.pre_roll_frames = 0;
+                }
+            }
+
+            // the budget bounds the decoding work, wherever it ran
+            budget_credit -= duration_cast<microseconds>(steady_clock::now() - chunk_start);
+            budget_credit -= helper_time - chunk_helper_time;
+        }
+
+        backlog.erase(backlog.begin(), backlog.begin() + static_cast<std::ptrdiff_t>(decoded_chunks));
+        _backlog_depth = backlog.size();
+
+        auto decode_time = duration_cast<microseconds>(steady_clock::now() - decode_start);
+        auto audio_duration = duration_cast<microseconds>
+        (
+            duration<double>(static_cast<double>(decoded_frames) / static_cast<double>(mix_rate))
+        );
+
+        if (load_monitor.observe(decode_time, audio_duration))
+        {
+            GDVOSK_TRACE_SCOPE("signal_dispatch");
+            call_deferred
+            (
+                "emit_signal",
+                "overload_changed",
+                load_monitor.is_overloaded(),
+                load_monitor.get_real_time_factor()
+            );
+        }
+
+        for (std::size_t i = 0; i < lanes.size(); ++i)
+        {
+            auto& lane = lanes[i];
+            for (std::size_t c = 0; c < lane.channels.size(); ++c)
+            {
+                auto& channel = lane.channels[c];
+                if (!channel.endpointer.is_endpoint(now))
+                {
+                    continue;
+                }
+
+                channel.endpointer.reset();
+                channel.in_utterance = false;
+
+                emit_final_result(*lane.active.instances[c], get_result_target(lane.active, c, lane_targets[i]));
+            }
+        }
+
+        if (is_gated && gate.is_open)
+        {
+            auto in_utterance = std::any_of
+            (
+                lanes.begin(),
+                lanes.end(),
+                [](const auto& lane)
+                {
+                    return std::any_of
+                    (
+                        lane.channels.begin(),
+                        lane.channels.end(),
+                        [](const auto& channel) { return channel.in_utterance; }
+                    );
+                }
+            );
+
+            gate.has_heard_speech = gate.has_heard_speech || in_utterance;
+
+            // the gate closes after the utterance that followed the wake phrase, or if none followed it in time
+            auto has_timed_out = now - gate.opened_at > config->silence_timeout;
+            if (!in_utterance && (gate.has_heard_speech || has_timed_out))
+            {
+                for (std::size_t i = 0; i < lanes.size(); ++i)
+                {
+                    auto& lane = lanes[i];
+
+                    emit_final_results(lane.active, lane_targets[i]);
+                    for (auto& channel : lane.channels)
+                    {
+                        channel.endpointer.reset();
+                    }
+                }
+
+                gate.is_open = false;
+            }
+        }
+
+        if (replay != nullptr && replay->is_exhausted() && backlog.empty())
+        {
+            restart_stream();
+            replay->finish();
+
+            // replay_finished must not overtake the results still on their way through the result stage
+            result_job job;
+            job.type = result_job::kind::finish_replay;
+
+            queue_result_job(std::move(job));
+        }
+
+        select_best_results();
+    }
+
+    if (gate.pending_listener.valid())
+    {
+        core::recognizer_pool::shared().release(gate.pending_key, gate.pending_listener.get());
+    }
+
+    release_recognizers(gate.listener);
+
+    for (auto& lane : lanes)
+    {
+        for (auto& recognizer : lane.pending_recognizers)
+        {
+            lane.pending.instances.push_back(recognizer.get());
+        }
+
+        release_recognizers(lane.pending);
+        release_recognizers(lane.staged);
+        release_recognizers(lane.active);
+    }
+
+    _backlog_depth = 0;
+    _result_queue.close();
+}
+
+void SpeechRecognizer::result_main()
+{
+    GDVOSK_TRACE_THREAD_NAME("SpeechRecognizer results");
+
+    // held to the same cores as the background thread, following changes between jobs
+    std::optional<int64_t> applied_affinity;
+    auto apply_affinity = [&]
+    {
+        auto cpu_affinity = std::atomic_load(&_config)->cpu_affinity;
+        if (applied_affinity != cpu_affinity)
+        {
+            core::set_current_thread_affinity(static_cast<std::uint64_t>(cpu_affinity));
+            applied_affinity = cpu_affinity;
+        }
+    };
+
+    apply_affinity();
+    while (auto job = _result_queue.pop())
+    {
+        apply_affinity();
+        handle_result_job(*job);
+    }
+
+    _held_results.clear();
+}
+
+void SpeechRecognizer::handle_result_job(result_job& job)
+{
+    GDVOSK_TRACE_SCOPE("result_handling");
+
+    switch (job.type)
+    {
+        case result_job::kind::partial_result:
+        {
+            auto dictionary = to_dictionary(job.partial->document);
+            tag_result(dictionary, job.target);
+
+            GDVOSK_TRACE_SCOPE("signal_dispatch");
+            call_deferred("emit_signal", "partial_result", dictionary);
+            break;
         }
+        case result_job::kind::result:
+        {
+            auto result = core::parse_result(job.json);
+            if (!result.has_value())
+            {
+                emit_result("result", Dictionary(), std::nullopt, job.target);
+                break;
+            }
 
-        if (!has_set_up)
+            auto dictionary = to_dictionary(result->document);
+            identify_speaker(dictionary, *result, job.target);
+
+            auto confidence = result->text.empty() ? std::optional<double>() : result->confidence();
+            emit_result("result", dictionary, confidence, job.target);
+            break;
+        }
+        case result_job::kind::final_result:
         {
-            Error setup;
+            auto final_result = core::parse_result(job.json);
+            if (!final_result.has_value() || final_result->text.empty())
             {
-                semaphore_lock lock(model_semaphore);
-                setup = recognizer->setup(_vosk_model, static_cast<float>(mix_rate));
+                break;
             }
 
-            if (setup != OK)
+            auto dictionary = to_dictionary(final_result->document);
+            identify_speaker(dictionary, *final_result, job.target);
+
+            emit_result("final_result", dictionary, final_result->confidence(), job.target);
+            break;
+        }
+        case result_job::kind::select_best_results:
+        {
+            if (!_held_results.empty())
             {
-                continue;
+                emit_best_results(job.utterances);
             }
 
-            has_set_up = true;
+            break;
+        }
+        case result_job::kind::finish_replay:
+        default:
+        {
+            callable_mp(this, &SpeechRecognizer::finish_replay).call_deferred();
+            break;
+        }
+    }
+}
+
+void SpeechRecognizer::queue_result_job(result_job job)
+{
+    _result_queue.push(std::move(job));
+}
+
+void SpeechRecognizer::update_lane
+(
+    recognizer_lane& lane,
+    const lane_config& desired,
+    const core::recognizer_options& options,
+    const result_target& lane_target
+)
+{
+    // recognizers for a new model or grammar are prepared in the background and staged until they can be swapped in,
+    // so decoding continues on the active recognizers in the meantime and no audio is lost
+    auto is_pending_ready = !lane.pending_recognizers.empty() && std::all_of
+    (
+        lane.pending_recognizers.begin(),
+        lane.pending_recognizers.end(),
+        [](const auto& recognizer) { return recognizer.wait_for(seconds(0)) == std::future_status::ready; }
+    );
+
+    if (is_pending_ready)
+    {
+        for (auto& recognizer : lane.pending_recognizers)
+        {
+            lane.pending.instances.push_back(recognizer.get());
         }
 
-        auto accept_waveform = recognizer->accept_samples(data);
+        lane.pending_recognizers.clear();
+        lane.pending_lease = core::model_lease();
 
-        switch (accept_waveform)
+        auto is_complete = std::all_of
+        (
+            lane.pending.instances.begin(),
+            lane.pending.instances.end(),
+            [](const auto& instance) { return instance != nullptr; }
+        );
+
+        if (!is_complete)
         {
-            case ERR_BUSY:
-            {
-                auto new_partial_result = recognizer->get_partial_result();
-                if (!partial_result.has_value() || partial_result != new_partial_result)
-                {
-                    partial_result = new_partial_result;
-                    no_change_time_start = steady_clock::now();
+            // don't keep retrying a configuration the model can't handle
+            lane.rejected_key = lane.pending.key;
+            release_recognizers(lane.pending);
+        }
+        else
+        {
+            release_recognizers(lane.staged);
+            lane.staged = std::move(lane.pending);
+        }
 
-                    if (partial_result->get("partial", "") != "")
-                    {
-                        call_deferred("emit_signal", "partial_result", *partial_result);
-                    }
-                }
+        lane.pending = recognizer_slot();
+    }
+
+    auto is_staged = !lane.staged.instances.empty();
+    if (is_staged && (lane.staged.key != desired.key || lane.staged.instances.size() != desired.channels))
+    {
+        // the configuration changed again while this one was being prepared
+        release_recognizers(lane.staged);
+        is_staged = false;
+    }
+
+    // grammar and channel switches happen right away, while model switches wait for the current utterance to end;
+    // either way, whatever the active recognizers have heard so far is flushed out as a final result
+    auto in_utterance = std::any_of
+    (
+        lane.channels.begin(),
+        lane.channels.end(),
+        [](const auto& channel) { return channel.in_utterance; }
+    );
+
+    auto can_swap = lane.active.instances.empty() || !in_utterance || lane.staged.key.model == lane.active.key.model;
+    if (is_staged && can_swap)
+    {
+        GDVOSK_TRACE_SCOPE("recognizer_swap");
+
+        emit_final_results(lane.active, lane_target);
+        release_recognizers(lane.active);
+
+        lane.active = std::move(lane.staged);
+        lane.staged = recognizer_slot();
 
+        for (auto& instance : lane.active.instances)
+        {
+            instance->apply(options);
+        }
+
+        lane.applied_options = options;
+        lane.channels = std::vector<channel_state>(lane.active.instances.size());
+    }
+
+    if (desired.model == nullptr)
+    {
+        emit_final_results(lane.active, lane_target);
+        release_recognizers(lane.active);
+        lane.channels.clear();
+        return;
+    }
+
+    auto is_wanted = desired.key != lane.active.key || desired.channels != lane.active.instances.size();
+    auto is_idle = lane.staged.instances.empty() && lane.pending_recognizers.empty();
+    if (is_wanted && is_idle && desired.key != lane.rejected_key)
+    {
+        lane.pending.key = desired.key;
+        lane.pending.model = desired.model;
+        lane.pending.speaker_model = desired.speaker_model;
+        lane.pending_lease = desired.lease;
+
+        for (std::size_t i = 0; i < desired.channels; ++i)
+        {
+            lane.pending_recognizers.push_back(core::recognizer_pool::shared().acquire_async(lane.pending.key));
+        }
+    }
+
+    if (options != lane.applied_options)
+    {
+        for (auto& instance : lane.active.instances)
+        {
+            instance->apply(options);
+        }
+
+        lane.applied_options = options;
+    }
+}
+
+void SpeechRecognizer::handle_status
+(
+    core::recognizer& recognizer,
+    core::accept_status status,
+    channel_state& channel,
+    const result_target& target,
+    bool skip_partials,
+    microseconds now
+)
+{
+    switch (status)
+    {
+        case core::accept_status::partial_ready:
+        {
+            if (skip_partials)
+            {
                 break;
             }
-            case OK:
+
+            const auto* partial_json = recognizer.partial_result_json();
+            if (partial_json == nullptr || !channel.endpointer.observe_partial(partial_json, now))
             {
-                call_deferred("emit_signal", "result", recognizer->get_result());
                 break;
             }
-            case FAILED:
-            default:
+
+            auto partial_result = core::parse_result(partial_json);
+            channel.in_utterance = partial_result.has_value() && !partial_result->text.empty();
+
+            if (channel.in_utterance)
             {
-                continue;
+                if (target.recorder != nullptr)
+                {
+                    target.recorder->record_event("partial", partial_json, target.model_index, target.channel_index);
+                }
+
+                result_job job;
+                job.type = result_job::kind::partial_result;
+                job.target = target;
+                job.partial = std::move(partial_result);
+
+                queue_result_job(std::move(job));
+            }
+
+            break;
+        }
+        case core::accept_status::result_ready:
+        {
+            channel.in_utterance = false;
+
+            const auto* result_json = recognizer.result_json();
+            if (result_json != nullptr && target.recorder != nullptr)
+            {
+                target.recorder->record_event("result", result_json, target.model_index, target.channel_index);
+            }
+
+            // the document is copied out, since the recognizer reuses its buffer for the next result
+            result_job job;
+            job.type = result_job::kind::result;
+            job.target = target;
+            job.json = result_json != nullptr ? result_json : "";
+
+            queue_result_job(std::move(job));
+            break;
+        }
+        case core::accept_status::failed:
+        default:
+        {
+            break;
+        }
+    }
+}
+
+void SpeechRecognizer::emit_result
+(
+    const StringName& signal,
+    Dictionary result,
+    std::optional<double> confidence,
+    const result_target& target
+)
+{
+    tag_result(result, target);
+
+    if (target.is_held)
+    {
+        _held_results.push_back({ target, signal, result, confidence });
+        return;
+    }
+
+    GDVOSK_TRACE_SCOPE("signal_dispatch");
+    call_deferred("emit_signal", signal, result);
+}
+
+void SpeechRecognizer::emit_best_results(const std::vector<std::vector<bool>>& utterances)
+{
+    std::vector<int> channel_indices;
+    for (const auto& held : _held_results)
+    {
+        auto channel_index = held.target.channel_index;
+        if (std::find(channel_indices.begin(), channel_indices.end(), channel_index) == channel_indices.end())
+        {
+            channel_indices.push_back(channel_index);
+        }
+    }
+
+    for (auto channel_index : channel_indices)
+    {
+        auto in_utterance = std::any_of
+        (
+            utterances.begin(),
+            utterances.end(),
+            [&](const auto& channels)
+            {
+                for (std::size_t c = 0; c < channels.size(); ++c)
+                {
+                    auto is_same_channel = channel_index < 0 || static_cast<int>(c) == channel_index;
+                    if (is_same_channel && channels[c])
+                    {
+                        return true;
+                    }
+                }
+
+                return false;
             }
+        );
+
+        if (in_utterance)
+        {
+            // wait for the slower models to finish the utterance too
+            continue;
         }
 
-        auto now = steady_clock::now();
-        if (no_change_time_start.has_value() && (now - *no_change_time_start > _silence_timeout.load()))
+        // rank the models by the mean confidence of the results they heard something in; ties go to the lower index
+        std::optional<int> best_model;
+        auto best_confidence = 0.0;
+        for (std::size_t i = 0; i < utterances.size(); ++i)
         {
-            partial_result = std::nullopt;
-            no_change_time_start = std::nullopt;
+            auto sum = 0.0;
+            auto count = 0;
+            for (const auto& held : _held_results)
+            {
+                auto is_candidate = held.target.channel_index == channel_index
+                    && held.target.model_index == static_cast<int>(i)
+                    && held.confidence.has_value();
 
-            auto final_result = recognizer->get_final_result();
-            auto final_alternatives = static_cast<Array>(final_result.get("alternatives", Array()));
+                if (is_candidate)
+                {
+                    sum += *held.confidence;
+                    ++count;
+                }
+            }
 
-            if (final_alternatives.is_empty())
+            if (count == 0)
             {
                 continue;
             }
 
-            auto final_alternative = static_cast<Dictionary>(final_alternatives[0]);
+            auto confidence = sum / count;
+            if (!best_model.has_value() || confidence > best_confidence)
+            {
+                best_model = static_cast<int>(i);
+                best_confidence = confidence;
+            }
+        }
 
-            if (final_alternative.get("text", "") == "")
+        for (const auto& held : _held_results)
+        {
+            if (held.target.channel_index != channel_index || held.target.model_index != best_model)
             {
                 continue;
             }
 
-            call_deferred("emit_signal", "final_result", final_result);
+            GDVOSK_TRACE_SCOPE("signal_dispatch");
+            call_deferred("emit_signal", held.signal, held.data);
         }
+
+        _held_results.erase
+        (
+            std::remove_if
+            (
+                _held_results.begin(),
+                _held_results.end(),
+                [&](const auto& held) { return held.target.channel_index == channel_index; }
+            ),
+            _held_results.end()
+        );
     }
 }
-#pragma clang diagnostic pop
 
-SpeechRecognizer::SpeechRecognizer()
+std::vector<std::vector<bool>> SpeechRecognizer::get_utterances(const std::deque<recognizer_lane>& lanes)
+{
+    std::vector<std::vector<bool>> utterances;
+    utterances.reserve(lanes.size());
+
+    for (const auto& lane : lanes)
+    {
+        auto& channels = utterances.emplace_back();
+        for (const auto& channel : lane.channels)
+        {
+            channels.push_back(channel.in_utterance);
+        }
+    }
+
+    return utterances;
+}
+
+void SpeechRecognizer::update_wake_gate
+(
+    wake_gate& gate,
+    const Ref<gdvosk::VoskModel>& desired_model,
+    const core::recognizer_key& desired_key,
+    const core::model_lease& desired_lease
+)
+{
+    auto is_pending_ready = gate.pending_listener.valid()
+        && gate.pending_listener.wait_for(seconds(0)) == std::future_status::ready;
+
+    if (is_pending_ready)
+    {
+        auto listener = gate.pending_listener.get();
+        gate.pending_lease = core::model_lease();
+
+        if (listener == nullptr)
+        {
+            // don't keep retrying a configuration the model can't handle
+            gate.rejected_key = gate.pending_key;
+        }
+        else if (gate.pending_key == desired_key)
+        {
+            // the listener's state is of no value, so it's replaced right away
+            release_recognizers(gate.listener);
+
+            gate.listener.instances.push_back(std::move(listener));
+            gate.listener.key = gate.pending_key;
+            gate.listener.model = desired_model;
+        }
+        else
+        {
+            core::recognizer_pool::shared().release(gate.pending_key, std::move(listener));
+        }
+    }
+
+    if (desired_model == nullptr)
+    {
+        release_recognizers(gate.listener);
+        return;
+    }
+
+    auto is_wanted = desired_key != gate.listener.key;
+    if (is_wanted && !gate.pending_listener.valid() && desired_key != gate.rejected_key)
+    {
+        gate.pending_key = desired_key;
+        gate.pending_lease = desired_lease;
+        gate.pending_listener = core::recognizer_pool::shared().acquire_async(desired_key);
+    }
+}
+
+std::optional<std::size_t> SpeechRecognizer::listen_for_wake_phrase
+(
+    wake_gate& gate,
+    core::span<const float> samples,
+    const std::vector<std::string>& phrases
+)
+{
+    if (gate.listener.instances.empty())
+    {
+        return std::nullopt;
+    }
+
+    auto& listener = *gate.listener.instances.front();
+
+    const char* json = nullptr;
+    switch (listener.accept(samples))
+    {
+        case core::accept_status::partial_ready:
+        {
+            json = listener.partial_result_json();
+            break;
+        }
+        case core::accept_status::result_ready:
+        {
+            json = listener.result_json();
+            break;
+        }
+        case core::accept_status::failed:
+        default:
+        {
+            break;
+        }
+    }
+
+    auto result = json != nullptr ? core::parse_result(json) : std::nullopt;
+    if (!result.has_value())
+    {
+        return std::nullopt;
+    }
+
+    auto phrase = core::find_phrase(result->text, phrases);
+    if (phrase.has_value())
+    {
+        // the next time the gate closes, listening starts from scratch
+        listener.reset();
+    }
+
+    return phrase;
+}
+
+void SpeechRecognizer::release_recognizers(recognizer_slot& slot)
+{
+    for (auto& instance : slot.instances)
+    {
+        core::recognizer_pool::shared().release(slot.key, std::move(instance));
+    }
+
+    slot.instances.clear();
+    slot.key = core::recognizer_key();
+    slot.model.unref();
+    slot.speaker_model.unref();
+}
+
+result_target SpeechRecognizer::get_result_target
+(
+    const recognizer_slot& slot,
+    std::size_t instance,
+    const result_target& lane_target
+)
+{
+    auto target = lane_target;
+    target.channel_index = slot.instances.size() > 1 ? static_cast<int>(instance) : -1;
+
+    return target;
+}
+
+void SpeechRecognizer::tag_result(Dictionary& result, const result_target& target)
+{
+    if (target.model_index >= 0)
+    {
+        result["model"] = target.model_index;
+    }
+
+    if (target.channel_index >= 0)
+    {
+        result["channel"] = target.channel_index;
+    }
+}
+
+void SpeechRecognizer::identify_speaker
+(
+    Dictionary& result,
+    const core::recognition_result& parsed,
+    const result_target& target
+)
+{
+    if (target.speakers == nullptr || parsed.speaker_vector.empty())
+    {
+        return;
+    }
+
+    auto matches = target.speakers->match(parsed.speaker_vector);
+    if (matches.empty() || matches.front().score < target.speaker_threshold)
+    {
+        return;
+    }
+
+    result["speaker"] = String::utf8(matches.front().id.c_str());
+    result["speaker_score"] = matches.front().score;
+}
+
+void SpeechRecognizer::emit_final_results(recognizer_slot& slot, const result_target& lane_target)
 {
-    _model_semaphore.instantiate();
-    _model_semaphore->post();
+    for (std::size_t i = 0; i < slot.instances.size(); ++i)
+    {
+        emit_final_result(*slot.instances[i], get_result_target(slot, i, lane_target));
+    }
+}
+
+void SpeechRecognizer::emit_final_result(core::recognizer& recognizer, const result_target& target)
+{
+    const auto* final_json = recognizer.final_result_json();
+    if (final_json == nullptr)
+    {
+        return;
+    }
 
-    _bus_semaphore.instantiate();
-    _bus_semaphore->post();
+    if (target.recorder != nullptr)
+    {
+        target.recorder->record_event("final", final_json, target.model_index, target.channel_index);
+    }
+
+    result_job job;
+    job.type = result_job::kind::final_result;
+    job.target = target;
+    job.json = final_json;
+
+    queue_result_job(std::move(job));
+}
+
+SpeechRecognizer::SpeechRecognizer()
+{
+    publish_config();
 }
 
 SpeechRecognizer::~SpeechRecognizer()
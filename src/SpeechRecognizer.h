@@ -6,23 +6,290 @@
 
 #include <condition_variable>
 #include <chrono>
+#include <deque>
+#include <future>
 #include <memory>
 #include <optional>
+#include <string>
 #include <variant>
+#include <vector>
 #include <queue>
 #include <godot_cpp/classes/audio_effect_record.hpp>
 #include <godot_cpp/classes/audio_effect_capture.hpp>
 #include <godot_cpp/classes/audio_server.hpp>
+#include <godot_cpp/classes/audio_stream_wav.hpp>
 #include <godot_cpp/classes/node.hpp>
 #include <godot_cpp/classes/thread.hpp>
+#include <godot_cpp/variant/typed_array.hpp>
 
 #include <vosk_api.h>
-#include <godot_cpp/classes/semaphore.hpp>
 #include "vosk/VoskModel.h"
+#include "vosk/VoskRecognizer.h"
+#include "vosk/VoskSpeakerModel.h"
+#include "vosk/VoskSpeakerRegistry.h"
+#include "core/bounded_queue.h"
+#include "core/endpointer.h"
+#include "core/grammar.h"
+#include "core/recognizer.h"
+#include "core/recognizer_pool.h"
+#include "core/result.h"
+#include "core/session_recorder.h"
+#include "core/speaker_registry.h"
 #include "helpers/auto_property.h"
+#include "helpers/capture_hub.h"
+#include "helpers/replay_source.h"
 
 namespace gdvosk
 {
+    /**
+     * Represents a set of native recognizers owned by the background thread, along with the configuration they were
+     * acquired with.
+     */
+    struct recognizer_slot
+    {
+        /**
+         * Holds one recognizer per decoded channel, or a single recognizer when the channels are mixed.
+         */
+        std::vector<std::unique_ptr<core::recognizer>> instances;
+        core::recognizer_key key;
+
+        /**
+         * Holds the model the recognizer was built on, keeping it alive for as long as the recognizer is in use.
+         */
+        godot::Ref<VoskModel> model;
+
+        /**
+         * Holds the speaker model attached to the recognizer, if any, keeping it alive for as long as the recognizer
+         * is in use.
+         */
+        godot::Ref<VoskSpeakerModel> speaker_model;
+    };
+
+    /**
+     * Represents the configuration a lane's recognizers should have.
+     */
+    struct lane_config
+    {
+        /**
+         * Holds the model the lane should decode with, or nullptr to stop decoding.
+         */
+        godot::Ref<VoskModel> model;
+        godot::Ref<VoskSpeakerModel> speaker_model;
+        core::recognizer_key key;
+
+        /**
+         * Holds a lease on the native model of the key, which keeps it resident while recognizers are created from it.
+         */
+        core::model_lease lease;
+
+        /**
+         * Holds the number of recognizers the lane should have.
+         */
+        std::size_t channels = 1;
+    };
+
+    /**
+     * Represents the state of the utterance in progress on one decoded channel.
+     */
+    struct channel_state
+    {
+        core::endpointer endpointer;
+
+        /**
+         * Holds a value indicating whether the channel's current partial result contains speech.
+         */
+        bool in_utterance = false;
+    };
+
+    /**
+     * Represents the recognizers decoding captured audio with one model, along with the recognizers being prepared to
+     * replace them and the state of the utterances in progress on them.
+     */
+    struct recognizer_lane
+    {
+        /**
+         * Holds the recognizers currently decoding.
+         */
+        recognizer_slot active;
+
+        /**
+         * Holds recognizers for a new configuration, waiting to be swapped in.
+         */
+        recognizer_slot staged;
+
+        /**
+         * Holds the configuration of the recognizers being created in the background.
+         */
+        recognizer_slot pending;
+        std::vector<std::future<std::unique_ptr<core::recognizer>>> pending_recognizers;
+
+        /**
+         * Holds a lease on the model the recognizers are being created from, until they have been.
+         */
+        core::model_lease pending_lease;
+
+        /**
+         * Holds the model the lane was last configured with, along with a lease on the native model it was to decode
+         * with, which the lane keeps decoding with while a copy of the model for another decoder profile is loaded.
+         */
+        godot::Ref<VoskModel> model;
+        core::model_lease lease;
+
+        /**
+         * Holds a configuration the model could not create recognizers for, so it isn't retried.
+         */
+        std::optional<core::recognizer_key> rejected_key;
+
+        /**
+         * Holds one entry per active recognizer.
+         */
+        std::vector<channel_state> channels;
+        core::recognizer_options applied_options;
+    };
+
+    /**
+     * Represents the keyword gate in front of the full recognizers: a cheap grammar-restricted recognizer that listens
+     * for a wake phrase, while recent audio is kept so it can be replayed to the full recognizers once it's heard.
+     */
+    struct wake_gate
+    {
+        /**
+         * Holds the recognizer listening for wake phrases.
+         */
+        recognizer_slot listener;
+
+        /**
+         * Holds the recognizer being created in the background, along with its configuration.
+         */
+        std::future<std::unique_ptr<core::recognizer>> pending_listener;
+        core::recognizer_key pending_key;
+        core::model_lease pending_lease;
+
+        /**
+         * Holds a configuration the model could not create a recognizer for, so it isn't retried.
+         */
+        std::optional<core::recognizer_key> rejected_key;
+
+        /**
+         * Holds a value indicating whether the full recognizers are being fed.
+         */
+        bool is_open = false;
+
+        /**
+         * Holds the time at which the gate last opened.
+         */
+        std::chrono::microseconds opened_at = std::chrono::microseconds::zero();
+
+        /**
+         * Holds a value indicating whether the full recognizers have heard speech since the gate last opened.
+         */
+        bool has_heard_speech = false;
+
+        /**
+         * Holds the most recent audio while the gate is closed, oldest first.
+         */
+        std::deque<godot::PackedVector2Array> pre_roll;
+        int64_t pre_roll_frames = 0;
+    };
+
+    /**
+     * Represents where the results of one recognizer go.
+     */
+    struct result_target
+    {
+        /**
+         * Holds the index of the model to tag results with, or -1 for none.
+         */
+        int model_index = -1;
+
+        /**
+         * Holds the index of the channel to tag results with, or -1 for none.
+         */
+        int channel_index = -1;
+
+        /**
+         * Holds a value indicating whether complete results are held back for best-result selection.
+         */
+        bool is_held = false;
+
+        /**
+         * Holds the registry to identify the speakers of complete results against, or nullptr for none.
+         */
+        std::shared_ptr<const core::speaker_registry> speakers;
+
+        /**
+         * Holds the score a speaker must reach for a result to be attributed to them.
+         */
+        float speaker_threshold = 0;
+
+        /**
+         * Holds the recorder to log results to, or nullptr for none.
+         */
+        std::shared_ptr<core::session_recorder> recorder;
+    };
+
+    /**
+     * Represents a result withheld until every model has finished the utterance, so the best one can be chosen.
+     */
+    struct held_result
+    {
+        result_target target;
+
+        /**
+         * Holds the name of the signal to emit the result with.
+         */
+        godot::StringName signal;
+        godot::Dictionary data;
+
+        /**
+         * Holds the confidence of the result, or nothing if nothing was recognized.
+         */
+        std::optional<double> confidence;
+    };
+
+    /**
+     * Represents a piece of work passed from the decoding stage of the background pipeline to the result stage, which
+     * converts results to Godot types and emits them while the next chunk is being decoded.
+     */
+    struct result_job
+    {
+        enum class kind
+        {
+            partial_result,
+            result,
+            final_result,
+
+            /**
+             * Emit the best of the withheld results for every channel on which no model is in an utterance any more.
+             */
+            select_best_results,
+
+            /**
+             * Report that the replay has been decoded, once everything before it has been emitted.
+             */
+            finish_replay
+        };
+
+        kind type = kind::result;
+        result_target target;
+
+        /**
+         * Holds the JSON document of a complete or final result, which the result stage parses.
+         */
+        std::string json;
+
+        /**
+         * Holds a partial result. Partials are parsed by the decoding stage, which needs to know whether they contain
+         * speech.
+         */
+        std::optional<core::recognition_result> partial;
+
+        /**
+         * Holds, for best-result selection, whether each channel of each lane is in an utterance, by lane.
+         */
+        std::vector<std::vector<bool>> utterances;
+    };
+
     /**
      * Acts as a continuous speech recognizer, producing results via signals over time via a background thread.
      */
@@ -30,16 +297,109 @@ namespace gdvosk
     {
         GDCLASS(SpeechRecognizer, godot::Node)
 
+    public:
+        /**
+         * Represents the actions taken when decoding falls behind real time.
+         */
+        enum OverloadPolicy
+        {
+            /**
+             * Keep decoding everything. Latency grows for as long as the overload lasts.
+             */
+            OVERLOAD_POLICY_NONE,
+
+            /**
+             * Drop the oldest captured audio, so that no more than a fraction of a second is waiting to be decoded.
+             */
+            OVERLOAD_POLICY_DROP_OLDEST,
+
+            /**
+             * Stop producing partial results. Utterances then end only when the recognizer detects silence itself.
+             */
+            OVERLOAD_POLICY_SKIP_PARTIALS,
+
+            /**
+             * Produce at most one alternative and no word timings.
+             */
+            OVERLOAD_POLICY_REDUCE_OUTPUT,
+
+            /**
+             * Switch to the fallback model at the next utterance boundary.
+             */
+            OVERLOAD_POLICY_FALLBACK_MODEL,
+        };
+
+    private:
+        /**
+         * Represents the configuration the background thread works from. The main thread publishes a new immutable
+         * snapshot whenever a property changes, and the background thread picks it up between chunks; neither ever
+         * waits for the other.
+         */
+        struct worker_config
+        {
+            std::shared_ptr<capture_subscription> capture;
+            std::shared_ptr<replay_source> replay;
+            std::shared_ptr<core::session_recorder> recorder;
+            godot::Ref<VoskModel> model;
+            std::shared_ptr<const core::compiled_grammar> grammar;
+            std::vector<godot::Ref<VoskModel>> additional_models;
+            godot::Ref<VoskModel> wake_model;
+            std::vector<std::string> wake_phrases;
+            std::shared_ptr<const core::compiled_grammar> wake_grammar;
+            std::chrono::microseconds wake_pre_roll = std::chrono::seconds(1);
+            bool select_best_result = false;
+            std::chrono::microseconds silence_timeout = std::chrono::seconds(2);
+            core::recognizer_options options;
+            OverloadPolicy overload_policy = OVERLOAD_POLICY_NONE;
+            float overload_threshold = 0.9f;
+            godot::Ref<VoskModel> fallback_model;
+            int64_t cpu_affinity = 0;
+            float cpu_budget = 0;
+            VoskRecognizer::ChannelMode channel_mode = VoskRecognizer::CHANNEL_MODE_MIX;
+            VoskModel::DecoderProfile decoder_profile = VoskModel::DECODER_PROFILE_DEFAULT;
+            godot::Ref<VoskSpeakerModel> speaker_model;
+            std::shared_ptr<const core::speaker_registry> speaker_registry;
+            float speaker_threshold = 0.6f;
+        };
+
         /**
          * Holds the control variable for the background processing thread.
          */
         std::atomic_bool _should_worker_run = false;
 
         /**
-         * Holds the background thread.
+         * Holds the background thread, which reads, converts and decodes audio.
          */
         godot::Ref<godot::Thread> _worker = nullptr;
 
+        /**
+         * Holds the thread that parses the results of the background thread, converts them to Godot types and emits
+         * them.
+         */
+        godot::Ref<godot::Thread> _result_worker = nullptr;
+
+        /**
+         * Holds the priority the running threads were started with, which their helpers are given as well.
+         */
+        core::thread_priority _worker_priority = core::thread_priority::normal;
+
+        /**
+         * Holds the number of jobs the decoding stage may get ahead of the result stage by.
+         */
+        static constexpr std::size_t result_queue_capacity = 64;
+
+        /**
+         * Holds the work passed from the background thread to the result thread.
+         */
+        core::bounded_queue<result_job> _result_queue { result_queue_capacity };
+
+        /**
+         * Holds the number of captured chunks waiting to be decoded, and the largest number that has waited at once
+         * since recognition started.
+         */
+        std::atomic_size_t _backlog_depth = 0;
+        std::atomic_size_t _peak_backlog_depth = 0;
+
         /**
          * Holds the index of the recording bus.
          */
@@ -51,14 +411,24 @@ namespace gdvosk
         godot::Ref<godot::AudioEffectCapture> _effect;
 
         /**
-         * Holds a semaphore used for synchronization with the background thread when accessing the Vosk model.
+         * Holds the subscription to the shared capture hub of the effect.
          */
-        godot::Ref<godot::Semaphore> _model_semaphore = nullptr;
+        std::shared_ptr<capture_subscription> _capture;
 
         /**
-         * Holds a semaphore used for synchronization with the background thread when accessing audio bus objects.
+         * Holds the recorded audio being decoded in place of the capture effect's, if any.
          */
-        godot::Ref<godot::Semaphore> _bus_semaphore = nullptr;
+        std::shared_ptr<replay_source> _replay;
+
+        /**
+         * Holds the recorder of the current session recording, if any.
+         */
+        std::shared_ptr<core::session_recorder> _recorder;
+
+        /**
+         * Holds the most recently published configuration snapshot. Accessed atomically.
+         */
+        std::shared_ptr<const worker_config> _config;
 
         /**
          * Gets or sets the name of the recording bus.
@@ -66,15 +436,170 @@ namespace gdvosk
         GODOT_PROPERTY(godot::StringName, recording_bus_name, "")
 
         /**
-         * Gets or sets the Vosk language model to use.
+         * Gets or sets the Vosk language model to use. Changing the model while recognition is running prepares the new
+         * model's recognizer in the background and swaps it in once the current utterance has ended.
          */
         GODOT_PROPERTY(godot::Ref<gdvosk::VoskModel>, vosk_model, nullptr)
 
+        /**
+         * Gets or sets further models to decode the same audio with, such as models for other languages. Audio is
+         * captured and converted once and decoded by every model in parallel, on separate threads. Results then carry a
+         * "model" key; 0 for vosk_model and 1 onwards for these, in order.
+         */
+        GODOT_PROPERTY(godot::TypedArray<gdvosk::VoskModel>, additional_models, godot::TypedArray<gdvosk::VoskModel>())
+
+        /**
+         * Gets or sets a value indicating whether, when several models are decoding, only the most confident result of
+         * each utterance is emitted. Results are then held back until every model has finished the utterance. Partial
+         * results are still emitted by every model.
+         */
+        GODOT_PROPERTY(bool, select_best_result, false)
+
+        /**
+         * Gets or sets the small model to listen for wake phrases with. When both this and wake_phrases are set, only
+         * this model decodes audio until a wake phrase is heard; the full models then decode the utterance that
+         * follows, along with the audio leading up to it, and stop again once it has ended.
+         */
+        GODOT_PROPERTY(godot::Ref<gdvosk::VoskModel>, wake_model, nullptr)
+
+        /**
+         * Gets or sets the phrases that wake the full models.
+         */
+        GODOT_PROPERTY(godot::PackedStringArray, wake_phrases, godot::PackedStringArray())
+
+        /**
+         * Holds the phrases the wake model listens for, in UTF-8.
+         */
+        std::vector<std::string> _wake_phrases_utf8;
+
+        /**
+         * Holds the grammar the wake model listens with; the wake phrases, and the unknown word for everything else.
+         */
+        std::shared_ptr<const core::compiled_grammar> _wake_grammar;
+
+        /**
+         * Gets or sets the length, in seconds, of the audio before a wake phrase is detected that is passed to the full
+         * models. It should cover the wake phrase itself, since detection only happens once it has been heard.
+         */
+        GODOT_PROPERTY(float, wake_pre_roll, 1.0f)
+
+        /**
+         * Gets or sets the phrases the recognizer is restricted to, or an empty array for none. Changes take effect on
+         * a running recognizer without restarting it, as soon as the recognizers for the new grammar are ready; if an
+         * utterance is in progress, what has been heard of it so far is emitted as a final result first, and the rest
+         * is decoded on the new grammar.
+         */
+        GODOT_PROPERTY(godot::PackedStringArray, grammar, godot::PackedStringArray())
+
+        /**
+         * Holds the cached form of the grammar.
+         */
+        std::shared_ptr<const core::compiled_grammar> _compiled_grammar;
+
+        /**
+         * Gets or sets the maximum allowed number of alternative phrases to be returned by the recognizer.
+         */
+        GODOT_PROPERTY(int, max_alternatives, 1)
+
+        /**
+         * Gets or sets a value indicating whether words with start and end times should be returned in output.
+         */
+        GODOT_PROPERTY(bool, include_words_in_output, false)
+
+        /**
+         * Gets or sets a value indicating whether words with start and end times should be returned in partial output.
+         */
+        GODOT_PROPERTY(bool, include_words_in_partial_output, false)
+
+        /**
+         * Gets or sets the length, in seconds, up to which the capture effect's buffer is grown when audio is lost
+         * because the background thread could not keep up. Growing the buffer re-instantiates the effects on the bus.
+         */
+        GODOT_PROPERTY(float, max_capture_buffer_length, 1.0f)
+
+        /**
+         * Gets or sets the action taken when decoding falls behind real time.
+         */
+        GODOT_PROPERTY(OverloadPolicy, overload_policy, OVERLOAD_POLICY_NONE)
+
+        /**
+         * Gets or sets the real-time factor (decoding time divided by audio duration) above which decoding is
+         * considered to be falling behind.
+         */
+        GODOT_PROPERTY(float, overload_threshold, 0.9f)
+
+        /**
+         * Gets or sets the smaller model to switch to when the overload policy is OVERLOAD_POLICY_FALLBACK_MODEL.
+         */
+        GODOT_PROPERTY(godot::Ref<gdvosk::VoskModel>, fallback_model, nullptr)
+
+        /**
+         * Gets or sets how stereo input is decoded. In split mode, each channel is decoded on its own recognizer, in
+         * parallel, and every result carries a "channel" key; 0 for left and 1 for right.
+         */
+        GODOT_PROPERTY(VoskRecognizer::ChannelMode, channel_mode, VoskRecognizer::CHANNEL_MODE_MIX)
+
+        /**
+         * Gets or sets the search profile the models are decoded with. Profiles other than the default, or other than
+         * the one a model was loaded with, decode on a copy of the model loaded for the purpose. The copy is loaded in
+         * the background, and recognition switches to it at the end of an utterance once it's ready; until then, it
+         * carries on as it was. See VoskModel::prepare_decoder_profile. The wake word model always decodes with its
+         * own profile.
+         */
+        GODOT_PROPERTY(VoskModel::DecoderProfile, decoder_profile, VoskModel::DECODER_PROFILE_DEFAULT)
+
+        /**
+         * Gets or sets the speaker model attached to the recognizers. When set, complete results carry the speaker
+         * vector of the utterance in their "spk" key. Like grammar changes, changes take effect right away, ending an
+         * utterance in progress with a final result.
+         */
+        GODOT_PROPERTY(godot::Ref<gdvosk::VoskSpeakerModel>, speaker_model, nullptr)
+
+        /**
+         * Gets or sets the registry of known speakers. When set along with a speaker model, complete results whose
+         * speaker is recognized carry the speaker's identifier in a "speaker" key and the match score in a
+         * "speaker_score" key.
+         */
+        GODOT_PROPERTY(godot::Ref<gdvosk::VoskSpeakerRegistry>, speaker_registry, nullptr)
+
+        /**
+         * Gets or sets the score, between -1 and 1, a known speaker must reach for a result to be attributed to them.
+         */
+        GODOT_PROPERTY(float, speaker_match_threshold, 0.6f)
+
+        /**
+         * Gets or sets the scheduling priority of the background thread. Takes effect the next time the thread starts.
+         */
+        GODOT_PROPERTY(godot::Thread::Priority, thread_priority, godot::Thread::PRIORITY_NORMAL)
+
+        /**
+         * Gets or sets the CPU cores the background thread may run on, as a bit mask where bit N is core N; or zero for
+         * no restriction. The helper threads that decode alongside it and the thread that handles its results are
+         * held to the same cores. Only supported on Linux.
+         */
+        GODOT_PROPERTY(int64_t, cpu_affinity, 0)
+
+        /**
+         * Gets or sets the fraction of a single core the background thread may spend decoding, or zero for no limit.
+         * Time its helper threads spend decoding counts against the same budget. Audio that doesn't fit in the budget
+         * is carried over to later slices.
+         */
+        GODOT_PROPERTY(float, cpu_budget, 0.0f)
+
+        /**
+         * Holds a value indicating whether a deferred call to grow the capture buffer is pending.
+         */
+        std::atomic_bool _is_capture_growth_pending = false;
+
         /**
          * Holds the backing data for the silence timeout in microseconds.
          */
-        std::atomic<std::chrono::microseconds> _silence_timeout =
-                std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::seconds(2));
+        std::chrono::microseconds _silence_timeout = std::chrono::seconds(2);
+
+        /**
+         * Holds the results withheld for best-result selection. Accessed by the result thread only.
+         */
+        std::vector<held_result> _held_results;
 
     protected:
         static void _bind_methods();
@@ -90,23 +615,292 @@ namespace gdvosk
         void set_silence_timeout(float silence_timeout);
         [[nodiscard]] float get_silence_timeout() const;
 
+        /**
+         * Decodes a WAV stream in place of the audio on the recording bus. The stream goes through the same pipeline
+         * as captured audio and raises the same signals, with silence timeouts measured on the stream's own clock;
+         * replay_finished is raised once all of it has been decoded. Only 8 and 16-bit streams are supported.
+         * @param stream The stream.
+         * @param paced Whether the stream is fed at real-time speed instead of as fast as it can be decoded.
+         * @return The result of the operation.
+         */
+        godot::Error replay_stream(const godot::Ref<godot::AudioStreamWAV>& stream, bool paced);
+
+        /**
+         * Decodes a WAV file in place of the audio on the recording bus. See replay_stream.
+         * @param path The path to the file.
+         * @param paced Whether the file is fed at real-time speed instead of as fast as it can be decoded.
+         * @return The result of the operation.
+         */
+        godot::Error replay_file(const godot::String& path, bool paced);
+
+        /**
+         * Decodes raw signed 16-bit little-endian PCM in place of the audio on the recording bus. See replay_stream.
+         * @param data The interleaved samples.
+         * @param sample_rate The sample rate of the samples.
+         * @param channels The number of channels.
+         * @param paced Whether the audio is fed at real-time speed instead of as fast as it can be decoded.
+         * @return The result of the operation.
+         */
+        godot::Error replay_pcm(const godot::PackedByteArray& data, int sample_rate, int channels, bool paced);
+
+        /**
+         * Stops the current replay, if any, and goes back to the audio on the recording bus. replay_finished is not
+         * raised.
+         */
+        void stop_replay();
+
+        [[nodiscard]] bool is_replaying() const;
+
+        /**
+         * Starts recording the decoded audio, mixed to mono at the mix rate, along with every partial, complete and
+         * final result and the time each was produced at. The recording is written in the background as numbered
+         * segments of a raw PCM file and a JSON Lines file, and the oldest segments are deleted to stay within the
+         * given disk usage. Records are dropped rather than slowing recognition down if the disk can't keep up.
+         * @param directory The directory to write the recording to. Created if necessary.
+         * @param max_segment_size The size, in bytes, after which a new segment is started.
+         * @param max_disk_usage The size, in bytes, the recording may take up.
+         * @return The result of the operation.
+         */
+        godot::Error start_session_recording
+        (
+            const godot::String& directory,
+            int64_t max_segment_size,
+            int64_t max_disk_usage
+        );
+
+        /**
+         * Stops the current session recording, if any, waiting for everything recorded so far to be written.
+         */
+        void stop_session_recording();
+
+        [[nodiscard]] bool is_recording_session() const;
+
+        /**
+         * Gets the number of records the current session recording has dropped because the disk couldn't keep up.
+         * @return The number of records.
+         */
+        [[nodiscard]] int64_t get_dropped_session_records() const;
+
+        /**
+         * Gets the occupancy of the queues between the stages of the background pipeline. Captured audio waits in the
+         * backlog to be decoded, and decoded results wait in the result queue to be converted and emitted; a queue
+         * that stays full points at the stage after it as the bottleneck.
+         * @return A dictionary with the keys "backlog_depth", "backlog_peak_depth" and "backlog_capacity", in chunks
+         * of captured audio, and "result_queue_depth", "result_queue_peak_depth", "result_queue_capacity" and
+         * "result_queue_stalls" (the number of times decoding waited for the result stage), in results. Peaks are
+         * measured since recognition last started.
+         */
+        [[nodiscard]] godot::Dictionary get_pipeline_statistics() const;
+
         void _ready() override;
         void _exit_tree() override;
         [[nodiscard]] godot::PackedStringArray _get_configuration_warnings() const override;
 
     private:
         void update_bus_data();
+
+        /**
+         * Sets the capture effect to read audio from, subscribing to its shared capture hub.
+         * @param effect The effect, or nullptr for none.
+         */
+        void set_effect(const godot::Ref<godot::AudioEffectCapture>& effect);
+
+        /**
+         * Doubles the length of the capture effect's buffer, up to the configured maximum.
+         */
+        void grow_capture_buffer();
         void update_vosk_data();
 
+        /**
+         * Hands a replay to the background thread, starting it if necessary.
+         * @param replay The replay, or nullptr if the audio could not be converted.
+         * @return The result of the operation.
+         */
+        godot::Error start_replay(std::shared_ptr<replay_source> replay);
+
+        /**
+         * Forgets a replay the background thread has finished decoding and raises replay_finished.
+         */
+        void finish_replay();
+
+        /**
+         * Publishes the current property values to the background thread.
+         */
+        void publish_config();
+
         void stop_voice_recognition();
         void start_voice_recognition();
 
-        void worker_main
+        void worker_main();
+
+        /**
+         * Runs the result stage of the background pipeline until the result queue is closed and drained.
+         */
+        void result_main();
+
+        /**
+         * Carries out a piece of work passed to the result stage.
+         * @param job The work.
+         */
+        void handle_result_job(result_job& job);
+
+        /**
+         * Passes a piece of work to the result stage, waiting for room if it is behind.
+         * @param job The work.
+         */
+        void queue_result_job(result_job job);
+
+        /**
+         * Moves the recognizers of a lane towards the given configuration. Recognizers prepared in the background are
+         * collected and swapped in when possible, and new ones are requested when the configuration changed.
+         * @param lane The lane.
+         * @param desired The configuration the lane's recognizers should have.
+         * @param options The output settings to apply.
+         * @param lane_target Where the lane's results go.
+         */
+        void update_lane
         (
-            godot::Ref<godot::Semaphore> bus_semaphore,
-            godot::Ref<godot::Semaphore> model_semaphore
+            recognizer_lane& lane,
+            const lane_config& desired,
+            const core::recognizer_options& options,
+            const result_target& lane_target
         );
+
+        /**
+         * Passes the results of decoding a chunk of audio on one channel on to the result stage.
+         * @param recognizer The recognizer that decoded the chunk.
+         * @param status The outcome.
+         * @param channel The state of the channel.
+         * @param target Where the results go.
+         * @param skip_partials Whether partial results should be skipped.
+         * @param now The current time.
+         */
+        void handle_status
+        (
+            core::recognizer& recognizer,
+            core::accept_status status,
+            channel_state& channel,
+            const result_target& target,
+            bool skip_partials,
+            std::chrono::microseconds now
+        );
+
+        /**
+         * Emits a complete result, or holds it back for best-result selection.
+         * @param signal The signal to emit the result with.
+         * @param result The result.
+         * @param confidence The confidence of the result, or nothing if nothing was recognized.
+         * @param target Where the result goes.
+         */
+        void emit_result
+        (
+            const godot::StringName& signal,
+            godot::Dictionary result,
+            std::optional<double> confidence,
+            const result_target& target
+        );
+
+        /**
+         * Emits the withheld results of the model with the highest mean confidence, for every channel on which no
+         * model is in an utterance any more, and discards the rest.
+         * @param utterances Whether each channel of each lane is in an utterance, by lane.
+         */
+        void emit_best_results(const std::vector<std::vector<bool>>& utterances);
+
+        /**
+         * Records whether each channel of each lane is in an utterance, for best-result selection on the result stage.
+         * @param lanes The lanes.
+         * @return The flags, by lane.
+         */
+        [[nodiscard]] static std::vector<std::vector<bool>> get_utterances(const std::deque<recognizer_lane>& lanes);
+
+        /**
+         * Moves the wake listener of a gate towards the given configuration, replacing it once a new one has been
+         * created in the background.
+         * @param gate The gate.
+         * @param desired_model The model to listen with, or nullptr to stop listening.
+         * @param desired_key The configuration the listener should have.
+         * @param desired_lease A lease on the native model of the configuration.
+         */
+        static void update_wake_gate
+        (
+            wake_gate& gate,
+            const godot::Ref<VoskModel>& desired_model,
+            const core::recognizer_key& desired_key,
+            const core::model_lease& desired_lease
+        );
+
+        /**
+         * Passes a chunk of audio to the wake listener of a closed gate and looks for a wake phrase in its output.
+         * @param gate The gate.
+         * @param samples The chunk, as mono samples in the range Vosk expects.
+         * @param phrases The wake phrases.
+         * @return The index of the wake phrase heard, or nothing if none was.
+         */
+        static std::optional<std::size_t> listen_for_wake_phrase
+        (
+            wake_gate& gate,
+            core::span<const float> samples,
+            const std::vector<std::string>& phrases
+        );
+
+        /**
+         * Returns the recognizers in the given slot to the shared pool and clears the slot.
+         * @param slot The slot.
+         */
+        static void release_recognizers(recognizer_slot& slot);
+
+        /**
+         * Gets where the results of a recognizer in the given slot go.
+         * @param slot The slot.
+         * @param instance The index of the recognizer within the slot.
+         * @param lane_target Where the results of the slot's lane go.
+         * @return The target.
+         */
+        [[nodiscard]] static result_target get_result_target
+        (
+            const recognizer_slot& slot,
+            std::size_t instance,
+            const result_target& lane_target
+        );
+
+        /**
+         * Tags a result with the model and channel it was decoded by.
+         * @param result The result.
+         * @param target Where the result goes.
+         */
+        static void tag_result(godot::Dictionary& result, const result_target& target);
+
+        /**
+         * Identifies the speaker of a complete result against the target's speaker registry, and tags the result with
+         * the best match if it is good enough.
+         * @param result The result.
+         * @param parsed The parsed form of the result.
+         * @param target Where the result goes.
+         */
+        static void identify_speaker
+        (
+            godot::Dictionary& result,
+            const core::recognition_result& parsed,
+            const result_target& target
+        );
+
+        /**
+         * Flushes every recognizer in the given slot and passes their final results on to the result stage.
+         * @param slot The slot.
+         * @param lane_target Where the results of the slot's lane go.
+         */
+        void emit_final_results(recognizer_slot& slot, const result_target& lane_target);
+
+        /**
+         * Flushes the given recognizer and passes its final result on to the result stage.
+         * @param recognizer The recognizer.
+         * @param target Where the result goes.
+         */
+        void emit_final_result(core::recognizer& recognizer, const result_target& target);
     };
 }
 
+VARIANT_ENUM_CAST(gdvosk::SpeechRecognizer::OverloadPolicy);
+
 #endif //SPEECHRECOGNIZER_H
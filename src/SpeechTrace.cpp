@@ -0,0 +1,52 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "SpeechTrace.h"
+#include "core/trace.h"
+
+#include <godot_cpp/classes/file_access.hpp>
+
+using namespace godot;
+using namespace gdvosk;
+
+bool SpeechTrace::is_enabled()
+{
+    return trace::is_enabled();
+}
+
+String SpeechTrace::get_json()
+{
+    return String::utf8(trace::to_chrome_json().c_str());
+}
+
+Error SpeechTrace::save(const String& path)
+{
+    if (!trace::is_enabled())
+    {
+        return ERR_UNAVAILABLE;
+    }
+
+    auto file = FileAccess::open(path, FileAccess::ModeFlags::WRITE);
+    if (!file.is_valid() || !file->is_open())
+    {
+        return ERR_FILE_CANT_WRITE;
+    }
+
+    file->store_string(get_json());
+    file->close();
+
+    return OK;
+}
+
+void SpeechTrace::clear()
+{
+    trace::clear();
+}
+
+void SpeechTrace::_bind_methods()
+{
+    ClassDB::bind_static_method(get_class_static(), D_METHOD("is_enabled"), &SpeechTrace::is_enabled);
+    ClassDB::bind_static_method(get_class_static(), D_METHOD("get_json"), &SpeechTrace::get_json);
+    ClassDB::bind_static_method(get_class_static(), D_METHOD("save", "path"), &SpeechTrace::save);
+    ClassDB::bind_static_method(get_class_static(), D_METHOD("clear"), &SpeechTrace::clear);
+}
@@ -0,0 +1,49 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef SPEECHTRACE_H
+#define SPEECHTRACE_H
+
+#include <godot_cpp/classes/object.hpp>
+
+namespace gdvosk
+{
+    /**
+     * Exposes the hot-path timing spans recorded by the extension. Spans are only recorded when the extension is built
+     * with the GDVOSK_ENABLE_TRACING option; otherwise, exported traces are empty.
+     */
+    class SpeechTrace final : public godot::Object
+    {
+        GDCLASS(SpeechTrace, godot::Object)
+
+    public:
+        /**
+         * Gets a value indicating whether span recording was compiled into the extension.
+         * @return true if spans are recorded; otherwise, false.
+         */
+        [[nodiscard]] static bool is_enabled();
+
+        /**
+         * Gets the recorded spans as Chrome trace-event JSON.
+         * @return The serialized trace.
+         */
+        [[nodiscard]] static godot::String get_json();
+
+        /**
+         * Saves the recorded spans as Chrome trace-event JSON, which can be opened in chrome://tracing or Perfetto.
+         * @param path The path to save the trace to.
+         * @return The result of the operation.
+         */
+        static godot::Error save(const godot::String& path);
+
+        /**
+         * Discards all recorded spans.
+         */
+        static void clear();
+
+    protected:
+        static void _bind_methods();
+    };
+}
+
+#endif //SPEECHTRACE_H
@@ -0,0 +1,77 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "audio.h"
+
+#include <algorithm>
+
+void gdvosk::core::mix_stereo_to_mono(span<const float> interleaved, span<float> output)
+{
+    const auto frames = std::min(interleaved.size() / 2, output.size());
+
+    const auto* __restrict input = interleaved.data();
+    auto* __restrict mixed = output.data();
+
+    for (std::size_t i = 0; i < frames; ++i)
+    {
+        const auto sample = std::clamp((input[i * 2] + input[i * 2 + 1]) / 2.0f, -1.0f, 1.0f);
+        mixed[i] = sample * vosk_sample_scale;
+    }
+}
+
+void gdvosk::core::mix_stereo_to_mono(span<const std::int16_t> interleaved, span<std::int16_t> output)
+{
+    const auto frames = std::min(interleaved.size() / 2, output.size());
+
+    const auto* __restrict input = interleaved.data();
+    auto* __restrict mixed = output.data();
+
+    for (std::size_t i = 0; i < frames; ++i)
+    {
+        mixed[i] = static_cast<std::int16_t>((std::int32_t(input[i * 2]) + input[i * 2 + 1]) / 2);
+    }
+}
+
+void gdvosk::core::extract_channel(span<const float> interleaved, std::size_t channel, span<float> output)
+{
+    const auto frames = std::min(interleaved.size() / 2, output.size());
+
+    const auto* __restrict input = interleaved.data() + channel;
+    auto* __restrict extracted = output.data();
+
+    for (std::size_t i = 0; i < frames; ++i)
+    {
+        extracted[i] = std::clamp(input[i * 2], -1.0f, 1.0f) * vosk_sample_scale;
+    }
+}
+
+void gdvosk::core::extract_channel
+(
+    span<const std::int16_t> interleaved,
+    std::size_t channel,
+    span<std::int16_t> output
+)
+{
+    const auto frames = std::min(interleaved.size() / 2, output.size());
+
+    const auto* __restrict input = interleaved.data() + channel;
+    auto* __restrict extracted = output.data();
+
+    for (std::size_t i = 0; i < frames; ++i)
+    {
+        extracted[i] = input[i * 2];
+    }
+}
+
+void gdvosk::core::scale_to_vosk(span<const float> samples, span<float> output)
+{
+    const auto count = std::min(samples.size(), output.size());
+
+    const auto* __restrict input = samples.data();
+    auto* __restrict scaled = output.data();
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        scaled[i] = std::clamp(input[i], -1.0f, 1.0f) * vosk_sample_scale;
+    }
+}
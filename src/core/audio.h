@@ -0,0 +1,58 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_CORE_AUDIO_H
+#define GDVOSK_CORE_AUDIO_H
+
+#include <cstdint>
+
+#include "span.h"
+
+namespace gdvosk::core
+{
+    /**
+     * Holds the factor between normalized floating-point samples (-1 to 1) and the 16-bit range Vosk expects.
+     */
+    constexpr float vosk_sample_scale = 32768.0f;
+
+    /**
+     * Mixes interleaved, normalized stereo samples to mono, scaling the result to the range Vosk expects.
+     * @param interleaved The interleaved left/right samples, in the range -1 to 1. A trailing unpaired sample is
+     * ignored.
+     * @param output The output buffer. Must hold at least interleaved.size() / 2 samples.
+     */
+    void mix_stereo_to_mono(span<const float> interleaved, span<float> output);
+
+    /**
+     * Mixes interleaved 16-bit stereo samples to mono.
+     * @param interleaved The interleaved left/right samples. A trailing unpaired sample is ignored.
+     * @param output The output buffer. Must hold at least interleaved.size() / 2 samples.
+     */
+    void mix_stereo_to_mono(span<const std::int16_t> interleaved, span<std::int16_t> output);
+
+    /**
+     * Extracts one channel from interleaved, normalized stereo samples, scaling it to the range Vosk expects.
+     * @param interleaved The interleaved left/right samples, in the range -1 to 1. A trailing unpaired sample is
+     * ignored.
+     * @param channel The channel to extract; 0 for left and 1 for right.
+     * @param output The output buffer. Must hold at least interleaved.size() / 2 samples.
+     */
+    void extract_channel(span<const float> interleaved, std::size_t channel, span<float> output);
+
+    /**
+     * Extracts one channel from interleaved 16-bit stereo samples.
+     * @param interleaved The interleaved left/right samples. A trailing unpaired sample is ignored.
+     * @param channel The channel to extract; 0 for left and 1 for right.
+     * @param output The output buffer. Must hold at least interleaved.size() / 2 samples.
+     */
+    void extract_channel(span<const std::int16_t> interleaved, std::size_t channel, span<std::int16_t> output);
+
+    /**
+     * Scales normalized mono samples to the range Vosk expects, clamping out-of-range input.
+     * @param samples The samples, in the range -1 to 1.
+     * @param output The output buffer. Must hold at least samples.size() samples.
+     */
+    void scale_to_vosk(span<const float> samples, span<float> output);
+}
+
+#endif //GDVOSK_CORE_AUDIO_H
@@ -0,0 +1,171 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_CORE_BOUNDED_QUEUE_H
+#define GDVOSK_CORE_BOUNDED_QUEUE_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace gdvosk::core
+{
+    /**
+     * Represents the occupancy of a bounded queue.
+     */
+    struct queue_statistics
+    {
+        /**
+         * Holds the number of items waiting in the queue.
+         */
+        std::size_t depth = 0;
+
+        /**
+         * Holds the largest number of items that have waited in the queue at once since it was last opened.
+         */
+        std::size_t peak_depth = 0;
+
+        std::size_t capacity = 0;
+
+        /**
+         * Holds the number of times a producer had to wait for room in the queue since it was last opened.
+         */
+        std::uint64_t stalls = 0;
+    };
+
+    /**
+     * Passes items from one pipeline stage to the next, in order. Producers wait while the queue is full, so a slow
+     * stage holds the ones before it back instead of letting work pile up. Thread-safe.
+     */
+    template <typename T>
+    class bounded_queue final
+    {
+        mutable std::mutex _mutex;
+
+        /**
+         * Wakes the consumer once an item has been pushed or the queue has been closed.
+         */
+        std::condition_variable _pushed;
+
+        /**
+         * Wakes the producers once an item has been popped or the queue has been closed.
+         */
+        std::condition_variable _popped;
+
+        std::deque<T> _items;
+        std::size_t _capacity;
+        bool _is_closed = false;
+
+        std::size_t _peak_depth = 0;
+        std::uint64_t _stalls = 0;
+
+    public:
+        /**
+         * Initializes a new instance of the bounded_queue class.
+         * @param capacity The number of items the queue holds before producers have to wait; at least one.
+         */
+        explicit bounded_queue(std::size_t capacity) :
+            _capacity(std::max<std::size_t>(capacity, 1))
+        {
+        }
+
+        bounded_queue(const bounded_queue&) = delete;
+        bounded_queue& operator=(const bounded_queue&) = delete;
+
+        /**
+         * Adds an item to the back of the queue, waiting for room if it's full.
+         * @param item The item.
+         * @return true if the item was added; false if the queue was closed.
+         */
+        bool push(T item)
+        {
+            std::unique_lock lock(_mutex);
+
+            if (!_is_closed && _items.size() >= _capacity)
+            {
+                ++_stalls;
+                _popped.wait(lock, [&] { return _is_closed || _items.size() < _capacity; });
+            }
+
+            if (_is_closed)
+            {
+                return false;
+            }
+
+            _items.push_back(std::move(item));
+            _peak_depth = std::max(_peak_depth, _items.size());
+
+            lock.unlock();
+            _pushed.notify_one();
+
+            return true;
+        }
+
+        /**
+         * Takes the item at the front of the queue, waiting for one if it's empty. Items pushed before the queue was
+         * closed are still handed out.
+         * @return The item, or nothing once the queue has been closed and drained.
+         */
+        std::optional<T> pop()
+        {
+            std::unique_lock lock(_mutex);
+            _pushed.wait(lock, [&] { return _is_closed || !_items.empty(); });
+
+            if (_items.empty())
+            {
+                return std::nullopt;
+            }
+
+            auto item = std::move(_items.front());
+            _items.pop_front();
+
+            lock.unlock();
+            _popped.notify_one();
+
+            return item;
+        }
+
+        /**
+         * Closes the queue. Waiting producers give up, and the consumer stops once it has drained the queue.
+         */
+        void close()
+        {
+            {
+                std::lock_guard lock(_mutex);
+                _is_closed = true;
+            }
+
+            _pushed.notify_all();
+            _popped.notify_all();
+        }
+
+        /**
+         * Opens the queue again after it has been closed, discarding anything left in it and resetting its
+         * statistics. Must not be called while it is in use.
+         */
+        void open()
+        {
+            std::lock_guard lock(_mutex);
+
+            _items.clear();
+            _is_closed = false;
+            _peak_depth = 0;
+            _stalls = 0;
+        }
+
+        /**
+         * Gets the occupancy of the queue.
+         * @return The statistics.
+         */
+        [[nodiscard]] queue_statistics get_statistics() const
+        {
+            std::lock_guard lock(_mutex);
+            return { _items.size(), _peak_depth, _capacity, _stalls };
+        }
+    };
+}
+
+#endif //GDVOSK_CORE_BOUNDED_QUEUE_H
@@ -0,0 +1,134 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "decode_helpers.h"
+
+#include <optional>
+
+#include "trace.h"
+
+using namespace std::chrono;
+using namespace gdvosk::core;
+
+decode_helpers::~decode_helpers()
+{
+    {
+        std::lock_guard lock(_mutex);
+        _is_stopping = true;
+    }
+
+    _started.notify_all();
+
+    for (auto& thread : _threads)
+    {
+        thread.join();
+    }
+}
+
+void decode_helpers::configure(const thread_settings& settings)
+{
+    std::lock_guard lock(_mutex);
+    _settings = settings;
+}
+
+microseconds decode_helpers::run(std::size_t count, const std::function<void(std::size_t)>& job)
+{
+    if (count == 0)
+    {
+        return microseconds::zero();
+    }
+
+    std::unique_lock lock(_mutex);
+
+    if (count == 1 || is_single_core(_settings.affinity))
+    {
+        lock.unlock();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            job(i);
+        }
+
+        return microseconds::zero();
+    }
+
+    // helpers are only ever added; a batch never needs more than one per job besides the calling thread
+    while (_threads.size() < count - 1)
+    {
+        _threads.emplace_back(&decode_helpers::helper_main, this);
+    }
+
+    _job = &job;
+    _job_count = count;
+    _next_job = 0;
+    _pending_jobs = count;
+    _helper_time = microseconds::zero();
+    ++_batch;
+
+    _started.notify_all();
+
+    run_jobs(lock);
+    _finished.wait(lock, [&] { return _pending_jobs == 0; });
+
+    _job = nullptr;
+    return _helper_time;
+}
+
+void decode_helpers::helper_main()
+{
+    GDVOSK_TRACE_THREAD_NAME("Parallel decoder");
+
+    std::optional<thread_settings> applied_settings;
+    std::uint64_t batch = 0;
+
+    std::unique_lock lock(_mutex);
+    while (true)
+    {
+        _started.wait(lock, [&] { return _is_stopping || _batch != batch; });
+        if (_is_stopping)
+        {
+            return;
+        }
+
+        batch = _batch;
+
+        if (applied_settings != _settings)
+        {
+            auto settings = _settings;
+
+            lock.unlock();
+            apply_current_thread_settings(settings);
+            lock.lock();
+
+            applied_settings = settings;
+        }
+
+        _helper_time += run_jobs(lock);
+    }
+}
+
+microseconds decode_helpers::run_jobs(std::unique_lock<std::mutex>& lock)
+{
+    auto busy_time = microseconds::zero();
+
+    // the batch may have been finished by the others by the time a late helper gets here
+    while (_job != nullptr && _next_job < _job_count)
+    {
+        auto index = _next_job++;
+        const auto& job = *_job;
+
+        lock.unlock();
+
+        auto start = steady_clock::now();
+        job(index);
+        busy_time += duration_cast<microseconds>(steady_clock::now() - start);
+
+        lock.lock();
+
+        if (--_pending_jobs == 0)
+        {
+            _finished.notify_one();
+        }
+    }
+
+    return busy_time;
+}
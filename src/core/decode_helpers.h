@@ -0,0 +1,110 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_CORE_DECODE_HELPERS_H
+#define GDVOSK_CORE_DECODE_HELPERS_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "thread_control.h"
+
+namespace gdvosk::core
+{
+    /**
+     * Runs batches of independent decoding jobs in parallel on helper threads that are started once and then kept
+     * for later batches, instead of on a fresh thread per batch. The helpers are scheduled with the constraints given
+     * by their owner, so that they stay on the cores it is confined to. Not thread-safe; a set of helpers must only be
+     * used by one thread at a time.
+     */
+    class decode_helpers final
+    {
+        std::mutex _mutex;
+
+        /**
+         * Wakes the helpers once a batch has been handed out or the helpers are stopping.
+         */
+        std::condition_variable _started;
+
+        /**
+         * Wakes the owner once the last job of a batch has finished.
+         */
+        std::condition_variable _finished;
+
+        std::vector<std::thread> _threads;
+        bool _is_stopping = false;
+
+        thread_settings _settings;
+
+        /**
+         * Holds the job of the current batch, or nullptr between batches.
+         */
+        const std::function<void(std::size_t)>* _job = nullptr;
+
+        std::size_t _job_count = 0;
+
+        /**
+         * Holds the index of the next job of the current batch nobody has claimed yet.
+         */
+        std::size_t _next_job = 0;
+
+        /**
+         * Holds the number of jobs of the current batch that haven't finished yet.
+         */
+        std::size_t _pending_jobs = 0;
+
+        /**
+         * Counts the batches handed out, so that a helper can tell a new batch from the one it last worked on.
+         */
+        std::uint64_t _batch = 0;
+
+        /**
+         * Holds the time the helpers spent running jobs of the current batch.
+         */
+        std::chrono::microseconds _helper_time { };
+
+    public:
+        decode_helpers() = default;
+        ~decode_helpers();
+
+        // disable copy and move
+        decode_helpers(const decode_helpers&) = delete;
+        decode_helpers(decode_helpers&&) = delete;
+        decode_helpers& operator=(const decode_helpers&) = delete;
+        decode_helpers& operator=(decode_helpers&&) = delete;
+
+        /**
+         * Sets the scheduling constraints of the helpers. Each helper applies them before it runs its next job.
+         * @param settings The constraints.
+         */
+        void configure(const thread_settings& settings);
+
+        /**
+         * Runs a batch of jobs and waits for all of them to finish. The calling thread runs jobs of its own while the
+         * helpers run the rest. When the helpers are confined to a single core, the calling thread runs every job
+         * itself, since helpers could only take turns with it.
+         * @param count The number of jobs.
+         * @param job The job, called once with the index of each job, in parallel and in no particular order.
+         * @return The time helpers spent running jobs; on top of the time the calling thread spent.
+         */
+        std::chrono::microseconds run(std::size_t count, const std::function<void(std::size_t)>& job);
+
+    private:
+        void helper_main();
+
+        /**
+         * Claims and runs jobs of the current batch until none are left unclaimed.
+         * @param lock A lock on the mutex, which is released while a job runs.
+         * @return The time spent running jobs.
+         */
+        std::chrono::microseconds run_jobs(std::unique_lock<std::mutex>& lock);
+    };
+}
+
+#endif //GDVOSK_CORE_DECODE_HELPERS_H
@@ -0,0 +1,162 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "decoder_settings.h"
+
+#include <vector>
+
+using namespace gdvosk::core;
+
+namespace
+{
+    /**
+     * Gets the name of the option a configuration line sets, if it sets one.
+     */
+    std::string_view get_option_name(std::string_view line)
+    {
+        auto start = line.find_first_not_of(" \t");
+        if (start == std::string_view::npos || line.compare(start, 2, "--") != 0)
+        {
+            return { };
+        }
+
+        auto end = line.find('=', start);
+        return line.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start);
+    }
+}
+
+bool decoder_settings::is_overriding() const
+{
+    return min_active > 0 || max_active > 0 || beam > 0 || lattice_beam > 0;
+}
+
+bool decoder_settings::operator==(const decoder_settings& other) const
+{
+    return min_active == other.min_active
+        && max_active == other.max_active
+        && beam == other.beam
+        && lattice_beam == other.lattice_beam;
+}
+
+bool decoder_settings::operator!=(const decoder_settings& other) const
+{
+    return !(*this == other);
+}
+
+decoder_settings gdvosk::core::get_decoder_settings(decoder_profile profile)
+{
+    switch (profile)
+    {
+        case decoder_profile::fast:
+        {
+            // what small models ship with; large ones usually keep more than twice as many states active
+            return { 0, 3000, 10.0f, 2.0f };
+        }
+        case decoder_profile::fastest:
+        {
+            return { 100, 1000, 7.0f, 1.0f };
+        }
+        case decoder_profile::accurate:
+        {
+            return { 0, 10000, 15.0f, 8.0f };
+        }
+        case decoder_profile::model_default:
+        default:
+        {
+            return { };
+        }
+    }
+}
+
+std::optional<decoder_profile> gdvosk::core::parse_decoder_profile(std::string_view name)
+{
+    if (name == "default")
+    {
+        return decoder_profile::model_default;
+    }
+
+    if (name == "fast")
+    {
+        return decoder_profile::fast;
+    }
+
+    if (name == "fastest")
+    {
+        return decoder_profile::fastest;
+    }
+
+    if (name == "accurate")
+    {
+        return decoder_profile::accurate;
+    }
+
+    return std::nullopt;
+}
+
+std::string gdvosk::core::apply_decoder_settings(std::string_view config, const decoder_settings& settings)
+{
+    std::vector<std::pair<std::string_view, std::string>> overrides;
+    if (settings.min_active > 0)
+    {
+        overrides.emplace_back("--min-active", std::to_string(settings.min_active));
+    }
+
+    if (settings.max_active > 0)
+    {
+        overrides.emplace_back("--max-active", std::to_string(settings.max_active));
+    }
+
+    if (settings.beam > 0)
+    {
+        overrides.emplace_back("--beam", std::to_string(settings.beam));
+    }
+
+    if (settings.lattice_beam > 0)
+    {
+        overrides.emplace_back("--lattice-beam", std::to_string(settings.lattice_beam));
+    }
+
+    std::vector<bool> is_applied(overrides.size(), false);
+    std::string output;
+
+    std::size_t position = 0;
+    while (position < config.size())
+    {
+        auto end = config.find('\n', position);
+        if (end == std::string_view::npos)
+        {
+            end = config.size();
+        }
+
+        auto line = config.substr(position, end - position);
+        position = end + 1;
+
+        auto name = get_option_name(line);
+
+        std::size_t i = 0;
+        while (i < overrides.size() && (name.empty() || overrides[i].first != name))
+        {
+            ++i;
+        }
+
+        if (i < overrides.size())
+        {
+            // options may be set more than once, in which case the last one wins; every one of them is replaced
+            output.append(overrides[i].first).append("=").append(overrides[i].second).append("\n");
+            is_applied[i] = true;
+            continue;
+        }
+
+        output.append(line).append("\n");
+    }
+
+    for (std::size_t i = 0; i < overrides.size(); ++i)
+    {
+        if (!is_applied[i])
+        {
+            output.append(overrides[i].first).append("=").append(overrides[i].second).append("\n");
+        }
+    }
+
+    return output;
+}
@@ -0,0 +1,100 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_CORE_DECODER_SETTINGS_H
+#define GDVOSK_CORE_DECODER_SETTINGS_H
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace gdvosk::core
+{
+    /**
+     * Enumerates the named trade-offs between decoding speed and accuracy.
+     */
+    enum class decoder_profile
+    {
+        /**
+         * Search as configured by the model's packager.
+         */
+        model_default,
+
+        /**
+         * Search a narrower beam, for roughly half the decoding work of a typical large model's configuration.
+         */
+        fast,
+
+        /**
+         * Search a very narrow beam. Only suited to small grammars, such as voice commands, where few hypotheses
+         * compete.
+         */
+        fastest,
+
+        /**
+         * Search a wider beam and keep a deeper lattice, for the best accuracy at a considerably higher cost.
+         */
+        accurate
+    };
+
+    /**
+     * Represents overrides of the decoder search parameters in a model's conf/model.conf. Parameters left at zero keep
+     * the model's own value.
+     */
+    struct decoder_settings
+    {
+        /**
+         * Holds the fewest states kept active per frame.
+         */
+        int min_active = 0;
+
+        /**
+         * Holds the most states kept active per frame; the main bound on decoding work.
+         */
+        int max_active = 0;
+
+        /**
+         * Holds the width of the search beam.
+         */
+        float beam = 0;
+
+        /**
+         * Holds the width of the beam used to prune the lattice, which alternatives and word confidences come from.
+         */
+        float lattice_beam = 0;
+
+        /**
+         * Gets a value indicating whether any parameter is overridden.
+         */
+        [[nodiscard]] bool is_overriding() const;
+
+        [[nodiscard]] bool operator==(const decoder_settings& other) const;
+        [[nodiscard]] bool operator!=(const decoder_settings& other) const;
+    };
+
+    /**
+     * Gets the search parameters of a named profile.
+     * @param profile The profile.
+     * @return The parameters.
+     */
+    [[nodiscard]] decoder_settings get_decoder_settings(decoder_profile profile);
+
+    /**
+     * Parses the name of a profile; "default", "fast", "fastest" or "accurate".
+     * @param name The name.
+     * @return The profile, or nothing if the name is unknown.
+     */
+    [[nodiscard]] std::optional<decoder_profile> parse_decoder_profile(std::string_view name);
+
+    /**
+     * Rewrites the text of a Kaldi configuration file with the given parameters, replacing the lines that set them
+     * and appending the ones it didn't set. Vosk only reads the parameters from a model's conf/model.conf while
+     * loading the model, so the rewritten configuration is meant to be loaded from an overlay of the model.
+     * @param config The configuration.
+     * @param settings The parameters.
+     * @return The rewritten configuration.
+     */
+    [[nodiscard]] std::string apply_decoder_settings(std::string_view config, const decoder_settings& settings);
+}
+
+#endif //GDVOSK_CORE_DECODER_SETTINGS_H
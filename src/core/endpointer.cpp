@@ -0,0 +1,47 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "endpointer.h"
+
+using namespace gdvosk::core;
+
+endpointer::endpointer(std::chrono::microseconds silence_timeout) :
+    _silence_timeout(silence_timeout)
+{
+}
+
+void endpointer::set_silence_timeout(std::chrono::microseconds silence_timeout)
+{
+    _silence_timeout = silence_timeout;
+}
+
+bool endpointer::observe_partial(std::string_view partial_json, std::chrono::microseconds now)
+{
+    if (_has_partial && _last_partial == partial_json)
+    {
+        return false;
+    }
+
+    _last_partial.assign(partial_json);
+    _has_partial = true;
+    _last_change = now;
+
+    return true;
+}
+
+bool endpointer::is_active() const
+{
+    return _has_partial;
+}
+
+bool endpointer::is_endpoint(std::chrono::microseconds now) const
+{
+    return _last_change.has_value() && now - *_last_change > _silence_timeout;
+}
+
+void endpointer::reset()
+{
+    _last_partial.clear();
+    _has_partial = false;
+    _last_change = std::nullopt;
+}
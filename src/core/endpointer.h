@@ -0,0 +1,82 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_CORE_ENDPOINTER_H
+#define GDVOSK_CORE_ENDPOINTER_H
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace gdvosk::core
+{
+    /**
+     * Decides when an utterance has ended by watching for the recognizer's partial result to stop changing. Time is
+     * passed in by the caller as a monotonic timestamp, so the same logic works for wall-clock and audio-clock input.
+     */
+    class endpointer final
+    {
+        /**
+         * Holds the amount of time the partial result must remain unchanged before the utterance is considered over.
+         */
+        std::chrono::microseconds _silence_timeout;
+
+        /**
+         * Holds the last partial result seen, in its serialized form.
+         */
+        std::string _last_partial;
+
+        /**
+         * Holds a value indicating whether a partial result has been seen since the last reset.
+         */
+        bool _has_partial = false;
+
+        /**
+         * Holds the time at which the partial result last changed.
+         */
+        std::optional<std::chrono::microseconds> _last_change;
+
+    public:
+        /**
+         * Initializes a new instance of the endpointer class.
+         * @param silence_timeout The amount of unchanged time after which an utterance ends.
+         */
+        explicit endpointer(std::chrono::microseconds silence_timeout = std::chrono::seconds(2));
+
+        /**
+         * Sets the amount of unchanged time after which an utterance ends.
+         * @param silence_timeout The timeout.
+         */
+        void set_silence_timeout(std::chrono::microseconds silence_timeout);
+
+        /**
+         * Observes a partial result.
+         * @param partial_json The partial result, in its serialized form.
+         * @param now The current time.
+         * @return true if the partial result differs from the last one observed; otherwise, false.
+         */
+        bool observe_partial(std::string_view partial_json, std::chrono::microseconds now);
+
+        /**
+         * Gets a value indicating whether an utterance is in progress; that is, whether a partial result has been
+         * observed since the last reset.
+         * @return true if an utterance is in progress; otherwise, false.
+         */
+        [[nodiscard]] bool is_active() const;
+
+        /**
+         * Gets a value indicating whether the current utterance has ended.
+         * @param now The current time.
+         * @return true if the partial result has not changed for longer than the silence timeout; otherwise, false.
+         */
+        [[nodiscard]] bool is_endpoint(std::chrono::microseconds now) const;
+
+        /**
+         * Forgets the current utterance.
+         */
+        void reset();
+    };
+}
+
+#endif //GDVOSK_CORE_ENDPOINTER_H
@@ -0,0 +1,104 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "front_end.h"
+
+#include <algorithm>
+
+#include "audio.h"
+#include "trace.h"
+
+using namespace gdvosk::core;
+
+bool stream_format::operator==(const stream_format& other) const
+{
+    return channels == other.channels && sample_rate == other.sample_rate;
+}
+
+bool stream_format::operator!=(const stream_format& other) const
+{
+    return !(*this == other);
+}
+
+front_end::front_end(int input_rate) :
+    _input_rate(input_rate)
+{
+}
+
+void front_end::push(span<const float> interleaved)
+{
+    _outputs.erase
+    (
+        std::remove_if
+        (
+            _outputs.begin(),
+            _outputs.end(),
+            [&](const auto& output) { return output.generation != _generation; }
+        ),
+        _outputs.end()
+    );
+
+    _input = interleaved;
+    ++_generation;
+}
+
+span<const float> front_end::get(const stream_format& format, std::size_t channel)
+{
+    auto existing = std::find_if
+    (
+        _outputs.begin(),
+        _outputs.end(),
+        [&](const auto& output) { return output.format == format; }
+    );
+
+    if (existing == _outputs.end())
+    {
+        output created;
+        created.format = format;
+        created.channels.resize(format.channels);
+        for (std::size_t i = 0; i < format.channels; ++i)
+        {
+            created.resamplers.emplace_back(_input_rate, format.sample_rate);
+        }
+
+        _outputs.push_back(std::move(created));
+        existing = _outputs.end() - 1;
+    }
+
+    auto& output = *existing;
+    if (output.generation != _generation)
+    {
+        GDVOSK_TRACE_SCOPE("front_end");
+
+        output.generation = _generation;
+
+        _scratch.resize(_input.size() / 2);
+        for (std::size_t i = 0; i < format.channels; ++i)
+        {
+            if (format.channels == 1)
+            {
+                mix_stereo_to_mono(_input, _scratch);
+            }
+            else
+            {
+                extract_channel(_input, i, _scratch);
+            }
+
+            output.channels[i].clear();
+            output.resamplers[i].process(_scratch, output.channels[i]);
+        }
+    }
+
+    if (channel >= output.channels.size())
+    {
+        return {};
+    }
+
+    return output.channels[channel];
+}
+
+void front_end::reset()
+{
+    _outputs.clear();
+    _input = {};
+}
@@ -0,0 +1,110 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_CORE_FRONT_END_H
+#define GDVOSK_CORE_FRONT_END_H
+
+#include <cstdint>
+#include <vector>
+
+#include "resampler.h"
+#include "span.h"
+
+namespace gdvosk::core
+{
+    /**
+     * Represents the shape of the audio a recognizer expects.
+     */
+    struct stream_format
+    {
+        /**
+         * Holds the number of channels; 1 to mix stereo input down, or 2 to decode each channel separately.
+         */
+        std::size_t channels = 1;
+
+        int sample_rate = 16000;
+
+        [[nodiscard]] bool operator==(const stream_format& other) const;
+        [[nodiscard]] bool operator!=(const stream_format& other) const;
+    };
+
+    /**
+     * Converts captured stereo audio into the mono streams recognizers decode, doing the work once per distinct format
+     * no matter how many recognizers read the result. Conversions happen lazily, on the first request for a format
+     * after each chunk is pushed.
+     */
+    class front_end final
+    {
+        /**
+         * Represents the converted form of the current chunk in one format.
+         */
+        struct output
+        {
+            stream_format format;
+
+            /**
+             * Holds one resampler per channel, carrying filter state over from the previous chunk.
+             */
+            std::vector<resampler> resamplers;
+
+            /**
+             * Holds the converted samples of each channel.
+             */
+            std::vector<std::vector<float>> channels;
+
+            /**
+             * Holds the chunk the output was last converted from.
+             */
+            std::uint64_t generation = 0;
+        };
+
+        int _input_rate;
+
+        /**
+         * Holds the interleaved samples of the current chunk.
+         */
+        span<const float> _input;
+
+        /**
+         * Holds a counter that increases with every chunk pushed.
+         */
+        std::uint64_t _generation = 0;
+
+        std::vector<output> _outputs;
+
+        /**
+         * Holds a reusable buffer for mono audio at the input rate.
+         */
+        std::vector<float> _scratch;
+
+    public:
+        /**
+         * Initializes a new instance of the front_end class.
+         * @param input_rate The sample rate of the captured audio.
+         */
+        explicit front_end(int input_rate);
+
+        /**
+         * Sets the chunk subsequent requests are served from. Formats that were not requested for the previous chunk
+         * are forgotten, since their resamplers missed audio.
+         * @param interleaved The interleaved left/right samples, in the range -1 to 1. Must outlive any views returned
+         * for it.
+         */
+        void push(span<const float> interleaved);
+
+        /**
+         * Gets one channel of the current chunk in the given format, scaled to the range Vosk expects.
+         * @param format The format.
+         * @param channel The channel; 0 when mixing, or 0 for left and 1 for right otherwise.
+         * @return The samples. Remains valid until the next chunk is pushed.
+         */
+        span<const float> get(const stream_format& format, std::size_t channel);
+
+        /**
+         * Forgets all formats and their filter state.
+         */
+        void reset();
+    };
+}
+
+#endif //GDVOSK_CORE_FRONT_END_H
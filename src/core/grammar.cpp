@@ -0,0 +1,187 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "grammar.h"
+
+#include <cstdio>
+
+using namespace gdvosk::core;
+
+namespace
+{
+    constexpr std::uint64_t fnv_offset_basis = 14695981039346656037ull;
+    constexpr std::uint64_t fnv_prime = 1099511628211ull;
+
+    void hash_bytes(std::uint64_t& hash, const char* data, std::size_t length)
+    {
+        for (std::size_t i = 0; i < length; ++i)
+        {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= fnv_prime;
+        }
+    }
+
+    void append_json_string(std::string& output, const std::string& value)
+    {
+        output += '"';
+        for (const auto c : value)
+        {
+            switch (c)
+            {
+                case '"': output += "\\\""; break;
+                case '\\': output += "\\\\"; break;
+                case '\n': output += "\\n"; break;
+                case '\r': output += "\\r"; break;
+                case '\t': output += "\\t"; break;
+                default:
+                {
+                    if (static_cast<unsigned char>(c) < 0x20)
+                    {
+                        char escaped[8];
+                        std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                        output += escaped;
+                        break;
+                    }
+
+                    output += c;
+                    break;
+                }
+            }
+        }
+
+        output += '"';
+    }
+}
+
+std::uint64_t gdvosk::core::hash_phrases(const std::vector<std::string>& phrases)
+{
+    auto hash = fnv_offset_basis;
+    for (const auto& phrase : phrases)
+    {
+        const auto length = static_cast<std::uint64_t>(phrase.size());
+
+        hash_bytes(hash, reinterpret_cast<const char*>(&length), sizeof(length));
+        hash_bytes(hash, phrase.data(), phrase.size());
+    }
+
+    return hash != 0 ? hash : 1;
+}
+
+std::optional<std::size_t> gdvosk::core::find_phrase(std::string_view text, const std::vector<std::string>& phrases)
+{
+    for (std::size_t i = 0; i < phrases.size(); ++i)
+    {
+        const auto& phrase = phrases[i];
+        if (phrase.empty())
+        {
+            continue;
+        }
+
+        auto position = text.find(phrase);
+        while (position != std::string_view::npos)
+        {
+            auto end = position + phrase.size();
+
+            auto starts_word = position == 0 || text[position - 1] == ' ';
+            auto ends_word = end == text.size() || text[end] == ' ';
+            if (starts_word && ends_word)
+            {
+                return i;
+            }
+
+            position = text.find(phrase, position + 1);
+        }
+    }
+
+    return std::nullopt;
+}
+
+grammar_cache& grammar_cache::shared()
+{
+    static grammar_cache cache;
+    return cache;
+}
+
+std::shared_ptr<const compiled_grammar> grammar_cache::get(const std::vector<std::string>& phrases)
+{
+    if (phrases.empty())
+    {
+        return nullptr;
+    }
+
+    const auto hash = hash_phrases(phrases);
+    {
+        std::lock_guard lock(_mutex);
+
+        auto existing = _index.find(hash);
+        if (existing != _index.end() && (*existing->second)->phrases == phrases)
+        {
+            _entries.splice(_entries.begin(), _entries, existing->second);
+            return *existing->second;
+        }
+    }
+
+    auto grammar = std::make_shared<compiled_grammar>();
+    grammar->hash = hash;
+    grammar->phrases = phrases;
+
+    grammar->json = "[";
+    for (std::size_t i = 0; i < phrases.size(); ++i)
+    {
+        if (i > 0)
+        {
+            grammar->json += ", ";
+        }
+
+        append_json_string(grammar->json, phrases[i]);
+    }
+
+    grammar->json += "]";
+
+    std::lock_guard lock(_mutex);
+
+    auto existing = _index.find(hash);
+    if (existing != _index.end())
+    {
+        // either another thread got here first, or this is a genuine collision; in both cases the newest grammar wins
+        _entries.erase(existing->second);
+        _index.erase(existing);
+    }
+
+    _entries.push_front(grammar);
+    _index[hash] = _entries.begin();
+    trim();
+
+    return grammar;
+}
+
+void grammar_cache::set_capacity(std::size_t capacity)
+{
+    std::lock_guard lock(_mutex);
+
+    _capacity = capacity;
+    trim();
+}
+
+std::size_t grammar_cache::get_capacity() const
+{
+    std::lock_guard lock(_mutex);
+    return _capacity;
+}
+
+void grammar_cache::clear()
+{
+    std::lock_guard lock(_mutex);
+
+    _entries.clear();
+    _index.clear();
+}
+
+void grammar_cache::trim()
+{
+    while (_entries.size() > _capacity)
+    {
+        _index.erase(_entries.back()->hash);
+        _entries.pop_back();
+    }
+}
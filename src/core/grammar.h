@@ -0,0 +1,117 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_CORE_GRAMMAR_H
+#define GDVOSK_CORE_GRAMMAR_H
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace gdvosk::core
+{
+    /**
+     * Represents a grammar in the form Vosk consumes it, identified by a hash of its phrase list.
+     */
+    struct compiled_grammar
+    {
+        /**
+         * Holds the hash of the phrase list. Never zero, which is reserved for "no grammar".
+         */
+        std::uint64_t hash = 0;
+
+        /**
+         * Holds the phrases, in order.
+         */
+        std::vector<std::string> phrases;
+
+        /**
+         * Holds the phrases as a JSON array, as expected by Vosk.
+         */
+        std::string json;
+    };
+
+    /**
+     * Computes the hash of a phrase list. Phrase boundaries are part of the hash, so {"a b"} and {"a", "b"} differ.
+     * @param phrases The phrases.
+     * @return The hash; never zero.
+     */
+    std::uint64_t hash_phrases(const std::vector<std::string>& phrases);
+
+    /**
+     * Holds the pseudo-word Vosk matches anything outside a grammar with. Adding it to a grammar lets the recognizer
+     * reject speech instead of forcing it onto the closest phrase.
+     */
+    constexpr std::string_view unknown_word = "[unk]";
+
+    /**
+     * Finds the first of several phrases in a transcription, as a sequence of whole words.
+     * @param text The transcription, as space-separated words.
+     * @param phrases The phrases.
+     * @return The index of the first phrase found, or nothing if none was.
+     */
+    std::optional<std::size_t> find_phrase(std::string_view text, const std::vector<std::string>& phrases);
+
+    /**
+     * Keeps recently used grammars so that switching back and forth between vocabularies neither re-serializes them
+     * nor (through the recognizer pool, which keys on the hash) recompiles them. Thread-safe.
+     */
+    class grammar_cache final
+    {
+        using entry_list = std::list<std::shared_ptr<const compiled_grammar>>;
+
+        mutable std::mutex _mutex;
+
+        /**
+         * Holds the cached grammars, most recently used first.
+         */
+        entry_list _entries;
+
+        /**
+         * Maps grammar hashes to their position in the entry list.
+         */
+        std::unordered_map<std::uint64_t, entry_list::iterator> _index;
+
+        /**
+         * Holds the maximum number of grammars kept.
+         */
+        std::size_t _capacity = 64;
+
+    public:
+        /**
+         * Gets the process-wide cache.
+         * @return The cache.
+         */
+        static grammar_cache& shared();
+
+        /**
+         * Gets the grammar for a phrase list, creating and caching it if necessary.
+         * @param phrases The phrases.
+         * @return The grammar, or nullptr if the phrase list is empty.
+         */
+        std::shared_ptr<const compiled_grammar> get(const std::vector<std::string>& phrases);
+
+        /**
+         * Sets the maximum number of grammars kept. The least recently used grammars are dropped first.
+         * @param capacity The maximum.
+         */
+        void set_capacity(std::size_t capacity);
+        [[nodiscard]] std::size_t get_capacity() const;
+
+        /**
+         * Drops every cached grammar.
+         */
+        void clear();
+
+    private:
+        void trim();
+    };
+}
+
+#endif //GDVOSK_CORE_GRAMMAR_H
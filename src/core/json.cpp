@@ -0,0 +1,451 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "json.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+using namespace gdvosk::core;
+
+namespace
+{
+    /**
+     * Implements a small recursive-descent parser. Vosk's output is machine-generated and shallow, so the parser
+     * favours simplicity over speed tricks; it does, however, avoid the locale-dependent C number parsing functions.
+     */
+    class json_parser final
+    {
+        std::string_view _text;
+        std::size_t _position = 0;
+
+        /**
+         * Holds the maximum nesting depth accepted before parsing fails.
+         */
+        static constexpr int max_depth = 64;
+
+    public:
+        explicit json_parser(std::string_view text) :
+            _text(text)
+        {
+        }
+
+        bool parse_document(json_value& value)
+        {
+            if (!parse_value(value, 0))
+            {
+                return false;
+            }
+
+            skip_whitespace();
+            return _position == _text.size();
+        }
+
+    private:
+        void skip_whitespace()
+        {
+            while (_position < _text.size())
+            {
+                const auto c = _text[_position];
+                if (c != ' ' && c != '\n' && c != '\r' && c != '\t')
+                {
+                    return;
+                }
+
+                ++_position;
+            }
+        }
+
+        bool consume(char expected)
+        {
+            skip_whitespace();
+            if (_position < _text.size() && _text[_position] == expected)
+            {
+                ++_position;
+                return true;
+            }
+
+            return false;
+        }
+
+        bool consume_literal(std::string_view literal)
+        {
+            if (_text.substr(_position, literal.size()) != literal)
+            {
+                return false;
+            }
+
+            _position += literal.size();
+            return true;
+        }
+
+        bool parse_value(json_value& value, int depth)
+        {
+            if (depth > max_depth)
+            {
+                return false;
+            }
+
+            skip_whitespace();
+            if (_position >= _text.size())
+            {
+                return false;
+            }
+
+            switch (_text[_position])
+            {
+                case '{':
+                {
+                    value.type = json_value::kind::object;
+                    return parse_object(value, depth);
+                }
+                case '[':
+                {
+                    value.type = json_value::kind::array;
+                    return parse_array(value, depth);
+                }
+                case '"':
+                {
+                    value.type = json_value::kind::string;
+                    return parse_string(value.string);
+                }
+                case 't':
+                {
+                    value.type = json_value::kind::boolean;
+                    value.boolean = true;
+                    return consume_literal("true");
+                }
+                case 'f':
+                {
+                    value.type = json_value::kind::boolean;
+                    value.boolean = false;
+                    return consume_literal("false");
+                }
+                case 'n':
+                {
+                    value.type = json_value::kind::null;
+                    return consume_literal("null");
+                }
+                default:
+                {
+                    value.type = json_value::kind::number;
+                    return parse_number(value.number);
+                }
+            }
+        }
+
+        bool parse_object(json_value& value, int depth)
+        {
+            ++_position;
+            if (consume('}'))
+            {
+                return true;
+            }
+
+            do
+            {
+                skip_whitespace();
+
+                json_member member;
+                if (!parse_string(member.key) || !consume(':') || !parse_value(member.value, depth + 1))
+                {
+                    return false;
+                }
+
+                value.object.push_back(std::move(member));
+            }
+            while (consume(','));
+
+            return consume('}');
+        }
+
+        bool parse_array(json_value& value, int depth)
+        {
+            ++_position;
+            if (consume(']'))
+            {
+                return true;
+            }
+
+            do
+            {
+                json_value element;
+                if (!parse_value(element, depth + 1))
+                {
+                    return false;
+                }
+
+                value.array.push_back(std::move(element));
+            }
+            while (consume(','));
+
+            return consume(']');
+        }
+
+        bool parse_hex4(std::uint32_t& code_point)
+        {
+            if (_position + 4 > _text.size())
+            {
+                return false;
+            }
+
+            code_point = 0;
+            for (auto i = 0; i < 4; ++i)
+            {
+                const auto c = _text[_position++];
+                code_point <<= 4;
+
+                if (c >= '0' && c <= '9')
+                {
+                    code_point |= c - '0';
+                }
+                else if (c >= 'a' && c <= 'f')
+                {
+                    code_point |= c - 'a' + 10;
+                }
+                else if (c >= 'A' && c <= 'F')
+                {
+                    code_point |= c - 'A' + 10;
+                }
+                else
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        static void append_utf8(std::string& output, std::uint32_t code_point)
+        {
+            if (code_point < 0x80)
+            {
+                output += static_cast<char>(code_point);
+            }
+            else if (code_point < 0x800)
+            {
+                output += static_cast<char>(0xC0 | (code_point >> 6));
+                output += static_cast<char>(0x80 | (code_point & 0x3F));
+            }
+            else if (code_point < 0x10000)
+            {
+                output += static_cast<char>(0xE0 | (code_point >> 12));
+                output += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+                output += static_cast<char>(0x80 | (code_point & 0x3F));
+            }
+            else
+            {
+                output += static_cast<char>(0xF0 | (code_point >> 18));
+                output += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+                output += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+                output += static_cast<char>(0x80 | (code_point & 0x3F));
+            }
+        }
+
+        bool parse_string(std::string& output)
+        {
+            if (_position >= _text.size() || _text[_position] != '"')
+            {
+                return false;
+            }
+
+            ++_position;
+            while (_position < _text.size())
+            {
+                const auto c = _text[_position++];
+                if (c == '"')
+                {
+                    return true;
+                }
+
+                if (c != '\\')
+                {
+                    output += c;
+                    continue;
+                }
+
+                if (_position >= _text.size())
+                {
+                    return false;
+                }
+
+                const auto escape = _text[_position++];
+                switch (escape)
+                {
+                    case '"': output += '"'; break;
+                    case '\\': output += '\\'; break;
+                    case '/': output += '/'; break;
+                    case 'b': output += '\b'; break;
+                    case 'f': output += '\f'; break;
+                    case 'n': output += '\n'; break;
+                    case 'r': output += '\r'; break;
+                    case 't': output += '\t'; break;
+                    case 'u':
+                    {
+                        std::uint32_t code_point;
+                        if (!parse_hex4(code_point))
+                        {
+                            return false;
+                        }
+
+                        if (code_point >= 0xD800 && code_point <= 0xDBFF)
+                        {
+                            std::uint32_t low;
+                            if (!consume_literal("\\u") || !parse_hex4(low) || low < 0xDC00 || low > 0xDFFF)
+                            {
+                                return false;
+                            }
+
+                            code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                        }
+
+                        append_utf8(output, code_point);
+                        break;
+                    }
+                    default:
+                    {
+                        return false;
+                    }
+                }
+            }
+
+            return false;
+        }
+
+        bool parse_number(double& number)
+        {
+            const auto start = _position;
+
+            auto negative = false;
+            if (_position < _text.size() && _text[_position] == '-')
+            {
+                negative = true;
+                ++_position;
+            }
+
+            std::uint64_t mantissa = 0;
+            auto exponent = 0;
+            auto digits = 0;
+
+            auto read_digits = [&](bool fractional)
+            {
+                while (_position < _text.size() && _text[_position] >= '0' && _text[_position] <= '9')
+                {
+                    if (digits < 19)
+                    {
+                        mantissa = mantissa * 10 + (_text[_position] - '0');
+                        digits += mantissa != 0 ? 1 : 0;
+                        exponent -= fractional ? 1 : 0;
+                    }
+                    else if (!fractional)
+                    {
+                        // out of precision; keep the magnitude
+                        exponent += 1;
+                    }
+
+                    ++_position;
+                }
+            };
+
+            read_digits(false);
+
+            if (_position < _text.size() && _text[_position] == '.')
+            {
+                ++_position;
+                read_digits(true);
+            }
+
+            if (_position < _text.size() && (_text[_position] == 'e' || _text[_position] == 'E'))
+            {
+                ++_position;
+
+                auto exponent_negative = false;
+                if (_position < _text.size() && (_text[_position] == '+' || _text[_position] == '-'))
+                {
+                    exponent_negative = _text[_position] == '-';
+                    ++_position;
+                }
+
+                auto explicit_exponent = 0;
+                while (_position < _text.size() && _text[_position] >= '0' && _text[_position] <= '9')
+                {
+                    explicit_exponent = std::min(explicit_exponent * 10 + (_text[_position] - '0'), 10000);
+                    ++_position;
+                }
+
+                exponent += exponent_negative ? -explicit_exponent : explicit_exponent;
+            }
+
+            if (_position == start || (negative && _position == start + 1))
+            {
+                return false;
+            }
+
+            // dividing by an exact power of ten rounds correctly for the short decimals Vosk emits, where
+            // multiplying by a negative power does not
+            number = exponent < 0
+                ? static_cast<double>(mantissa) / std::pow(10.0, -exponent)
+                : static_cast<double>(mantissa) * std::pow(10.0, exponent);
+            if (negative)
+            {
+                number = -number;
+            }
+
+            return true;
+        }
+    };
+}
+
+const json_value* json_value::find(std::string_view key) const
+{
+    if (type != kind::object)
+    {
+        return nullptr;
+    }
+
+    for (const auto& member : object)
+    {
+        if (member.key == key)
+        {
+            return &member.value;
+        }
+    }
+
+    return nullptr;
+}
+
+std::string_view json_value::get_string(std::string_view key) const
+{
+    const auto* value = find(key);
+    if (value == nullptr || value->type != kind::string)
+    {
+        return { };
+    }
+
+    return value->string;
+}
+
+double json_value::get_number(std::string_view key, double fallback) const
+{
+    const auto* value = find(key);
+    if (value == nullptr || value->type != kind::number)
+    {
+        return fallback;
+    }
+
+    return value->number;
+}
+
+std::optional<json_value> gdvosk::core::parse_json(std::string_view text)
+{
+    json_value value;
+
+    json_parser parser(text);
+    if (!parser.parse_document(value))
+    {
+        return std::nullopt;
+    }
+
+    return value;
+}
@@ -0,0 +1,85 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_CORE_JSON_H
+#define GDVOSK_CORE_JSON_H
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace gdvosk::core
+{
+    struct json_member;
+
+    /**
+     * Represents a parsed JSON value. Only the members matching the value's type are meaningful.
+     */
+    struct json_value
+    {
+        /**
+         * Enumerates the types a JSON value can have.
+         */
+        enum class kind
+        {
+            null,
+            boolean,
+            number,
+            string,
+            array,
+            object
+        };
+
+        kind type = kind::null;
+        bool boolean = false;
+        double number = 0;
+        std::string string;
+        std::vector<json_value> array;
+
+        /**
+         * Holds the members of an object, in document order.
+         */
+        std::vector<json_member> object;
+
+        /**
+         * Finds the member of an object with the given key.
+         * @param key The key.
+         * @return The member's value, or nullptr if the value is not an object or has no such member.
+         */
+        [[nodiscard]] const json_value* find(std::string_view key) const;
+
+        /**
+         * Gets the string stored under the given key of an object.
+         * @param key The key.
+         * @return The string, or an empty string if there is no string member with that key.
+         */
+        [[nodiscard]] std::string_view get_string(std::string_view key) const;
+
+        /**
+         * Gets the number stored under the given key of an object.
+         * @param key The key.
+         * @param fallback The value to return if there is no numeric member with that key.
+         * @return The number.
+         */
+        [[nodiscard]] double get_number(std::string_view key, double fallback = 0) const;
+    };
+
+    /**
+     * Represents a single key-value pair of a JSON object.
+     */
+    struct json_member
+    {
+        std::string key;
+        json_value value;
+    };
+
+    /**
+     * Parses a JSON document.
+     * @param text The document.
+     * @return The parsed value, or nothing if the document is malformed.
+     */
+    std::optional<json_value> parse_json(std::string_view text);
+}
+
+#endif //GDVOSK_CORE_JSON_H
@@ -0,0 +1,73 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "load_monitor.h"
+
+using namespace gdvosk::core;
+
+load_monitor::load_monitor(double threshold, std::chrono::microseconds hold_time) :
+    _threshold(threshold),
+    _hold_time(hold_time)
+{
+}
+
+bool load_monitor::observe(std::chrono::microseconds decode_time, std::chrono::microseconds audio_duration)
+{
+    if (audio_duration <= std::chrono::microseconds::zero())
+    {
+        return false;
+    }
+
+    auto sample = static_cast<double>(decode_time.count()) / static_cast<double>(audio_duration.count());
+    _real_time_factor = smoothing * sample + (1.0 - smoothing) * _real_time_factor;
+
+    if (!_is_overloaded)
+    {
+        if (_real_time_factor <= _threshold)
+        {
+            return false;
+        }
+
+        _is_overloaded = true;
+        _recovered_for = std::chrono::microseconds::zero();
+
+        return true;
+    }
+
+    if (_real_time_factor >= _threshold * recovery_ratio)
+    {
+        _recovered_for = std::chrono::microseconds::zero();
+        return false;
+    }
+
+    _recovered_for += audio_duration;
+    if (_recovered_for < _hold_time)
+    {
+        return false;
+    }
+
+    _is_overloaded = false;
+    return true;
+}
+
+void load_monitor::set_threshold(double threshold)
+{
+    _threshold = threshold;
+}
+
+double load_monitor::get_real_time_factor() const
+{
+    return _real_time_factor;
+}
+
+bool load_monitor::is_overloaded() const
+{
+    return _is_overloaded;
+}
+
+void load_monitor::reset()
+{
+    _real_time_factor = 0;
+    _is_overloaded = false;
+    _recovered_for = std::chrono::microseconds::zero();
+}
@@ -0,0 +1,81 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_CORE_LOAD_MONITOR_H
+#define GDVOSK_CORE_LOAD_MONITOR_H
+
+#include <chrono>
+
+namespace gdvosk::core
+{
+    /**
+     * Tracks how fast audio is decoded relative to real time, and decides when a decoder is overloaded. The real-time
+     * factor is smoothed with an exponential moving average, and the overload state has hysteresis, so a single slow
+     * chunk doesn't trigger it and a single fast one doesn't clear it.
+     */
+    class load_monitor final
+    {
+        /**
+         * Holds the weight of each new measurement in the moving average.
+         */
+        static constexpr double smoothing = 0.2;
+
+        /**
+         * Holds the fraction of the threshold the real-time factor must fall below before an overload can clear.
+         */
+        static constexpr double recovery_ratio = 0.75;
+
+        double _threshold;
+        std::chrono::microseconds _hold_time;
+
+        double _real_time_factor = 0;
+        bool _is_overloaded = false;
+
+        /**
+         * Holds the amount of audio decoded below the recovery threshold since the factor last rose above it.
+         */
+        std::chrono::microseconds _recovered_for = std::chrono::microseconds::zero();
+
+    public:
+        /**
+         * Initializes a new instance of the load_monitor class.
+         * @param threshold The real-time factor above which the decoder is overloaded.
+         * @param hold_time The amount of audio that must be decoded comfortably below the threshold before an overload
+         * clears.
+         */
+        explicit load_monitor(double threshold = 0.9, std::chrono::microseconds hold_time = std::chrono::seconds(10));
+
+        /**
+         * Records the time it took to decode a stretch of audio.
+         * @param decode_time The time spent decoding.
+         * @param audio_duration The duration of the decoded audio.
+         * @return true if the overload state changed; otherwise, false.
+         */
+        bool observe(std::chrono::microseconds decode_time, std::chrono::microseconds audio_duration);
+
+        /**
+         * Sets the real-time factor above which the decoder is overloaded.
+         * @param threshold The threshold.
+         */
+        void set_threshold(double threshold);
+
+        /**
+         * Gets the smoothed real-time factor; that is, decoding time divided by audio duration.
+         * @return The real-time factor.
+         */
+        [[nodiscard]] double get_real_time_factor() const;
+
+        /**
+         * Gets a value indicating whether the decoder is currently considered overloaded.
+         * @return true if the decoder is overloaded; otherwise, false.
+         */
+        [[nodiscard]] bool is_overloaded() const;
+
+        /**
+         * Forgets every measurement and clears the overload state.
+         */
+        void reset();
+    };
+}
+
+#endif //GDVOSK_CORE_LOAD_MONITOR_H
@@ -0,0 +1,491 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "model_registry.h"
+
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+
+#include "recognizer.h"
+#include "recognizer_pool.h"
+#include "trace.h"
+
+using namespace gdvosk::core;
+using namespace std::chrono;
+
+namespace
+{
+    /**
+     * Holds the shortest idle delay allowed, which keeps a model that's used in bursts from being loaded over and over
+     * again.
+     */
+    constexpr steady_clock::duration min_idle_delay = seconds(1);
+}
+
+model_lease::model_lease(model_registry* registry, std::uint64_t handle, ::VoskModel* model) :
+    _registry(registry),
+    _handle(handle),
+    _model(model)
+{
+}
+
+model_lease::~model_lease()
+{
+    release();
+}
+
+model_lease::model_lease(const model_lease& other)
+{
+    *this = other;
+}
+
+model_lease::model_lease(model_lease&& other) noexcept :
+    _registry(std::exchange(other._registry, nullptr)),
+    _handle(std::exchange(other._handle, 0)),
+    _model(std::exchange(other._model, nullptr))
+{
+}
+
+model_lease& model_lease::operator=(const model_lease& other)
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+
+    release();
+
+    if (other._registry != nullptr)
+    {
+        std::lock_guard lock(other._registry->_mutex);
+
+        // the lease being copied keeps the entry and its model around
+        ++other._registry->_entries.at(other._handle).leases;
+    }
+
+    _registry = other._registry;
+    _handle = other._handle;
+    _model = other._model;
+
+    return *this;
+}
+
+model_lease& model_lease::operator=(model_lease&& other) noexcept
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+
+    release();
+
+    _registry = std::exchange(other._registry, nullptr);
+    _handle = std::exchange(other._handle, 0);
+    _model = std::exchange(other._model, nullptr);
+
+    return *this;
+}
+
+::VoskModel* model_lease::get() const
+{
+    return _model;
+}
+
+void model_lease::release()
+{
+    if (_registry != nullptr)
+    {
+        _registry->release(_handle);
+    }
+
+    _registry = nullptr;
+    _handle = 0;
+    _model = nullptr;
+}
+
+model_registry& model_registry::shared()
+{
+    static model_registry registry;
+    return registry;
+}
+
+std::uint64_t model_registry::add(std::string path, ::VoskModel* model, std::uint64_t size)
+{
+    std::uint64_t handle;
+    {
+        std::lock_guard lock(_mutex);
+
+        handle = _next_handle++;
+
+        auto& added = _entries[handle];
+        added.path = std::move(path);
+        added.model = model;
+        added.size = size;
+        added.last_used = steady_clock::now();
+    }
+
+    // other models may have to make room for this one
+    trim();
+    return handle;
+}
+
+void model_registry::remove(std::uint64_t handle)
+{
+    ::VoskModel* model = nullptr;
+    {
+        std::lock_guard lock(_mutex);
+
+        auto existing = _entries.find(handle);
+        if (existing == _entries.end() || existing->second.is_removed)
+        {
+            return;
+        }
+
+        auto& removed = existing->second;
+        if (removed.leases > 0 || removed.is_evicting)
+        {
+            // whoever lets go of the model last frees it
+            removed.is_removed = true;
+        }
+        else
+        {
+            model = removed.model;
+            _entries.erase(existing);
+        }
+    }
+
+    // anyone waiting for the model to be loaded again gives up
+    _loaded.notify_all();
+
+    if (model != nullptr)
+    {
+        free_model(model);
+    }
+}
+
+::VoskModel* model_registry::use(std::uint64_t handle)
+{
+    return use(handle, false);
+}
+
+model_lease model_registry::lease(std::uint64_t handle)
+{
+    auto* model = use(handle, true);
+    return model != nullptr ? model_lease(this, handle, model) : model_lease();
+}
+
+model_lease model_registry::try_lease(std::uint64_t handle)
+{
+    std::lock_guard lock(_mutex);
+
+    auto existing = _entries.find(handle);
+    if (existing == _entries.end())
+    {
+        return {};
+    }
+
+    auto& used = existing->second;
+    if (used.model == nullptr || used.is_loading || used.is_evicting || used.is_removed)
+    {
+        return {};
+    }
+
+    used.last_used = steady_clock::now();
+    ++used.leases;
+
+    return model_lease(this, handle, used.model);
+}
+
+::VoskModel* model_registry::use(std::uint64_t handle, bool is_leased)
+{
+    std::string path;
+    {
+        std::unique_lock lock(_mutex);
+
+        auto existing = _entries.find(handle);
+        while (existing != _entries.end() && (existing->second.is_loading || existing->second.is_evicting))
+        {
+            _loaded.wait(lock);
+            existing = _entries.find(handle);
+        }
+
+        if (existing == _entries.end() || existing->second.is_removed)
+        {
+            return nullptr;
+        }
+
+        auto& used = existing->second;
+        used.last_used = steady_clock::now();
+
+        if (used.model != nullptr)
+        {
+            used.leases += is_leased ? 1 : 0;
+            return used.model;
+        }
+
+        used.is_loading = true;
+        path = used.path;
+    }
+
+    ::VoskModel* loaded;
+    {
+        // the files are normally still in the page cache, so this is much faster than the first load
+        GDVOSK_TRACE_SCOPE("model_reload");
+        loaded = vosk_model_new(path.c_str());
+    }
+
+    {
+        std::lock_guard lock(_mutex);
+
+        auto existing = _entries.find(handle);
+        if (existing != _entries.end())
+        {
+            auto& used = existing->second;
+            used.is_loading = false;
+            used.model = loaded;
+            used.last_used = steady_clock::now();
+
+            if (loaded != nullptr)
+            {
+                ++used.reloads;
+                used.leases += is_leased ? 1 : 0;
+            }
+        }
+        else if (loaded != nullptr)
+        {
+            // the model was removed while it was being loaded
+            vosk_model_free(loaded);
+            loaded = nullptr;
+        }
+    }
+
+    _loaded.notify_all();
+
+    if (loaded != nullptr)
+    {
+        trim();
+    }
+
+    return loaded;
+}
+
+void model_registry::release(std::uint64_t handle)
+{
+    ::VoskModel* model = nullptr;
+    {
+        std::lock_guard lock(_mutex);
+
+        auto existing = _entries.find(handle);
+        if (existing == _entries.end() || existing->second.leases == 0)
+        {
+            return;
+        }
+
+        auto& released = existing->second;
+        if (--released.leases == 0 && released.is_removed && !released.is_evicting)
+        {
+            model = released.model;
+            _entries.erase(existing);
+        }
+    }
+
+    if (model != nullptr)
+    {
+        free_model(model);
+        return;
+    }
+
+    // the model may have been kept resident past the budget while it was leased
+    trim();
+}
+
+void model_registry::free_model(::VoskModel* model)
+{
+    recognizer_pool::shared().evict(model);
+    vosk_model_free(model);
+}
+
+model_statistics model_registry::get_statistics(std::uint64_t handle) const
+{
+    model_statistics statistics;
+    {
+        std::lock_guard lock(_mutex);
+
+        auto existing = _entries.find(handle);
+        if (existing == _entries.end())
+        {
+            return statistics;
+        }
+
+        const auto& model = existing->second;
+        statistics.is_resident = model.model != nullptr;
+        statistics.size = model.size;
+        statistics.evictions = model.evictions;
+        statistics.reloads = model.reloads;
+
+        if (model.model != nullptr)
+        {
+            statistics.recognizers = count_recognizers(model.model);
+        }
+    }
+
+    return statistics;
+}
+
+std::uint64_t model_registry::get_resident_size() const
+{
+    std::lock_guard lock(_mutex);
+    return sum_resident_sizes();
+}
+
+void model_registry::set_budget(std::uint64_t budget)
+{
+    {
+        std::lock_guard lock(_mutex);
+        _budget = budget;
+    }
+
+    trim();
+}
+
+std::uint64_t model_registry::get_budget() const
+{
+    std::lock_guard lock(_mutex);
+    return _budget;
+}
+
+void model_registry::set_idle_delay(steady_clock::duration idle_delay)
+{
+    std::lock_guard lock(_mutex);
+    _idle_delay = std::max(idle_delay, min_idle_delay);
+}
+
+steady_clock::duration model_registry::get_idle_delay() const
+{
+    std::lock_guard lock(_mutex);
+    return _idle_delay;
+}
+
+std::size_t model_registry::trim()
+{
+    std::size_t evicted = 0;
+
+    // models found to be in use are left alone for the rest of this pass
+    std::unordered_set<std::uint64_t> skipped;
+
+    while (true)
+    {
+        std::uint64_t handle = 0;
+        ::VoskModel* candidate = nullptr;
+        {
+            std::lock_guard lock(_mutex);
+            if (_budget == 0 || sum_resident_sizes() <= _budget)
+            {
+                break;
+            }
+
+            auto now = steady_clock::now();
+            for (const auto& [entry_handle, model] : _entries)
+            {
+                auto is_idle = model.model != nullptr && now - model.last_used >= _idle_delay;
+                if (!is_idle || model.is_evicting || skipped.count(entry_handle) > 0)
+                {
+                    continue;
+                }
+
+                if (candidate == nullptr || model.last_used < _entries.at(handle).last_used)
+                {
+                    handle = entry_handle;
+                    candidate = model.model;
+                }
+            }
+
+            if (candidate == nullptr)
+            {
+                break;
+            }
+
+            auto& chosen = _entries.at(handle);
+            if (is_in_use(chosen))
+            {
+                // the model keeps its pooled recognizers, since it stays resident
+                skipped.insert(handle);
+                continue;
+            }
+
+            // from here on, anyone after the model waits to see whether it was evicted
+            chosen.is_evicting = true;
+        }
+
+        // idle recognizers in the pool would keep the model's memory alive, and an evicted model has no use for them
+        recognizer_pool::shared().evict(candidate);
+
+        auto is_freed = false;
+        {
+            std::lock_guard lock(_mutex);
+
+            // the entry stays while it's being evicted, even if it's removed meanwhile
+            auto existing = _entries.find(handle);
+            auto& evicting = existing->second;
+            evicting.is_evicting = false;
+
+            if (evicting.is_removed)
+            {
+                // nobody can have leased the model since, so the removal is finished here
+                _entries.erase(existing);
+                is_freed = true;
+            }
+            else if (count_recognizers(candidate) == 0)
+            {
+                // a recognizer created without a lease would still be using the model, which is then kept
+                evicting.model = nullptr;
+                ++evicting.evictions;
+
+                is_freed = true;
+                ++evicted;
+            }
+        }
+
+        _loaded.notify_all();
+
+        if (!is_freed)
+        {
+            skipped.insert(handle);
+            continue;
+        }
+
+        vosk_model_free(candidate);
+    }
+
+    return evicted;
+}
+
+bool model_registry::is_in_use(const entry& model)
+{
+    if (model.leases > 0)
+    {
+        return true;
+    }
+
+    // the total goes first, so that a recognizer moving in or out of the pool in between can only make the model
+    // look busier than it is
+    auto recognizers = count_recognizers(model.model);
+    auto spares = recognizer_pool::shared().count_spares(model.model);
+
+    return recognizers > spares;
+}
+
+std::uint64_t model_registry::sum_resident_sizes() const
+{
+    std::uint64_t size = 0;
+    for (const auto& [handle, model] : _entries)
+    {
+        if (model.model != nullptr)
+        {
+            size += model.size;
+        }
+    }
+
+    return size;
+}
@@ -0,0 +1,262 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_CORE_MODEL_REGISTRY_H
+#define GDVOSK_CORE_MODEL_REGISTRY_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <vosk_api.h>
+
+namespace gdvosk::core
+{
+    /**
+     * Represents the residency of one model in a registry.
+     */
+    struct model_statistics
+    {
+        /**
+         * Holds a value indicating whether the native model is loaded.
+         */
+        bool is_resident = false;
+
+        /**
+         * Holds the estimated memory the native model takes up while loaded, in bytes.
+         */
+        std::uint64_t size = 0;
+
+        std::uint64_t evictions = 0;
+        std::uint64_t reloads = 0;
+
+        /**
+         * Holds the number of recognizers alive for the model.
+         */
+        std::size_t recognizers = 0;
+    };
+
+    class model_registry;
+
+    /**
+     * Keeps a model from being evicted for as long as it lives, so that recognizers can be created from it. Copies
+     * keep it from being evicted as well.
+     */
+    class model_lease final
+    {
+        friend class model_registry;
+
+        model_registry* _registry = nullptr;
+        std::uint64_t _handle = 0;
+        ::VoskModel* _model = nullptr;
+
+        model_lease(model_registry* registry, std::uint64_t handle, ::VoskModel* model);
+
+    public:
+        model_lease() = default;
+        ~model_lease();
+
+        model_lease(const model_lease& other);
+        model_lease(model_lease&& other) noexcept;
+        model_lease& operator=(const model_lease& other);
+        model_lease& operator=(model_lease&& other) noexcept;
+
+        /**
+         * Gets the native model.
+         * @return The model, or nullptr if the lease is empty.
+         */
+        [[nodiscard]] ::VoskModel* get() const;
+
+    private:
+        void release();
+    };
+
+    /**
+     * Keeps loaded models within a memory budget. Models are registered once loaded and referred to by handle; when
+     * the models resident together take up more than the budget, the least recently used ones that have been idle
+     * for a while and have no recognizers decoding with them are freed, and loaded again from their directory the
+     * next time they're used. Thread-safe.
+     *
+     * Idle recognizers in the shared pool don't keep a model resident, and are destroyed along with it. Recognizers
+     * must therefore only be created or taken from the pool while holding a lease on their model.
+     */
+    class model_registry final
+    {
+        friend class model_lease;
+
+        struct entry
+        {
+            std::string path;
+
+            /**
+             * Holds the native model, or nullptr while it's evicted.
+             */
+            ::VoskModel* model = nullptr;
+
+            std::uint64_t size = 0;
+            std::chrono::steady_clock::time_point last_used;
+
+            std::uint64_t evictions = 0;
+            std::uint64_t reloads = 0;
+
+            /**
+             * Holds a value indicating whether the model is being loaded again.
+             */
+            bool is_loading = false;
+
+            /**
+             * Holds a value indicating whether the model is being evicted.
+             */
+            bool is_evicting = false;
+
+            /**
+             * Holds a value indicating whether the model has been unregistered while leased or being evicted, and is
+             * only kept until neither is the case anymore.
+             */
+            bool is_removed = false;
+
+            /**
+             * Holds the number of leases on the model, which keep it from being evicted.
+             */
+            std::size_t leases = 0;
+        };
+
+        mutable std::mutex _mutex;
+
+        /**
+         * Wakes the threads waiting for a model to be loaded again or evicted.
+         */
+        std::condition_variable _loaded;
+
+        std::unordered_map<std::uint64_t, entry> _entries;
+        std::uint64_t _next_handle = 1;
+
+        /**
+         * Holds the memory the resident models may take up together, in bytes, or zero for no limit.
+         */
+        std::uint64_t _budget = 0;
+
+        /**
+         * Holds the time a model must go unused before it may be evicted.
+         */
+        std::chrono::steady_clock::duration _idle_delay = std::chrono::seconds(60);
+
+    public:
+        /**
+         * Gets the process-wide registry.
+         * @return The registry.
+         */
+        static model_registry& shared();
+
+        /**
+         * Registers a loaded model, taking ownership of it.
+         * @param path The directory the model was loaded from, which it's reloaded from after an eviction.
+         * @param model The model.
+         * @param size The estimated memory the model takes up, in bytes.
+         * @return The handle of the model; never zero.
+         */
+        std::uint64_t add(std::string path, ::VoskModel* model, std::uint64_t size);
+
+        /**
+         * Unregisters a model, freeing it along with any idle recognizers the shared pool keeps for it. A leased
+         * model is freed once the last lease on it is released.
+         * @param handle The handle of the model.
+         */
+        void remove(std::uint64_t handle);
+
+        /**
+         * Gets the native model for a handle, loading it again if it was evicted, and marks it as used.
+         * @param handle The handle of the model.
+         * @return The model, or nullptr if the handle is unknown or the model could not be loaded again.
+         */
+        ::VoskModel* use(std::uint64_t handle);
+
+        /**
+         * Gets the native model for a handle like use, and keeps it from being evicted for as long as the returned
+         * lease lives.
+         * @param handle The handle of the model.
+         * @return The lease, which is empty if the handle is unknown or the model could not be loaded again.
+         */
+        model_lease lease(std::uint64_t handle);
+
+        /**
+         * Leases a model like lease, but only if it's resident; a model that was evicted is neither waited for nor
+         * loaded again.
+         * @param handle The handle of the model.
+         * @return The lease, which is empty if the handle is unknown or the model isn't resident.
+         */
+        model_lease try_lease(std::uint64_t handle);
+
+        /**
+         * Gets the residency of a model.
+         * @param handle The handle of the model.
+         * @return The statistics.
+         */
+        [[nodiscard]] model_statistics get_statistics(std::uint64_t handle) const;
+
+        /**
+         * Gets the estimated memory the resident models take up together.
+         * @return The size, in bytes.
+         */
+        [[nodiscard]] std::uint64_t get_resident_size() const;
+
+        /**
+         * Sets the memory the resident models may take up together. Models are evicted right away if they take up
+         * more.
+         * @param budget The budget, in bytes, or zero for no limit.
+         */
+        void set_budget(std::uint64_t budget);
+        [[nodiscard]] std::uint64_t get_budget() const;
+
+        /**
+         * Sets the time a model must go unused before it may be evicted. Delays shorter than a second are raised to
+         * one.
+         * @param idle_delay The delay.
+         */
+        void set_idle_delay(std::chrono::steady_clock::duration idle_delay);
+        [[nodiscard]] std::chrono::steady_clock::duration get_idle_delay() const;
+
+        /**
+         * Evicts idle models until the resident ones fit the budget, or no more can be evicted.
+         * @return The number of models evicted.
+         */
+        std::size_t trim();
+
+    private:
+        /**
+         * Gets the native model for a handle, loading it again if it was evicted, and marks it as used.
+         * @param handle The handle of the model.
+         * @param is_leased Whether to take a lease on the model once it's resident.
+         * @return The model, or nullptr if the handle is unknown or the model could not be loaded again.
+         */
+        ::VoskModel* use(std::uint64_t handle, bool is_leased);
+
+        /**
+         * Releases a lease on a model, freeing it if it was unregistered meanwhile.
+         * @param handle The handle of the model.
+         */
+        void release(std::uint64_t handle);
+
+        /**
+         * Frees a model along with any idle recognizers the shared pool keeps for it.
+         * @param model The model.
+         */
+        static void free_model(::VoskModel* model);
+
+        /**
+         * Determines whether a model is in use; that is, whether it's leased or has recognizers besides the idle ones
+         * in the shared pool. Must be called with the mutex held.
+         */
+        [[nodiscard]] static bool is_in_use(const entry& model);
+
+        /**
+         * Sums the sizes of the resident models. Must be called with the mutex held.
+         */
+        [[nodiscard]] std::uint64_t sum_resident_sizes() const;
+    };
+}
+
+#endif //GDVOSK_CORE_MODEL_REGISTRY_H
@@ -0,0 +1,318 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "recognizer.h"
+#include "audio.h"
+#include "trace.h"
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+using namespace gdvosk::core;
+
+namespace
+{
+    /**
+     * Tracks the number of recognizers alive per model.
+     */
+    struct recognizer_counts
+    {
+        std::mutex mutex;
+        std::unordered_map<const ::VoskModel*, std::size_t> counts;
+    };
+
+    recognizer_counts& get_recognizer_counts()
+    {
+        static recognizer_counts counts;
+        return counts;
+    }
+}
+
+bool recognizer_options::operator==(const recognizer_options& other) const
+{
+    return max_alternatives == other.max_alternatives
+        && words == other.words
+        && partial_words == other.partial_words
+        && nlsml == other.nlsml;
+}
+
+bool recognizer_options::operator!=(const recognizer_options& other) const
+{
+    return !(*this == other);
+}
+
+recognizer::recognizer(::VoskRecognizer* recognizer, ::VoskModel* model) :
+    _recognizer(recognizer),
+    _model(model)
+{
+    auto& counts = get_recognizer_counts();
+
+    std::lock_guard lock(counts.mutex);
+    ++counts.counts[_model];
+}
+
+std::unique_ptr<recognizer> recognizer::create
+(
+    ::VoskModel* model,
+    float sample_rate,
+    ::VoskSpkModel* speaker_model
+)
+{
+    if (model == nullptr)
+    {
+        return nullptr;
+    }
+
+    auto* created = speaker_model != nullptr
+        ? vosk_recognizer_new_spk(model, sample_rate, speaker_model)
+        : vosk_recognizer_new(model, sample_rate);
+
+    if (created == nullptr)
+    {
+        return nullptr;
+    }
+
+    return std::unique_ptr<recognizer>(new recognizer(created, model));
+}
+
+std::unique_ptr<recognizer> recognizer::create_with_grammar
+(
+    ::VoskModel* model,
+    float sample_rate,
+    std::string_view grammar_json
+)
+{
+    if (model == nullptr)
+    {
+        return nullptr;
+    }
+
+    const std::string grammar(grammar_json);
+
+    auto* created = vosk_recognizer_new_grm(model, sample_rate, grammar.c_str());
+    if (created == nullptr)
+    {
+        return nullptr;
+    }
+
+    return std::unique_ptr<recognizer>(new recognizer(created, model));
+}
+
+recognizer::~recognizer()
+{
+    vosk_recognizer_free(_recognizer);
+
+    auto& counts = get_recognizer_counts();
+
+    std::lock_guard lock(counts.mutex);
+    auto existing = counts.counts.find(_model);
+    if (--existing->second == 0)
+    {
+        counts.counts.erase(existing);
+    }
+}
+
+accept_status recognizer::accept(span<const float> samples)
+{
+    GDVOSK_TRACE_SCOPE("accept_waveform_f");
+    return to_status(vosk_recognizer_accept_waveform_f(_recognizer, samples.data(), static_cast<int>(samples.size())));
+}
+
+accept_status recognizer::accept(span<const std::int16_t> samples)
+{
+    GDVOSK_TRACE_SCOPE("accept_waveform_s");
+    return to_status(vosk_recognizer_accept_waveform_s(_recognizer, samples.data(), static_cast<int>(samples.size())));
+}
+
+accept_status recognizer::accept_stereo(span<const float> interleaved)
+{
+    {
+        GDVOSK_TRACE_SCOPE("downmix");
+
+        _scratch.resize(interleaved.size() / 2);
+        mix_stereo_to_mono(interleaved, span<float>(_scratch));
+    }
+
+    return accept(span<const float>(_scratch));
+}
+
+accept_status recognizer::accept_stereo(span<const std::int16_t> interleaved)
+{
+    {
+        GDVOSK_TRACE_SCOPE("downmix");
+
+        _scratch_pcm.resize(interleaved.size() / 2);
+        mix_stereo_to_mono(interleaved, span<std::int16_t>(_scratch_pcm));
+    }
+
+    return accept(span<const std::int16_t>(_scratch_pcm));
+}
+
+accept_status recognizer::accept_channel(span<const float> interleaved, std::size_t channel)
+{
+    {
+        GDVOSK_TRACE_SCOPE("extract_channel");
+
+        _scratch.resize(interleaved.size() / 2);
+        extract_channel(interleaved, channel, span<float>(_scratch));
+    }
+
+    return accept(span<const float>(_scratch));
+}
+
+accept_status recognizer::accept_channel(span<const std::int16_t> interleaved, std::size_t channel)
+{
+    {
+        GDVOSK_TRACE_SCOPE("extract_channel");
+
+        _scratch_pcm.resize(interleaved.size() / 2);
+        extract_channel(interleaved, channel, span<std::int16_t>(_scratch_pcm));
+    }
+
+    return accept(span<const std::int16_t>(_scratch_pcm));
+}
+
+const char* recognizer::result_json()
+{
+    GDVOSK_TRACE_SCOPE("result_json");
+    return vosk_recognizer_result(_recognizer);
+}
+
+const char* recognizer::partial_result_json()
+{
+    GDVOSK_TRACE_SCOPE("result_json");
+    return vosk_recognizer_partial_result(_recognizer);
+}
+
+const char* recognizer::final_result_json()
+{
+    GDVOSK_TRACE_SCOPE("result_json");
+    return vosk_recognizer_final_result(_recognizer);
+}
+
+void recognizer::reset()
+{
+    vosk_recognizer_reset(_recognizer);
+}
+
+void recognizer::apply(const recognizer_options& options)
+{
+    set_max_alternatives(options.max_alternatives);
+    set_words(options.words);
+    set_partial_words(options.partial_words);
+    set_nlsml(options.nlsml);
+}
+
+void recognizer::set_speaker_model(::VoskSpkModel* speaker_model)
+{
+    if (speaker_model == nullptr)
+    {
+        // vosk cannot detach a speaker model once attached
+        return;
+    }
+
+    vosk_recognizer_set_spk_model(_recognizer, speaker_model);
+}
+
+void recognizer::set_max_alternatives(int max_alternatives)
+{
+    vosk_recognizer_set_max_alternatives(_recognizer, max_alternatives);
+}
+
+void recognizer::set_words(bool words)
+{
+    vosk_recognizer_set_words(_recognizer, words ? 1 : 0);
+}
+
+void recognizer::set_partial_words(bool partial_words)
+{
+    vosk_recognizer_set_partial_words(_recognizer, partial_words ? 1 : 0);
+}
+
+void recognizer::set_nlsml(bool nlsml)
+{
+    vosk_recognizer_set_nlsml(_recognizer, nlsml ? 1 : 0);
+}
+
+accept_status recognizer::to_status(int result)
+{
+    if (result >= 1)
+    {
+        return accept_status::result_ready;
+    }
+
+    if (result == 0)
+    {
+        return accept_status::partial_ready;
+    }
+
+    return accept_status::failed;
+}
+
+std::size_t gdvosk::core::count_recognizers(const ::VoskModel* model)
+{
+    auto& counts = get_recognizer_counts();
+
+    std::lock_guard lock(counts.mutex);
+    auto existing = counts.counts.find(model);
+
+    return existing != counts.counts.end() ? existing->second : 0;
+}
+
+std::chrono::microseconds gdvosk::core::accept_all(decode_helpers& helpers, span<decode_task> tasks)
+{
+    return helpers.run
+    (
+        tasks.size(),
+        [&](std::size_t i)
+        {
+            auto& task = tasks[i];
+            task.status = task.target->accept(task.samples);
+        }
+    );
+}
+
+namespace
+{
+    template <typename T>
+    std::array<accept_status, 2> accept_channels_parallel
+    (
+        decode_helpers& helpers,
+        const std::array<recognizer*, 2>& recognizers,
+        span<const T> interleaved
+    )
+    {
+        std::array<accept_status, 2> statuses { accept_status::failed, accept_status::failed };
+        helpers.run
+        (
+            statuses.size(),
+            [&](std::size_t channel)
+            {
+                statuses[channel] = recognizers[channel]->accept_channel(interleaved, channel);
+            }
+        );
+
+        return statuses;
+    }
+}
+
+std::array<accept_status, 2> gdvosk::core::accept_channels
+(
+    decode_helpers& helpers,
+    const std::array<recognizer*, 2>& recognizers,
+    span<const float> interleaved
+)
+{
+    return accept_channels_parallel(helpers, recognizers, interleaved);
+}
+
+std::array<accept_status, 2> gdvosk::core::accept_channels
+(
+    decode_helpers& helpers,
+    const std::array<recognizer*, 2>& recognizers,
+    span<const std::int16_t> interleaved
+)
+{
+    return accept_channels_parallel(helpers, recognizers, interleaved);
+}
@@ -0,0 +1,286 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_CORE_RECOGNIZER_H
+#define GDVOSK_CORE_RECOGNIZER_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include <vosk_api.h>
+
+#include "decode_helpers.h"
+#include "span.h"
+
+namespace gdvosk::core
+{
+    /**
+     * Enumerates the outcomes of passing audio to a recognizer.
+     */
+    enum class accept_status
+    {
+        /**
+         * The audio was accepted and an utterance was completed; a result is available.
+         */
+        result_ready,
+
+        /**
+         * The audio was accepted and the recognizer is still decoding the current utterance; a partial result is
+         * available.
+         */
+        partial_ready,
+
+        /**
+         * The audio was not accepted.
+         */
+        failed
+    };
+
+    /**
+     * Represents the output settings of a recognizer.
+     */
+    struct recognizer_options
+    {
+        /**
+         * Holds the maximum number of alternative transcriptions to return.
+         */
+        int max_alternatives = 1;
+
+        /**
+         * Holds a value indicating whether words with start and end times are included in results.
+         */
+        bool words = false;
+
+        /**
+         * Holds a value indicating whether words with start and end times are included in partial results.
+         */
+        bool partial_words = false;
+
+        /**
+         * Holds a value indicating whether results are produced in NLSML format instead of JSON.
+         */
+        bool nlsml = false;
+
+        [[nodiscard]] bool operator==(const recognizer_options& other) const;
+        [[nodiscard]] bool operator!=(const recognizer_options& other) const;
+    };
+
+    /**
+     * Owns a native Vosk recognizer and feeds it audio without any engine-specific types. Not thread-safe; a recognizer
+     * must only be used by one thread at a time.
+     */
+    class recognizer final
+    {
+        /**
+         * Holds the underlying pointer to the recognizer.
+         */
+        ::VoskRecognizer* _recognizer = nullptr;
+
+        /**
+         * Holds the model the recognizer was created from.
+         */
+        ::VoskModel* _model = nullptr;
+
+        /**
+         * Holds a reusable buffer for downmixed floating-point audio.
+         */
+        std::vector<float> _scratch;
+
+        /**
+         * Holds a reusable buffer for downmixed 16-bit audio.
+         */
+        std::vector<std::int16_t> _scratch_pcm;
+
+        recognizer(::VoskRecognizer* recognizer, ::VoskModel* model);
+
+    public:
+        /**
+         * Creates a recognizer for the given model and sample rate, with an optional speaker model.
+         * @param model The language model.
+         * @param sample_rate The sample rate of audio to be processed.
+         * @param speaker_model The speaker model, or nullptr.
+         * @return The recognizer, or nullptr if Vosk could not create it.
+         */
+        static std::unique_ptr<recognizer> create
+        (
+            ::VoskModel* model,
+            float sample_rate,
+            ::VoskSpkModel* speaker_model = nullptr
+        );
+
+        /**
+         * Creates a recognizer for the given model and sample rate that only recognizes the phrases in a grammar.
+         * @param model The language model.
+         * @param sample_rate The sample rate of audio to be processed.
+         * @param grammar_json The grammar, as a JSON array of phrases.
+         * @return The recognizer, or nullptr if Vosk could not create it.
+         */
+        static std::unique_ptr<recognizer> create_with_grammar
+        (
+            ::VoskModel* model,
+            float sample_rate,
+            std::string_view grammar_json
+        );
+
+        ~recognizer();
+
+        // disable copy and move
+        recognizer(const recognizer&) = delete;
+        recognizer(recognizer&&) = delete;
+        recognizer& operator=(const recognizer&) = delete;
+        recognizer& operator=(recognizer&&) = delete;
+
+        /**
+         * Accepts mono floating-point samples in the range Vosk expects (-32768 to 32767).
+         * @param samples The samples.
+         * @return The outcome of the operation.
+         */
+        accept_status accept(span<const float> samples);
+
+        /**
+         * Accepts mono 16-bit samples.
+         * @param samples The samples.
+         * @return The outcome of the operation.
+         */
+        accept_status accept(span<const std::int16_t> samples);
+
+        /**
+         * Accepts interleaved, normalized (-1 to 1) stereo samples, mixing them to mono before decoding.
+         * @param interleaved The samples.
+         * @return The outcome of the operation.
+         */
+        accept_status accept_stereo(span<const float> interleaved);
+
+        /**
+         * Accepts interleaved 16-bit stereo samples, mixing them to mono before decoding.
+         * @param interleaved The samples.
+         * @return The outcome of the operation.
+         */
+        accept_status accept_stereo(span<const std::int16_t> interleaved);
+
+        /**
+         * Accepts one channel of interleaved, normalized (-1 to 1) stereo samples, ignoring the other.
+         * @param interleaved The samples.
+         * @param channel The channel to decode; 0 for left and 1 for right.
+         * @return The outcome of the operation.
+         */
+        accept_status accept_channel(span<const float> interleaved, std::size_t channel);
+
+        /**
+         * Accepts one channel of interleaved 16-bit stereo samples, ignoring the other.
+         * @param interleaved The samples.
+         * @param channel The channel to decode; 0 for left and 1 for right.
+         * @return The outcome of the operation.
+         */
+        accept_status accept_channel(span<const std::int16_t> interleaved, std::size_t channel);
+
+        /**
+         * Gets the JSON result of the last completed utterance. The returned string is owned by the recognizer and
+         * remains valid until the next call into it.
+         * @return The JSON result.
+         */
+        const char* result_json();
+
+        /**
+         * Gets the JSON partial result of the utterance in progress. The returned string is owned by the recognizer and
+         * remains valid until the next call into it.
+         * @return The JSON partial result.
+         */
+        const char* partial_result_json();
+
+        /**
+         * Flushes the remaining audio through the decoder and gets the JSON result. The returned string is owned by the
+         * recognizer and remains valid until the next call into it.
+         * @return The JSON result.
+         */
+        const char* final_result_json();
+
+        /**
+         * Resets the recognizer so transcription can continue from scratch.
+         */
+        void reset();
+
+        /**
+         * Applies a full set of output settings.
+         * @param options The settings.
+         */
+        void apply(const recognizer_options& options);
+
+        void set_speaker_model(::VoskSpkModel* speaker_model);
+        void set_max_alternatives(int max_alternatives);
+        void set_words(bool words);
+        void set_partial_words(bool partial_words);
+        void set_nlsml(bool nlsml);
+
+    private:
+        static accept_status to_status(int result);
+    };
+
+    /**
+     * Counts the recognizers alive for a model, whether they're decoding or idle in a pool. Thread-safe.
+     * @param model The model.
+     * @return The number of recognizers.
+     */
+    std::size_t count_recognizers(const ::VoskModel* model);
+
+    /**
+     * Represents a stretch of mono audio to be decoded by a recognizer, as part of a batch decoded in parallel.
+     */
+    struct decode_task
+    {
+        recognizer* target = nullptr;
+
+        /**
+         * Holds the samples, in the range Vosk expects (-32768 to 32767).
+         */
+        span<const float> samples;
+
+        /**
+         * Holds the outcome, once the task has run.
+         */
+        accept_status status = accept_status::failed;
+    };
+
+    /**
+     * Runs a batch of decoding tasks in parallel, on the calling thread and the given helpers. The targets must be
+     * distinct.
+     * @param helpers The helper threads.
+     * @param tasks The tasks.
+     * @return The time the helpers spent decoding, on top of the time the calling thread spent.
+     */
+    std::chrono::microseconds accept_all(decode_helpers& helpers, span<decode_task> tasks);
+
+    /**
+     * Decodes each channel of interleaved stereo samples on its own recognizer, in parallel.
+     * @param helpers The helper threads the right channel is decoded on, while the calling thread decodes the left.
+     * @param recognizers The recognizers; the first decodes the left channel and the second the right channel.
+     * @param interleaved The samples, normalized to the range -1 to 1.
+     * @return The outcome for each channel, in order.
+     */
+    std::array<accept_status, 2> accept_channels
+    (
+        decode_helpers& helpers,
+        const std::array<recognizer*, 2>& recognizers,
+        span<const float> interleaved
+    );
+
+    /**
+     * Decodes each channel of interleaved 16-bit stereo samples on its own recognizer, in parallel.
+     * @param helpers The helper threads the right channel is decoded on, while the calling thread decodes the left.
+     * @param recognizers The recognizers; the first decodes the left channel and the second the right channel.
+     * @param interleaved The samples.
+     * @return The outcome for each channel, in order.
+     */
+    std::array<accept_status, 2> accept_channels
+    (
+        decode_helpers& helpers,
+        const std::array<recognizer*, 2>& recognizers,
+        span<const std::int16_t> interleaved
+    );
+}
+
+#endif //GDVOSK_CORE_RECOGNIZER_H
@@ -0,0 +1,292 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "recognizer_pool.h"
+
+#include <algorithm>
+
+using namespace gdvosk::core;
+
+bool recognizer_key::operator==(const recognizer_key& other) const
+{
+    return model == other.model
+        && speaker_model == other.speaker_model
+        && sample_rate == other.sample_rate
+        && grammar_hash() == other.grammar_hash();
+}
+
+std::uint64_t recognizer_key::grammar_hash() const
+{
+    return grammar != nullptr ? grammar->hash : 0;
+}
+
+bool recognizer_key::operator!=(const recognizer_key& other) const
+{
+    return !(*this == other);
+}
+
+recognizer_pool& recognizer_pool::shared()
+{
+    static recognizer_pool pool;
+    return pool;
+}
+
+std::unique_ptr<recognizer> recognizer_pool::acquire(const recognizer_key& key)
+{
+    {
+        std::lock_guard lock(_mutex);
+
+        auto instance = take_idle(key);
+        if (instance != nullptr)
+        {
+            return instance;
+        }
+    }
+
+    // constructing a recognizer can take a long time, so it is done without holding the lock
+    return construct(key);
+}
+
+std::future<std::unique_ptr<recognizer>> recognizer_pool::acquire_async(const recognizer_key& key)
+{
+    {
+        std::lock_guard lock(_mutex);
+
+        auto instance = take_idle(key);
+        if (instance != nullptr)
+        {
+            std::promise<std::unique_ptr<recognizer>> ready;
+            ready.set_value(std::move(instance));
+
+            return ready.get_future();
+        }
+    }
+
+    return std::async(std::launch::async, [key] { return construct(key); });
+}
+
+void recognizer_pool::release(const recognizer_key& key, std::unique_ptr<recognizer> instance)
+{
+    if (instance == nullptr)
+    {
+        return;
+    }
+
+    instance->reset();
+    instance->apply(recognizer_options());
+
+    std::vector<std::unique_ptr<recognizer>> removed;
+    {
+        std::lock_guard lock(_mutex);
+        if (count_idle(key) >= _warm_spares)
+        {
+            removed.push_back(std::move(instance));
+        }
+        else
+        {
+            _idle.push_back({ key, std::move(instance) });
+            removed = trim();
+        }
+    }
+}
+
+std::size_t recognizer_pool::prewarm(const recognizer_key& key)
+{
+    std::size_t available;
+    std::size_t target;
+    {
+        std::lock_guard lock(_mutex);
+        available = count_idle(key);
+        target = _warm_spares;
+    }
+
+    while (available < target)
+    {
+        auto instance = construct(key);
+        if (instance == nullptr)
+        {
+            break;
+        }
+
+        instance->apply(recognizer_options());
+
+        std::lock_guard lock(_mutex);
+        _idle.push_back({ key, std::move(instance) });
+        available = count_idle(key);
+    }
+
+    return available;
+}
+
+void recognizer_pool::evict(const ::VoskModel* model)
+{
+    std::vector<idle_entry> removed;
+    {
+        std::lock_guard lock(_mutex);
+
+        auto first = std::stable_partition
+        (
+            _idle.begin(),
+            _idle.end(),
+            [&](const auto& entry) { return entry.key.model != model; }
+        );
+
+        std::move(first, _idle.end(), std::back_inserter(removed));
+        _idle.erase(first, _idle.end());
+    }
+}
+
+void recognizer_pool::evict(const ::VoskSpkModel* speaker_model)
+{
+    std::vector<idle_entry> removed;
+    {
+        std::lock_guard lock(_mutex);
+
+        auto first = std::stable_partition
+        (
+            _idle.begin(),
+            _idle.end(),
+            [&](const auto& entry) { return entry.key.speaker_model != speaker_model; }
+        );
+
+        std::move(first, _idle.end(), std::back_inserter(removed));
+        _idle.erase(first, _idle.end());
+    }
+}
+
+std::size_t recognizer_pool::count_spares(const ::VoskModel* model) const
+{
+    std::lock_guard lock(_mutex);
+    return static_cast<std::size_t>
+    (
+        std::count_if(_idle.begin(), _idle.end(), [&](const auto& entry) { return entry.key.model == model; })
+    );
+}
+
+void recognizer_pool::clear()
+{
+    std::vector<idle_entry> removed;
+    {
+        std::lock_guard lock(_mutex);
+        removed.swap(_idle);
+    }
+}
+
+void recognizer_pool::set_warm_spares(std::size_t warm_spares)
+{
+    std::vector<std::unique_ptr<recognizer>> removed;
+    {
+        std::lock_guard lock(_mutex);
+        _warm_spares = warm_spares;
+        removed = trim();
+    }
+}
+
+std::size_t recognizer_pool::get_warm_spares() const
+{
+    std::lock_guard lock(_mutex);
+    return _warm_spares;
+}
+
+void recognizer_pool::set_max_idle(std::size_t max_idle)
+{
+    std::vector<std::unique_ptr<recognizer>> removed;
+    {
+        std::lock_guard lock(_mutex);
+        _max_idle = max_idle;
+        removed = trim();
+    }
+}
+
+std::size_t recognizer_pool::get_max_idle() const
+{
+    std::lock_guard lock(_mutex);
+    return _max_idle;
+}
+
+recognizer_pool_statistics recognizer_pool::get_statistics() const
+{
+    std::lock_guard lock(_mutex);
+    return { _hits, _misses, _idle.size() };
+}
+
+std::unique_ptr<recognizer> recognizer_pool::take_idle(const recognizer_key& key)
+{
+    auto idle = std::find_if(_idle.begin(), _idle.end(), [&](const auto& entry) { return entry.key == key; });
+    if (idle == _idle.end())
+    {
+        ++_misses;
+        return nullptr;
+    }
+
+    auto instance = std::move(idle->instance);
+    _idle.erase(idle);
+
+    ++_hits;
+    return instance;
+}
+
+std::unique_ptr<recognizer> recognizer_pool::construct(const recognizer_key& key)
+{
+    if (key.grammar != nullptr)
+    {
+        auto instance = recognizer::create_with_grammar(key.model, key.sample_rate, key.grammar->json);
+        if (instance != nullptr && key.speaker_model != nullptr)
+        {
+            instance->set_speaker_model(key.speaker_model);
+        }
+
+        return instance;
+    }
+
+    return recognizer::create(key.model, key.sample_rate, key.speaker_model);
+}
+
+std::size_t recognizer_pool::count_idle(const recognizer_key& key) const
+{
+    return static_cast<std::size_t>
+    (
+        std::count_if(_idle.begin(), _idle.end(), [&](const auto& entry) { return entry.key == key; })
+    );
+}
+
+std::vector<std::unique_ptr<recognizer>> recognizer_pool::trim()
+{
+    std::vector<std::unique_ptr<recognizer>> removed;
+
+    // drop spares beyond the per-key limit, keeping the most recently released ones
+    for (auto entry = _idle.begin(); entry != _idle.end(); ++entry)
+    {
+        auto same_key_or_newer = std::count_if
+        (
+            entry,
+            _idle.end(),
+            [&](const auto& other) { return other.instance != nullptr && other.key == entry->key; }
+        );
+
+        if (static_cast<std::size_t>(same_key_or_newer) > _warm_spares)
+        {
+            removed.push_back(std::move(entry->instance));
+        }
+    }
+
+    _idle.erase
+    (
+        std::remove_if(_idle.begin(), _idle.end(), [](const auto& entry) { return entry.instance == nullptr; }),
+        _idle.end()
+    );
+
+    // then drop the oldest spares beyond the global limit
+    if (_idle.size() > _max_idle)
+    {
+        const auto excess = _idle.size() - _max_idle;
+        for (std::size_t i = 0; i < excess; ++i)
+        {
+            removed.push_back(std::move(_idle[i].instance));
+        }
+
+        _idle.erase(_idle.begin(), _idle.begin() + static_cast<std::ptrdiff_t>(excess));
+    }
+
+    return removed;
+}
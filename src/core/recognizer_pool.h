@@ -0,0 +1,202 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_CORE_RECOGNIZER_POOL_H
+#define GDVOSK_CORE_RECOGNIZER_POOL_H
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <vosk_api.h>
+
+#include "grammar.h"
+#include "recognizer.h"
+
+namespace gdvosk::core
+{
+    /**
+     * Identifies the configuration a native recognizer was constructed with. Recognizers with equal keys are
+     * interchangeable once reset.
+     */
+    struct recognizer_key
+    {
+        ::VoskModel* model = nullptr;
+        ::VoskSpkModel* speaker_model = nullptr;
+        float sample_rate = 0;
+
+        /**
+         * Holds the grammar the recognizer is restricted to, or nullptr for none. Grammars are compared by hash.
+         */
+        std::shared_ptr<const compiled_grammar> grammar;
+
+        /**
+         * Gets the hash of the grammar the recognizer is restricted to.
+         * @return The hash, or zero for none.
+         */
+        [[nodiscard]] std::uint64_t grammar_hash() const;
+
+        [[nodiscard]] bool operator==(const recognizer_key& other) const;
+        [[nodiscard]] bool operator!=(const recognizer_key& other) const;
+    };
+
+    /**
+     * Represents counters describing how well a pool is serving requests.
+     */
+    struct recognizer_pool_statistics
+    {
+        /**
+         * Holds the number of requests served from an idle recognizer.
+         */
+        std::uint64_t hits = 0;
+
+        /**
+         * Holds the number of requests that had to construct a new recognizer.
+         */
+        std::uint64_t misses = 0;
+
+        /**
+         * Holds the number of idle recognizers currently held.
+         */
+        std::size_t idle = 0;
+    };
+
+    /**
+     * Keeps reset, ready-to-use native recognizers around so that short-lived sessions do not pay for constructing a
+     * recognizer (and compiling its grammar) every time. Thread-safe.
+     */
+    class recognizer_pool final
+    {
+        /**
+         * Represents an idle recognizer held by the pool.
+         */
+        struct idle_entry
+        {
+            recognizer_key key;
+            std::unique_ptr<recognizer> instance;
+        };
+
+        mutable std::mutex _mutex;
+
+        /**
+         * Holds the idle recognizers, oldest first.
+         */
+        std::vector<idle_entry> _idle;
+
+        /**
+         * Holds the number of idle recognizers kept per key.
+         */
+        std::size_t _warm_spares = 1;
+
+        /**
+         * Holds the maximum number of idle recognizers kept in total.
+         */
+        std::size_t _max_idle = 16;
+
+        std::uint64_t _hits = 0;
+        std::uint64_t _misses = 0;
+
+    public:
+        /**
+         * Gets the process-wide pool.
+         * @return The pool.
+         */
+        static recognizer_pool& shared();
+
+        /**
+         * Gets a ready recognizer for the given key, reusing an idle one if possible.
+         * @param key The configuration of the recognizer.
+         * @return The recognizer, or nullptr if one could not be constructed.
+         */
+        std::unique_ptr<recognizer> acquire(const recognizer_key& key);
+
+        /**
+         * Gets a ready recognizer for the given key without blocking the calling thread. If no idle recognizer is
+         * available, one is constructed on a background thread.
+         * @param key The configuration of the recognizer.
+         * @return A future that yields the recognizer, or nullptr if one could not be constructed.
+         */
+        std::future<std::unique_ptr<recognizer>> acquire_async(const recognizer_key& key);
+
+        /**
+         * Returns a recognizer to the pool. The recognizer is reset and kept if there is room for another spare with
+         * its key; otherwise, it is destroyed.
+         * @param key The configuration the recognizer was acquired with.
+         * @param instance The recognizer.
+         */
+        void release(const recognizer_key& key, std::unique_ptr<recognizer> instance);
+
+        /**
+         * Constructs idle recognizers for the given key ahead of time, until the configured number of warm spares is
+         * available.
+         * @param key The configuration of the recognizers.
+         * @return The number of idle recognizers available for the key afterwards.
+         */
+        std::size_t prewarm(const recognizer_key& key);
+
+        /**
+         * Destroys every idle recognizer built on the given model. Must be called before the model is freed, since a
+         * later model may be allocated at the same address.
+         * @param model The model.
+         */
+        void evict(const ::VoskModel* model);
+
+        /**
+         * Destroys every idle recognizer built with the given speaker model.
+         * @param speaker_model The speaker model.
+         */
+        void evict(const ::VoskSpkModel* speaker_model);
+
+        /**
+         * Counts the idle recognizers built on the given model.
+         * @param model The model.
+         * @return The number of recognizers.
+         */
+        [[nodiscard]] std::size_t count_spares(const ::VoskModel* model) const;
+
+        /**
+         * Destroys every idle recognizer.
+         */
+        void clear();
+
+        /**
+         * Sets the number of idle recognizers kept per key.
+         * @param warm_spares The number of spares.
+         */
+        void set_warm_spares(std::size_t warm_spares);
+        [[nodiscard]] std::size_t get_warm_spares() const;
+
+        /**
+         * Sets the maximum number of idle recognizers kept in total. The oldest spares are destroyed first.
+         * @param max_idle The maximum.
+         */
+        void set_max_idle(std::size_t max_idle);
+        [[nodiscard]] std::size_t get_max_idle() const;
+
+        [[nodiscard]] recognizer_pool_statistics get_statistics() const;
+
+    private:
+        /**
+         * Takes an idle recognizer for the given key, updating the hit and miss counters. Must be called with the mutex
+         * held.
+         * @param key The configuration of the recognizer.
+         * @return The recognizer, or nullptr if none is idle.
+         */
+        std::unique_ptr<recognizer> take_idle(const recognizer_key& key);
+
+        static std::unique_ptr<recognizer> construct(const recognizer_key& key);
+
+        [[nodiscard]] std::size_t count_idle(const recognizer_key& key) const;
+
+        /**
+         * Removes idle recognizers beyond the configured limits. Must be called with the mutex held.
+         * @return The removed recognizers, to be destroyed once the mutex is released.
+         */
+        std::vector<std::unique_ptr<recognizer>> trim();
+    };
+}
+
+#endif //GDVOSK_CORE_RECOGNIZER_POOL_H
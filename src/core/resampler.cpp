@@ -0,0 +1,137 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "trace.h"
+
+using namespace gdvosk::core;
+
+namespace
+{
+    constexpr double pi = 3.14159265358979323846;
+}
+
+resampler::resampler(int input_rate, int output_rate)
+{
+    auto divisor = std::gcd(input_rate, output_rate);
+    if (divisor == 0)
+    {
+        return;
+    }
+
+    _input_step = input_rate / divisor;
+    _output_step = output_rate / divisor;
+
+    if (is_passthrough())
+    {
+        return;
+    }
+
+    // in cycles per input sample
+    auto cutoff = cutoff_ratio * 0.5 * std::min(input_rate, output_rate) / input_rate;
+    auto window_width = zero_crossings / (2.0 * cutoff);
+
+    _half_width = static_cast<std::int64_t>(std::ceil(window_width)) + 1;
+
+    auto width = 2 * _half_width;
+    _taps.resize(static_cast<std::size_t>(_output_step * width));
+
+    for (std::int64_t phase = 0; phase < _output_step; ++phase)
+    {
+        auto* row = _taps.data() + phase * width;
+        auto offset = static_cast<double>(phase) / static_cast<double>(_output_step);
+
+        auto sum = 0.0;
+        for (std::int64_t i = 0; i < width; ++i)
+        {
+            // distance from the output sample's position to the input sample this tap applies to
+            auto t = static_cast<double>(i - _half_width + 1) - offset;
+            if (std::abs(t) >= window_width)
+            {
+                row[i] = 0;
+                continue;
+            }
+
+            auto x = 2.0 * cutoff * t;
+            auto sinc = x == 0.0 ? 1.0 : std::sin(pi * x) / (pi * x);
+            auto window = 0.5 * (1.0 + std::cos(pi * t / window_width));
+
+            auto tap = 2.0 * cutoff * sinc * window;
+            row[i] = static_cast<float>(tap);
+            sum += tap;
+        }
+
+        // normalize each phase separately, so that a constant signal comes out unchanged regardless of position
+        for (std::int64_t i = 0; i < width; ++i)
+        {
+            row[i] = static_cast<float>(row[i] / sum);
+        }
+    }
+
+    reset();
+}
+
+bool resampler::is_passthrough() const
+{
+    return _input_step == _output_step;
+}
+
+void resampler::process(span<const float> input, std::vector<float>& output)
+{
+    if (is_passthrough())
+    {
+        output.insert(output.end(), input.begin(), input.end());
+        return;
+    }
+
+    GDVOSK_TRACE_SCOPE("resample");
+
+    _history.insert(_history.end(), input.begin(), input.end());
+
+    auto width = 2 * _half_width;
+    auto history_end = _history_start + static_cast<std::int64_t>(_history.size());
+
+    // the last input sample an output sample depends on is _half_width samples after its base
+    while (_next_base + _half_width < history_end)
+    {
+        const auto* row = _taps.data() + _next_phase * width;
+        const auto* samples = _history.data() + (_next_base - _half_width + 1 - _history_start);
+
+        auto sample = 0.0f;
+        for (std::int64_t i = 0; i < width; ++i)
+        {
+            sample += row[i] * samples[i];
+        }
+
+        output.push_back(sample);
+
+        _next_phase += _input_step;
+        _next_base += _next_phase / _output_step;
+        _next_phase %= _output_step;
+    }
+
+    auto consumed = std::clamp<std::int64_t>
+    (
+        _next_base - _half_width + 1 - _history_start,
+        0,
+        static_cast<std::int64_t>(_history.size())
+    );
+
+    _history.erase(_history.begin(), _history.begin() + consumed);
+    _history_start += consumed;
+}
+
+void resampler::reset()
+{
+    _next_base = 0;
+    _next_phase = 0;
+
+    // the stream is preceded by silence, so the first output sample can be centred on the first input sample
+    _history.assign(static_cast<std::size_t>(std::max<std::int64_t>(_half_width - 1, 0)), 0.0f);
+    _history_start = -static_cast<std::int64_t>(_history.size());
+}
@@ -0,0 +1,101 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_CORE_RESAMPLER_H
+#define GDVOSK_CORE_RESAMPLER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "span.h"
+
+namespace gdvosk::core
+{
+    /**
+     * Converts a continuous stream of mono samples from one sample rate to another with a Hann-windowed sinc filter.
+     * The input may be passed in chunks of any size; the filter state carries over between them, so the output is the
+     * same as if the whole stream had been converted at once.
+     */
+    class resampler final
+    {
+        /**
+         * Holds the number of zero crossings of the sinc function on each side of the filter's centre.
+         */
+        static constexpr int zero_crossings = 8;
+
+        /**
+         * Holds the cutoff frequency of the low-pass filter, as a fraction of the lower of the two Nyquist frequencies.
+         */
+        static constexpr double cutoff_ratio = 0.95;
+
+        /**
+         * Holds the input rate divided by the greatest common divisor of the two rates.
+         */
+        std::int64_t _input_step = 1;
+
+        /**
+         * Holds the output rate divided by the greatest common divisor of the two rates. This is also the number of
+         * distinct positions an output sample can have between two input samples, and so the number of filter phases.
+         */
+        std::int64_t _output_step = 1;
+
+        /**
+         * Holds the number of filter taps on each side of an output sample's position.
+         */
+        std::int64_t _half_width = 0;
+
+        /**
+         * Holds the filter taps for every phase, one row of 2 * _half_width taps after another.
+         */
+        std::vector<float> _taps;
+
+        /**
+         * Holds the input samples that later output samples still depend on.
+         */
+        std::vector<float> _history;
+
+        /**
+         * Holds the index in the input stream of the input sample just before the next output sample's position.
+         */
+        std::int64_t _next_base = 0;
+
+        /**
+         * Holds the fractional part of the next output sample's position, in units of 1 / _output_step input samples.
+         */
+        std::int64_t _next_phase = 0;
+
+        /**
+         * Holds the index in the input stream of the first sample in the history.
+         */
+        std::int64_t _history_start = 0;
+
+    public:
+        /**
+         * Initializes a new instance of the resampler class.
+         * @param input_rate The sample rate of the input.
+         * @param output_rate The sample rate of the output.
+         */
+        resampler(int input_rate, int output_rate);
+
+        /**
+         * Gets a value indicating whether the input and output rates are equal, in which case the resampler passes
+         * samples through unchanged.
+         * @return true if no conversion takes place; otherwise, false.
+         */
+        [[nodiscard]] bool is_passthrough() const;
+
+        /**
+         * Converts the next chunk of the stream. The output lags the input by the filter's half width.
+         * @param input The input samples.
+         * @param output The buffer to append the converted samples to.
+         */
+        void process(span<const float> input, std::vector<float>& output);
+
+        /**
+         * Forgets the stream so far, so that a new one can be converted.
+         */
+        void reset();
+    };
+}
+
+#endif //GDVOSK_CORE_RESAMPLER_H
@@ -0,0 +1,112 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "result.h"
+#include "trace.h"
+
+using namespace gdvosk::core;
+
+namespace
+{
+    std::vector<recognized_word> parse_words(const json_value* words)
+    {
+        std::vector<recognized_word> parsed;
+        if (words == nullptr || words->type != json_value::kind::array)
+        {
+            return parsed;
+        }
+
+        parsed.reserve(words->array.size());
+        for (const auto& word : words->array)
+        {
+            parsed.push_back
+            ({
+                std::string(word.get_string("word")),
+                word.get_number("start"),
+                word.get_number("end"),
+                word.get_number("conf", 1)
+            });
+        }
+
+        return parsed;
+    }
+}
+
+double recognition_result::confidence() const
+{
+    if (!alternatives.empty())
+    {
+        return alternatives.front().confidence;
+    }
+
+    if (words.empty())
+    {
+        return 0;
+    }
+
+    auto sum = 0.0;
+    for (const auto& word : words)
+    {
+        sum += word.confidence;
+    }
+
+    return sum / static_cast<double>(words.size());
+}
+
+std::optional<recognition_result> gdvosk::core::parse_result(std::string_view json)
+{
+    GDVOSK_TRACE_SCOPE("parse_json");
+
+    auto document = parse_json(json);
+    if (!document.has_value() || document->type != json_value::kind::object)
+    {
+        return std::nullopt;
+    }
+
+    recognition_result result;
+
+    if (const auto* partial = document->find("partial"); partial != nullptr)
+    {
+        result.is_partial = true;
+        result.text = partial->string;
+        result.words = parse_words(document->find("partial_result"));
+    }
+    else
+    {
+        result.text = document->get_string("text");
+        result.words = parse_words(document->find("result"));
+    }
+
+    if (const auto* alternatives = document->find("alternatives");
+        alternatives != nullptr && alternatives->type == json_value::kind::array)
+    {
+        for (const auto& alternative : alternatives->array)
+        {
+            result.alternatives.push_back
+            ({
+                std::string(alternative.get_string("text")),
+                alternative.get_number("confidence"),
+                parse_words(alternative.find("result"))
+            });
+        }
+
+        if (result.text.empty() && !result.alternatives.empty())
+        {
+            result.text = result.alternatives.front().text;
+        }
+    }
+
+    if (const auto* speaker = document->find("spk"); speaker != nullptr && speaker->type == json_value::kind::array)
+    {
+        result.speaker_vector.reserve(speaker->array.size());
+        for (const auto& element : speaker->array)
+        {
+            result.speaker_vector.push_back(static_cast<float>(element.number));
+        }
+
+        result.speaker_frames = static_cast<int>(document->get_number("spk_frames"));
+    }
+
+    result.document = std::move(*document);
+    return result;
+}
@@ -0,0 +1,106 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_CORE_RESULT_H
+#define GDVOSK_CORE_RESULT_H
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "json.h"
+
+namespace gdvosk::core
+{
+    /**
+     * Represents a single recognized word with its timing.
+     */
+    struct recognized_word
+    {
+        std::string word;
+
+        /**
+         * Holds the start of the word, in seconds since the recognizer was last reset.
+         */
+        double start = 0;
+
+        /**
+         * Holds the end of the word, in seconds since the recognizer was last reset.
+         */
+        double end = 0;
+
+        /**
+         * Holds the recognizer's confidence in the word, between 0 and 1.
+         */
+        double confidence = 1;
+    };
+
+    /**
+     * Represents one of several alternative transcriptions of an utterance.
+     */
+    struct recognition_alternative
+    {
+        std::string text;
+        double confidence = 0;
+        std::vector<recognized_word> words;
+    };
+
+    /**
+     * Represents a result produced by a Vosk recognizer, either partial or final.
+     */
+    struct recognition_result
+    {
+        /**
+         * Holds the best transcription of the utterance; that is, the partial text, the plain text, or the text of the
+         * first alternative, whichever is present.
+         */
+        std::string text;
+
+        /**
+         * Holds a value indicating whether this is a partial result of an utterance still in progress.
+         */
+        bool is_partial = false;
+
+        /**
+         * Holds the recognized words, if word output is enabled.
+         */
+        std::vector<recognized_word> words;
+
+        /**
+         * Holds the alternative transcriptions, if alternatives are enabled.
+         */
+        std::vector<recognition_alternative> alternatives;
+
+        /**
+         * Holds the speaker x-vector, if a speaker model is attached.
+         */
+        std::vector<float> speaker_vector;
+
+        /**
+         * Holds the number of frames the speaker vector was computed from.
+         */
+        int speaker_frames = 0;
+
+        /**
+         * Holds the full parsed document, for consumers that need fields not mapped above.
+         */
+        json_value document;
+
+        /**
+         * Gets the confidence of the best transcription. Results without alternatives report the mean confidence of
+         * their words, or 0 if there are none.
+         * @return The confidence.
+         */
+        [[nodiscard]] double confidence() const;
+    };
+
+    /**
+     * Parses a JSON result produced by a Vosk recognizer.
+     * @param json The JSON document.
+     * @return The result, or nothing if the document could not be parsed.
+     */
+    std::optional<recognition_result> parse_result(std::string_view json);
+}
+
+#endif //GDVOSK_CORE_RESULT_H
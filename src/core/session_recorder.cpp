@@ -0,0 +1,314 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "session_recorder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "trace.h"
+
+using namespace gdvosk::core;
+using namespace std::chrono;
+
+namespace
+{
+    /**
+     * Collapses a JSON document onto a single line. Vosk pretty-prints its output, but line breaks inside strings are
+     * always escaped, so every raw line break is insignificant whitespace.
+     */
+    std::string to_single_line(std::string_view json)
+    {
+        std::string line(json);
+        std::replace_if(line.begin(), line.end(), [](char c) { return c == '\n' || c == '\r'; }, ' ');
+
+        return line;
+    }
+
+    bool write(std::FILE* file, const void* data, std::size_t size)
+    {
+        return size == 0 || std::fwrite(data, 1, size, file) == size;
+    }
+}
+
+session_recorder::session_recorder
+(
+    std::string directory,
+    std::string prefix,
+    int sample_rate,
+    recorder_limits limits
+) :
+    _directory(std::move(directory)),
+    _prefix(std::move(prefix)),
+    _sample_rate(sample_rate),
+    _limits(limits),
+    _started_at(steady_clock::now())
+{
+}
+
+session_recorder::~session_recorder()
+{
+    close();
+}
+
+std::shared_ptr<session_recorder> session_recorder::open
+(
+    const std::string& directory,
+    const std::string& prefix,
+    int sample_rate,
+    const recorder_limits& limits
+)
+{
+    auto recorder = std::make_shared<session_recorder>(directory, prefix, sample_rate, limits);
+    if (!recorder->start_segment())
+    {
+        return nullptr;
+    }
+
+    recorder->_writer = std::thread(&session_recorder::write_records, recorder.get());
+    return recorder;
+}
+
+void session_recorder::record_audio(span<const float> samples)
+{
+    if (samples.empty())
+    {
+        return;
+    }
+
+    GDVOSK_TRACE_SCOPE("session_recorder");
+
+    record entry;
+    entry.samples.resize(samples.size());
+    for (std::size_t i = 0; i < samples.size(); ++i)
+    {
+        auto sample = std::clamp(std::round(samples[i]), -32768.0f, 32767.0f);
+        entry.samples[i] = static_cast<std::int16_t>(sample);
+    }
+
+    std::lock_guard lock(_mutex);
+    if (_is_closing)
+    {
+        return;
+    }
+
+    entry.line = "{\"type\":\"audio\",\"t\":" + std::to_string(elapsed())
+        + ",\"sample\":" + std::to_string(_recorded_samples)
+        + ",\"frames\":" + std::to_string(samples.size());
+
+    if (_pending_gap > 0)
+    {
+        // the audio dropped since the last record is missing from the file, so readers can tell the two apart
+        entry.line += ",\"gap\":" + std::to_string(_pending_gap);
+    }
+
+    entry.line += "}";
+
+    if (!enqueue(std::move(entry)))
+    {
+        _pending_gap += samples.size();
+        return;
+    }
+
+    _recorded_samples += samples.size();
+    _pending_gap = 0;
+}
+
+void session_recorder::record_event(std::string_view type, std::string_view json, int model_index, int channel_index)
+{
+    GDVOSK_TRACE_SCOPE("session_recorder");
+
+    auto data = to_single_line(json);
+
+    std::lock_guard lock(_mutex);
+    if (_is_closing)
+    {
+        return;
+    }
+
+    record entry;
+    entry.line = "{\"type\":\"" + std::string(type) + "\",\"t\":" + std::to_string(elapsed())
+        + ",\"sample\":" + std::to_string(_recorded_samples)
+        + ",\"model\":" + std::to_string(model_index)
+        + ",\"channel\":" + std::to_string(channel_index)
+        + ",\"data\":" + data + "}";
+
+    enqueue(std::move(entry));
+}
+
+std::uint64_t session_recorder::get_dropped_records() const
+{
+    std::lock_guard lock(_mutex);
+    return _dropped_records;
+}
+
+void session_recorder::close()
+{
+    {
+        std::lock_guard lock(_mutex);
+        _is_closing = true;
+    }
+
+    _wake.notify_one();
+
+    if (_writer.joinable())
+    {
+        _writer.join();
+    }
+
+    close_segment();
+}
+
+bool session_recorder::enqueue(record&& entry)
+{
+    auto size = entry.line.size() + entry.samples.size() * sizeof(std::int16_t);
+    if (_queued_bytes + size > _limits.max_queued_bytes)
+    {
+        ++_dropped_records;
+        return false;
+    }
+
+    _queued_bytes += size;
+    _queue.push_back(std::move(entry));
+
+    _wake.notify_one();
+    return true;
+}
+
+std::int64_t session_recorder::elapsed() const
+{
+    return duration_cast<microseconds>(steady_clock::now() - _started_at).count();
+}
+
+void session_recorder::write_records()
+{
+    std::unique_lock lock(_mutex);
+
+    while (true)
+    {
+        _wake.wait(lock, [&] { return !_queue.empty() || _is_closing; });
+        if (_queue.empty())
+        {
+            break;
+        }
+
+        std::deque<record> batch;
+        batch.swap(_queue);
+        _queued_bytes = 0;
+
+        lock.unlock();
+
+        std::uint64_t failed_records = 0;
+        for (const auto& entry : batch)
+        {
+            if (!_has_failed && _segments.back().size >= _limits.max_segment_size)
+            {
+                start_segment();
+            }
+
+            if (_has_failed)
+            {
+                ++failed_records;
+                continue;
+            }
+
+            // every platform Godot runs on is little-endian, so the samples are written as they are
+            auto line = entry.line + "\n";
+            auto samples_size = entry.samples.size() * sizeof(std::int16_t);
+            if (!write(_pcm_file, entry.samples.data(), samples_size) || !write(_jsonl_file, line.data(), line.size()))
+            {
+                _has_failed = true;
+                ++failed_records;
+                continue;
+            }
+
+            _written_samples += entry.samples.size();
+            _segments.back().size += samples_size + line.size();
+        }
+
+        if (!_has_failed)
+        {
+            // whatever made it this far survives a crash of the process
+            std::fflush(_pcm_file);
+            std::fflush(_jsonl_file);
+        }
+
+        lock.lock();
+        _dropped_records += failed_records;
+    }
+}
+
+bool session_recorder::start_segment()
+{
+    close_segment();
+
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), "-%04llu", static_cast<unsigned long long>(_segment_index));
+
+    auto base_path = _directory + "/" + _prefix + suffix;
+
+    segment created { base_path + ".pcm", base_path + ".jsonl", 0 };
+    _pcm_file = std::fopen(created.pcm_path.c_str(), "wb");
+    _jsonl_file = std::fopen(created.jsonl_path.c_str(), "wb");
+
+    if (_pcm_file == nullptr || _jsonl_file == nullptr)
+    {
+        close_segment();
+        std::remove(created.pcm_path.c_str());
+        std::remove(created.jsonl_path.c_str());
+
+        _has_failed = true;
+        return false;
+    }
+
+    auto header = "{\"type\":\"header\",\"t\":" + std::to_string(elapsed())
+        + ",\"sample\":" + std::to_string(_written_samples)
+        + ",\"segment\":" + std::to_string(_segment_index)
+        + ",\"sample_rate\":" + std::to_string(_sample_rate)
+        + ",\"channels\":1,\"format\":\"s16le\"}\n";
+
+    if (!write(_jsonl_file, header.data(), header.size()))
+    {
+        _has_failed = true;
+        return false;
+    }
+
+    created.size = header.size();
+    _segments.push_back(std::move(created));
+    ++_segment_index;
+
+    std::uint64_t total_size = 0;
+    for (const auto& existing : _segments)
+    {
+        total_size += existing.size;
+    }
+
+    // the current segment is never deleted, even if it alone is over the limit
+    while (_segments.size() > 1 && total_size > _limits.max_disk_usage)
+    {
+        const auto& oldest = _segments.front();
+        std::remove(oldest.pcm_path.c_str());
+        std::remove(oldest.jsonl_path.c_str());
+
+        total_size -= oldest.size;
+        _segments.pop_front();
+    }
+
+    return true;
+}
+
+void session_recorder::close_segment()
+{
+    if (_pcm_file != nullptr)
+    {
+        std::fclose(_pcm_file);
+        _pcm_file = nullptr;
+    }
+
+    if (_jsonl_file != nullptr)
+    {
+        std::fclose(_jsonl_file);
+        _jsonl_file = nullptr;
+    }
+}
@@ -0,0 +1,217 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_CORE_SESSION_RECORDER_H
+#define GDVOSK_CORE_SESSION_RECORDER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "span.h"
+
+namespace gdvosk::core
+{
+    /**
+     * Represents the limits a session recorder works within.
+     */
+    struct recorder_limits
+    {
+        /**
+         * Holds the size, in bytes, after which a new segment is started.
+         */
+        std::uint64_t max_segment_size = 64ull * 1024 * 1024;
+
+        /**
+         * Holds the size, in bytes, the segments of a session may take up together. The oldest segments are deleted
+         * to stay below it.
+         */
+        std::uint64_t max_disk_usage = 1024ull * 1024 * 1024;
+
+        /**
+         * Holds the number of bytes that may wait for the writer before further records are dropped.
+         */
+        std::size_t max_queued_bytes = 8 * 1024 * 1024;
+    };
+
+    /**
+     * Records the audio a recognizer decoded and the results it produced, so that a session can be reproduced and its
+     * latencies examined later. Records are queued and written by a background thread; recording never waits for
+     * the disk, and drops records instead if the writer falls too far behind.
+     *
+     * A session is written as numbered segments, each a pair of files: <prefix>-NNNN.pcm holds the audio as mono
+     * signed 16-bit little-endian samples, and <prefix>-NNNN.jsonl holds one JSON object per line. The first line of a
+     * segment describes its audio; every later line is an "audio" record marking when a chunk of audio was decoded, or
+     * a "partial", "result" or "final" record holding Vosk's output. Every record carries "t", the microseconds since
+     * the session started, and "sample", the number of samples recorded before it over the whole session.
+     *
+     * Thread-safe.
+     */
+    class session_recorder final
+    {
+        /**
+         * Represents a record waiting for the writer.
+         */
+        struct record
+        {
+            /**
+             * Holds the JSON line describing the record, without the trailing newline.
+             */
+            std::string line;
+
+            /**
+             * Holds the audio of an audio record.
+             */
+            std::vector<std::int16_t> samples;
+        };
+
+        /**
+         * Represents a segment on disk.
+         */
+        struct segment
+        {
+            std::string pcm_path;
+            std::string jsonl_path;
+            std::uint64_t size = 0;
+        };
+
+        std::string _directory;
+        std::string _prefix;
+        int _sample_rate = 0;
+        recorder_limits _limits;
+
+        std::chrono::steady_clock::time_point _started_at;
+
+        mutable std::mutex _mutex;
+        std::condition_variable _wake;
+
+        /**
+         * Holds the records waiting for the writer, oldest first.
+         */
+        std::deque<record> _queue;
+        std::size_t _queued_bytes = 0;
+        bool _is_closing = false;
+
+        /**
+         * Holds the number of samples recorded so far.
+         */
+        std::uint64_t _recorded_samples = 0;
+
+        /**
+         * Holds the number of samples dropped since the last audio record that was queued.
+         */
+        std::uint64_t _pending_gap = 0;
+
+        std::uint64_t _dropped_records = 0;
+
+        /**
+         * Holds the segments of the session still on disk, oldest first. Accessed by the writer only.
+         */
+        std::deque<segment> _segments;
+
+        std::FILE* _pcm_file = nullptr;
+        std::FILE* _jsonl_file = nullptr;
+        std::uint64_t _segment_index = 0;
+
+        /**
+         * Holds the number of samples written so far. Accessed by the writer only.
+         */
+        std::uint64_t _written_samples = 0;
+
+        /**
+         * Holds a value indicating whether writing failed, after which nothing more is written.
+         */
+        bool _has_failed = false;
+
+        std::thread _writer;
+
+    public:
+        /**
+         * Initializes a new instance of the session_recorder class. Use open instead.
+         */
+        session_recorder(std::string directory, std::string prefix, int sample_rate, recorder_limits limits);
+
+        /**
+         * Destroys an instance of the session_recorder class, writing out every queued record first.
+         */
+        ~session_recorder();
+
+        session_recorder(const session_recorder&) = delete;
+        session_recorder& operator=(const session_recorder&) = delete;
+
+        /**
+         * Starts recording a session.
+         * @param directory The existing directory to write the session to.
+         * @param prefix The name the session's files start with.
+         * @param sample_rate The sample rate of the recorded audio.
+         * @param limits The limits to work within.
+         * @return The recorder, or nullptr if the first segment could not be created.
+         */
+        static std::shared_ptr<session_recorder> open
+        (
+            const std::string& directory,
+            const std::string& prefix,
+            int sample_rate,
+            const recorder_limits& limits = recorder_limits()
+        );
+
+        /**
+         * Records a chunk of decoded audio.
+         * @param samples The mono samples, in the range Vosk expects.
+         */
+        void record_audio(span<const float> samples);
+
+        /**
+         * Records the output of a recognizer.
+         * @param type The kind of output; "partial", "result" or "final".
+         * @param json The output, as produced by Vosk.
+         * @param model_index The index of the model that produced the output, or -1 for none.
+         * @param channel_index The index of the channel the output belongs to, or -1 for none.
+         */
+        void record_event(std::string_view type, std::string_view json, int model_index, int channel_index);
+
+        /**
+         * Gets the number of records dropped because the writer fell behind or failed.
+         * @return The number of records.
+         */
+        [[nodiscard]] std::uint64_t get_dropped_records() const;
+
+        /**
+         * Stops accepting records, writes out the queued ones and closes the files. Blocks until done.
+         */
+        void close();
+
+    private:
+        /**
+         * Queues a record, or drops it if the queue is full. Must be called with the mutex held.
+         * @return true if the record was queued; otherwise, false.
+         */
+        bool enqueue(record&& entry);
+
+        /**
+         * Gets the microseconds since the session started.
+         */
+        [[nodiscard]] std::int64_t elapsed() const;
+
+        void write_records();
+
+        /**
+         * Closes the current segment, if any, and starts the next one, deleting the oldest segments if the session
+         * takes up too much space.
+         * @return true if the segment was started; otherwise, false.
+         */
+        bool start_segment();
+
+        void close_segment();
+    };
+}
+
+#endif //GDVOSK_CORE_SESSION_RECORDER_H
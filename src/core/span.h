@@ -0,0 +1,91 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_CORE_SPAN_H
+#define GDVOSK_CORE_SPAN_H
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace gdvosk::core
+{
+    /**
+     * Represents a non-owning view of a contiguous sequence of elements, in the spirit of C++20's std::span.
+     */
+    template <typename T>
+    class span final
+    {
+        /**
+         * Holds a pointer to the first element.
+         */
+        T* _data = nullptr;
+
+        /**
+         * Holds the number of elements.
+         */
+        std::size_t _size = 0;
+
+    public:
+        constexpr span() = default;
+
+        constexpr span(T* data, std::size_t size) :
+            _data(data),
+            _size(size)
+        {
+        }
+
+        template <typename U, typename = std::enable_if_t<std::is_convertible_v<U(*)[], T(*)[]>>>
+        constexpr span(const span<U>& other) :
+            _data(other.data()),
+            _size(other.size())
+        {
+        }
+
+        template <typename U, typename = std::enable_if_t<std::is_convertible_v<U(*)[], T(*)[]>>>
+        span(std::vector<U>& vector) :
+            _data(vector.data()),
+            _size(vector.size())
+        {
+        }
+
+        template <typename U, typename = std::enable_if_t<std::is_convertible_v<const U(*)[], T(*)[]>>>
+        span(const std::vector<U>& vector) :
+            _data(vector.data()),
+            _size(vector.size())
+        {
+        }
+
+        [[nodiscard]] constexpr T* data() const { return _data; }
+        [[nodiscard]] constexpr std::size_t size() const { return _size; }
+        [[nodiscard]] constexpr bool empty() const { return _size == 0; }
+
+        [[nodiscard]] constexpr T* begin() const { return _data; }
+        [[nodiscard]] constexpr T* end() const { return _data + _size; }
+
+        [[nodiscard]] constexpr T& operator[](std::size_t index) const { return _data[index]; }
+
+        /**
+         * Gets a view of a part of the sequence. The range is clamped to the bounds of this view.
+         * @param offset The index of the first element of the view.
+         * @param count The maximum number of elements in the view.
+         * @return The view.
+         */
+        [[nodiscard]] constexpr span subspan(std::size_t offset, std::size_t count = static_cast<std::size_t>(-1)) const
+        {
+            if (offset > _size)
+            {
+                offset = _size;
+            }
+
+            if (count > _size - offset)
+            {
+                count = _size - offset;
+            }
+
+            return { _data + offset, count };
+        }
+    };
+}
+
+#endif //GDVOSK_CORE_SPAN_H
@@ -0,0 +1,395 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "speaker_registry.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+
+#include "trace.h"
+
+using namespace gdvosk::core;
+
+namespace
+{
+    constexpr char file_magic[8] = { 'G', 'D', 'V', 'S', 'P', 'K', 'R', '1' };
+
+    /**
+     * Computes the dot product of two vectors. Independent partial sums let the compiler vectorize the loop without
+     * having to reorder floating-point additions itself.
+     */
+    float dot(const float* a, const float* b, std::size_t length)
+    {
+        constexpr std::size_t lanes = 8;
+
+        float partial[lanes] = { };
+
+        std::size_t i = 0;
+        for (; i + lanes <= length; i += lanes)
+        {
+            for (std::size_t j = 0; j < lanes; ++j)
+            {
+                partial[j] += a[i + j] * b[i + j];
+            }
+        }
+
+        auto sum = 0.0f;
+        for (auto value : partial)
+        {
+            sum += value;
+        }
+
+        for (; i < length; ++i)
+        {
+            sum += a[i] * b[i];
+        }
+
+        return sum;
+    }
+
+    bool normalize(span<const float> vector, std::vector<float>& output)
+    {
+        auto norm = std::sqrt(dot(vector.data(), vector.data(), vector.size()));
+        if (!(norm > 0.0f) || !std::isfinite(norm))
+        {
+            return false;
+        }
+
+        output.resize(vector.size());
+        for (std::size_t i = 0; i < vector.size(); ++i)
+        {
+            output[i] = vector[i] / norm;
+        }
+
+        return true;
+    }
+
+    void write_u32(std::vector<std::uint8_t>& output, std::uint32_t value)
+    {
+        for (auto shift = 0; shift < 32; shift += 8)
+        {
+            output.push_back(static_cast<std::uint8_t>(value >> shift));
+        }
+    }
+
+    /**
+     * Reads from a serialized registry, which is always little-endian.
+     */
+    class reader final
+    {
+        span<const std::uint8_t> _data;
+        std::size_t _position = 0;
+
+    public:
+        explicit reader(span<const std::uint8_t> data) :
+            _data(data)
+        {
+        }
+
+        bool read_bytes(void* output, std::size_t length)
+        {
+            if (_data.size() - _position < length)
+            {
+                return false;
+            }
+
+            std::memcpy(output, _data.data() + _position, length);
+            _position += length;
+            return true;
+        }
+
+        bool read_u32(std::uint32_t& value)
+        {
+            std::uint8_t bytes[4];
+            if (!read_bytes(bytes, sizeof(bytes)))
+            {
+                return false;
+            }
+
+            value = 0;
+            for (auto i = 0; i < 4; ++i)
+            {
+                value |= static_cast<std::uint32_t>(bytes[i]) << (i * 8);
+            }
+
+            return true;
+        }
+
+        bool read_float(float& value)
+        {
+            std::uint32_t bits = 0;
+            if (!read_u32(bits))
+            {
+                return false;
+            }
+
+            std::memcpy(&value, &bits, sizeof(value));
+            return std::isfinite(value);
+        }
+
+        [[nodiscard]] bool is_at_end() const
+        {
+            return _position == _data.size();
+        }
+    };
+}
+
+bool speaker_registry::enroll(const std::string& id, span<const float> vector)
+{
+    std::vector<float> normalized;
+    if (vector.empty() || !normalize(vector, normalized))
+    {
+        return false;
+    }
+
+    std::unique_lock lock(_mutex);
+
+    if (_dimension != 0 && _dimension != normalized.size())
+    {
+        return false;
+    }
+
+    _dimension = normalized.size();
+
+    auto existing = std::find_if(_speakers.begin(), _speakers.end(), [&](const auto& s) { return s.id == id; });
+    if (existing == _speakers.end())
+    {
+        _speakers.push_back({ id, std::vector<float>(_dimension, 0.0f), 0 });
+        _matrix.resize(_speakers.size() * _dimension);
+
+        existing = _speakers.end() - 1;
+    }
+
+    for (std::size_t i = 0; i < _dimension; ++i)
+    {
+        existing->sum[i] += normalized[i];
+    }
+
+    ++existing->count;
+
+    update_row(static_cast<std::size_t>(existing - _speakers.begin()));
+    return true;
+}
+
+bool speaker_registry::remove(const std::string& id)
+{
+    std::unique_lock lock(_mutex);
+
+    auto existing = std::find_if(_speakers.begin(), _speakers.end(), [&](const auto& s) { return s.id == id; });
+    if (existing == _speakers.end())
+    {
+        return false;
+    }
+
+    auto index = static_cast<std::size_t>(existing - _speakers.begin());
+    auto row = _matrix.begin() + static_cast<std::ptrdiff_t>(index * _dimension);
+
+    _matrix.erase(row, row + static_cast<std::ptrdiff_t>(_dimension));
+    _speakers.erase(existing);
+
+    if (_speakers.empty())
+    {
+        _dimension = 0;
+    }
+
+    return true;
+}
+
+void speaker_registry::clear()
+{
+    std::unique_lock lock(_mutex);
+
+    _speakers.clear();
+    _matrix.clear();
+    _dimension = 0;
+}
+
+bool speaker_registry::contains(const std::string& id) const
+{
+    std::shared_lock lock(_mutex);
+    return std::any_of(_speakers.begin(), _speakers.end(), [&](const auto& s) { return s.id == id; });
+}
+
+std::vector<std::string> speaker_registry::get_ids() const
+{
+    std::shared_lock lock(_mutex);
+
+    std::vector<std::string> ids;
+    ids.reserve(_speakers.size());
+    for (const auto& speaker : _speakers)
+    {
+        ids.push_back(speaker.id);
+    }
+
+    return ids;
+}
+
+std::size_t speaker_registry::size() const
+{
+    std::shared_lock lock(_mutex);
+    return _speakers.size();
+}
+
+std::size_t speaker_registry::dimension() const
+{
+    std::shared_lock lock(_mutex);
+    return _dimension;
+}
+
+std::vector<speaker_match> speaker_registry::match(span<const float> vector, std::size_t max_results) const
+{
+    GDVOSK_TRACE_SCOPE("speaker_match");
+
+    std::vector<float> query;
+    if (vector.empty() || !normalize(vector, query))
+    {
+        return { };
+    }
+
+    std::shared_lock lock(_mutex);
+
+    if (query.size() != _dimension)
+    {
+        return { };
+    }
+
+    // both sides are normalized, so each dot product is the cosine similarity
+    std::vector<std::pair<float, std::size_t>> scores(_speakers.size());
+    for (std::size_t i = 0; i < _speakers.size(); ++i)
+    {
+        scores[i] = { dot(_matrix.data() + i * _dimension, query.data(), _dimension), i };
+    }
+
+    auto count = std::min(max_results, scores.size());
+    std::partial_sort
+    (
+        scores.begin(),
+        scores.begin() + static_cast<std::ptrdiff_t>(count),
+        scores.end(),
+        [](const auto& a, const auto& b) { return a.first > b.first; }
+    );
+
+    std::vector<speaker_match> matches;
+    matches.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        matches.push_back({ _speakers[scores[i].second].id, scores[i].first });
+    }
+
+    return matches;
+}
+
+std::vector<std::uint8_t> speaker_registry::serialize() const
+{
+    std::shared_lock lock(_mutex);
+
+    std::vector<std::uint8_t> output(std::begin(file_magic), std::end(file_magic));
+
+    write_u32(output, static_cast<std::uint32_t>(_dimension));
+    write_u32(output, static_cast<std::uint32_t>(_speakers.size()));
+
+    for (const auto& speaker : _speakers)
+    {
+        write_u32(output, static_cast<std::uint32_t>(speaker.id.size()));
+        output.insert(output.end(), speaker.id.begin(), speaker.id.end());
+
+        write_u32(output, speaker.count);
+        for (auto value : speaker.sum)
+        {
+            std::uint32_t bits = 0;
+            std::memcpy(&bits, &value, sizeof(bits));
+
+            write_u32(output, bits);
+        }
+    }
+
+    return output;
+}
+
+bool speaker_registry::deserialize(span<const std::uint8_t> data)
+{
+    reader input(data);
+
+    char magic[sizeof(file_magic)];
+    if (!input.read_bytes(magic, sizeof(magic)) || std::memcmp(magic, file_magic, sizeof(magic)) != 0)
+    {
+        return false;
+    }
+
+    std::uint32_t dimension = 0;
+    std::uint32_t count = 0;
+    if (!input.read_u32(dimension) || !input.read_u32(count))
+    {
+        return false;
+    }
+
+    if ((dimension == 0) != (count == 0))
+    {
+        return false;
+    }
+
+    std::vector<speaker> speakers;
+    for (std::uint32_t i = 0; i < count; ++i)
+    {
+        speaker loaded;
+
+        std::uint32_t id_length = 0;
+        if (!input.read_u32(id_length) || id_length > data.size())
+        {
+            return false;
+        }
+
+        loaded.id.resize(id_length);
+        if (!input.read_bytes(loaded.id.data(), id_length) || !input.read_u32(loaded.count) || loaded.count == 0)
+        {
+            return false;
+        }
+
+        loaded.sum.resize(dimension);
+        for (auto& value : loaded.sum)
+        {
+            if (!input.read_float(value))
+            {
+                return false;
+            }
+        }
+
+        speakers.push_back(std::move(loaded));
+    }
+
+    if (!input.is_at_end())
+    {
+        return false;
+    }
+
+    std::unique_lock lock(_mutex);
+
+    _dimension = dimension;
+    _speakers = std::move(speakers);
+    _matrix.assign(_speakers.size() * _dimension, 0.0f);
+
+    for (std::size_t i = 0; i < _speakers.size(); ++i)
+    {
+        update_row(i);
+    }
+
+    return true;
+}
+
+void speaker_registry::update_row(std::size_t index)
+{
+    const auto& sum = _speakers[index].sum;
+    auto* row = _matrix.data() + index * _dimension;
+
+    std::vector<float> normalized;
+    if (!normalize(sum, normalized))
+    {
+        // opposing enrolments cancelled out; the speaker matches nothing
+        std::fill(row, row + _dimension, 0.0f);
+        return;
+    }
+
+    std::copy(normalized.begin(), normalized.end(), row);
+}
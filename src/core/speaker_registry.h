@@ -0,0 +1,133 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_CORE_SPEAKER_REGISTRY_H
+#define GDVOSK_CORE_SPEAKER_REGISTRY_H
+
+#include <cstdint>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "span.h"
+
+namespace gdvosk::core
+{
+    /**
+     * Represents how closely a speaker's enrolled voice matches a speaker vector.
+     */
+    struct speaker_match
+    {
+        std::string id;
+
+        /**
+         * Holds the cosine similarity between the vectors, between -1 and 1.
+         */
+        float score = 0;
+    };
+
+    /**
+     * Holds the voices of known speakers and identifies the speaker of an utterance from the x-vector Vosk produces
+     * for it. Each speaker is represented by the normalized mean of the vectors enrolled for them, and every speaker's
+     * representation is kept in one contiguous row-major matrix so that a search is a single pass of dot products.
+     * Thread-safe; searches may run concurrently with each other.
+     */
+    class speaker_registry final
+    {
+        /**
+         * Represents the enrolment data of one speaker.
+         */
+        struct speaker
+        {
+            std::string id;
+
+            /**
+             * Holds the sum of the normalized vectors enrolled for the speaker.
+             */
+            std::vector<float> sum;
+
+            /**
+             * Holds the number of vectors enrolled for the speaker.
+             */
+            std::uint32_t count = 0;
+        };
+
+        mutable std::shared_mutex _mutex;
+
+        /**
+         * Holds the length of every vector in the registry, or zero if nothing has been enrolled.
+         */
+        std::size_t _dimension = 0;
+
+        std::vector<speaker> _speakers;
+
+        /**
+         * Holds the normalized mean vector of each speaker, one row per speaker, in the same order as the speakers.
+         */
+        std::vector<float> _matrix;
+
+    public:
+        /**
+         * Enrols a speaker vector, adding the speaker if they are not known yet. Enrolling several vectors for the same
+         * speaker, taken from different utterances, makes matching more reliable.
+         * @param id The speaker's identifier.
+         * @param vector The speaker vector.
+         * @return true if the vector was enrolled; false if it is empty, all zero, or differs in length from the
+         * vectors already enrolled.
+         */
+        bool enroll(const std::string& id, span<const float> vector);
+
+        /**
+         * Removes a speaker.
+         * @param id The speaker's identifier.
+         * @return true if the speaker was known; otherwise, false.
+         */
+        bool remove(const std::string& id);
+
+        /**
+         * Removes every speaker.
+         */
+        void clear();
+
+        [[nodiscard]] bool contains(const std::string& id) const;
+        [[nodiscard]] std::vector<std::string> get_ids() const;
+        [[nodiscard]] std::size_t size() const;
+
+        /**
+         * Gets the length of the vectors in the registry.
+         * @return The length, or zero if nothing has been enrolled.
+         */
+        [[nodiscard]] std::size_t dimension() const;
+
+        /**
+         * Finds the enrolled speakers whose voices are closest to a speaker vector.
+         * @param vector The speaker vector.
+         * @param max_results The maximum number of matches to return.
+         * @return The matches, best first; or nothing if the vector's length doesn't match the registry's.
+         */
+        [[nodiscard]] std::vector<speaker_match> match(span<const float> vector, std::size_t max_results = 1) const;
+
+        /**
+         * Serializes the registry.
+         * @return The serialized form.
+         */
+        [[nodiscard]] std::vector<std::uint8_t> serialize() const;
+
+        /**
+         * Replaces the contents of the registry with a serialized form.
+         * @param data The serialized form.
+         * @return true if the data was valid; otherwise, false, and the registry is left unchanged.
+         */
+        bool deserialize(span<const std::uint8_t> data);
+
+    private:
+        /**
+         * Recomputes the row of the matrix that belongs to a speaker.
+         * @param index The index of the speaker.
+         */
+        void update_row(std::size_t index);
+    };
+}
+
+#endif //GDVOSK_CORE_SPEAKER_REGISTRY_H
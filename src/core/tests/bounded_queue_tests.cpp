@@ -0,0 +1,119 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include <chrono>
+#include <thread>
+
+#include "core/bounded_queue.h"
+
+#include "check.h"
+
+using namespace gdvosk::core;
+
+namespace
+{
+    /**
+     * Waits until a producer is blocked on the given queue.
+     * @param queue The queue.
+     */
+    void wait_for_stall(const bounded_queue<int>& queue)
+    {
+        while (queue.get_statistics().stalls == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+GDVOSK_TEST(bounded_queue, hands_out_items_in_order)
+{
+    bounded_queue<int> queue(4);
+    GDVOSK_CHECK(queue.push(1));
+    GDVOSK_CHECK(queue.push(2));
+    GDVOSK_CHECK(queue.push(3));
+
+    GDVOSK_CHECK(queue.pop() == 1);
+    GDVOSK_CHECK(queue.pop() == 2);
+    GDVOSK_CHECK(queue.pop() == 3);
+
+    auto statistics = queue.get_statistics();
+    GDVOSK_CHECK(statistics.depth == 0);
+    GDVOSK_CHECK(statistics.peak_depth == 3);
+    GDVOSK_CHECK(statistics.capacity == 4);
+}
+
+GDVOSK_TEST(bounded_queue, drains_after_close)
+{
+    bounded_queue<int> queue(4);
+    queue.push(1);
+    queue.push(2);
+    queue.close();
+
+    GDVOSK_CHECK(!queue.push(3));
+    GDVOSK_CHECK(queue.pop() == 1);
+    GDVOSK_CHECK(queue.pop() == 2);
+    GDVOSK_CHECK(!queue.pop().has_value());
+    GDVOSK_CHECK(!queue.pop().has_value());
+}
+
+GDVOSK_TEST(bounded_queue, close_releases_waiting_producer)
+{
+    bounded_queue<int> queue(1);
+    queue.push(1);
+
+    auto is_pushed = true;
+    std::thread producer([&] { is_pushed = queue.push(2); });
+
+    wait_for_stall(queue);
+    queue.close();
+    producer.join();
+
+    GDVOSK_CHECK(!is_pushed);
+    GDVOSK_CHECK(queue.pop() == 1);
+    GDVOSK_CHECK(!queue.pop().has_value());
+}
+
+GDVOSK_TEST(bounded_queue, close_releases_waiting_consumer)
+{
+    bounded_queue<int> queue(1);
+
+    auto is_empty = false;
+    std::thread consumer([&] { is_empty = !queue.pop().has_value(); });
+
+    queue.close();
+    consumer.join();
+
+    GDVOSK_CHECK(is_empty);
+}
+
+GDVOSK_TEST(bounded_queue, pop_makes_room_for_waiting_producer)
+{
+    bounded_queue<int> queue(1);
+    queue.push(1);
+
+    std::thread producer([&] { queue.push(2); });
+
+    wait_for_stall(queue);
+    GDVOSK_CHECK(queue.pop() == 1);
+    producer.join();
+
+    GDVOSK_CHECK(queue.pop() == 2);
+    GDVOSK_CHECK(queue.get_statistics().stalls == 1);
+}
+
+GDVOSK_TEST(bounded_queue, open_discards_items_and_statistics)
+{
+    bounded_queue<int> queue(2);
+    queue.push(1);
+    queue.push(2);
+    queue.close();
+
+    queue.open();
+
+    auto statistics = queue.get_statistics();
+    GDVOSK_CHECK(statistics.depth == 0);
+    GDVOSK_CHECK(statistics.peak_depth == 0);
+
+    GDVOSK_CHECK(queue.push(3));
+    GDVOSK_CHECK(queue.pop() == 3);
+}
@@ -0,0 +1,60 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_CORE_TESTS_CHECK_H
+#define GDVOSK_CORE_TESTS_CHECK_H
+
+#include <vector>
+
+namespace gdvosk::core::tests
+{
+    /**
+     * Represents a single test, grouped into a suite that can be run on its own.
+     */
+    struct test_case
+    {
+        const char* suite = nullptr;
+        const char* name = nullptr;
+        void (*run)() = nullptr;
+    };
+
+    /**
+     * Gets every test registered with GDVOSK_TEST, in registration order.
+     * @return The tests.
+     */
+    std::vector<test_case>& get_test_cases();
+
+    /**
+     * Registers a test. Called by GDVOSK_TEST during static initialization.
+     * @param suite The name of the suite the test belongs to.
+     * @param name The name of the test.
+     * @param run The test.
+     * @return Always true.
+     */
+    bool register_test(const char* suite, const char* name, void (*run)());
+
+    /**
+     * Records a failed check. The test carries on, so that one run reports every failure.
+     * @param expression The text of the expression that didn't hold.
+     * @param file The file the check is in.
+     * @param line The line the check is on.
+     */
+    void report_failure(const char* expression, const char* file, int line);
+}
+
+/**
+ * Defines a test in the given suite.
+ */
+#define GDVOSK_TEST(suite, name) \
+    static void suite##_##name(); \
+    [[maybe_unused]] static const bool suite##_##name##_is_registered = \
+        gdvosk::core::tests::register_test(#suite, #name, &suite##_##name); \
+    static void suite##_##name()
+
+/**
+ * Fails the running test, without stopping it, if the given expression doesn't hold.
+ */
+#define GDVOSK_CHECK(expression) \
+    ((expression) ? static_cast<void>(0) : gdvosk::core::tests::report_failure(#expression, __FILE__, __LINE__))
+
+#endif //GDVOSK_CORE_TESTS_CHECK_H
@@ -0,0 +1,169 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+// Stands in for the parts of the Vosk C API the core uses. Models are empty, any path but an empty one loads, and
+// recognizers never hear anything.
+
+#include "fake_vosk.h"
+
+#include <atomic>
+#include <string>
+
+#include <vosk_api.h>
+
+namespace
+{
+    std::atomic<std::size_t> live_models = 0;
+    std::atomic<std::size_t> loaded_models = 0;
+
+    constexpr const char* empty_result = R"({"text" : ""})";
+    constexpr const char* empty_partial_result = R"({"partial" : ""})";
+}
+
+struct VoskModel
+{
+};
+
+struct VoskSpkModel
+{
+};
+
+struct VoskRecognizer
+{
+    VoskModel* model = nullptr;
+    std::string grammar;
+};
+
+std::size_t gdvosk::core::tests::count_live_models()
+{
+    return live_models;
+}
+
+std::size_t gdvosk::core::tests::count_loaded_models()
+{
+    return loaded_models;
+}
+
+extern "C"
+{
+    VoskModel* vosk_model_new(const char* model_path)
+    {
+        if (model_path == nullptr || *model_path == '\0')
+        {
+            return nullptr;
+        }
+
+        ++live_models;
+        ++loaded_models;
+        return new VoskModel();
+    }
+
+    void vosk_model_free(VoskModel* model)
+    {
+        if (model == nullptr)
+        {
+            return;
+        }
+
+        --live_models;
+        delete model;
+    }
+
+    int vosk_model_find_word(VoskModel*, const char*)
+    {
+        return -1;
+    }
+
+    VoskSpkModel* vosk_spk_model_new(const char*)
+    {
+        return new VoskSpkModel();
+    }
+
+    void vosk_spk_model_free(VoskSpkModel* model)
+    {
+        delete model;
+    }
+
+    VoskRecognizer* vosk_recognizer_new(VoskModel* model, float)
+    {
+        return new VoskRecognizer { model, "" };
+    }
+
+    VoskRecognizer* vosk_recognizer_new_spk(VoskModel* model, float, VoskSpkModel*)
+    {
+        return new VoskRecognizer { model, "" };
+    }
+
+    VoskRecognizer* vosk_recognizer_new_grm(VoskModel* model, float, const char* grammar)
+    {
+        return new VoskRecognizer { model, grammar };
+    }
+
+    void vosk_recognizer_set_spk_model(VoskRecognizer*, VoskSpkModel*)
+    {
+    }
+
+    void vosk_recognizer_set_grm(VoskRecognizer* recognizer, const char* grammar)
+    {
+        recognizer->grammar = grammar;
+    }
+
+    void vosk_recognizer_set_max_alternatives(VoskRecognizer*, int)
+    {
+    }
+
+    void vosk_recognizer_set_words(VoskRecognizer*, int)
+    {
+    }
+
+    void vosk_recognizer_set_partial_words(VoskRecognizer*, int)
+    {
+    }
+
+    void vosk_recognizer_set_nlsml(VoskRecognizer*, int)
+    {
+    }
+
+    int vosk_recognizer_accept_waveform(VoskRecognizer*, const char*, int)
+    {
+        return 0;
+    }
+
+    int vosk_recognizer_accept_waveform_s(VoskRecognizer*, const short*, int)
+    {
+        return 0;
+    }
+
+    int vosk_recognizer_accept_waveform_f(VoskRecognizer*, const float*, int)
+    {
+        return 0;
+    }
+
+    const char* vosk_recognizer_result(VoskRecognizer*)
+    {
+        return empty_result;
+    }
+
+    const char* vosk_recognizer_partial_result(VoskRecognizer*)
+    {
+        return empty_partial_result;
+    }
+
+    const char* vosk_recognizer_final_result(VoskRecognizer*)
+    {
+        return empty_result;
+    }
+
+    void vosk_recognizer_reset(VoskRecognizer*)
+    {
+    }
+
+    void vosk_recognizer_free(VoskRecognizer* recognizer)
+    {
+        delete recognizer;
+    }
+
+    void vosk_set_log_level(int)
+    {
+    }
+}
@@ -0,0 +1,24 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_CORE_TESTS_FAKE_VOSK_H
+#define GDVOSK_CORE_TESTS_FAKE_VOSK_H
+
+#include <cstddef>
+
+namespace gdvosk::core::tests
+{
+    /**
+     * Counts the models loaded through the stand-in Vosk API that haven't been freed yet.
+     * @return The number of models.
+     */
+    std::size_t count_live_models();
+
+    /**
+     * Counts the models loaded through the stand-in Vosk API so far, including freed ones.
+     * @return The number of models.
+     */
+    std::size_t count_loaded_models();
+}
+
+#endif //GDVOSK_CORE_TESTS_FAKE_VOSK_H
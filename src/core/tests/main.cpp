@@ -0,0 +1,70 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include <cstdio>
+#include <cstring>
+
+#include "check.h"
+
+using namespace gdvosk::core::tests;
+
+namespace
+{
+    /**
+     * Holds the number of failed checks in the running test.
+     */
+    int failures = 0;
+}
+
+std::vector<test_case>& gdvosk::core::tests::get_test_cases()
+{
+    static std::vector<test_case> test_cases;
+    return test_cases;
+}
+
+bool gdvosk::core::tests::register_test(const char* suite, const char* name, void (*run)())
+{
+    get_test_cases().push_back({ suite, name, run });
+    return true;
+}
+
+void gdvosk::core::tests::report_failure(const char* expression, const char* file, int line)
+{
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+    ++failures;
+}
+
+/**
+ * Runs the tests of the suite named on the command line, or every test if none is.
+ */
+int main(int argc, char** argv)
+{
+    const char* suite = argc > 1 ? argv[1] : nullptr;
+
+    auto ran = 0;
+    auto failed = 0;
+    for (const auto& test : get_test_cases())
+    {
+        if (suite != nullptr && std::strcmp(suite, test.suite) != 0)
+        {
+            continue;
+        }
+
+        failures = 0;
+        test.run();
+
+        std::printf("%s %s.%s\n", failures == 0 ? "[  ok  ]" : "[FAILED]", test.suite, test.name);
+
+        ++ran;
+        failed += failures != 0 ? 1 : 0;
+    }
+
+    if (ran == 0)
+    {
+        std::fprintf(stderr, "no tests in suite %s\n", suite != nullptr ? suite : "(any)");
+        return 1;
+    }
+
+    std::printf("%d of %d tests passed\n", ran - failed, ran);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include <chrono>
+#include <thread>
+
+#include "core/model_registry.h"
+
+#include "check.h"
+#include "fake_vosk.h"
+
+using namespace gdvosk::core;
+using namespace gdvosk::core::tests;
+using namespace std::chrono;
+
+namespace
+{
+    constexpr std::uint64_t model_size = 100;
+
+    /**
+     * Waits out the registry's idle delay, so that models not used since become candidates for eviction.
+     */
+    void wait_until_idle()
+    {
+        std::this_thread::sleep_for(seconds(1) + milliseconds(100));
+    }
+
+    /**
+     * Adds a freshly loaded model to the given registry.
+     * @param registry The registry.
+     * @param path The path the model reloads from.
+     * @return The model's handle.
+     */
+    std::uint64_t add_model(model_registry& registry, const char* path)
+    {
+        auto handle = registry.add(path, vosk_model_new(path), model_size);
+
+        // keeps the models apart in least-recently-used order
+        std::this_thread::sleep_for(milliseconds(10));
+        return handle;
+    }
+}
+
+GDVOSK_TEST(model_registry, keeps_everything_without_budget)
+{
+    model_registry registry;
+    registry.set_idle_delay(seconds(1));
+
+    auto first = add_model(registry, "first");
+    auto second = add_model(registry, "second");
+    wait_until_idle();
+
+    GDVOSK_CHECK(registry.trim() == 0);
+    GDVOSK_CHECK(registry.get_resident_size() == 2 * model_size);
+
+    registry.set_budget(2 * model_size);
+    GDVOSK_CHECK(registry.get_resident_size() == 2 * model_size);
+
+    registry.remove(first);
+    registry.remove(second);
+}
+
+GDVOSK_TEST(model_registry, evicts_least_recently_used_first)
+{
+    auto live_models = count_live_models();
+
+    model_registry registry;
+    registry.set_idle_delay(seconds(1));
+
+    auto first = add_model(registry, "first");
+    auto second = add_model(registry, "second");
+    auto third = add_model(registry, "third");
+    wait_until_idle();
+
+    registry.set_budget(2 * model_size + model_size / 2);
+
+    GDVOSK_CHECK(!registry.get_statistics(first).is_resident);
+    GDVOSK_CHECK(registry.get_statistics(first).evictions == 1);
+    GDVOSK_CHECK(registry.get_statistics(second).is_resident);
+    GDVOSK_CHECK(registry.get_statistics(third).is_resident);
+    GDVOSK_CHECK(registry.get_resident_size() == 2 * model_size);
+    GDVOSK_CHECK(count_live_models() == live_models + 2);
+
+    // using the evicted model reloads it, which in turn pushes out the least recently used of the others
+    GDVOSK_CHECK(registry.use(first) != nullptr);
+    GDVOSK_CHECK(registry.get_statistics(first).reloads == 1);
+    GDVOSK_CHECK(!registry.get_statistics(second).is_resident);
+    GDVOSK_CHECK(registry.get_statistics(third).is_resident);
+    GDVOSK_CHECK(registry.get_resident_size() == 2 * model_size);
+
+    registry.remove(first);
+    registry.remove(second);
+    registry.remove(third);
+
+    GDVOSK_CHECK(count_live_models() == live_models);
+}
+
+GDVOSK_TEST(model_registry, spares_recently_used_models)
+{
+    model_registry registry;
+    registry.set_idle_delay(seconds(1));
+
+    auto handle = add_model(registry, "model");
+    registry.set_budget(model_size / 2);
+
+    GDVOSK_CHECK(registry.get_statistics(handle).is_resident);
+
+    registry.remove(handle);
+}
+
+GDVOSK_TEST(model_registry, keeps_leased_models_resident)
+{
+    model_registry registry;
+    registry.set_idle_delay(seconds(1));
+
+    auto handle = add_model(registry, "model");
+    auto lease = registry.lease(handle);
+    wait_until_idle();
+
+    registry.set_budget(model_size / 2);
+    GDVOSK_CHECK(registry.get_statistics(handle).is_resident);
+    GDVOSK_CHECK(lease.get() != nullptr);
+
+    // letting go of the last lease makes the model fair game again
+    lease = model_lease();
+    GDVOSK_CHECK(!registry.get_statistics(handle).is_resident);
+
+    registry.remove(handle);
+}
+
+GDVOSK_TEST(model_registry, try_lease_does_not_reload)
+{
+    auto loaded_models = count_loaded_models();
+
+    model_registry registry;
+    registry.set_idle_delay(seconds(1));
+
+    auto handle = add_model(registry, "model");
+    wait_until_idle();
+    registry.set_budget(model_size / 2);
+
+    GDVOSK_CHECK(registry.try_lease(handle).get() == nullptr);
+    GDVOSK_CHECK(!registry.get_statistics(handle).is_resident);
+    GDVOSK_CHECK(count_loaded_models() == loaded_models + 1);
+
+    auto lease = registry.lease(handle);
+    GDVOSK_CHECK(lease.get() != nullptr);
+    GDVOSK_CHECK(registry.try_lease(handle).get() == lease.get());
+    GDVOSK_CHECK(count_loaded_models() == loaded_models + 2);
+
+    lease = model_lease();
+    registry.remove(handle);
+}
+
+GDVOSK_TEST(model_registry, frees_removed_model_after_last_lease)
+{
+    auto live_models = count_live_models();
+
+    model_registry registry;
+    auto handle = add_model(registry, "model");
+
+    auto lease = registry.lease(handle);
+    auto copy = lease;
+    registry.remove(handle);
+
+    GDVOSK_CHECK(registry.try_lease(handle).get() == nullptr);
+    GDVOSK_CHECK(registry.use(handle) == nullptr);
+    GDVOSK_CHECK(count_live_models() == live_models + 1);
+
+    lease = model_lease();
+    GDVOSK_CHECK(count_live_models() == live_models + 1);
+
+    copy = model_lease();
+    GDVOSK_CHECK(count_live_models() == live_models);
+}
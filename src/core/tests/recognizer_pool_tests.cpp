@@ -0,0 +1,171 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "core/recognizer_pool.h"
+
+#include "check.h"
+
+using namespace gdvosk::core;
+
+namespace
+{
+    /**
+     * Creates a grammar with the given hash. The phrases don't matter, since keys only compare the hash.
+     * @param hash The hash.
+     * @return The grammar.
+     */
+    std::shared_ptr<const compiled_grammar> make_grammar(std::uint64_t hash)
+    {
+        auto grammar = std::make_shared<compiled_grammar>();
+        grammar->hash = hash;
+        grammar->phrases = { "yes", "no" };
+        grammar->json = R"(["yes", "no"])";
+
+        return grammar;
+    }
+
+    /**
+     * Owns a model for the duration of a test, along with the pool recognizers are built on it in.
+     */
+    struct pool_fixture
+    {
+        ::VoskModel* model = vosk_model_new("model");
+        ::VoskModel* other_model = vosk_model_new("other");
+        recognizer_pool pool;
+
+        ~pool_fixture()
+        {
+            pool.clear();
+
+            vosk_model_free(model);
+            vosk_model_free(other_model);
+        }
+    };
+}
+
+GDVOSK_TEST(recognizer_pool, keys_compare_every_field)
+{
+    pool_fixture fixture;
+
+    recognizer_key key { fixture.model, nullptr, 16000, nullptr };
+    GDVOSK_CHECK(key == key);
+
+    auto other = key;
+    other.model = fixture.other_model;
+    GDVOSK_CHECK(key != other);
+
+    other = key;
+    other.sample_rate = 48000;
+    GDVOSK_CHECK(key != other);
+
+    other = key;
+    other.grammar = make_grammar(1);
+    GDVOSK_CHECK(key != other);
+    GDVOSK_CHECK(key.grammar_hash() == 0);
+    GDVOSK_CHECK(other.grammar_hash() == 1);
+}
+
+GDVOSK_TEST(recognizer_pool, keys_compare_grammars_by_hash)
+{
+    pool_fixture fixture;
+
+    recognizer_key key { fixture.model, nullptr, 16000, make_grammar(42) };
+    recognizer_key same { fixture.model, nullptr, 16000, make_grammar(42) };
+    recognizer_key different { fixture.model, nullptr, 16000, make_grammar(43) };
+
+    GDVOSK_CHECK(key.grammar != same.grammar);
+    GDVOSK_CHECK(key == same);
+    GDVOSK_CHECK(key != different);
+}
+
+GDVOSK_TEST(recognizer_pool, reuses_recognizers_with_equal_keys)
+{
+    pool_fixture fixture;
+
+    recognizer_key key { fixture.model, nullptr, 16000, make_grammar(42) };
+    auto instance = fixture.pool.acquire(key);
+    GDVOSK_CHECK(instance != nullptr);
+
+    auto* released = instance.get();
+    fixture.pool.release(key, std::move(instance));
+    GDVOSK_CHECK(fixture.pool.get_statistics().idle == 1);
+
+    // a key built separately, with its own copy of the grammar, still finds the spare
+    recognizer_key same { fixture.model, nullptr, 16000, make_grammar(42) };
+    instance = fixture.pool.acquire(same);
+    GDVOSK_CHECK(instance.get() == released);
+
+    auto statistics = fixture.pool.get_statistics();
+    GDVOSK_CHECK(statistics.hits == 1);
+    GDVOSK_CHECK(statistics.misses == 1);
+    GDVOSK_CHECK(statistics.idle == 0);
+}
+
+GDVOSK_TEST(recognizer_pool, does_not_mix_up_keys)
+{
+    pool_fixture fixture;
+
+    recognizer_key key { fixture.model, nullptr, 16000, make_grammar(42) };
+    recognizer_key other_grammar { fixture.model, nullptr, 16000, make_grammar(43) };
+    recognizer_key other_rate { fixture.model, nullptr, 48000, make_grammar(42) };
+    recognizer_key other_model { fixture.other_model, nullptr, 16000, make_grammar(42) };
+
+    fixture.pool.release(key, fixture.pool.acquire(key));
+
+    for (const auto& other : { other_grammar, other_rate, other_model })
+    {
+        auto instance = fixture.pool.acquire(other);
+        GDVOSK_CHECK(instance != nullptr);
+        GDVOSK_CHECK(fixture.pool.get_statistics().idle == 1);
+    }
+
+    GDVOSK_CHECK(fixture.pool.get_statistics().hits == 0);
+    GDVOSK_CHECK(fixture.pool.acquire(key) != nullptr);
+    GDVOSK_CHECK(fixture.pool.get_statistics().hits == 1);
+}
+
+GDVOSK_TEST(recognizer_pool, keeps_warm_spares_per_key)
+{
+    pool_fixture fixture;
+    fixture.pool.set_warm_spares(2);
+
+    recognizer_key key { fixture.model, nullptr, 16000, nullptr };
+    recognizer_key other { fixture.model, nullptr, 48000, nullptr };
+
+    auto first = fixture.pool.acquire(key);
+    auto second = fixture.pool.acquire(key);
+    auto third = fixture.pool.acquire(key);
+    fixture.pool.release(key, std::move(first));
+    fixture.pool.release(key, std::move(second));
+    fixture.pool.release(key, std::move(third));
+
+    GDVOSK_CHECK(fixture.pool.get_statistics().idle == 2);
+    GDVOSK_CHECK(fixture.pool.prewarm(other) == 2);
+    GDVOSK_CHECK(fixture.pool.get_statistics().idle == 4);
+
+    // the oldest spares go first once there are too many in total
+    fixture.pool.set_max_idle(3);
+    GDVOSK_CHECK(fixture.pool.get_statistics().idle == 3);
+
+    fixture.pool.set_warm_spares(1);
+    GDVOSK_CHECK(fixture.pool.get_statistics().idle == 2);
+}
+
+GDVOSK_TEST(recognizer_pool, evicts_spares_of_a_model)
+{
+    pool_fixture fixture;
+
+    recognizer_key key { fixture.model, nullptr, 16000, nullptr };
+    recognizer_key other { fixture.other_model, nullptr, 16000, nullptr };
+    fixture.pool.prewarm(key);
+    fixture.pool.prewarm(other);
+
+    GDVOSK_CHECK(fixture.pool.count_spares(fixture.model) == 1);
+    GDVOSK_CHECK(count_recognizers(fixture.model) == 1);
+
+    fixture.pool.evict(fixture.model);
+
+    GDVOSK_CHECK(fixture.pool.count_spares(fixture.model) == 0);
+    GDVOSK_CHECK(fixture.pool.count_spares(fixture.other_model) == 1);
+    GDVOSK_CHECK(count_recognizers(fixture.model) == 0);
+}
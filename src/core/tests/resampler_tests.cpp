@@ -0,0 +1,138 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include <cmath>
+#include <cstdlib>
+
+#include "core/resampler.h"
+
+#include "check.h"
+
+using namespace gdvosk::core;
+
+namespace
+{
+    /**
+     * Generates a second of a tone with some deterministic noise on top, so that every sample differs.
+     * @param rate The sample rate.
+     * @return The samples.
+     */
+    std::vector<float> generate_signal(int rate)
+    {
+        std::vector<float> samples(static_cast<std::size_t>(rate));
+
+        std::uint32_t state = 1;
+        for (std::size_t i = 0; i < samples.size(); ++i)
+        {
+            state = state * 1664525u + 1013904223u;
+            auto noise = static_cast<float>(state >> 8) / static_cast<float>(1u << 24) - 0.5f;
+
+            samples[i] = 0.5f * std::sin(2.0f * 3.14159265f * 440.0f * static_cast<float>(i) / rate) + 0.1f * noise;
+        }
+
+        return samples;
+    }
+
+    /**
+     * Converts a signal in chunks of the given sizes, cycling through them until the input runs out.
+     * @param input_rate The sample rate of the signal.
+     * @param output_rate The sample rate to convert to.
+     * @param input The signal.
+     * @param chunk_sizes The sizes of the chunks.
+     * @return The converted signal.
+     */
+    std::vector<float> convert
+    (
+        int input_rate,
+        int output_rate,
+        const std::vector<float>& input,
+        const std::vector<std::size_t>& chunk_sizes
+    )
+    {
+        resampler converter(input_rate, output_rate);
+
+        std::vector<float> output;
+        std::size_t offset = 0;
+        for (std::size_t i = 0; offset < input.size(); ++i)
+        {
+            auto size = chunk_sizes[i % chunk_sizes.size()];
+            converter.process(span<const float>(input).subspan(offset, size), output);
+            offset += size;
+        }
+
+        return output;
+    }
+}
+
+GDVOSK_TEST(resampler, passes_equal_rates_through)
+{
+    resampler converter(16000, 16000);
+    GDVOSK_CHECK(converter.is_passthrough());
+
+    auto input = generate_signal(16000);
+    std::vector<float> output;
+    converter.process(input, output);
+
+    GDVOSK_CHECK(output == input);
+}
+
+GDVOSK_TEST(resampler, output_does_not_depend_on_chunking)
+{
+    for (auto [input_rate, output_rate] : { std::pair(44100, 16000), std::pair(48000, 16000), std::pair(8000, 16000) })
+    {
+        auto input = generate_signal(input_rate);
+
+        auto whole = convert(input_rate, output_rate, input, { input.size() });
+        GDVOSK_CHECK(!whole.empty());
+
+        // the output lags the input by the filter's half width, so it's a little short of the exact ratio
+        auto expected = static_cast<std::size_t>(output_rate);
+        GDVOSK_CHECK(whole.size() <= expected && whole.size() + 64 >= expected);
+
+        for (const auto& chunk_sizes : std::vector<std::vector<std::size_t>> { { 1 }, { 7, 160, 3 }, { 441, 1023 } })
+        {
+            auto chunked = convert(input_rate, output_rate, input, chunk_sizes);
+            GDVOSK_CHECK(chunked == whole);
+        }
+    }
+}
+
+GDVOSK_TEST(resampler, reset_starts_a_new_stream)
+{
+    auto input = generate_signal(44100);
+
+    resampler converter(44100, 16000);
+
+    std::vector<float> first;
+    converter.process(input, first);
+
+    converter.reset();
+
+    std::vector<float> second;
+    converter.process(input, second);
+
+    GDVOSK_CHECK(first == second);
+}
+
+GDVOSK_TEST(resampler, keeps_low_frequencies)
+{
+    auto input = generate_signal(48000);
+    auto output = convert(48000, 16000, input, { 480 });
+
+    // well inside the passband, the tone's level comes through the filter unchanged
+    auto input_energy = 0.0;
+    for (auto sample : input)
+    {
+        input_energy += static_cast<double>(sample) * sample;
+    }
+
+    auto output_energy = 0.0;
+    for (auto sample : output)
+    {
+        output_energy += static_cast<double>(sample) * sample;
+    }
+
+    auto input_level = std::sqrt(input_energy / static_cast<double>(input.size()));
+    auto output_level = std::sqrt(output_energy / static_cast<double>(output.size()));
+    GDVOSK_CHECK(std::abs(output_level - input_level) < 0.05 * input_level);
+}
@@ -0,0 +1,121 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include <cmath>
+
+#include "core/result.h"
+
+#include "check.h"
+
+using namespace gdvosk::core;
+
+namespace
+{
+    bool is_close(double value, double expected)
+    {
+        return std::abs(value - expected) < 1e-9;
+    }
+}
+
+GDVOSK_TEST(result, parses_final_result_with_words)
+{
+    auto result = parse_result
+    (
+        R"({
+          "result" : [{
+              "conf" : 0.5,
+              "end" : 0.9,
+              "start" : 0.3,
+              "word" : "hello"
+            }, {
+              "conf" : 1.0,
+              "end" : 1.5,
+              "start" : 1.0,
+              "word" : "world"
+            }],
+          "text" : "hello world"
+        })"
+    );
+
+    GDVOSK_CHECK(result.has_value());
+    GDVOSK_CHECK(!result->is_partial);
+    GDVOSK_CHECK(result->text == "hello world");
+    GDVOSK_CHECK(result->words.size() == 2);
+    GDVOSK_CHECK(result->words[0].word == "hello");
+    GDVOSK_CHECK(is_close(result->words[0].start, 0.3));
+    GDVOSK_CHECK(is_close(result->words[0].end, 0.9));
+    GDVOSK_CHECK(is_close(result->words[1].confidence, 1.0));
+    GDVOSK_CHECK(is_close(result->confidence(), 0.75));
+    GDVOSK_CHECK(result->document.find("text") != nullptr);
+}
+
+GDVOSK_TEST(result, parses_partial_result)
+{
+    auto result = parse_result(R"({"partial" : "hel", "partial_result" : [{"word" : "hel", "start" : 0, "end" : 1}]})");
+
+    GDVOSK_CHECK(result.has_value());
+    GDVOSK_CHECK(result->is_partial);
+    GDVOSK_CHECK(result->text == "hel");
+    GDVOSK_CHECK(result->words.size() == 1);
+
+    // words without a confidence count as certain
+    GDVOSK_CHECK(is_close(result->confidence(), 1.0));
+}
+
+GDVOSK_TEST(result, takes_text_from_first_alternative)
+{
+    auto result = parse_result
+    (
+        R"({"alternatives" : [
+            {"confidence" : 210.5, "text" : "one two"},
+            {"confidence" : 190.25, "text" : "won too", "result" : [{"word" : "won"}, {"word" : "too"}]}
+        ]})"
+    );
+
+    GDVOSK_CHECK(result.has_value());
+    GDVOSK_CHECK(result->text == "one two");
+    GDVOSK_CHECK(result->alternatives.size() == 2);
+    GDVOSK_CHECK(result->alternatives[1].text == "won too");
+    GDVOSK_CHECK(result->alternatives[1].words.size() == 2);
+    GDVOSK_CHECK(is_close(result->confidence(), 210.5));
+}
+
+GDVOSK_TEST(result, parses_speaker_vector)
+{
+    auto result = parse_result(R"({"text" : "hi", "spk" : [0.25, -1.5, 3e-2], "spk_frames" : 118})");
+
+    GDVOSK_CHECK(result.has_value());
+    GDVOSK_CHECK(result->speaker_vector.size() == 3);
+    GDVOSK_CHECK(result->speaker_vector[0] == 0.25f);
+    GDVOSK_CHECK(result->speaker_vector[1] == -1.5f);
+    GDVOSK_CHECK(std::abs(result->speaker_vector[2] - 0.03f) < 1e-6f);
+    GDVOSK_CHECK(result->speaker_frames == 118);
+}
+
+GDVOSK_TEST(result, decodes_string_escapes)
+{
+    auto result = parse_result(R"({"text" : "café \"quoted\" 😀 a\\b"})");
+
+    GDVOSK_CHECK(result.has_value());
+    GDVOSK_CHECK(result->text == "caf\xc3\xa9 \"quoted\" \xf0\x9f\x98\x80 a\\b");
+}
+
+GDVOSK_TEST(result, handles_empty_result)
+{
+    auto result = parse_result(R"({"text" : ""})");
+
+    GDVOSK_CHECK(result.has_value());
+    GDVOSK_CHECK(result->text.empty());
+    GDVOSK_CHECK(result->words.empty());
+    GDVOSK_CHECK(result->confidence() == 0);
+}
+
+GDVOSK_TEST(result, rejects_malformed_documents)
+{
+    GDVOSK_CHECK(!parse_result("").has_value());
+    GDVOSK_CHECK(!parse_result("[]").has_value());
+    GDVOSK_CHECK(!parse_result(R"({"text" : "unterminated})").has_value());
+    GDVOSK_CHECK(!parse_result(R"({"text" : "a",})").has_value());
+    GDVOSK_CHECK(!parse_result(R"({"text" : "a"} trailing)").has_value());
+    GDVOSK_CHECK(!parse_result(R"({"text" : "\ud83d"})").has_value());
+}
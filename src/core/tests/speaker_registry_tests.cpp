@@ -0,0 +1,135 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include <cmath>
+
+#include "core/speaker_registry.h"
+
+#include "check.h"
+
+using namespace gdvosk::core;
+
+namespace
+{
+    bool is_close(float value, float expected)
+    {
+        return std::abs(value - expected) < 1e-5f;
+    }
+}
+
+GDVOSK_TEST(speaker_registry, matches_closest_speakers_first)
+{
+    speaker_registry registry;
+    GDVOSK_CHECK(registry.enroll("alice", std::vector<float> { 1, 0, 0 }));
+    GDVOSK_CHECK(registry.enroll("bob", std::vector<float> { 0, 1, 0 }));
+    GDVOSK_CHECK(registry.enroll("carol", std::vector<float> { 0, 0, 1 }));
+
+    auto matches = registry.match(std::vector<float> { 0.8f, 0.6f, 0 }, 2);
+    GDVOSK_CHECK(matches.size() == 2);
+    GDVOSK_CHECK(matches[0].id == "alice");
+    GDVOSK_CHECK(is_close(matches[0].score, 0.8f));
+    GDVOSK_CHECK(matches[1].id == "bob");
+    GDVOSK_CHECK(is_close(matches[1].score, 0.6f));
+
+    // vectors are compared by direction only
+    matches = registry.match(std::vector<float> { 0, 0, 25 });
+    GDVOSK_CHECK(matches.size() == 1);
+    GDVOSK_CHECK(matches[0].id == "carol");
+    GDVOSK_CHECK(is_close(matches[0].score, 1.0f));
+}
+
+GDVOSK_TEST(speaker_registry, averages_repeated_enrollments)
+{
+    speaker_registry registry;
+    registry.enroll("alice", std::vector<float> { 1, 0 });
+    registry.enroll("alice", std::vector<float> { 0, 3 });
+
+    GDVOSK_CHECK(registry.size() == 1);
+
+    auto matches = registry.match(std::vector<float> { 1, 1 });
+    GDVOSK_CHECK(matches.size() == 1);
+    GDVOSK_CHECK(is_close(matches[0].score, 1.0f));
+}
+
+GDVOSK_TEST(speaker_registry, rejects_unusable_vectors)
+{
+    speaker_registry registry;
+    GDVOSK_CHECK(!registry.enroll("empty", std::vector<float> { }));
+    GDVOSK_CHECK(!registry.enroll("zero", std::vector<float> { 0, 0, 0 }));
+    GDVOSK_CHECK(!registry.enroll("nan", std::vector<float> { NAN, 1, 0 }));
+    GDVOSK_CHECK(registry.size() == 0);
+
+    GDVOSK_CHECK(registry.enroll("alice", std::vector<float> { 1, 0, 0 }));
+    GDVOSK_CHECK(!registry.enroll("bob", std::vector<float> { 1, 0 }));
+    GDVOSK_CHECK(registry.match(std::vector<float> { 1, 0 }).empty());
+    GDVOSK_CHECK(registry.dimension() == 3);
+}
+
+GDVOSK_TEST(speaker_registry, forgets_dimension_once_empty)
+{
+    speaker_registry registry;
+    registry.enroll("alice", std::vector<float> { 1, 0, 0 });
+    registry.enroll("bob", std::vector<float> { 0, 1, 0 });
+
+    GDVOSK_CHECK(registry.remove("alice"));
+    GDVOSK_CHECK(!registry.remove("alice"));
+    GDVOSK_CHECK(!registry.contains("alice"));
+    GDVOSK_CHECK(registry.match(std::vector<float> { 1, 1, 0 })[0].id == "bob");
+
+    GDVOSK_CHECK(registry.remove("bob"));
+    GDVOSK_CHECK(registry.dimension() == 0);
+    GDVOSK_CHECK(registry.enroll("carol", std::vector<float> { 1, 0 }));
+}
+
+GDVOSK_TEST(speaker_registry, round_trips_through_serialization)
+{
+    speaker_registry registry;
+    registry.enroll("alice", std::vector<float> { 1, 0.5f, 0 });
+    registry.enroll("alice", std::vector<float> { 0.5f, 1, 0 });
+    registry.enroll("bob", std::vector<float> { 0, 0.2f, 1 });
+
+    auto data = registry.serialize();
+
+    speaker_registry restored;
+    GDVOSK_CHECK(restored.deserialize(data));
+    GDVOSK_CHECK(restored.get_ids() == registry.get_ids());
+    GDVOSK_CHECK(restored.dimension() == 3);
+    GDVOSK_CHECK(restored.serialize() == data);
+
+    std::vector<float> query { 0.3f, 0.4f, 0.5f };
+    auto expected = registry.match(query, 2);
+    auto matches = restored.match(query, 2);
+    GDVOSK_CHECK(matches.size() == expected.size());
+    for (std::size_t i = 0; i < matches.size() && i < expected.size(); ++i)
+    {
+        GDVOSK_CHECK(matches[i].id == expected[i].id);
+        GDVOSK_CHECK(matches[i].score == expected[i].score);
+    }
+}
+
+GDVOSK_TEST(speaker_registry, rejects_damaged_data)
+{
+    speaker_registry registry;
+    registry.enroll("alice", std::vector<float> { 1, 0, 0 });
+
+    auto data = registry.serialize();
+
+    speaker_registry restored;
+    restored.enroll("bob", std::vector<float> { 0, 1 });
+
+    auto truncated = data;
+    truncated.pop_back();
+    GDVOSK_CHECK(!restored.deserialize(truncated));
+
+    auto extended = data;
+    extended.push_back(0);
+    GDVOSK_CHECK(!restored.deserialize(extended));
+
+    auto wrong_magic = data;
+    wrong_magic[0] = 'X';
+    GDVOSK_CHECK(!restored.deserialize(wrong_magic));
+
+    // a failed load leaves the registry as it was
+    GDVOSK_CHECK(restored.get_ids() == std::vector<std::string> { "bob" });
+    GDVOSK_CHECK(restored.dimension() == 2);
+}
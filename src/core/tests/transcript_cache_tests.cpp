@@ -0,0 +1,175 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "core/transcript_cache.h"
+
+#include "check.h"
+
+using namespace gdvosk::core;
+
+namespace
+{
+    std::uint64_t hash_text(const char* text, std::uint64_t seed = 0)
+    {
+        const auto* data = reinterpret_cast<const std::uint8_t*>(text);
+        return hash_data(span<const std::uint8_t>(data, std::strlen(text)), seed);
+    }
+
+    /**
+     * Creates an empty directory for a test to persist transcripts in, and removes it again afterwards.
+     */
+    struct scratch_directory
+    {
+        std::filesystem::path path;
+
+        explicit scratch_directory(const char* name) :
+            path(std::filesystem::temp_directory_path() / name)
+        {
+            std::filesystem::remove_all(path);
+            std::filesystem::create_directories(path);
+        }
+
+        ~scratch_directory()
+        {
+            std::error_code error;
+            std::filesystem::remove_all(path, error);
+        }
+    };
+
+    transcript make_transcript()
+    {
+        transcript value;
+        value.channels.push_back({ accept_status::result_ready, R"({"text" : "left"})", R"({"text" : ""})" });
+        value.channels.push_back({ accept_status::partial_ready, "", R"({"text" : "right é"})" });
+
+        return value;
+    }
+
+    bool is_equal(const transcript& value, const transcript& expected)
+    {
+        if (value.channels.size() != expected.channels.size())
+        {
+            return false;
+        }
+
+        for (std::size_t i = 0; i < value.channels.size(); ++i)
+        {
+            const auto& channel = value.channels[i];
+            const auto& expected_channel = expected.channels[i];
+            if (channel.status != expected_channel.status || channel.result_json != expected_channel.result_json
+                || channel.final_json != expected_channel.final_json)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+GDVOSK_TEST(transcript_cache, hashes_match_xxh64)
+{
+    // reference values published with XXH64
+    GDVOSK_CHECK(hash_text("") == 0xEF46DB3751D8E999ull);
+    GDVOSK_CHECK(hash_text("a") == 0xD24EC4F1A98C6E5Bull);
+    GDVOSK_CHECK(hash_text("abc") == 0x44BC2CF5AD770999ull);
+    GDVOSK_CHECK(hash_text("Nobody inspects the spammish repetition") == 0xFBCEA83C8A378BF1ull);
+
+    GDVOSK_CHECK(hash_text("abc", 1) != hash_text("abc"));
+}
+
+GDVOSK_TEST(transcript_cache, keeps_most_recently_used_entries)
+{
+    transcript_cache cache;
+    cache.set_max_entries(2);
+
+    transcript_key first { 1, 10, 7 };
+    transcript_key second { 2, 10, 7 };
+    transcript_key third { 3, 10, 7 };
+
+    cache.put(first, make_transcript());
+    cache.put(second, make_transcript());
+    GDVOSK_CHECK(cache.get(first).has_value());
+
+    cache.put(third, make_transcript());
+    GDVOSK_CHECK(cache.get(first).has_value());
+    GDVOSK_CHECK(!cache.get(second).has_value());
+    GDVOSK_CHECK(cache.get(third).has_value());
+
+    auto statistics = cache.get_statistics();
+    GDVOSK_CHECK(statistics.entries == 2);
+    GDVOSK_CHECK(statistics.hits == 3);
+    GDVOSK_CHECK(statistics.misses == 1);
+}
+
+GDVOSK_TEST(transcript_cache, tells_keys_with_equal_hashes_apart)
+{
+    transcript_cache cache;
+
+    transcript_key key { 1, 10, 7 };
+    transcript_key other_config { 1, 10, 8 };
+    transcript_key other_size { 1, 11, 7 };
+
+    cache.put(key, make_transcript());
+    GDVOSK_CHECK(cache.get(key).has_value());
+    GDVOSK_CHECK(!cache.get(other_config).has_value());
+    GDVOSK_CHECK(!cache.get(other_size).has_value());
+}
+
+GDVOSK_TEST(transcript_cache, round_trips_through_directory)
+{
+    scratch_directory directory("gdvosk-core-tests-transcripts");
+
+    transcript_key key { hash_text("audio"), 5, hash_text("configuration") };
+    auto value = make_transcript();
+    {
+        transcript_cache cache;
+        cache.set_directory(directory.path.string());
+        cache.put(key, value);
+    }
+
+    transcript_cache cache;
+    cache.set_directory(directory.path.string());
+
+    auto loaded = cache.get(key);
+    GDVOSK_CHECK(loaded.has_value());
+    GDVOSK_CHECK(loaded.has_value() && is_equal(*loaded, value));
+    GDVOSK_CHECK(cache.get_statistics().entries == 1);
+
+    // the file is named after the hashes only, so the stored key has to rule out a collision
+    auto collision = key;
+    collision.audio_size = 6;
+    GDVOSK_CHECK(!cache.get(collision).has_value());
+}
+
+GDVOSK_TEST(transcript_cache, ignores_damaged_files)
+{
+    scratch_directory directory("gdvosk-core-tests-damaged-transcripts");
+
+    transcript_key key { hash_text("audio"), 5, hash_text("configuration") };
+    {
+        transcript_cache cache;
+        cache.set_directory(directory.path.string());
+        cache.put(key, make_transcript());
+    }
+
+    for (const auto& file : std::filesystem::directory_iterator(directory.path))
+    {
+        std::filesystem::resize_file(file.path(), std::filesystem::file_size(file.path()) - 1);
+    }
+
+    transcript_cache cache;
+    cache.set_directory(directory.path.string());
+    GDVOSK_CHECK(!cache.get(key).has_value());
+
+    for (const auto& file : std::filesystem::directory_iterator(directory.path))
+    {
+        std::ofstream(file.path(), std::ios::binary | std::ios::trunc) << "not a transcript";
+    }
+
+    GDVOSK_CHECK(!cache.get(key).has_value());
+}
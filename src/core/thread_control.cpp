@@ -0,0 +1,156 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "thread_control.h"
+
+#if defined(__linux__)
+#include <cerrno>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+using namespace gdvosk::core;
+
+namespace
+{
+#if defined(__linux__)
+    /**
+     * Maps a priority to the niceness of a thread. Linux schedules threads individually, so niceness is per thread.
+     */
+    int to_niceness(thread_priority priority)
+    {
+        switch (priority)
+        {
+            case thread_priority::low:
+            {
+                return 10;
+            }
+            case thread_priority::high:
+            {
+                return -10;
+            }
+            case thread_priority::normal:
+            default:
+            {
+                return 0;
+            }
+        }
+    }
+
+    pid_t get_current_thread_id()
+    {
+        return static_cast<pid_t>(syscall(SYS_gettid));
+    }
+#endif
+}
+
+bool thread_settings::operator==(const thread_settings& other) const
+{
+    return affinity == other.affinity && priority == other.priority;
+}
+
+bool thread_settings::operator!=(const thread_settings& other) const
+{
+    return !(*this == other);
+}
+
+bool gdvosk::core::set_current_thread_affinity(std::uint64_t mask)
+{
+#ifdef __linux__
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+
+    if (mask == 0)
+    {
+        // the main thread's affinity is the process's
+        if (sched_getaffinity(getpid(), sizeof(cpus), &cpus) != 0)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        for (auto core = 0; core < 64 && core < CPU_SETSIZE; ++core)
+        {
+            if ((mask >> core) & 1u)
+            {
+                CPU_SET(core, &cpus);
+            }
+        }
+    }
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#else
+    static_cast<void>(mask);
+    return false;
+#endif
+}
+
+bool gdvosk::core::set_current_thread_priority(thread_priority priority)
+{
+#if defined(__linux__)
+    return setpriority(PRIO_PROCESS, static_cast<id_t>(get_current_thread_id()), to_niceness(priority)) == 0;
+#elif defined(_WIN32)
+    auto level = priority == thread_priority::low
+        ? THREAD_PRIORITY_BELOW_NORMAL
+        : priority == thread_priority::high ? THREAD_PRIORITY_ABOVE_NORMAL : THREAD_PRIORITY_NORMAL;
+
+    return SetThreadPriority(GetCurrentThread(), level) != 0;
+#else
+    static_cast<void>(priority);
+    return false;
+#endif
+}
+
+void gdvosk::core::apply_current_thread_settings(const thread_settings& settings)
+{
+    set_current_thread_affinity(settings.affinity);
+    set_current_thread_priority(settings.priority);
+}
+
+thread_settings gdvosk::core::get_current_thread_settings()
+{
+    thread_settings settings;
+
+#if defined(__linux__)
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+
+    if (pthread_getaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0)
+    {
+        for (auto core = 0; core < 64 && core < CPU_SETSIZE; ++core)
+        {
+            if (CPU_ISSET(core, &cpus))
+            {
+                settings.affinity |= std::uint64_t(1) << core;
+            }
+        }
+    }
+
+    errno = 0;
+    auto niceness = getpriority(PRIO_PROCESS, static_cast<id_t>(get_current_thread_id()));
+    if (errno == 0)
+    {
+        settings.priority = niceness > 0
+            ? thread_priority::low
+            : niceness < 0 ? thread_priority::high : thread_priority::normal;
+    }
+#elif defined(_WIN32)
+    auto level = GetThreadPriority(GetCurrentThread());
+    settings.priority = level < THREAD_PRIORITY_NORMAL
+        ? thread_priority::low
+        : level > THREAD_PRIORITY_NORMAL ? thread_priority::high : thread_priority::normal;
+#endif
+
+    return settings;
+}
+
+bool gdvosk::core::is_single_core(std::uint64_t mask)
+{
+    return mask != 0 && (mask & (mask - 1)) == 0;
+}
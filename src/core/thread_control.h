@@ -0,0 +1,76 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_CORE_THREAD_CONTROL_H
+#define GDVOSK_CORE_THREAD_CONTROL_H
+
+#include <cstdint>
+
+namespace gdvosk::core
+{
+    /**
+     * Enumerates the scheduling priorities of a thread.
+     */
+    enum class thread_priority
+    {
+        low,
+        normal,
+        high
+    };
+
+    /**
+     * Represents the scheduling constraints of a thread.
+     */
+    struct thread_settings
+    {
+        /**
+         * Holds a bit mask of the cores the thread may run on, where bit N is core N; or zero for every core the
+         * process may run on.
+         */
+        std::uint64_t affinity = 0;
+
+        thread_priority priority = thread_priority::normal;
+
+        [[nodiscard]] bool operator==(const thread_settings& other) const;
+        [[nodiscard]] bool operator!=(const thread_settings& other) const;
+    };
+
+    /**
+     * Restricts the calling thread to the given set of CPU cores. Only supported on Linux.
+     * @param mask A bit mask of allowed cores, where bit N is core N; or zero to allow every core the process may run
+     * on.
+     * @return true if the affinity was applied; otherwise, false.
+     */
+    bool set_current_thread_affinity(std::uint64_t mask);
+
+    /**
+     * Sets the scheduling priority of the calling thread. Only supported on Linux and Windows. Raising the priority
+     * above normal may need privileges the process doesn't have.
+     * @param priority The priority.
+     * @return true if the priority was applied; otherwise, false.
+     */
+    bool set_current_thread_priority(thread_priority priority);
+
+    /**
+     * Applies a full set of scheduling constraints to the calling thread.
+     * @param settings The constraints.
+     */
+    void apply_current_thread_settings(const thread_settings& settings);
+
+    /**
+     * Gets the scheduling constraints of the calling thread, so that threads working on its behalf can be scheduled
+     * like it. Constraints that can't be read on the platform are left at their defaults.
+     * @return The constraints.
+     */
+    [[nodiscard]] thread_settings get_current_thread_settings();
+
+    /**
+     * Determines whether an affinity mask restricts a thread to a single core, on which work handed to other threads
+     * would only compete with it.
+     * @param mask The mask.
+     * @return true if exactly one core is allowed; otherwise, false.
+     */
+    [[nodiscard]] bool is_single_core(std::uint64_t mask);
+}
+
+#endif //GDVOSK_CORE_THREAD_CONTROL_H
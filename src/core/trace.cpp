@@ -0,0 +1,248 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "trace.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    /**
+     * Holds the number of spans each thread can keep before the oldest ones are overwritten. Must be a power of two.
+     */
+    constexpr std::size_t thread_buffer_capacity = 1 << 14;
+
+    /**
+     * Represents a single recorded span. The fields are relaxed atomics so that a concurrent export never reads a torn
+     * value; on the platforms we target, relaxed stores compile to plain stores.
+     */
+    struct span_event
+    {
+        std::atomic<const char*> name { nullptr };
+        std::atomic<std::uint64_t> begin_ns { 0 };
+        std::atomic<std::uint64_t> end_ns { 0 };
+    };
+
+    /**
+     * Represents a single-producer ring buffer of spans owned by one thread.
+     */
+    struct thread_buffer
+    {
+        std::array<span_event, thread_buffer_capacity> events;
+
+        /**
+         * Holds the total number of spans ever written. Only the owning thread writes it.
+         */
+        std::atomic<std::uint64_t> head { 0 };
+
+        /**
+         * Holds the number of spans discarded by clear(). Readers skip everything before it.
+         */
+        std::atomic<std::uint64_t> tail { 0 };
+
+        std::uint32_t thread_id = 0;
+        std::string thread_name;
+    };
+
+    /**
+     * Holds every thread buffer ever created. Buffers are kept alive after their thread exits so that spans from
+     * short-lived threads still show up in exports.
+     */
+    struct buffer_registry
+    {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<thread_buffer>> buffers;
+    };
+
+    buffer_registry& get_registry()
+    {
+        static buffer_registry registry;
+        return registry;
+    }
+
+    thread_buffer& get_thread_buffer()
+    {
+        thread_local std::shared_ptr<thread_buffer> buffer = []
+        {
+            auto created = std::make_shared<thread_buffer>();
+
+            auto& registry = get_registry();
+            std::lock_guard lock(registry.mutex);
+
+            created->thread_id = static_cast<std::uint32_t>(registry.buffers.size() + 1);
+            registry.buffers.push_back(created);
+
+            return created;
+        }();
+
+        return *buffer;
+    }
+
+    void append_escaped(std::string& output, const std::string& value)
+    {
+        for (const auto c : value)
+        {
+            switch (c)
+            {
+                case '"': output += "\\\""; break;
+                case '\\': output += "\\\\"; break;
+                case '\n': output += "\\n"; break;
+                default:
+                {
+                    if (static_cast<unsigned char>(c) < 0x20)
+                    {
+                        continue;
+                    }
+
+                    output += c;
+                    break;
+                }
+            }
+        }
+    }
+
+    void append_microseconds(std::string& output, std::uint64_t nanoseconds)
+    {
+        char buffer[32];
+        std::snprintf
+        (
+            buffer,
+            sizeof(buffer),
+            "%llu.%03llu",
+            static_cast<unsigned long long>(nanoseconds / 1000),
+            static_cast<unsigned long long>(nanoseconds % 1000)
+        );
+
+        output += buffer;
+    }
+}
+
+bool gdvosk::trace::is_enabled()
+{
+#ifdef GDVOSK_ENABLE_TRACING
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::uint64_t gdvosk::trace::now_ns()
+{
+    static const auto epoch = std::chrono::steady_clock::now();
+
+    const auto elapsed = std::chrono::steady_clock::now() - epoch;
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+}
+
+void gdvosk::trace::record(const char* name, std::uint64_t begin_ns, std::uint64_t end_ns)
+{
+    auto& buffer = get_thread_buffer();
+
+    const auto index = buffer.head.load(std::memory_order_relaxed);
+    auto& event = buffer.events[index & (thread_buffer_capacity - 1)];
+
+    // orders the head that says this slot is being reused before the fields, for exports that re-check the head
+    std::atomic_thread_fence(std::memory_order_release);
+
+    event.name.store(name, std::memory_order_relaxed);
+    event.begin_ns.store(begin_ns, std::memory_order_relaxed);
+    event.end_ns.store(end_ns, std::memory_order_relaxed);
+
+    buffer.head.store(index + 1, std::memory_order_release);
+}
+
+void gdvosk::trace::set_thread_name(const std::string& name)
+{
+    auto& buffer = get_thread_buffer();
+
+    std::lock_guard lock(get_registry().mutex);
+    buffer.thread_name = name;
+}
+
+std::string gdvosk::trace::to_chrome_json()
+{
+    auto& registry = get_registry();
+    std::lock_guard lock(registry.mutex);
+
+    std::string output = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    auto first = true;
+
+    auto begin_event = [&]
+    {
+        if (!first)
+        {
+            output += ",\n";
+        }
+
+        first = false;
+    };
+
+    for (const auto& buffer : registry.buffers)
+    {
+        const auto tid = std::to_string(buffer->thread_id);
+
+        if (!buffer->thread_name.empty())
+        {
+            begin_event();
+            output += R"({"name":"thread_name","ph":"M","pid":1,"tid":)" + tid + R"(,"args":{"name":")";
+            append_escaped(output, buffer->thread_name);
+            output += "\"}}";
+        }
+
+        const auto head = buffer->head.load(std::memory_order_acquire);
+        auto start = buffer->tail.load(std::memory_order_relaxed);
+        if (head - start > thread_buffer_capacity)
+        {
+            start = head - thread_buffer_capacity;
+        }
+
+        for (auto index = start; index < head; ++index)
+        {
+            const auto& event = buffer->events[index & (thread_buffer_capacity - 1)];
+
+            const auto* name = event.name.load(std::memory_order_relaxed);
+            const auto begin_ns = event.begin_ns.load(std::memory_order_relaxed);
+            const auto end_ns = event.end_ns.load(std::memory_order_relaxed);
+
+            // the owning thread may have lapped us while we were reading; anything it could have overwritten, the
+            // slot it's writing right now included, is dropped rather than exported with mixed fields. The fence
+            // keeps the head from being read before the fields, which would make the check meaningless
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            const auto current_head = buffer->head.load(std::memory_order_relaxed);
+            if (current_head - index >= thread_buffer_capacity || name == nullptr)
+            {
+                continue;
+            }
+
+            begin_event();
+            output += R"({"name":")";
+            append_escaped(output, name);
+            output += R"(","ph":"X","pid":1,"tid":)" + tid + R"(,"ts":)";
+            append_microseconds(output, begin_ns);
+            output += ",\"dur\":";
+            append_microseconds(output, end_ns >= begin_ns ? end_ns - begin_ns : 0);
+            output += "}";
+        }
+    }
+
+    output += "]}";
+    return output;
+}
+
+void gdvosk::trace::clear()
+{
+    auto& registry = get_registry();
+    std::lock_guard lock(registry.mutex);
+
+    for (const auto& buffer : registry.buffers)
+    {
+        buffer->tail.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,113 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_CORE_TRACE_H
+#define GDVOSK_CORE_TRACE_H
+
+#include <cstdint>
+#include <string>
+
+namespace gdvosk::trace
+{
+    /**
+     * Gets a value indicating whether span recording was compiled into this build.
+     * @return true if spans are recorded; otherwise, false.
+     */
+    [[nodiscard]] bool is_enabled();
+
+    /**
+     * Gets the current time on the trace clock, in nanoseconds since the first use of the clock.
+     * @return The current time.
+     */
+    [[nodiscard]] std::uint64_t now_ns();
+
+    /**
+     * Records a completed span into the calling thread's buffer. The name must outlive the trace, which in practice
+     * means it should be a string literal.
+     * @param name The name of the span.
+     * @param begin_ns The start time of the span, as returned by now_ns.
+     * @param end_ns The end time of the span, as returned by now_ns.
+     */
+    void record(const char* name, std::uint64_t begin_ns, std::uint64_t end_ns);
+
+    /**
+     * Sets a human-readable name for the calling thread, shown as the track name in trace viewers.
+     * @param name The name of the thread.
+     */
+    void set_thread_name(const std::string& name);
+
+    /**
+     * Serializes every span currently held in the per-thread buffers as Chrome trace-event JSON, suitable for loading
+     * into chrome://tracing or Perfetto.
+     * @return The serialized trace.
+     */
+    [[nodiscard]] std::string to_chrome_json();
+
+    /**
+     * Discards every span currently held in the per-thread buffers.
+     */
+    void clear();
+
+    /**
+     * Records a span covering the lifetime of the object.
+     */
+    class scoped_span final
+    {
+        /**
+         * Holds the name of the span.
+         */
+        const char* _name;
+
+        /**
+         * Holds the time at which the span was opened.
+         */
+        std::uint64_t _begin_ns;
+
+    public:
+        /**
+         * Initializes a new instance of the scoped_span class, opening the span.
+         * @param name The name of the span.
+         */
+        explicit scoped_span(const char* name) :
+            _name(name),
+            _begin_ns(now_ns())
+        {
+        }
+
+        /**
+         * Destroys an instance of the scoped_span class, closing and recording the span.
+         */
+        ~scoped_span()
+        {
+            record(_name, _begin_ns, now_ns());
+        }
+
+        // disable copy and move
+        scoped_span(const scoped_span&) = delete;
+        scoped_span(scoped_span&&) = delete;
+        scoped_span& operator=(const scoped_span&) = delete;
+        scoped_span& operator=(scoped_span&&) = delete;
+    };
+}
+
+#define GDVOSK_TRACE_CONCAT_INNER(A, B) A##B
+#define GDVOSK_TRACE_CONCAT(A, B) GDVOSK_TRACE_CONCAT_INNER(A, B)
+
+#ifdef GDVOSK_ENABLE_TRACING
+/**
+ * Records a span named NAME from this point until the end of the enclosing scope. Compiles to nothing unless the
+ * GDVOSK_ENABLE_TRACING build option is turned on.
+ */
+#define GDVOSK_TRACE_SCOPE(NAME) \
+    const ::gdvosk::trace::scoped_span GDVOSK_TRACE_CONCAT(_gdvosk_trace_span_, __LINE__)(NAME)
+
+/**
+ * Names the calling thread in exported traces. Compiles to nothing unless tracing is enabled.
+ */
+#define GDVOSK_TRACE_THREAD_NAME(NAME) ::gdvosk::trace::set_thread_name(NAME)
+#else
+#define GDVOSK_TRACE_SCOPE(NAME) static_cast<void>(0)
+#define GDVOSK_TRACE_THREAD_NAME(NAME) static_cast<void>(0)
+#endif
+
+#endif //GDVOSK_CORE_TRACE_H
@@ -0,0 +1,491 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "transcript_cache.h"
+
+#include <cstdio>
+#include <cstring>
+
+using namespace gdvosk::core;
+
+namespace
+{
+    constexpr std::uint64_t prime_1 = 11400714785074694791ull;
+    constexpr std::uint64_t prime_2 = 14029467366897019727ull;
+    constexpr std::uint64_t prime_3 = 1609587929392839161ull;
+    constexpr std::uint64_t prime_4 = 9650029242287828579ull;
+    constexpr std::uint64_t prime_5 = 2870177450012600261ull;
+
+    constexpr char file_magic[8] = { 'G', 'D', 'V', 'T', 'R', 'N', 'S', '1' };
+
+    /**
+     * Holds the largest transcript file read back, as a guard against reading garbage.
+     */
+    constexpr long max_file_size = 16 * 1024 * 1024;
+
+    std::uint64_t rotate_left(std::uint64_t value, int bits)
+    {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    std::uint64_t load_u64(const std::uint8_t* data)
+    {
+        std::uint64_t value = 0;
+        for (auto i = 0; i < 8; ++i)
+        {
+            value |= static_cast<std::uint64_t>(data[i]) << (i * 8);
+        }
+
+        return value;
+    }
+
+    std::uint32_t load_u32(const std::uint8_t* data)
+    {
+        std::uint32_t value = 0;
+        for (auto i = 0; i < 4; ++i)
+        {
+            value |= static_cast<std::uint32_t>(data[i]) << (i * 8);
+        }
+
+        return value;
+    }
+
+    std::uint64_t mix_round(std::uint64_t accumulator, std::uint64_t input)
+    {
+        accumulator += input * prime_2;
+        accumulator = rotate_left(accumulator, 31);
+        return accumulator * prime_1;
+    }
+
+    std::uint64_t merge_round(std::uint64_t accumulator, std::uint64_t value)
+    {
+        accumulator ^= mix_round(0, value);
+        return accumulator * prime_1 + prime_4;
+    }
+
+    void write_u32(std::vector<std::uint8_t>& output, std::uint32_t value)
+    {
+        for (auto shift = 0; shift < 32; shift += 8)
+        {
+            output.push_back(static_cast<std::uint8_t>(value >> shift));
+        }
+    }
+
+    void write_u64(std::vector<std::uint8_t>& output, std::uint64_t value)
+    {
+        for (auto shift = 0; shift < 64; shift += 8)
+        {
+            output.push_back(static_cast<std::uint8_t>(value >> shift));
+        }
+    }
+
+    void write_string(std::vector<std::uint8_t>& output, const std::string& value)
+    {
+        write_u32(output, static_cast<std::uint32_t>(value.size()));
+        output.insert(output.end(), value.begin(), value.end());
+    }
+
+    /**
+     * Reads from a serialized transcript, which is always little-endian.
+     */
+    class reader final
+    {
+        const std::vector<std::uint8_t>& _data;
+        std::size_t _position = 0;
+
+    public:
+        explicit reader(const std::vector<std::uint8_t>& data) :
+            _data(data)
+        {
+        }
+
+        bool read_u32(std::uint32_t& value)
+        {
+            if (_data.size() - _position < 4)
+            {
+                return false;
+            }
+
+            value = load_u32(_data.data() + _position);
+            _position += 4;
+            return true;
+        }
+
+        bool read_u64(std::uint64_t& value)
+        {
+            if (_data.size() - _position < 8)
+            {
+                return false;
+            }
+
+            value = load_u64(_data.data() + _position);
+            _position += 8;
+            return true;
+        }
+
+        bool read_string(std::string& value)
+        {
+            std::uint32_t length = 0;
+            if (!read_u32(length) || _data.size() - _position < length)
+            {
+                return false;
+            }
+
+            value.assign(reinterpret_cast<const char*>(_data.data() + _position), length);
+            _position += length;
+            return true;
+        }
+
+        [[nodiscard]] bool is_at_end() const
+        {
+            return _position == _data.size();
+        }
+    };
+}
+
+std::uint64_t gdvosk::core::hash_data(span<const std::uint8_t> data, std::uint64_t seed)
+{
+    const auto* position = data.data();
+    const auto* end = position + data.size();
+
+    std::uint64_t hash;
+    if (data.size() >= 32)
+    {
+        // four independent lanes keep several multiplications in flight at once
+        std::uint64_t lanes[4] = { seed + prime_1 + prime_2, seed + prime_2, seed, seed - prime_1 };
+        for (; end - position >= 32; position += 32)
+        {
+            for (auto i = 0; i < 4; ++i)
+            {
+                lanes[i] = mix_round(lanes[i], load_u64(position + i * 8));
+            }
+        }
+
+        hash = rotate_left(lanes[0], 1) + rotate_left(lanes[1], 7) + rotate_left(lanes[2], 12)
+            + rotate_left(lanes[3], 18);
+
+        for (auto lane : lanes)
+        {
+            hash = merge_round(hash, lane);
+        }
+    }
+    else
+    {
+        hash = seed + prime_5;
+    }
+
+    hash += static_cast<std::uint64_t>(data.size());
+
+    for (; end - position >= 8; position += 8)
+    {
+        hash ^= mix_round(0, load_u64(position));
+        hash = rotate_left(hash, 27) * prime_1 + prime_4;
+    }
+
+    if (end - position >= 4)
+    {
+        hash ^= static_cast<std::uint64_t>(load_u32(position)) * prime_1;
+        hash = rotate_left(hash, 23) * prime_2 + prime_3;
+        position += 4;
+    }
+
+    for (; position < end; ++position)
+    {
+        hash ^= static_cast<std::uint64_t>(*position) * prime_5;
+        hash = rotate_left(hash, 11) * prime_1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= prime_2;
+    hash ^= hash >> 29;
+    hash *= prime_3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+bool transcript_key::operator==(const transcript_key& other) const
+{
+    return audio_hash == other.audio_hash && audio_size == other.audio_size && config_hash == other.config_hash;
+}
+
+bool transcript_key::operator!=(const transcript_key& other) const
+{
+    return !(*this == other);
+}
+
+std::size_t transcript::size() const
+{
+    auto size = sizeof(transcript);
+    for (const auto& channel : channels)
+    {
+        size += sizeof(channel) + channel.result_json.size() + channel.final_json.size();
+    }
+
+    return size;
+}
+
+transcript_cache& transcript_cache::shared()
+{
+    static transcript_cache cache;
+    return cache;
+}
+
+std::optional<transcript> transcript_cache::get(const transcript_key& key)
+{
+    std::string directory;
+    {
+        std::lock_guard lock(_mutex);
+
+        auto existing = _index.find(combine(key));
+        if (existing != _index.end() && existing->second->key == key)
+        {
+            _entries.splice(_entries.begin(), _entries, existing->second);
+
+            ++_hits;
+            return existing->second->value;
+        }
+
+        directory = _directory;
+    }
+
+    auto persisted = directory.empty() ? std::nullopt : read_file(directory + "/" + get_file_name(key), key);
+
+    std::lock_guard lock(_mutex);
+    if (!persisted.has_value())
+    {
+        ++_misses;
+        return std::nullopt;
+    }
+
+    ++_hits;
+    insert(key, *persisted);
+
+    return persisted;
+}
+
+void transcript_cache::put(const transcript_key& key, transcript value)
+{
+    std::string directory;
+    {
+        std::lock_guard lock(_mutex);
+
+        directory = _directory;
+        insert(key, value);
+    }
+
+    if (!directory.empty())
+    {
+        write_file(directory + "/" + get_file_name(key), key, value);
+    }
+}
+
+void transcript_cache::set_max_entries(std::size_t max_entries)
+{
+    std::lock_guard lock(_mutex);
+
+    _max_entries = max_entries;
+    trim();
+}
+
+std::size_t transcript_cache::get_max_entries() const
+{
+    std::lock_guard lock(_mutex);
+    return _max_entries;
+}
+
+void transcript_cache::set_max_size(std::size_t max_size)
+{
+    std::lock_guard lock(_mutex);
+
+    _max_size = max_size;
+    trim();
+}
+
+std::size_t transcript_cache::get_max_size() const
+{
+    std::lock_guard lock(_mutex);
+    return _max_size;
+}
+
+void transcript_cache::set_directory(std::string directory)
+{
+    std::lock_guard lock(_mutex);
+    _directory = std::move(directory);
+}
+
+std::string transcript_cache::get_directory() const
+{
+    std::lock_guard lock(_mutex);
+    return _directory;
+}
+
+transcript_cache_statistics transcript_cache::get_statistics() const
+{
+    std::lock_guard lock(_mutex);
+    return { _hits, _misses, _entries.size(), _size };
+}
+
+void transcript_cache::clear()
+{
+    std::lock_guard lock(_mutex);
+
+    _entries.clear();
+    _index.clear();
+    _size = 0;
+}
+
+void transcript_cache::insert(const transcript_key& key, transcript value)
+{
+    auto hash = combine(key);
+
+    auto existing = _index.find(hash);
+    if (existing != _index.end())
+    {
+        // either the same transcript again, or a genuine collision; in both cases the newest transcript wins
+        _size -= existing->second->value.size();
+        _entries.erase(existing->second);
+        _index.erase(existing);
+    }
+
+    _size += value.size();
+    _entries.push_front({ key, std::move(value) });
+    _index[hash] = _entries.begin();
+
+    trim();
+}
+
+void transcript_cache::trim()
+{
+    while (!_entries.empty() && (_entries.size() > _max_entries || _size > _max_size))
+    {
+        _size -= _entries.back().value.size();
+        _index.erase(combine(_entries.back().key));
+        _entries.pop_back();
+    }
+}
+
+std::uint64_t transcript_cache::combine(const transcript_key& key)
+{
+    return key.audio_hash ^ rotate_left(key.config_hash, 32) ^ key.audio_size * prime_5;
+}
+
+std::string transcript_cache::get_file_name(const transcript_key& key)
+{
+    char name[64];
+    std::snprintf
+    (
+        name,
+        sizeof(name),
+        "%016llx%016llx.transcript",
+        static_cast<unsigned long long>(key.audio_hash),
+        static_cast<unsigned long long>(key.config_hash)
+    );
+
+    return name;
+}
+
+std::optional<transcript> transcript_cache::read_file(const std::string& path, const transcript_key& key)
+{
+    auto* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr)
+    {
+        return std::nullopt;
+    }
+
+    std::vector<std::uint8_t> data;
+    if (std::fseek(file, 0, SEEK_END) == 0)
+    {
+        auto length = std::ftell(file);
+        if (length > 0 && length <= max_file_size && std::fseek(file, 0, SEEK_SET) == 0)
+        {
+            data.resize(static_cast<std::size_t>(length));
+            if (std::fread(data.data(), 1, data.size(), file) != data.size())
+            {
+                data.clear();
+            }
+        }
+    }
+
+    std::fclose(file);
+
+    if (data.size() < sizeof(file_magic) || std::memcmp(data.data(), file_magic, sizeof(file_magic)) != 0)
+    {
+        return std::nullopt;
+    }
+
+    reader input(data);
+
+    std::uint64_t magic = 0;
+    transcript_key stored;
+    std::uint32_t channel_count = 0;
+    if (!input.read_u64(magic) || !input.read_u64(stored.audio_hash) || !input.read_u64(stored.audio_size)
+        || !input.read_u64(stored.config_hash) || !input.read_u32(channel_count))
+    {
+        return std::nullopt;
+    }
+
+    // the file name only carries the hashes, so the size tells a collision apart
+    if (stored != key || channel_count > 2)
+    {
+        return std::nullopt;
+    }
+
+    transcript value;
+    value.channels.resize(channel_count);
+    for (auto& channel : value.channels)
+    {
+        std::uint32_t status = 0;
+        if (!input.read_u32(status) || !input.read_string(channel.result_json))
+        {
+            return std::nullopt;
+        }
+
+        if (!input.read_string(channel.final_json) || status > static_cast<std::uint32_t>(accept_status::failed))
+        {
+            return std::nullopt;
+        }
+
+        channel.status = static_cast<accept_status>(status);
+    }
+
+    if (!input.is_at_end())
+    {
+        return std::nullopt;
+    }
+
+    return value;
+}
+
+void transcript_cache::write_file(const std::string& path, const transcript_key& key, const transcript& value)
+{
+    std::vector<std::uint8_t> data(std::begin(file_magic), std::end(file_magic));
+    write_u64(data, key.audio_hash);
+    write_u64(data, key.audio_size);
+    write_u64(data, key.config_hash);
+    write_u32(data, static_cast<std::uint32_t>(value.channels.size()));
+
+    for (const auto& channel : value.channels)
+    {
+        write_u32(data, static_cast<std::uint32_t>(channel.status));
+        write_string(data, channel.result_json);
+        write_string(data, channel.final_json);
+    }
+
+    // readers never see a partially written file, since it only appears under its name once complete
+    auto temporary_path = path + ".tmp";
+
+    auto* file = std::fopen(temporary_path.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return;
+    }
+
+    auto is_written = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+    is_written = std::fclose(file) == 0 && is_written;
+
+    if (!is_written || std::rename(temporary_path.c_str(), path.c_str()) != 0)
+    {
+        std::remove(temporary_path.c_str());
+    }
+}
@@ -0,0 +1,204 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_CORE_TRANSCRIPT_CACHE_H
+#define GDVOSK_CORE_TRANSCRIPT_CACHE_H
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "recognizer.h"
+#include "span.h"
+
+namespace gdvosk::core
+{
+    /**
+     * Computes a fast, well-distributed 64-bit hash of a block of data (XXH64).
+     * @param data The data.
+     * @param seed The seed.
+     * @return The hash.
+     */
+    std::uint64_t hash_data(span<const std::uint8_t> data, std::uint64_t seed = 0);
+
+    /**
+     * Identifies the transcription of a block of audio under one recognizer configuration.
+     */
+    struct transcript_key
+    {
+        std::uint64_t audio_hash = 0;
+        std::uint64_t audio_size = 0;
+
+        /**
+         * Holds the hash of everything besides the audio that affects the output; the model, grammar, sample rate and
+         * output settings.
+         */
+        std::uint64_t config_hash = 0;
+
+        [[nodiscard]] bool operator==(const transcript_key& other) const;
+        [[nodiscard]] bool operator!=(const transcript_key& other) const;
+    };
+
+    /**
+     * Represents what one recognizer produced for a block of audio.
+     */
+    struct transcript_channel
+    {
+        /**
+         * Holds the status accepting the audio returned.
+         */
+        accept_status status = accept_status::failed;
+
+        /**
+         * Holds the complete result retrieved after accepting the audio, if any.
+         */
+        std::string result_json;
+
+        /**
+         * Holds the final result retrieved after accepting the audio.
+         */
+        std::string final_json;
+    };
+
+    /**
+     * Represents what a set of recognizers produced for a block of audio, one channel per recognizer.
+     */
+    struct transcript
+    {
+        std::vector<transcript_channel> channels;
+
+        /**
+         * Gets the approximate memory the transcript takes up.
+         * @return The size, in bytes.
+         */
+        [[nodiscard]] std::size_t size() const;
+    };
+
+    /**
+     * Represents counters describing how well a transcript cache is serving requests.
+     */
+    struct transcript_cache_statistics
+    {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::size_t entries = 0;
+
+        /**
+         * Holds the approximate memory the cached transcripts take up, in bytes.
+         */
+        std::size_t size = 0;
+    };
+
+    /**
+     * Keeps the transcripts of recently decoded audio, so that decoding the same audio under the same configuration
+     * again returns instantly. Transcripts are kept in memory up to a number and size limit, least recently used
+     * first out, and optionally written to a directory as one file per transcript, named after its key, where they are
+     * looked up when they're not in memory. Thread-safe.
+     */
+    class transcript_cache final
+    {
+        struct entry
+        {
+            transcript_key key;
+            transcript value;
+        };
+
+        using entry_list = std::list<entry>;
+
+        mutable std::mutex _mutex;
+
+        /**
+         * Holds the cached transcripts, most recently used first.
+         */
+        entry_list _entries;
+
+        /**
+         * Maps the combined key hashes to their position in the entry list.
+         */
+        std::unordered_map<std::uint64_t, entry_list::iterator> _index;
+
+        std::size_t _max_entries = 1024;
+        std::size_t _max_size = 16 * 1024 * 1024;
+        std::size_t _size = 0;
+
+        /**
+         * Holds the directory transcripts are persisted in, or an empty string for none.
+         */
+        std::string _directory;
+
+        std::uint64_t _hits = 0;
+        std::uint64_t _misses = 0;
+
+    public:
+        /**
+         * Gets the process-wide cache.
+         * @return The cache.
+         */
+        static transcript_cache& shared();
+
+        /**
+         * Gets the transcript for a key, looking in the persistence directory if it isn't in memory.
+         * @param key The key.
+         * @return The transcript, or nothing if none is cached.
+         */
+        std::optional<transcript> get(const transcript_key& key);
+
+        /**
+         * Caches a transcript, writing it to the persistence directory if there is one.
+         * @param key The key.
+         * @param value The transcript.
+         */
+        void put(const transcript_key& key, transcript value);
+
+        /**
+         * Sets the maximum number of transcripts kept in memory.
+         * @param max_entries The maximum.
+         */
+        void set_max_entries(std::size_t max_entries);
+        [[nodiscard]] std::size_t get_max_entries() const;
+
+        /**
+         * Sets the maximum memory, in bytes, the transcripts kept in memory may take up.
+         * @param max_size The maximum.
+         */
+        void set_max_size(std::size_t max_size);
+        [[nodiscard]] std::size_t get_max_size() const;
+
+        /**
+         * Sets the existing directory transcripts are persisted in.
+         * @param directory The directory, or an empty string to keep transcripts in memory only.
+         */
+        void set_directory(std::string directory);
+        [[nodiscard]] std::string get_directory() const;
+
+        [[nodiscard]] transcript_cache_statistics get_statistics() const;
+
+        /**
+         * Drops every transcript kept in memory. Persisted transcripts are left alone.
+         */
+        void clear();
+
+    private:
+        /**
+         * Adds a transcript to the in-memory entries. Must be called with the mutex held.
+         */
+        void insert(const transcript_key& key, transcript value);
+
+        /**
+         * Drops the least recently used entries until the limits are met. Must be called with the mutex held.
+         */
+        void trim();
+
+        [[nodiscard]] static std::uint64_t combine(const transcript_key& key);
+        [[nodiscard]] static std::string get_file_name(const transcript_key& key);
+
+        static std::optional<transcript> read_file(const std::string& path, const transcript_key& key);
+        static void write_file(const std::string& path, const transcript_key& key, const transcript& value);
+    };
+}
+
+#endif //GDVOSK_CORE_TRANSCRIPT_CACHE_H
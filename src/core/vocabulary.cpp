@@ -0,0 +1,251 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "vocabulary.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+#include "grammar.h"
+
+using namespace gdvosk::core;
+
+namespace
+{
+    /**
+     * Holds the largest symbol accepted from a symbol table, as a guard against allocating for a corrupt one.
+     */
+    constexpr std::size_t max_symbol = 16 * 1024 * 1024;
+
+    bool is_space(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    /**
+     * Gets a value indicating whether a symbol is structural rather than a word; the epsilon symbol or one of the
+     * #0, #1, ... disambiguation symbols.
+     */
+    bool is_structural_symbol(std::string_view word)
+    {
+        if (word == "<eps>")
+        {
+            return true;
+        }
+
+        if (word.size() < 2 || word[0] != '#')
+        {
+            return false;
+        }
+
+        return word.find_first_not_of("0123456789", 1) == std::string_view::npos;
+    }
+
+    bool read_file(const std::string& path, std::string& output)
+    {
+        auto* file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr)
+        {
+            return false;
+        }
+
+        char buffer[64 * 1024];
+        std::size_t read;
+        while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+        {
+            output.append(buffer, read);
+        }
+
+        auto is_read = std::ferror(file) == 0;
+        std::fclose(file);
+
+        return is_read;
+    }
+}
+
+std::vector<std::string_view> gdvosk::core::split_words(std::string_view phrase)
+{
+    std::vector<std::string_view> words;
+
+    std::size_t position = 0;
+    while (position < phrase.size())
+    {
+        auto start = phrase.find_first_not_of(' ', position);
+        if (start == std::string_view::npos)
+        {
+            break;
+        }
+
+        auto end = phrase.find(' ', start);
+        if (end == std::string_view::npos)
+        {
+            end = phrase.size();
+        }
+
+        words.push_back(phrase.substr(start, end - start));
+        position = end;
+    }
+
+    return words;
+}
+
+vocabulary::vocabulary(::VoskModel* model) :
+    _model(model)
+{
+}
+
+std::shared_ptr<const vocabulary> vocabulary::load(::VoskModel* model, const std::string& model_path)
+{
+    auto loaded = std::make_shared<vocabulary>(model);
+
+    // a missing or unreadable table is not an error; lookups go through Vosk instead
+    std::string text;
+    if (!model_path.empty() && read_file(model_path + "/graph/words.txt", text) && !loaded->parse(text))
+    {
+        loaded->_words.clear();
+        loaded->_symbols.clear();
+    }
+
+    return loaded;
+}
+
+int vocabulary::find(std::string_view word) const
+{
+    if (has_symbol_table())
+    {
+        auto existing = _symbols.find(word);
+        return existing != _symbols.end() ? existing->second : -1;
+    }
+
+    if (_model == nullptr)
+    {
+        return -1;
+    }
+
+    return vosk_model_find_word(_model, std::string(word).c_str());
+}
+
+bool vocabulary::contains_phrase(std::string_view phrase) const
+{
+    auto words = split_words(phrase);
+    if (words.empty())
+    {
+        return false;
+    }
+
+    for (auto word : words)
+    {
+        if (word != unknown_word && find(word) < 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::vector<std::string_view> vocabulary::get_words() const
+{
+    std::vector<std::string_view> words;
+    words.reserve(_symbols.size());
+
+    for (const auto& word : _words)
+    {
+        if (!word.empty() && !is_structural_symbol(word))
+        {
+            words.emplace_back(word);
+        }
+    }
+
+    return words;
+}
+
+bool vocabulary::has_symbol_table() const
+{
+    return !_symbols.empty();
+}
+
+bool vocabulary::parse(std::string_view text)
+{
+    std::vector<std::pair<std::string_view, std::size_t>> entries;
+    std::size_t max_entry = 0;
+
+    std::size_t position = 0;
+    while (position < text.size())
+    {
+        auto end = text.find('\n', position);
+        if (end == std::string_view::npos)
+        {
+            end = text.size();
+        }
+
+        auto line = text.substr(position, end - position);
+        position = end + 1;
+
+        while (!line.empty() && is_space(line.back()))
+        {
+            line.remove_suffix(1);
+        }
+
+        if (line.empty())
+        {
+            continue;
+        }
+
+        auto separator = line.find_last_of(" \t");
+        if (separator == std::string_view::npos || separator == 0)
+        {
+            return false;
+        }
+
+        auto word = line.substr(0, separator);
+        while (!word.empty() && is_space(word.back()))
+        {
+            word.remove_suffix(1);
+        }
+
+        std::size_t symbol = 0;
+        for (auto c : line.substr(separator + 1))
+        {
+            if (c < '0' || c > '9' || symbol > max_symbol)
+            {
+                return false;
+            }
+
+            symbol = symbol * 10 + static_cast<std::size_t>(c - '0');
+        }
+
+        if (word.empty() || symbol > max_symbol)
+        {
+            return false;
+        }
+
+        entries.emplace_back(word, symbol);
+        max_entry = std::max(max_entry, symbol);
+    }
+
+    // symbol tables are dense, so a sparse one is corrupt and would only waste memory
+    if (entries.empty() || max_entry > entries.size() * 2)
+    {
+        return false;
+    }
+
+    _words.resize(max_entry + 1);
+    for (const auto& [word, symbol] : entries)
+    {
+        _words[symbol] = word;
+    }
+
+    // the word list is complete, so the views into it stay valid from here on
+    _symbols.reserve(entries.size());
+    for (std::size_t symbol = 0; symbol < _words.size(); ++symbol)
+    {
+        if (!_words[symbol].empty())
+        {
+            _symbols.emplace(_words[symbol], static_cast<int>(symbol));
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,97 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_CORE_VOCABULARY_H
+#define GDVOSK_CORE_VOCABULARY_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <vosk_api.h>
+
+namespace gdvosk::core
+{
+    /**
+     * Splits a grammar phrase into its words, which Vosk separates by spaces.
+     * @param phrase The phrase.
+     * @return The words, in order; views into the phrase.
+     */
+    std::vector<std::string_view> split_words(std::string_view phrase);
+
+    /**
+     * Represents the words a model can recognize. The symbol table is read once from the model's graph/words.txt and
+     * looked up in a hash table after that; models without the file, which carry their symbols inside the graph
+     * instead, fall back to asking Vosk one word at a time.
+     */
+    class vocabulary final
+    {
+        ::VoskModel* _model = nullptr;
+
+        /**
+         * Holds the words, indexed by symbol. Symbols missing from the table are empty.
+         */
+        std::vector<std::string> _words;
+
+        /**
+         * Maps the words to their symbols. The keys view the strings in the word list, which never changes after
+         * construction.
+         */
+        std::unordered_map<std::string_view, int> _symbols;
+
+    public:
+        /**
+         * Initializes a new instance of the vocabulary class. Use load instead.
+         */
+        explicit vocabulary(::VoskModel* model);
+
+        vocabulary(const vocabulary&) = delete;
+        vocabulary& operator=(const vocabulary&) = delete;
+
+        /**
+         * Loads the vocabulary of a model.
+         * @param model The model. Must outlive the vocabulary.
+         * @param model_path The directory the model was loaded from.
+         * @return The vocabulary.
+         */
+        static std::shared_ptr<const vocabulary> load(::VoskModel* model, const std::string& model_path);
+
+        /**
+         * Gets the symbol of a word.
+         * @param word The word.
+         * @return The symbol, or -1 if the model does not know the word.
+         */
+        [[nodiscard]] int find(std::string_view word) const;
+
+        /**
+         * Gets a value indicating whether the model knows every word of a grammar phrase. The unknown word marker is
+         * always accepted.
+         * @param phrase The phrase.
+         * @return true if every word is known; otherwise, false.
+         */
+        [[nodiscard]] bool contains_phrase(std::string_view phrase) const;
+
+        /**
+         * Gets the words the model can recognize, in symbol order, leaving out the epsilon and disambiguation
+         * symbols of the decoding graph.
+         * @return The words, or nothing if the symbol table could not be read.
+         */
+        [[nodiscard]] std::vector<std::string_view> get_words() const;
+
+        /**
+         * Gets a value indicating whether the symbol table was read, so lookups don't cross into Vosk.
+         */
+        [[nodiscard]] bool has_symbol_table() const;
+
+    private:
+        /**
+         * Parses a symbol table in the OpenFst text format; one "word symbol" pair per line.
+         * @return true if the table was parsed; otherwise, false.
+         */
+        bool parse(std::string_view text);
+    };
+}
+
+#endif //GDVOSK_CORE_VOCABULARY_H
@@ -0,0 +1,163 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "wav.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace gdvosk::core;
+
+namespace
+{
+    constexpr std::uint16_t format_pcm = 1;
+    constexpr std::uint16_t format_float = 3;
+    constexpr std::uint16_t format_extensible = 0xFFFE;
+
+    std::uint32_t read_u32(const std::uint8_t* data)
+    {
+        return static_cast<std::uint32_t>(data[0])
+            | static_cast<std::uint32_t>(data[1]) << 8
+            | static_cast<std::uint32_t>(data[2]) << 16
+            | static_cast<std::uint32_t>(data[3]) << 24;
+    }
+
+    std::uint16_t read_u16(const std::uint8_t* data)
+    {
+        return static_cast<std::uint16_t>(data[0] | data[1] << 8);
+    }
+
+    /**
+     * Decodes one sample of the given encoding.
+     */
+    float decode_sample(const std::uint8_t* data, std::uint16_t format, std::uint16_t bits)
+    {
+        if (format == format_float)
+        {
+            auto bits_value = read_u32(data);
+
+            float value = 0;
+            std::memcpy(&value, &bits_value, sizeof(value));
+            return value;
+        }
+
+        switch (bits)
+        {
+            case 8:
+            {
+                // 8-bit samples are the only unsigned ones
+                return (static_cast<float>(data[0]) - 128.0f) / 128.0f;
+            }
+            case 16:
+            {
+                return static_cast<float>(static_cast<std::int16_t>(read_u16(data))) / 32768.0f;
+            }
+            case 24:
+            {
+                auto value = static_cast<std::uint32_t>(data[0]) << 8
+                    | static_cast<std::uint32_t>(data[1]) << 16
+                    | static_cast<std::uint32_t>(data[2]) << 24;
+
+                return static_cast<float>(static_cast<std::int32_t>(value)) / 2147483648.0f;
+            }
+            default:
+            {
+                return static_cast<float>(static_cast<std::int32_t>(read_u32(data))) / 2147483648.0f;
+            }
+        }
+    }
+}
+
+std::optional<pcm_audio> gdvosk::core::decode_wav(span<const std::uint8_t> data)
+{
+    if (data.size() < 12 || std::memcmp(data.data(), "RIFF", 4) != 0 || std::memcmp(data.data() + 8, "WAVE", 4) != 0)
+    {
+        return std::nullopt;
+    }
+
+    std::optional<pcm_audio> audio;
+    std::uint16_t format = 0;
+    std::uint16_t bits = 0;
+
+    std::size_t position = 12;
+    while (data.size() - position >= 8)
+    {
+        const auto* chunk = data.data() + position;
+        auto chunk_size = static_cast<std::size_t>(read_u32(chunk + 4));
+        auto available = data.size() - position - 8;
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0)
+        {
+            if (chunk_size < 16 || chunk_size > available)
+            {
+                return std::nullopt;
+            }
+
+            format = read_u16(chunk + 8);
+            if (format == format_extensible && chunk_size >= 40)
+            {
+                // the actual encoding is the first two bytes of the subformat GUID
+                format = read_u16(chunk + 32);
+            }
+
+            audio.emplace();
+            audio->channels = read_u16(chunk + 10);
+            audio->sample_rate = static_cast<int>(read_u32(chunk + 12));
+            bits = read_u16(chunk + 22);
+        }
+        else if (std::memcmp(chunk, "data", 4) == 0)
+        {
+            if (!audio.has_value())
+            {
+                return std::nullopt;
+            }
+
+            auto is_supported_format = (format == format_pcm && (bits == 8 || bits == 16 || bits == 24 || bits == 32))
+                || (format == format_float && bits == 32);
+
+            if (!is_supported_format || audio->channels == 0 || audio->sample_rate <= 0)
+            {
+                return std::nullopt;
+            }
+
+            // streamed files may leave the size unset; take whatever is there
+            chunk_size = std::min(chunk_size, available);
+
+            std::size_t sample_size = bits / 8;
+            auto frame_size = sample_size * audio->channels;
+            auto sample_count = chunk_size / frame_size * audio->channels;
+
+            const auto* samples = chunk + 8;
+            audio->samples.resize(sample_count);
+            for (std::size_t i = 0; i < sample_count; ++i)
+            {
+                audio->samples[i] = decode_sample(samples + i * sample_size, format, bits);
+            }
+
+            return audio;
+        }
+
+        // chunks are padded to an even size
+        auto padded_size = chunk_size + (chunk_size & 1);
+        if (padded_size > available)
+        {
+            break;
+        }
+
+        position += 8 + padded_size;
+    }
+
+    return std::nullopt;
+}
+
+void gdvosk::core::decode_pcm16(span<const std::uint8_t> data, std::vector<float>& output)
+{
+    auto count = data.size() / 2;
+    auto offset = output.size();
+
+    output.resize(offset + count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        output[offset + i] = static_cast<float>(static_cast<std::int16_t>(read_u16(data.data() + i * 2))) / 32768.0f;
+    }
+}
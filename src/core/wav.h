@@ -0,0 +1,44 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_CORE_WAV_H
+#define GDVOSK_CORE_WAV_H
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "span.h"
+
+namespace gdvosk::core
+{
+    /**
+     * Represents decoded audio as interleaved, normalized samples.
+     */
+    struct pcm_audio
+    {
+        int sample_rate = 0;
+        std::size_t channels = 0;
+
+        /**
+         * Holds the interleaved samples, in the range -1 to 1.
+         */
+        std::vector<float> samples;
+    };
+
+    /**
+     * Decodes a RIFF WAVE file holding uncompressed integer (8, 16, 24 or 32-bit) or 32-bit floating-point samples.
+     * @param data The contents of the file.
+     * @return The audio, or nothing if the file is malformed or uses an unsupported encoding.
+     */
+    std::optional<pcm_audio> decode_wav(span<const std::uint8_t> data);
+
+    /**
+     * Decodes signed 16-bit little-endian samples. A trailing odd byte is ignored.
+     * @param data The samples.
+     * @param output The buffer to append the normalized samples to.
+     */
+    void decode_pcm16(span<const std::uint8_t> data, std::vector<float>& output);
+}
+
+#endif //GDVOSK_CORE_WAV_H
@@ -10,8 +10,11 @@
 #include <godot_cpp/classes/resource_loader.hpp>
 
 #include "SpeechRecognizer.h"
+#include "SpeechTrace.h"
+#include "vosk/VoskCancellationToken.h"
 #include "vosk/VoskModelResourceLoader.h"
 #include "vosk/VoskRecognizer.h"
+#include "vosk/VoskSpeakerRegistry.h"
 
 using namespace godot;
 using namespace gdvosk;
@@ -29,16 +32,20 @@ void initialize_gdvosk_module(ModuleInitializationLevel p_level)
     }
 
     GDREGISTER_CLASS(VoskModelResourceLoader);
+    VoskModelResourceLoader::register_settings();
 
     _model_loader.instantiate();
     ResourceLoader::get_singleton()->add_resource_format_loader(_model_loader);
 
     GDREGISTER_CLASS(gdvosk::VoskModel);
     GDREGISTER_CLASS(VoskSpeakerModel);
+    GDREGISTER_CLASS(VoskSpeakerRegistry);
 
+    GDREGISTER_CLASS(VoskCancellationToken);
     GDREGISTER_CLASS(gdvosk::VoskRecognizer);
 
     GDREGISTER_CLASS(SpeechRecognizer);
+    GDREGISTER_ABSTRACT_CLASS(SpeechTrace);
 }
 
 void uninitialize_gdvosk_module(ModuleInitializationLevel p_level) 
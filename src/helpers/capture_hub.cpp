@@ -0,0 +1,155 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "capture_hub.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+
+#include "core/trace.h"
+
+using namespace godot;
+using namespace gdvosk;
+
+capture_subscription::capture_subscription(std::shared_ptr<capture_hub> hub) :
+    _hub(std::move(hub))
+{
+}
+
+std::vector<PackedVector2Array> capture_subscription::read()
+{
+    _hub->drain();
+
+    std::lock_guard lock(_mutex);
+
+    std::vector<PackedVector2Array> chunks
+    (
+        std::make_move_iterator(_chunks.begin()),
+        std::make_move_iterator(_chunks.end())
+    );
+
+    _chunks.clear();
+
+    return chunks;
+}
+
+const Ref<AudioEffectCapture>& capture_subscription::get_effect() const
+{
+    return _hub->get_effect();
+}
+
+std::uint64_t capture_subscription::take_lost_frames()
+{
+    std::lock_guard lock(_mutex);
+    return std::exchange(_lost_frames, 0);
+}
+
+void capture_subscription::deliver(const PackedVector2Array& chunk, std::uint64_t lost_frames)
+{
+    std::lock_guard lock(_mutex);
+
+    _lost_frames += lost_frames;
+    if (chunk.is_empty())
+    {
+        return;
+    }
+
+    _chunks.push_back(chunk);
+    while (_chunks.size() > capture_hub::max_pending_chunks)
+    {
+        _lost_frames += static_cast<std::uint64_t>(_chunks.front().size());
+        _chunks.pop_front();
+    }
+}
+
+capture_hub::capture_hub(Ref<AudioEffectCapture> effect) :
+    _effect(std::move(effect))
+{
+    // frames the effect discarded before anyone listened were never going to be decoded, so they aren't lost
+    _discarded_frames = _effect->get_discarded_frames();
+}
+
+std::shared_ptr<capture_hub> capture_hub::for_effect(const Ref<AudioEffectCapture>& effect)
+{
+    static std::mutex registry_mutex;
+    static std::unordered_map<uint64_t, std::weak_ptr<capture_hub>> registry;
+
+    std::lock_guard lock(registry_mutex);
+
+    auto& entry = registry[effect->get_instance_id()];
+
+    auto hub = entry.lock();
+    if (hub == nullptr)
+    {
+        hub = std::make_shared<capture_hub>(effect);
+        entry = hub;
+    }
+
+    // forget hubs nobody subscribes to anymore
+    for (auto it = registry.begin(); it != registry.end();)
+    {
+        it = it->second.expired() ? registry.erase(it) : std::next(it);
+    }
+
+    return hub;
+}
+
+std::shared_ptr<capture_subscription> capture_hub::subscribe()
+{
+    auto subscription = std::make_shared<capture_subscription>(shared_from_this());
+
+    std::lock_guard lock(_mutex);
+    _subscriptions.push_back(subscription);
+
+    return subscription;
+}
+
+const Ref<AudioEffectCapture>& capture_hub::get_effect() const
+{
+    return _effect;
+}
+
+void capture_hub::drain()
+{
+    GDVOSK_TRACE_SCOPE("capture_drain");
+
+    std::lock_guard lock(_mutex);
+
+    // the counter starts over whenever the effect is instantiated again, e.g. after its buffer length changed, and
+    // is then counted from where it starts over
+    auto discarded_frames = _effect->get_discarded_frames();
+    auto lost_frames = discarded_frames >= _discarded_frames ? discarded_frames - _discarded_frames : 0;
+    _discarded_frames = discarded_frames;
+
+    PackedVector2Array chunk;
+
+    auto frames = _effect->get_frames_available();
+    if (frames > 0)
+    {
+        chunk = _effect->get_buffer(frames);
+    }
+    else if (lost_frames <= 0)
+    {
+        return;
+    }
+
+    _subscriptions.erase
+    (
+        std::remove_if
+        (
+            _subscriptions.begin(),
+            _subscriptions.end(),
+            [](const auto& subscription) { return subscription.expired(); }
+        ),
+        _subscriptions.end()
+    );
+
+    for (const auto& weak_subscription : _subscriptions)
+    {
+        if (auto subscription = weak_subscription.lock())
+        {
+            subscription->deliver(chunk, static_cast<std::uint64_t>(lost_frames));
+        }
+    }
+}
@@ -0,0 +1,128 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_CAPTURE_HUB_H
+#define GDVOSK_CAPTURE_HUB_H
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <godot_cpp/classes/audio_effect_capture.hpp>
+#include <godot_cpp/variant/packed_vector2_array.hpp>
+
+namespace gdvosk
+{
+    class capture_hub;
+
+    /**
+     * Represents one reader of a capture hub. Each subscription sees every frame captured after it was created, in
+     * order, independently of any other subscription. Thread-safe.
+     */
+    class capture_subscription final
+    {
+        friend class capture_hub;
+
+        std::shared_ptr<capture_hub> _hub;
+
+        std::mutex _mutex;
+
+        /**
+         * Holds the chunks delivered to this subscription that it has not read yet, oldest first.
+         */
+        std::deque<godot::PackedVector2Array> _chunks;
+
+        /**
+         * Holds the number of frames lost since the last call to take_lost_frames, either because the capture effect
+         * overflowed or because the subscription fell too far behind.
+         */
+        std::uint64_t _lost_frames = 0;
+
+    public:
+        explicit capture_subscription(std::shared_ptr<capture_hub> hub);
+
+        /**
+         * Drains the capture effect if necessary and takes every chunk delivered to this subscription so far. Chunks
+         * share their storage with every other subscription and must not be modified.
+         * @return The chunks, oldest first.
+         */
+        std::vector<godot::PackedVector2Array> read();
+
+        /**
+         * Gets the capture effect the subscription reads from.
+         * @return The effect.
+         */
+        [[nodiscard]] const godot::Ref<godot::AudioEffectCapture>& get_effect() const;
+
+        /**
+         * Gets and clears the number of frames this subscription has lost since the last call, either because the
+         * capture effect's buffer overflowed before it was drained or because the subscription was not read often
+         * enough.
+         * @return The number of frames.
+         */
+        std::uint64_t take_lost_frames();
+
+    private:
+        void deliver(const godot::PackedVector2Array& chunk, std::uint64_t lost_frames);
+    };
+
+    /**
+     * Owns the draining of a single capture effect. The effect is drained exactly once per read, and each drained
+     * chunk is handed to every subscription; since packed arrays are reference-counted and copy-on-write, the audio
+     * itself is never copied. Thread-safe.
+     */
+    class capture_hub final : public std::enable_shared_from_this<capture_hub>
+    {
+        godot::Ref<godot::AudioEffectCapture> _effect;
+
+        std::mutex _mutex;
+
+        /**
+         * Holds the effect's discarded frame counter as of the last drain, or as of the hub's creation before the
+         * first one.
+         */
+        std::int64_t _discarded_frames = 0;
+
+        /**
+         * Holds the current subscriptions. Expired subscriptions are removed on the next drain.
+         */
+        std::vector<std::weak_ptr<capture_subscription>> _subscriptions;
+
+    public:
+        /**
+         * Holds the number of undelivered chunks a subscription may accumulate before its oldest chunks are dropped.
+         */
+        static constexpr std::size_t max_pending_chunks = 64;
+
+        explicit capture_hub(godot::Ref<godot::AudioEffectCapture> effect);
+
+        /**
+         * Gets the hub for the given capture effect, creating it if necessary. Every caller asking for the same effect
+         * gets the same hub for as long as any subscription to it exists.
+         * @param effect The capture effect.
+         * @return The hub.
+         */
+        static std::shared_ptr<capture_hub> for_effect(const godot::Ref<godot::AudioEffectCapture>& effect);
+
+        /**
+         * Creates a new subscription to the hub.
+         * @return The subscription.
+         */
+        std::shared_ptr<capture_subscription> subscribe();
+
+        /**
+         * Gets the capture effect the hub drains.
+         * @return The effect.
+         */
+        [[nodiscard]] const godot::Ref<godot::AudioEffectCapture>& get_effect() const;
+
+        /**
+         * Drains every frame currently available from the capture effect and delivers it to all subscriptions.
+         */
+        void drain();
+    };
+}
+
+#endif //GDVOSK_CAPTURE_HUB_H
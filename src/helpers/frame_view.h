@@ -0,0 +1,70 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_FRAME_VIEW_H
+#define GDVOSK_FRAME_VIEW_H
+
+#include <vector>
+
+#include <godot_cpp/variant/packed_vector2_array.hpp>
+
+#include "core/span.h"
+
+namespace gdvosk
+{
+    /**
+     * Presents an array of stereo audio frames as interleaved single-precision samples. In the usual single-precision
+     * builds this is a view of the array's own memory; in double-precision builds the frames are converted once.
+     */
+    class frame_view final
+    {
+#ifdef REAL_T_IS_DOUBLE
+        /**
+         * Holds the converted samples.
+         */
+        std::vector<float> _converted;
+#endif
+
+        /**
+         * Holds the interleaved samples.
+         */
+        core::span<const float> _samples;
+
+    public:
+        /**
+         * Initializes a new instance of the frame_view class. The frames must outlive the view.
+         * @param frames The frames.
+         */
+        explicit frame_view(const godot::PackedVector2Array& frames)
+        {
+#ifdef REAL_T_IS_DOUBLE
+            _converted.resize(frames.size() * 2);
+            for (int64_t i = 0; i < frames.size(); ++i)
+            {
+                _converted[i * 2] = static_cast<float>(frames[i].x);
+                _converted[i * 2 + 1] = static_cast<float>(frames[i].y);
+            }
+
+            _samples = core::span<const float>(_converted);
+#else
+            static_assert(sizeof(godot::Vector2) == 2 * sizeof(float));
+            _samples = core::span<const float>
+            (
+                reinterpret_cast<const float*>(frames.ptr()),
+                static_cast<std::size_t>(frames.size()) * 2
+            );
+#endif
+        }
+
+        /**
+         * Gets the interleaved left/right samples.
+         * @return The samples.
+         */
+        [[nodiscard]] core::span<const float> samples() const
+        {
+            return _samples;
+        }
+    };
+}
+
+#endif //GDVOSK_FRAME_VIEW_H
@@ -0,0 +1,542 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "model_files.h"
+
+#include <atomic>
+
+#include <godot_cpp/classes/dir_access.hpp>
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/os.hpp>
+#include <godot_cpp/classes/zip_reader.hpp>
+
+using namespace godot;
+
+namespace
+{
+    /**
+     * The file a prepared copy of a model records its source in. Being hidden, it is not listed among the model's
+     * files, and being written last, its presence means the copy is complete.
+     */
+    constexpr const char* source_marker = ".gdvosk-source";
+
+    uint64_t get_file_size(const String& path)
+    {
+        auto file = FileAccess::open(path, FileAccess::READ);
+        return file.is_valid() ? file->get_length() : 0;
+    }
+
+    /**
+     * Gets the component of a model a path relative to the model's directory lies in; that is, its first segment.
+     */
+    String get_component(const String& relative_path)
+    {
+        auto separator = relative_path.find("/");
+        return separator < 0 ? relative_path : relative_path.substr(0, separator);
+    }
+
+    /**
+     * Gets the directory an archive holds all of its files in, if there is exactly one.
+     * @return The directory, including the trailing separator, or an empty string if the files are not all in one
+     * top-level directory.
+     */
+    String get_archive_root(const PackedStringArray& files)
+    {
+        String root;
+        for (const auto& file : files)
+        {
+            auto separator = file.find("/");
+            if (separator <= 0)
+            {
+                return {};
+            }
+
+            auto top = file.substr(0, separator + 1);
+            if (root.is_empty())
+            {
+                root = top;
+            }
+            else if (top != root)
+            {
+                return {};
+            }
+        }
+
+        return root;
+    }
+
+    Error copy_directory(const String& source_path, const String& output_path, const PackedStringArray& skipped)
+    {
+        auto make_output_folder = DirAccess::make_dir_recursive_absolute(output_path);
+        if (make_output_folder != OK)
+        {
+            return make_output_folder;
+        }
+
+        for (const auto& file_name : DirAccess::get_files_at(source_path))
+        {
+            if (skipped.has(file_name))
+            {
+                continue;
+            }
+
+            auto copy = DirAccess::copy_absolute(source_path.path_join(file_name), output_path.path_join(file_name));
+            if (copy != OK)
+            {
+                return copy;
+            }
+        }
+
+        for (const auto& directory_name : DirAccess::get_directories_at(source_path))
+        {
+            if (skipped.has(directory_name))
+            {
+                continue;
+            }
+
+            // components are only skipped at the top level of the model
+            auto copy = copy_directory
+            (
+                source_path.path_join(directory_name),
+                output_path.path_join(directory_name),
+                PackedStringArray()
+            );
+
+            if (copy != OK)
+            {
+                return copy;
+            }
+        }
+
+        return OK;
+    }
+
+    /**
+     * Links to the files of a directory tree from another, copying the files that can't be linked to.
+     * @param source_path The directory.
+     * @param output_path The directory to link to its files from.
+     * @param replaced The paths, relative to the source directory, of the files to leave out.
+     * @param relative_path The path of the directory relative to the top of the tree.
+     */
+    Error link_directory
+    (
+        const String& source_path,
+        const String& output_path,
+        const PackedStringArray& replaced,
+        const String& relative_path
+    )
+    {
+        auto make_output_folder = DirAccess::make_dir_recursive_absolute(output_path);
+        if (make_output_folder != OK)
+        {
+            return make_output_folder;
+        }
+
+        auto output_dir = DirAccess::open(output_path);
+        if (!output_dir.is_valid())
+        {
+            return DirAccess::get_open_error();
+        }
+
+        for (const auto& file_name : DirAccess::get_files_at(source_path))
+        {
+            if (replaced.has(relative_path.path_join(file_name)))
+            {
+                continue;
+            }
+
+            auto source_file = source_path.path_join(file_name);
+            auto output_file = output_path.path_join(file_name);
+
+            // links are not supported everywhere; on Windows, for one, they take elevated privileges
+            if (output_dir->create_link(source_file, output_file) == OK)
+            {
+                continue;
+            }
+
+            auto copy = DirAccess::copy_absolute(source_file, output_file);
+            if (copy != OK)
+            {
+                return copy;
+            }
+        }
+
+        for (const auto& directory_name : DirAccess::get_directories_at(source_path))
+        {
+            auto link = link_directory
+            (
+                source_path.path_join(directory_name),
+                output_path.path_join(directory_name),
+                replaced,
+                relative_path.path_join(directory_name)
+            );
+
+            if (link != OK)
+            {
+                return link;
+            }
+        }
+
+        return OK;
+    }
+
+    Error remove_directory(const String& path)
+    {
+        for (const auto& file_name : DirAccess::get_files_at(path))
+        {
+            auto remove = DirAccess::remove_absolute(path.path_join(file_name));
+            if (remove != OK)
+            {
+                return remove;
+            }
+        }
+
+        for (const auto& directory_name : DirAccess::get_directories_at(path))
+        {
+            auto remove = remove_directory(path.path_join(directory_name));
+            if (remove != OK)
+            {
+                return remove;
+            }
+        }
+
+        return DirAccess::remove_absolute(path);
+    }
+
+    /**
+     * Describes every file in a directory tree by its path, size and modification time.
+     */
+    String describe_directory(const String& path, const String& relative_path)
+    {
+        String description;
+        for (const auto& file_name : DirAccess::get_files_at(path))
+        {
+            auto file_path = path.path_join(file_name);
+
+            description += relative_path.path_join(file_name);
+            description += ":" + String::num_uint64(get_file_size(file_path));
+            description += ":" + String::num_uint64(FileAccess::get_modified_time(file_path)) + "\n";
+        }
+
+        for (const auto& directory_name : DirAccess::get_directories_at(path))
+        {
+            description += describe_directory(path.path_join(directory_name), relative_path.path_join(directory_name));
+        }
+
+        return description;
+    }
+
+    /**
+     * Describes what a prepared copy of a model is made from, so that a copy of a source that has since changed, or
+     * one made with other components left out, can be told apart from an up-to-date one.
+     * @param source_path The archive or directory the model is copied from.
+     * @param skipped_components The components left out of the copy.
+     * @return The description.
+     */
+    String describe_source(const String& source_path, const PackedStringArray& skipped_components)
+    {
+        String description;
+        if (DirAccess::dir_exists_absolute(source_path))
+        {
+            description = describe_directory(source_path, "");
+        }
+        else
+        {
+            description = String::num_uint64(get_file_size(source_path));
+            description += ":" + String::num_uint64(FileAccess::get_modified_time(source_path)) + "\n";
+        }
+
+        return description + "skipped:" + String(",").join(skipped_components) + "\n";
+    }
+
+    bool is_up_to_date(const String& output_path, const String& description)
+    {
+        auto marker_path = output_path.path_join(source_marker);
+        return FileAccess::file_exists(marker_path) && FileAccess::get_file_as_string(marker_path) == description;
+    }
+
+    /**
+     * Gets a path next to a directory that is not used by anything else, neither in this process nor in another one.
+     */
+    String get_sibling_path(const String& path, const String& purpose)
+    {
+        static std::atomic<uint64_t> counter {0};
+
+        auto process_id = OS::get_singleton()->get_process_id();
+        return path + "." + purpose + "-" + String::num_int64(process_id) + "-" + String::num_uint64(++counter);
+    }
+
+    /**
+     * Moves a complete copy of a model into place, replacing an outdated copy, if there is one.
+     */
+    Error replace_directory(const String& staging_path, const String& output_path, const String& description)
+    {
+        if (DirAccess::dir_exists_absolute(output_path))
+        {
+            if (is_up_to_date(output_path, description))
+            {
+                // someone else finished an identical copy first, and may already be loading it
+                remove_directory(staging_path);
+                return OK;
+            }
+
+            auto retired_path = get_sibling_path(output_path, "old");
+            auto retire = DirAccess::rename_absolute(output_path, retired_path);
+            if (retire != OK)
+            {
+                remove_directory(staging_path);
+                return retire;
+            }
+
+            remove_directory(retired_path);
+        }
+
+        auto rename = DirAccess::rename_absolute(staging_path, output_path);
+        if (rename != OK)
+        {
+            remove_directory(staging_path);
+            return is_up_to_date(output_path, description) ? OK : rename;
+        }
+
+        return OK;
+    }
+
+    /**
+     * Prepares a copy of a model, unless an up-to-date one is already in place. The copy is made next to its final
+     * location and only moved into place once it is complete, so that an interrupted copy is never mistaken for a
+     * model, and a model that is being loaded is never written to.
+     * @param description The description of what the copy is made from; see describe_source.
+     * @param output_path The directory the copy ends up in.
+     * @param build Writes the copy into the directory it is given.
+     * @return The result of the operation.
+     */
+    template <typename Build>
+    Error prepare_copy(const String& description, const String& output_path, Build&& build)
+    {
+        if (is_up_to_date(output_path, description))
+        {
+            return OK;
+        }
+
+        auto staging_path = get_sibling_path(output_path, "tmp");
+        auto make_staging_folder = DirAccess::make_dir_recursive_absolute(staging_path);
+        if (make_staging_folder != OK)
+        {
+            return make_staging_folder;
+        }
+
+        auto result = build(staging_path);
+        if (result == OK)
+        {
+            auto marker = FileAccess::open(staging_path.path_join(source_marker), FileAccess::ModeFlags::WRITE);
+            result = marker.is_valid() && marker->is_open() && marker->store_string(description)
+                ? OK
+                : ERR_FILE_CANT_WRITE;
+
+            if (marker.is_valid())
+            {
+                marker->close();
+            }
+        }
+
+        if (result != OK)
+        {
+            remove_directory(staging_path);
+            return result;
+        }
+
+        return replace_directory(staging_path, output_path, description);
+    }
+}
+
+uint64_t gdvosk::get_directory_size(const String& path)
+{
+    uint64_t size = 0;
+    for (const auto& file_name : DirAccess::get_files_at(path))
+    {
+        size += get_file_size(path.path_join(file_name));
+    }
+
+    for (const auto& directory_name : DirAccess::get_directories_at(path))
+    {
+        size += get_directory_size(path.path_join(directory_name));
+    }
+
+    return size;
+}
+
+Dictionary gdvosk::get_component_sizes(const String& model_path)
+{
+    Dictionary sizes;
+    for (const auto& file_name : DirAccess::get_files_at(model_path))
+    {
+        sizes[file_name] = static_cast<int64_t>(get_file_size(model_path.path_join(file_name)));
+    }
+
+    for (const auto& directory_name : DirAccess::get_directories_at(model_path))
+    {
+        sizes[directory_name] = static_cast<int64_t>(get_directory_size(model_path.path_join(directory_name)));
+    }
+
+    return sizes;
+}
+
+String gdvosk::get_model_fingerprint(const String& model_path)
+{
+    // the acoustic model, the decoding graph in either layout, the configuration and the optional components
+    static const char* const fingerprinted_files[] =
+    {
+        "am/final.mdl",
+        "graph/HCLG.fst",
+        "graph/HCLr.fst",
+        "graph/Gr.fst",
+        "graph/words.txt",
+        "conf/model.conf",
+        "conf/mfcc.conf",
+        "ivector/final.ie",
+        "rescore/G.carpa",
+        "rnnlm/final.raw",
+    };
+
+    String fingerprint;
+    for (const auto* file_name : fingerprinted_files)
+    {
+        auto path = model_path.path_join(file_name);
+
+        fingerprint += file_name;
+        if (FileAccess::file_exists(path))
+        {
+            fingerprint += ":" + String::num_uint64(get_file_size(path));
+            fingerprint += ":" + String::num_uint64(FileAccess::get_modified_time(path));
+        }
+
+        fingerprint += "\n";
+    }
+
+    return fingerprint;
+}
+
+Error gdvosk::extract_model
+(
+    const String& archive_path,
+    const String& output_path,
+    const PackedStringArray& skipped_components
+)
+{
+    Ref<ZIPReader> reader;
+    reader.instantiate();
+
+    auto open = reader->open(archive_path);
+    if (open != OK)
+    {
+        return open;
+    }
+
+    return prepare_copy
+    (
+        describe_source(archive_path, skipped_components),
+        output_path,
+        [&](const String& staging_path)
+        {
+            auto files = reader->get_files();
+            auto root = get_archive_root(files);
+
+            for (const auto& file : files)
+            {
+                if (file.ends_with("/"))
+                {
+                    // just a folder, ignore
+                    continue;
+                }
+
+                auto relative_path = file.substr(root.length());
+                if (skipped_components.has(get_component(relative_path)))
+                {
+                    continue;
+                }
+
+                auto output_file_path = staging_path.path_join(relative_path);
+                auto make_output_folder = DirAccess::make_dir_recursive_absolute(output_file_path.get_base_dir());
+                if (make_output_folder != OK)
+                {
+                    return make_output_folder;
+                }
+
+                auto bytes = reader->read_file(file);
+                auto output_file = FileAccess::open(output_file_path, FileAccess::ModeFlags::WRITE);
+                if (!output_file.is_valid() || !output_file->is_open())
+                {
+                    return ERR_FILE_CANT_WRITE;
+                }
+
+                output_file->store_buffer(bytes);
+                output_file->close();
+            }
+
+            return OK;
+        }
+    );
+}
+
+Error gdvosk::copy_model
+(
+    const String& model_path,
+    const String& output_path,
+    const PackedStringArray& skipped_components
+)
+{
+    if (!DirAccess::dir_exists_absolute(model_path))
+    {
+        return ERR_FILE_NOT_FOUND;
+    }
+
+    return prepare_copy
+    (
+        describe_source(model_path, skipped_components),
+        output_path,
+        [&](const String& staging_path)
+        {
+            return copy_directory(model_path, staging_path, skipped_components);
+        }
+    );
+}
+
+Error gdvosk::overlay_model(const String& model_path, const String& output_path, const String& config)
+{
+    static const char* const config_file = "conf/model.conf";
+
+    if (!DirAccess::dir_exists_absolute(model_path))
+    {
+        return ERR_FILE_NOT_FOUND;
+    }
+
+    return prepare_copy
+    (
+        describe_source(model_path, PackedStringArray()) + "config:\n" + config,
+        output_path,
+        [&](const String& staging_path)
+        {
+            auto link = link_directory(model_path, staging_path, { config_file }, "");
+            if (link != OK)
+            {
+                return link;
+            }
+
+            auto config_path = staging_path.path_join(config_file);
+            auto make_config_folder = DirAccess::make_dir_recursive_absolute(config_path.get_base_dir());
+            if (make_config_folder != OK)
+            {
+                return make_config_folder;
+            }
+
+            auto output_file = FileAccess::open(config_path, FileAccess::ModeFlags::WRITE);
+            if (!output_file.is_valid() || !output_file->is_open() || !output_file->store_string(config))
+            {
+                return ERR_FILE_CANT_WRITE;
+            }
+
+            output_file->close();
+            return OK;
+        }
+    );
+}
@@ -0,0 +1,90 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_MODEL_FILES_H
+#define GDVOSK_MODEL_FILES_H
+
+#include <cstdint>
+
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/packed_string_array.hpp>
+#include <godot_cpp/variant/string.hpp>
+
+namespace gdvosk
+{
+    /**
+     * Sums the sizes of the files in a directory tree. A loaded model takes up roughly as much memory as its files,
+     * which is the best estimate available, since Vosk does not report its memory use.
+     * @param path The directory.
+     * @return The size, in bytes.
+     */
+    [[nodiscard]] uint64_t get_directory_size(const godot::String& path);
+
+    /**
+     * Gets the size of each component of a model directory; that is, each of its top-level directories and files.
+     * @param model_path The model directory.
+     * @return A dictionary mapping the name of each component to its size, in bytes.
+     */
+    [[nodiscard]] godot::Dictionary get_component_sizes(const godot::String& model_path);
+
+    /**
+     * Describes the files of a model that determine what it recognizes, by their sizes and modification times, so
+     * that a model that was updated or replaced in place can be told apart from the one that was there before.
+     * @param model_path The model directory.
+     * @return The description; equal for two models only if their files are, as far as their sizes and modification
+     * times tell.
+     */
+    [[nodiscard]] godot::String get_model_fingerprint(const godot::String& model_path);
+
+    /**
+     * Extracts a model from a ZIP archive, leaving out some of its components. Archives usually hold the model in a
+     * single top-level directory, which is stripped, so that the model's own files end up directly in the output
+     * directory. An earlier extraction is reused as long as the archive and the skipped components are unchanged;
+     * otherwise, the model is extracted next to the output directory and then replaces it, once complete.
+     * @param archive_path The archive.
+     * @param output_path The directory to extract the model into.
+     * @param skipped_components The names of the top-level directories and files of the model to leave out.
+     * @return The result of the operation.
+     */
+    godot::Error extract_model
+    (
+        const godot::String& archive_path,
+        const godot::String& output_path,
+        const godot::PackedStringArray& skipped_components
+    );
+
+    /**
+     * Copies a model directory, leaving out some of its components. An earlier copy is reused as long as the model's
+     * files and the skipped components are unchanged; otherwise, the model is copied next to the output directory
+     * and then replaces it, once complete.
+     * @param model_path The model directory.
+     * @param output_path The directory to copy the model into.
+     * @param skipped_components The names of the top-level directories and files of the model to leave out.
+     * @return The result of the operation.
+     */
+    godot::Error copy_model
+    (
+        const godot::String& model_path,
+        const godot::String& output_path,
+        const godot::PackedStringArray& skipped_components
+    );
+
+    /**
+     * Makes an overlay of a model that differs from it only in its conf/model.conf: a directory holding the given
+     * configuration, with links to the model's other files, or copies of them where links aren't supported. The model
+     * itself is left untouched. An earlier overlay is reused as long as the model's files and the configuration are
+     * unchanged; otherwise, the overlay is made next to the output directory and then replaces it, once complete.
+     * @param model_path The model directory.
+     * @param output_path The directory to make the overlay in.
+     * @param config The contents of the overlay's conf/model.conf.
+     * @return The result of the operation.
+     */
+    godot::Error overlay_model
+    (
+        const godot::String& model_path,
+        const godot::String& output_path,
+        const godot::String& config
+    );
+}
+
+#endif //GDVOSK_MODEL_FILES_H
@@ -0,0 +1,128 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "replay_source.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "core/resampler.h"
+
+using namespace godot;
+using namespace gdvosk;
+using namespace std::chrono;
+
+replay_source::replay_source(PackedVector2Array frames, int sample_rate, bool is_paced) :
+    _frames(std::move(frames)),
+    _sample_rate(sample_rate),
+    _is_paced(is_paced)
+{
+}
+
+std::shared_ptr<replay_source> replay_source::from_samples
+(
+    core::span<const float> samples,
+    std::size_t channels,
+    int input_rate,
+    int mix_rate,
+    bool is_paced
+)
+{
+    if (channels == 0 || input_rate <= 0 || mix_rate <= 0)
+    {
+        return nullptr;
+    }
+
+    auto frame_count = samples.size() / channels;
+    auto output_count = static_cast<std::size_t>
+    (
+        static_cast<double>(frame_count) * static_cast<double>(mix_rate) / static_cast<double>(input_rate)
+    );
+
+    // the resampler's output lags its input, so the end of the audio is pushed out with a little silence
+    std::vector<float> padding(static_cast<std::size_t>(input_rate / 100 + 1), 0.0f);
+
+    std::vector<float> converted[2];
+    std::vector<float> channel(frame_count);
+    for (std::size_t c = 0; c < 2; ++c)
+    {
+        auto source_channel = std::min(c, channels - 1);
+        for (std::size_t i = 0; i < frame_count; ++i)
+        {
+            channel[i] = samples[i * channels + source_channel];
+        }
+
+        core::resampler resampler(input_rate, mix_rate);
+        resampler.process(channel, converted[c]);
+        resampler.process(padding, converted[c]);
+
+        converted[c].resize(output_count, 0.0f);
+    }
+
+    PackedVector2Array frames;
+    frames.resize(static_cast<int64_t>(output_count));
+
+    auto* output = frames.ptrw();
+    for (std::size_t i = 0; i < output_count; ++i)
+    {
+        output[i] = Vector2(converted[0][i], converted[1][i]);
+    }
+
+    return std::make_shared<replay_source>(std::move(frames), mix_rate, is_paced);
+}
+
+PackedVector2Array replay_source::read(steady_clock::time_point now, int64_t max_frames)
+{
+    auto remaining = _frames.size() - _position;
+
+    auto count = std::min(max_frames, remaining);
+    if (_is_paced)
+    {
+        if (!_started_at.has_value())
+        {
+            _started_at = now;
+        }
+
+        auto due = duration<double>(now - *_started_at).count() * static_cast<double>(_sample_rate);
+        count = std::min(static_cast<int64_t>(due) - _position, remaining);
+    }
+
+    if (count <= 0)
+    {
+        return { };
+    }
+
+    auto chunk = _frames.slice(_position, _position + count);
+    _position += count;
+
+    return chunk;
+}
+
+microseconds replay_source::get_audio_time() const
+{
+    return duration_cast<microseconds>
+    (
+        duration<double>(static_cast<double>(_position) / static_cast<double>(_sample_rate))
+    );
+}
+
+bool replay_source::is_exhausted() const
+{
+    return _position >= _frames.size();
+}
+
+bool replay_source::is_paced() const
+{
+    return _is_paced;
+}
+
+void replay_source::finish()
+{
+    _is_finished = true;
+}
+
+bool replay_source::is_finished() const
+{
+    return _is_finished;
+}
@@ -0,0 +1,107 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_REPLAY_SOURCE_H
+#define GDVOSK_REPLAY_SOURCE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include <godot_cpp/variant/packed_vector2_array.hpp>
+
+#include "core/span.h"
+
+namespace gdvosk
+{
+    /**
+     * Represents recorded audio fed to a speech recognizer in place of its capture effect, either paced to real time or
+     * as fast as it can be decoded. The audio is converted up front to the stereo frames at the mix rate a capture
+     * effect would produce, so it goes through exactly the same pipeline as live audio. Read by the background thread
+     * only, apart from the finished flag.
+     */
+    class replay_source final
+    {
+        /**
+         * Holds the audio, as stereo frames at the mix rate.
+         */
+        godot::PackedVector2Array _frames;
+
+        int _sample_rate = 0;
+        bool _is_paced = false;
+
+        /**
+         * Holds the number of frames read so far.
+         */
+        int64_t _position = 0;
+
+        /**
+         * Holds the time of the first paced read.
+         */
+        std::optional<std::chrono::steady_clock::time_point> _started_at;
+
+        std::atomic_bool _is_finished = false;
+
+    public:
+        /**
+         * Initializes a new instance of the replay_source class.
+         * @param frames The audio, as stereo frames at the mix rate.
+         * @param sample_rate The mix rate.
+         * @param is_paced Whether the audio is read at real-time speed.
+         */
+        replay_source(godot::PackedVector2Array frames, int sample_rate, bool is_paced);
+
+        /**
+         * Creates a replay source from interleaved audio of any channel count and sample rate. Mono audio is played on
+         * both channels, and only the first two channels of anything wider are kept.
+         * @param samples The interleaved samples, in the range -1 to 1.
+         * @param channels The number of channels.
+         * @param input_rate The sample rate of the samples.
+         * @param mix_rate The mix rate to convert to.
+         * @param is_paced Whether the audio is read at real-time speed.
+         * @return The source, or nullptr if the format is invalid.
+         */
+        static std::shared_ptr<replay_source> from_samples
+        (
+            core::span<const float> samples,
+            std::size_t channels,
+            int input_rate,
+            int mix_rate,
+            bool is_paced
+        );
+
+        /**
+         * Reads the next chunk of audio. Paced sources return the audio that has become due since the first read;
+         * unpaced sources return up to the given number of frames.
+         * @param now The current time.
+         * @param max_frames The maximum number of frames an unpaced source returns.
+         * @return The frames; empty once every frame has been read.
+         */
+        godot::PackedVector2Array read(std::chrono::steady_clock::time_point now, int64_t max_frames);
+
+        /**
+         * Gets the audio time of the end of the audio read so far.
+         * @return The time.
+         */
+        [[nodiscard]] std::chrono::microseconds get_audio_time() const;
+
+        /**
+         * Gets a value indicating whether every frame has been read.
+         * @return true if the source is exhausted; otherwise, false.
+         */
+        [[nodiscard]] bool is_exhausted() const;
+
+        [[nodiscard]] bool is_paced() const;
+
+        /**
+         * Marks the replay as finished, once its audio has been read and decoded.
+         */
+        void finish();
+
+        [[nodiscard]] bool is_finished() const;
+    };
+}
+
+#endif //GDVOSK_REPLAY_SOURCE_H
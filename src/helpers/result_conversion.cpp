@@ -0,0 +1,87 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "result_conversion.h"
+
+#include <godot_cpp/variant/array.hpp>
+#include <godot_cpp/variant/string.hpp>
+
+#include "core/trace.h"
+
+using namespace godot;
+using namespace gdvosk;
+
+Variant gdvosk::to_variant(const core::json_value& value)
+{
+    switch (value.type)
+    {
+        case core::json_value::kind::boolean:
+        {
+            return value.boolean;
+        }
+        case core::json_value::kind::number:
+        {
+            return value.number;
+        }
+        case core::json_value::kind::string:
+        {
+            return String::utf8(value.string.c_str(), static_cast<int64_t>(value.string.size()));
+        }
+        case core::json_value::kind::array:
+        {
+            Array array;
+            array.resize(static_cast<int64_t>(value.array.size()));
+
+            for (std::size_t i = 0; i < value.array.size(); ++i)
+            {
+                array[static_cast<int64_t>(i)] = to_variant(value.array[i]);
+            }
+
+            return array;
+        }
+        case core::json_value::kind::object:
+        {
+            return to_dictionary(value);
+        }
+        case core::json_value::kind::null:
+        default:
+        {
+            return { };
+        }
+    }
+}
+
+Dictionary gdvosk::to_dictionary(const core::json_value& value)
+{
+    Dictionary dictionary;
+    if (value.type != core::json_value::kind::object)
+    {
+        return dictionary;
+    }
+
+    for (const auto& member : value.object)
+    {
+        auto key = String::utf8(member.key.c_str(), static_cast<int64_t>(member.key.size()));
+        dictionary[key] = to_variant(member.value);
+    }
+
+    return dictionary;
+}
+
+Dictionary gdvosk::parse_result_dictionary(const char* json)
+{
+    if (json == nullptr)
+    {
+        return { };
+    }
+
+    GDVOSK_TRACE_SCOPE("parse_json");
+
+    auto parsed = core::parse_json(json);
+    if (!parsed.has_value())
+    {
+        return { };
+    }
+
+    return to_dictionary(*parsed);
+}
@@ -0,0 +1,37 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_RESULT_CONVERSION_H
+#define GDVOSK_RESULT_CONVERSION_H
+
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/variant.hpp>
+
+#include "core/json.h"
+
+namespace gdvosk
+{
+    /**
+     * Converts a parsed JSON value to the equivalent Godot variant. Numbers are converted to floats, matching the
+     * behaviour of Godot's own JSON parser.
+     * @param value The value.
+     * @return The variant.
+     */
+    [[nodiscard]] godot::Variant to_variant(const core::json_value& value);
+
+    /**
+     * Converts a parsed JSON object to a Godot dictionary.
+     * @param value The value.
+     * @return The dictionary, or an empty dictionary if the value is not an object.
+     */
+    [[nodiscard]] godot::Dictionary to_dictionary(const core::json_value& value);
+
+    /**
+     * Parses a JSON result produced by a Vosk recognizer into a Godot dictionary.
+     * @param json The JSON document.
+     * @return The dictionary, or an empty dictionary if the document is missing, malformed, or not an object.
+     */
+    [[nodiscard]] godot::Dictionary parse_result_dictionary(const char* json);
+}
+
+#endif //GDVOSK_RESULT_CONVERSION_H
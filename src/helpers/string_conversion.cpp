@@ -0,0 +1,25 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "string_conversion.h"
+
+using namespace godot;
+
+std::string gdvosk::to_utf8(const String& value)
+{
+    auto utf8 = value.utf8();
+    return { utf8.get_data(), static_cast<std::size_t>(utf8.length()) };
+}
+
+std::vector<std::string> gdvosk::to_utf8(const PackedStringArray& values)
+{
+    std::vector<std::string> converted;
+    converted.reserve(static_cast<std::size_t>(values.size()));
+
+    for (const auto& value : values)
+    {
+        converted.push_back(to_utf8(value));
+    }
+
+    return converted;
+}
@@ -0,0 +1,30 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef GDVOSK_STRING_CONVERSION_H
+#define GDVOSK_STRING_CONVERSION_H
+
+#include <string>
+#include <vector>
+
+#include <godot_cpp/variant/packed_string_array.hpp>
+#include <godot_cpp/variant/string.hpp>
+
+namespace gdvosk
+{
+    /**
+     * Converts a Godot string to a UTF-8 encoded standard string.
+     * @param value The string.
+     * @return The converted string.
+     */
+    [[nodiscard]] std::string to_utf8(const godot::String& value);
+
+    /**
+     * Converts an array of Godot strings to UTF-8 encoded standard strings.
+     * @param values The strings.
+     * @return The converted strings, in order.
+     */
+    [[nodiscard]] std::vector<std::string> to_utf8(const godot::PackedStringArray& values);
+}
+
+#endif //GDVOSK_STRING_CONVERSION_H
@@ -0,0 +1,29 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "VoskCancellationToken.h"
+
+using namespace godot;
+using namespace gdvosk;
+
+void gdvosk::VoskCancellationToken::cancel()
+{
+    _is_cancelled.store(true, std::memory_order_release);
+}
+
+bool gdvosk::VoskCancellationToken::is_cancelled() const
+{
+    return _is_cancelled.load(std::memory_order_acquire);
+}
+
+void gdvosk::VoskCancellationToken::reset()
+{
+    _is_cancelled.store(false, std::memory_order_release);
+}
+
+void gdvosk::VoskCancellationToken::_bind_methods()
+{
+    ClassDB::bind_method(D_METHOD("cancel"), &VoskCancellationToken::cancel);
+    ClassDB::bind_method(D_METHOD("is_cancelled"), &VoskCancellationToken::is_cancelled);
+    ClassDB::bind_method(D_METHOD("reset"), &VoskCancellationToken::reset);
+}
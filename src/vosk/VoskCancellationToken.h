@@ -0,0 +1,45 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef VOSKCANCELLATIONTOKEN_H
+#define VOSKCANCELLATIONTOKEN_H
+
+#include <atomic>
+
+#include <godot_cpp/classes/ref_counted.hpp>
+
+namespace gdvosk
+{
+    /**
+     * Signals a long-running operation to stop early. The token may be cancelled from any thread while the operation
+     * runs on another.
+     */
+    class VoskCancellationToken final : public godot::RefCounted
+    {
+        GDCLASS(VoskCancellationToken, godot::RefCounted)
+
+        std::atomic_bool _is_cancelled = false;
+
+    public:
+        /**
+         * Requests that the operations observing the token stop.
+         */
+        void cancel();
+
+        /**
+         * Gets a value indicating whether cancellation has been requested.
+         * @return true if the token is cancelled; otherwise, false.
+         */
+        [[nodiscard]] bool is_cancelled() const;
+
+        /**
+         * Clears the cancellation request, so the token can be used again.
+         */
+        void reset();
+
+    protected:
+        static void _bind_methods();
+    };
+}
+
+#endif //VOSKCANCELLATIONTOKEN_H
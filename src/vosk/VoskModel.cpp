@@ -2,24 +2,255 @@
 // SPDX-License-Identifier: MIT
 
 #include "VoskModel.h"
+#include "core/grammar.h"
+#include "core/model_registry.h"
+#include "core/trace.h"
+#include "../helpers/model_files.h"
+#include "../helpers/string_conversion.h"
 
+#include <chrono>
+#include <future>
+#include <string>
+#include <unordered_set>
+
+#include <godot_cpp/classes/file_access.hpp>
 #include <godot_cpp/classes/project_settings.hpp>
 
 using namespace gdvosk;
 using namespace godot;
 
+namespace
+{
+    /**
+     * Holds the directory models are extracted and copied into.
+     */
+    constexpr const char* models_root = "user://gdvosk/models";
+
+    core::decoder_profile to_core_profile(gdvosk::VoskModel::DecoderProfile decoder_profile)
+    {
+        switch (decoder_profile)
+        {
+            case gdvosk::VoskModel::DECODER_PROFILE_FAST:
+            {
+                return core::decoder_profile::fast;
+            }
+            case gdvosk::VoskModel::DECODER_PROFILE_FASTEST:
+            {
+                return core::decoder_profile::fastest;
+            }
+            case gdvosk::VoskModel::DECODER_PROFILE_ACCURATE:
+            {
+                return core::decoder_profile::accurate;
+            }
+            default:
+            {
+                return core::decoder_profile::model_default;
+            }
+        }
+    }
+
+    String get_profile_suffix(gdvosk::VoskModel::LoadProfile profile)
+    {
+        switch (profile)
+        {
+            case gdvosk::VoskModel::LOAD_PROFILE_FAST:
+            {
+                return "@fast";
+            }
+            default:
+            {
+                return "";
+            }
+        }
+    }
+
+    String get_profile_suffix(gdvosk::VoskModel::DecoderProfile decoder_profile)
+    {
+        switch (decoder_profile)
+        {
+            case gdvosk::VoskModel::DECODER_PROFILE_FAST:
+            {
+                return "@fast-search";
+            }
+            case gdvosk::VoskModel::DECODER_PROFILE_FASTEST:
+            {
+                return "@fastest-search";
+            }
+            case gdvosk::VoskModel::DECODER_PROFILE_ACCURATE:
+            {
+                return "@accurate-search";
+            }
+            default:
+            {
+                return "";
+            }
+        }
+    }
+
+    /**
+     * Loads a model to decode with a decoder profile. Vosk only reads the search parameters from the model's
+     * conf/model.conf while loading, so a profile that overrides them loads an overlay of the model with a rewritten
+     * configuration, made in user://gdvosk/models, and the model itself is left untouched. Models in the old layout,
+     * without the file, take their search parameters from elsewhere and are loaded as they are.
+     * @param globalized_path The absolute filesystem path to the model.
+     * @param decoder_profile The profile.
+     * @param loaded_path Receives the absolute filesystem path the model was loaded from.
+     * @return The model, or nullptr if it could not be loaded.
+     */
+    ::VoskModel* load_native_model
+    (
+        const String& globalized_path,
+        gdvosk::VoskModel::DecoderProfile decoder_profile,
+        String& loaded_path
+    )
+    {
+        GDVOSK_TRACE_SCOPE("model_load");
+
+        loaded_path = globalized_path;
+
+        auto settings = core::get_decoder_settings(to_core_profile(decoder_profile));
+        auto config_path = globalized_path.path_join("conf/model.conf");
+
+        if (settings.is_overriding() && FileAccess::file_exists(config_path))
+        {
+            auto config = core::apply_decoder_settings(to_utf8(FileAccess::get_file_as_string(config_path)), settings);
+
+            auto model_name = globalized_path.simplify_path().get_file();
+            auto overlay_path = String(models_root).path_join(model_name + get_profile_suffix(decoder_profile));
+
+            auto overlay = overlay_model
+            (
+                globalized_path,
+                overlay_path,
+                String::utf8(config.data(), static_cast<int64_t>(config.size()))
+            );
+
+            if (overlay != OK)
+            {
+                return nullptr;
+            }
+
+            loaded_path = ProjectSettings::get_singleton()->globalize_path(overlay_path);
+        }
+
+        return vosk_model_new(to_utf8(loaded_path).c_str());
+    }
+}
+
 gdvosk::VoskModel::~VoskModel()
 {
-    if (_model != nullptr)
+    for (auto& load : _variant_loads)
     {
-        vosk_model_free(_model);
-        _model = nullptr;
+        if (load.valid())
+        {
+            load.wait();
+        }
     }
+
+    _vocabulary.reset();
+    publish_model(nullptr);
 }
 
 int gdvosk::VoskModel::find_word(const String& word) const
 {
-    return vosk_model_find_word(_model, word.ascii());
+    auto vocabulary = get_vocabulary_snapshot();
+    if (vocabulary == nullptr)
+    {
+        return -1;
+    }
+
+    return vocabulary->find(to_utf8(word));
+}
+
+PackedInt32Array gdvosk::VoskModel::find_words(const PackedStringArray& words) const
+{
+    PackedInt32Array symbols;
+    symbols.resize(words.size());
+
+    auto vocabulary = get_vocabulary_snapshot();
+    auto* output = symbols.ptrw();
+
+    for (int64_t i = 0; i < words.size(); ++i)
+    {
+        output[i] = vocabulary != nullptr ? vocabulary->find(to_utf8(words[i])) : -1;
+    }
+
+    return symbols;
+}
+
+PackedStringArray gdvosk::VoskModel::get_vocabulary() const
+{
+    PackedStringArray words;
+
+    auto vocabulary = get_vocabulary_snapshot();
+    if (vocabulary == nullptr)
+    {
+        return words;
+    }
+
+    auto known_words = vocabulary->get_words();
+    words.resize(static_cast<int64_t>(known_words.size()));
+
+    auto* output = words.ptrw();
+    for (std::size_t i = 0; i < known_words.size(); ++i)
+    {
+        output[i] = String::utf8(known_words[i].data(), static_cast<int64_t>(known_words[i].size()));
+    }
+
+    return words;
+}
+
+PackedStringArray gdvosk::VoskModel::filter_grammar(const PackedStringArray& grammar) const
+{
+    PackedStringArray filtered;
+
+    auto vocabulary = get_vocabulary_snapshot();
+    if (vocabulary == nullptr)
+    {
+        return filtered;
+    }
+
+    for (const auto& phrase : grammar)
+    {
+        if (vocabulary->contains_phrase(to_utf8(phrase)))
+        {
+            filtered.push_back(phrase);
+        }
+    }
+
+    return filtered;
+}
+
+PackedStringArray gdvosk::VoskModel::find_unknown_words(const PackedStringArray& grammar) const
+{
+    PackedStringArray unknown_words;
+
+    auto vocabulary = get_vocabulary_snapshot();
+    if (vocabulary == nullptr)
+    {
+        return unknown_words;
+    }
+
+    // grammars repeat words across phrases a lot, so each word is only looked up once
+    std::unordered_set<std::string> seen_words;
+    for (const auto& phrase : grammar)
+    {
+        auto text = to_utf8(phrase);
+        for (auto word : core::split_words(text))
+        {
+            if (word == core::unknown_word || !seen_words.emplace(word).second)
+            {
+                continue;
+            }
+
+            if (vocabulary->find(word) < 0)
+            {
+                unknown_words.push_back(String::utf8(word.data(), static_cast<int64_t>(word.size())));
+            }
+        }
+    }
+
+    return unknown_words;
 }
 
 Error gdvosk::VoskModel::load(const String& path)
@@ -30,28 +261,546 @@ Error gdvosk::VoskModel::load(const String& path)
         return ERR_FILE_BAD_PATH;
     }
 
-    auto model = vosk_model_new(globalized_path.ascii());
+    auto error = load_directory(globalized_path);
+    if (error == OK)
+    {
+        _load_profile = LOAD_PROFILE_ACCURATE;
+    }
+
+    return error;
+}
+
+Error gdvosk::VoskModel::load_directory(const String& globalized_path)
+{
+    String loaded_path;
+
+    auto model = load_native_model(globalized_path, _decoder_profile, loaded_path);
     if (model == nullptr)
     {
         return ERR_FILE_CORRUPT;
     }
 
-    if (_model != nullptr)
     {
-        vosk_model_free(_model);
+        // the vocabulary may fall back to the old model, so it goes first
+        std::lock_guard lock(_vocabulary_mutex);
+        _vocabulary.reset();
+        _vocabulary_model = nullptr;
     }
 
-    _model = model;
+    auto size = get_directory_size(globalized_path);
+
+    auto loaded = std::make_shared<loaded_model>();
+    loaded->handle = core::model_registry::shared().add(to_utf8(loaded_path), model, size);
+    loaded->path = globalized_path;
+    loaded->fingerprint = to_utf8(get_model_fingerprint(globalized_path));
+    loaded->decoder_profile = _decoder_profile;
+
+    publish_model(std::move(loaded));
+
     return OK;
 }
 
+Error gdvosk::VoskModel::load_with_profile(const String& path, LoadProfile profile, DecoderProfile decoder_profile)
+{
+    auto previous_decoder_profile = _decoder_profile;
+    _decoder_profile = decoder_profile;
+
+    auto error = load_components(path, profile);
+    if (error != OK)
+    {
+        _decoder_profile = previous_decoder_profile;
+    }
+
+    return error;
+}
+
+Error gdvosk::VoskModel::load_components(const String& path, LoadProfile profile)
+{
+    auto skipped_components = get_skipped_components(profile);
+    auto is_archive = path.get_extension() == "vosk";
+
+    if (!is_archive && skipped_components.is_empty())
+    {
+        return load(path);
+    }
+
+    auto model_name = is_archive ? path.get_file().get_basename() : path.simplify_path().get_file();
+    if (model_name.is_empty())
+    {
+        return ERR_FILE_BAD_PATH;
+    }
+
+    // an earlier copy is reused only while it is complete and its source is unchanged
+    auto model_path = String(models_root).path_join(model_name + get_profile_suffix(profile));
+    auto prepare = is_archive
+        ? extract_model(path, model_path, skipped_components)
+        : copy_model(path, model_path, skipped_components);
+
+    if (prepare != OK)
+    {
+        return prepare;
+    }
+
+    auto error = load(model_path);
+    if (error == OK)
+    {
+        _load_profile = profile;
+    }
+
+    return error;
+}
+
+gdvosk::VoskModel::LoadProfile gdvosk::VoskModel::get_load_profile() const
+{
+    return _load_profile;
+}
+
+Dictionary gdvosk::VoskModel::get_component_sizes() const
+{
+    auto loaded = get_loaded_model();
+    if (loaded == nullptr)
+    {
+        return {};
+    }
+
+    return gdvosk::get_component_sizes(loaded->path);
+}
+
+Error gdvosk::VoskModel::set_decoder_profile(DecoderProfile decoder_profile)
+{
+    if (decoder_profile == _decoder_profile)
+    {
+        return OK;
+    }
+
+    auto previous_decoder_profile = _decoder_profile;
+    _decoder_profile = decoder_profile;
+
+    auto loaded = get_loaded_model();
+    if (loaded == nullptr)
+    {
+        return OK;
+    }
+
+    auto error = load_directory(loaded->path);
+    if (error != OK)
+    {
+        _decoder_profile = previous_decoder_profile;
+    }
+
+    return error;
+}
+
+gdvosk::VoskModel::DecoderProfile gdvosk::VoskModel::get_decoder_profile() const
+{
+    return _decoder_profile;
+}
+
+Error gdvosk::VoskModel::prepare_decoder_profile(DecoderProfile decoder_profile)
+{
+    if (get_loaded_model() == nullptr)
+    {
+        return ERR_UNCONFIGURED;
+    }
+
+    return get_ptr(decoder_profile) != nullptr ? OK : ERR_FILE_CORRUPT;
+}
+
+PackedStringArray gdvosk::VoskModel::get_skipped_components(LoadProfile profile)
+{
+    switch (profile)
+    {
+        case LOAD_PROFILE_FAST:
+        {
+            return { "rescore", "rnnlm" };
+        }
+        default:
+        {
+            return {};
+        }
+    }
+}
+
+Error gdvosk::VoskModel::ensure_resident()
+{
+    if (get_loaded_model() == nullptr)
+    {
+        return ERR_UNCONFIGURED;
+    }
+
+    return get_ptr() != nullptr ? OK : ERR_FILE_CORRUPT;
+}
+
+bool gdvosk::VoskModel::is_resident() const
+{
+    auto loaded = get_loaded_model();
+    return loaded != nullptr && core::model_registry::shared().get_statistics(loaded->handle).is_resident;
+}
+
+Dictionary gdvosk::VoskModel::get_memory_statistics() const
+{
+    auto loaded = get_loaded_model();
+    auto statistics = core::model_registry::shared().get_statistics(loaded != nullptr ? loaded->handle : 0);
+
+    Dictionary dictionary;
+    dictionary["resident"] = statistics.is_resident;
+    dictionary["size"] = static_cast<int64_t>(statistics.size);
+    dictionary["evictions"] = static_cast<int64_t>(statistics.evictions);
+    dictionary["reloads"] = static_cast<int64_t>(statistics.reloads);
+    dictionary["recognizers"] = static_cast<int64_t>(statistics.recognizers);
+
+    return dictionary;
+}
+
+void gdvosk::VoskModel::set_memory_budget(int64_t budget)
+{
+    core::model_registry::shared().set_budget(static_cast<uint64_t>(Math::max<int64_t>(budget, 0)));
+}
+
+int64_t gdvosk::VoskModel::get_memory_budget()
+{
+    return static_cast<int64_t>(core::model_registry::shared().get_budget());
+}
+
+void gdvosk::VoskModel::set_idle_eviction_delay(double delay)
+{
+    auto idle_delay = std::chrono::duration<double>(Math::max(delay, 0.0));
+    core::model_registry::shared().set_idle_delay
+    (
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(idle_delay)
+    );
+}
+
+double gdvosk::VoskModel::get_idle_eviction_delay()
+{
+    return std::chrono::duration<double>(core::model_registry::shared().get_idle_delay()).count();
+}
+
+int64_t gdvosk::VoskModel::get_resident_memory()
+{
+    return static_cast<int64_t>(core::model_registry::shared().get_resident_size());
+}
+
+int gdvosk::VoskModel::trim_models()
+{
+    return static_cast<int>(core::model_registry::shared().trim());
+}
+
 ::VoskModel* gdvosk::VoskModel::get_ptr() const
 {
-    return _model;
+    auto loaded = get_loaded_model();
+    return loaded != nullptr ? core::model_registry::shared().use(loaded->handle) : nullptr;
+}
+
+::VoskModel* gdvosk::VoskModel::get_ptr(DecoderProfile decoder_profile) const
+{
+    auto handle = get_handle(decoder_profile);
+    return handle != 0 ? core::model_registry::shared().use(handle) : nullptr;
+}
+
+core::model_lease gdvosk::VoskModel::lease(DecoderProfile decoder_profile) const
+{
+    auto handle = get_handle(decoder_profile);
+    return handle != 0 ? core::model_registry::shared().lease(handle) : core::model_lease();
+}
+
+core::model_lease gdvosk::VoskModel::lease_if_ready(DecoderProfile decoder_profile) const
+{
+    auto loaded = get_loaded_model();
+    if (loaded == nullptr || decoder_profile < DECODER_PROFILE_DEFAULT || decoder_profile > DECODER_PROFILE_ACCURATE)
+    {
+        return {};
+    }
+
+    if (decoder_profile == DECODER_PROFILE_DEFAULT || decoder_profile == loaded->decoder_profile)
+    {
+        auto lease = core::model_registry::shared().try_lease(loaded->handle);
+        if (lease.get() != nullptr)
+        {
+            return lease;
+        }
+    }
+
+    std::lock_guard lock(_variants_mutex);
+
+    loaded = get_loaded_model();
+    if (loaded == nullptr)
+    {
+        return {};
+    }
+
+    // the model's own profile is loaded as the model itself, which has the default slot among the copies to itself
+    if (decoder_profile == loaded->decoder_profile)
+    {
+        decoder_profile = DECODER_PROFILE_DEFAULT;
+    }
+
+    if (_variant_failures[decoder_profile])
+    {
+        return {};
+    }
+
+    auto handle = decoder_profile == DECODER_PROFILE_DEFAULT ? loaded->handle : _variant_handles[decoder_profile];
+    auto lease = handle != 0 ? core::model_registry::shared().try_lease(handle) : core::model_lease();
+    if (lease.get() == nullptr)
+    {
+        start_variant_load(decoder_profile, loaded);
+    }
+
+    return lease;
+}
+
+std::uint64_t gdvosk::VoskModel::get_handle(DecoderProfile decoder_profile) const
+{
+    auto loaded = get_loaded_model();
+    if (loaded == nullptr || decoder_profile < DECODER_PROFILE_DEFAULT || decoder_profile > DECODER_PROFILE_ACCURATE)
+    {
+        return 0;
+    }
+
+    if (decoder_profile == DECODER_PROFILE_DEFAULT || decoder_profile == loaded->decoder_profile)
+    {
+        return loaded->handle;
+    }
+
+    // a load that was under way may have been for a model that has since been replaced, and is then started over
+    while (true)
+    {
+        std::shared_future<void> load;
+        {
+            std::lock_guard lock(_variants_mutex);
+
+            // the copies belong to whichever model is loaded by the time the lock is held
+            loaded = get_loaded_model();
+            if (loaded == nullptr || _variant_failures[decoder_profile])
+            {
+                return 0;
+            }
+
+            if (decoder_profile == loaded->decoder_profile)
+            {
+                return loaded->handle;
+            }
+
+            if (_variant_handles[decoder_profile] != 0)
+            {
+                return _variant_handles[decoder_profile];
+            }
+
+            load = start_variant_load(decoder_profile, loaded);
+        }
+
+        load.wait();
+    }
+}
+
+std::shared_future<void> gdvosk::VoskModel::start_variant_load
+(
+    DecoderProfile decoder_profile,
+    std::shared_ptr<const loaded_model> loaded
+) const
+{
+    auto& load = _variant_loads[decoder_profile];
+    if (load.valid() && load.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+        return load;
+    }
+
+    // the model waits for its loads when it's destroyed, so they can't outlive it
+    load = std::async
+    (
+        std::launch::async,
+        [this, decoder_profile, loaded = std::move(loaded)]
+        {
+            load_variant(decoder_profile, loaded);
+        }
+    ).share();
+
+    return load;
+}
+
+void gdvosk::VoskModel::load_variant
+(
+    DecoderProfile decoder_profile,
+    const std::shared_ptr<const loaded_model>& loaded
+) const
+{
+    std::uint64_t handle;
+    {
+        std::lock_guard lock(_variants_mutex);
+        if (get_loaded_model() != loaded || _variant_failures[decoder_profile])
+        {
+            return;
+        }
+
+        handle = decoder_profile == DECODER_PROFILE_DEFAULT ? loaded->handle : _variant_handles[decoder_profile];
+    }
+
+    if (handle != 0)
+    {
+        // the model or the copy was evicted, and is loaded again as any other model would be
+        core::model_registry::shared().use(handle);
+        return;
+    }
+
+    String loaded_path;
+    auto* model = load_native_model(loaded->path, decoder_profile, loaded_path);
+
+    {
+        std::lock_guard lock(_variants_mutex);
+        if (get_loaded_model() == loaded && _variant_handles[decoder_profile] == 0)
+        {
+            if (model == nullptr)
+            {
+                _variant_failures[decoder_profile] = true;
+                return;
+            }
+
+            // the copy differs from the model only in how it searches, so it takes up as much memory
+            auto size = core::model_registry::shared().get_statistics(loaded->handle).size;
+
+            _variant_handles[decoder_profile] = core::model_registry::shared().add(to_utf8(loaded_path), model, size);
+            return;
+        }
+    }
+
+    // the model was replaced in the meantime
+    if (model != nullptr)
+    {
+        vosk_model_free(model);
+    }
+}
+
+void gdvosk::VoskModel::publish_model(std::shared_ptr<const loaded_model> loaded)
+{
+    std::shared_ptr<const loaded_model> previous;
+    decltype(_variant_handles) variant_handles;
+    {
+        std::lock_guard lock(_variants_mutex);
+
+        previous = std::atomic_exchange(&_loaded, std::move(loaded));
+
+        variant_handles = _variant_handles;
+        _variant_handles.fill(0);
+        _variant_failures.fill(false);
+    }
+
+    for (auto handle : variant_handles)
+    {
+        if (handle != 0)
+        {
+            core::model_registry::shared().remove(handle);
+        }
+    }
+
+    if (previous != nullptr)
+    {
+        core::model_registry::shared().remove(previous->handle);
+    }
+}
+
+std::shared_ptr<const gdvosk::VoskModel::loaded_model> gdvosk::VoskModel::get_loaded_model() const
+{
+    return std::atomic_load(&_loaded);
+}
+
+std::shared_ptr<const core::vocabulary> gdvosk::VoskModel::get_vocabulary_snapshot() const
+{
+    std::lock_guard lock(_vocabulary_mutex);
+
+    // a symbol table answers lookups by itself, so the model needn't be resident for them
+    if (_vocabulary != nullptr && _vocabulary->has_symbol_table())
+    {
+        return _vocabulary;
+    }
+
+    auto loaded = get_loaded_model();
+    auto* model = loaded != nullptr ? core::model_registry::shared().use(loaded->handle) : nullptr;
+    if (model == nullptr)
+    {
+        return nullptr;
+    }
+
+    if (_vocabulary == nullptr || _vocabulary_model != model)
+    {
+        _vocabulary = core::vocabulary::load(model, to_utf8(loaded->path));
+        _vocabulary_model = model;
+    }
+
+    return _vocabulary;
 }
 
 void gdvosk::VoskModel::_bind_methods()
 {
     ClassDB::bind_method(D_METHOD("find_word", "word"), &VoskModel::find_word);
+    ClassDB::bind_method(D_METHOD("find_words", "words"), &VoskModel::find_words);
+    ClassDB::bind_method(D_METHOD("get_vocabulary"), &VoskModel::get_vocabulary);
+    ClassDB::bind_method(D_METHOD("filter_grammar", "grammar"), &VoskModel::filter_grammar);
+    ClassDB::bind_method(D_METHOD("find_unknown_words", "grammar"), &VoskModel::find_unknown_words);
     ClassDB::bind_method(D_METHOD("load", "path"), &VoskModel::load);
+    ClassDB::bind_method
+    (
+        D_METHOD("load_with_profile", "path", "profile", "decoder_profile"),
+        &VoskModel::load_with_profile,
+        DEFVAL(DECODER_PROFILE_DEFAULT)
+    );
+    ClassDB::bind_method(D_METHOD("get_load_profile"), &VoskModel::get_load_profile);
+    ClassDB::bind_method(D_METHOD("get_component_sizes"), &VoskModel::get_component_sizes);
+    ClassDB::bind_method(D_METHOD("set_decoder_profile", "decoder_profile"), &VoskModel::set_decoder_profile);
+    ClassDB::bind_method(D_METHOD("get_decoder_profile"), &VoskModel::get_decoder_profile);
+    ClassDB::bind_method
+    (
+        D_METHOD("prepare_decoder_profile", "decoder_profile"),
+        &VoskModel::prepare_decoder_profile
+    );
+    ClassDB::bind_method(D_METHOD("ensure_resident"), &VoskModel::ensure_resident);
+    ClassDB::bind_method(D_METHOD("is_resident"), &VoskModel::is_resident);
+    ClassDB::bind_method(D_METHOD("get_memory_statistics"), &VoskModel::get_memory_statistics);
+
+    ClassDB::bind_static_method
+    (
+        get_class_static(),
+        D_METHOD("set_memory_budget", "budget"),
+        &VoskModel::set_memory_budget
+    );
+
+    ClassDB::bind_static_method(get_class_static(), D_METHOD("get_memory_budget"), &VoskModel::get_memory_budget);
+
+    ClassDB::bind_static_method
+    (
+        get_class_static(),
+        D_METHOD("set_idle_eviction_delay", "delay"),
+        &VoskModel::set_idle_eviction_delay
+    );
+
+    ClassDB::bind_static_method
+    (
+        get_class_static(),
+        D_METHOD("get_idle_eviction_delay"),
+        &VoskModel::get_idle_eviction_delay
+    );
+
+    ClassDB::bind_static_method
+    (
+        get_class_static(),
+        D_METHOD("get_resident_memory"),
+        &VoskModel::get_resident_memory
+    );
+
+    ClassDB::bind_static_method(get_class_static(), D_METHOD("trim_models"), &VoskModel::trim_models);
+
+    ClassDB::bind_static_method
+    (
+        get_class_static(),
+        D_METHOD("get_skipped_components", "profile"),
+        &VoskModel::get_skipped_components
+    );
+
+    BIND_ENUM_CONSTANT(LOAD_PROFILE_ACCURATE)
+    BIND_ENUM_CONSTANT(LOAD_PROFILE_FAST)
+
+    BIND_ENUM_CONSTANT(DECODER_PROFILE_DEFAULT)
+    BIND_ENUM_CONSTANT(DECODER_PROFILE_FAST)
+    BIND_ENUM_CONSTANT(DECODER_PROFILE_FASTEST)
+    BIND_ENUM_CONSTANT(DECODER_PROFILE_ACCURATE)
 }
@@ -4,12 +4,27 @@
 #ifndef VOSKMODEL_H
 #define VOSKMODEL_H
 
+#include <array>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+
 #include <godot_cpp/classes/resource.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/packed_int32_array.hpp>
+#include <godot_cpp/variant/packed_string_array.hpp>
 #include <vosk_api.h>
 
+#include "core/decoder_settings.h"
+#include "core/model_registry.h"
+#include "core/vocabulary.h"
+
 namespace gdvosk
 {
     class VoskRecognizer;
+    class SpeechRecognizer;
 
     /**
      * Represents a Vosk language model as a Godot resource.
@@ -19,11 +34,134 @@ namespace gdvosk
         GDCLASS(VoskModel, godot::Resource)
 
         friend class gdvosk::VoskRecognizer;
+        friend class gdvosk::SpeechRecognizer;
+
+    public:
+        /**
+         * Represents the sets of model components that can be loaded. Vosk loads the optional components of a model
+         * whenever their files are present, so profiles that leave components out load a copy of the model without
+         * them.
+         */
+        enum LoadProfile
+        {
+            /**
+             * Load every component of the model.
+             */
+            LOAD_PROFILE_ACCURATE,
+
+            /**
+             * Leave out the rescoring components (the "rescore" and "rnnlm" directories), which take up about as much
+             * memory and load time as the rest of the model in larger models, at some cost in accuracy.
+             */
+            LOAD_PROFILE_FAST,
+        };
+
+        /**
+         * Represents the named trade-offs between decoding speed and accuracy, which override the decoder search
+         * parameters (beam, max-active, min-active and lattice-beam) in the model's conf/model.conf.
+         */
+        enum DecoderProfile
+        {
+            /**
+             * Search as configured by the model's packager. For recognizers, search as the model was loaded.
+             */
+            DECODER_PROFILE_DEFAULT,
+
+            /**
+             * Search a narrower beam, for roughly half the decoding work of a typical large model's configuration.
+             */
+            DECODER_PROFILE_FAST,
+
+            /**
+             * Search a very narrow beam. Only suited to small grammars, such as voice commands.
+             */
+            DECODER_PROFILE_FASTEST,
+
+            /**
+             * Search a wider beam and keep a deeper lattice, for the best accuracy at a considerably higher cost.
+             */
+            DECODER_PROFILE_ACCURATE,
+        };
+
+    private:
+
+        /**
+         * Represents a loaded model. Recognizers read it from their own threads while the model may be loaded again
+         * on the main thread, so it's replaced as a whole rather than changed.
+         */
+        struct loaded_model
+        {
+            /**
+             * Holds the handle of the underlying model in the shared model registry.
+             */
+            std::uint64_t handle = 0;
+
+            /**
+             * Holds the absolute filesystem path the model was loaded from, which identifies it across runs.
+             */
+            godot::String path;
+
+            /**
+             * Holds the fingerprint of the model's files, taken when it was loaded, which tells apart the different
+             * models that have been at the same path.
+             */
+            std::string fingerprint;
+
+            /**
+             * Holds the decoder profile the model was loaded with.
+             */
+            DecoderProfile decoder_profile = DECODER_PROFILE_DEFAULT;
+        };
+
+        /**
+         * Holds the loaded model, or nullptr if no model has been loaded. Only accessed atomically.
+         */
+        std::shared_ptr<const loaded_model> _loaded;
+
+        /**
+         * Holds the profile the model was loaded with.
+         */
+        LoadProfile _load_profile = LOAD_PROFILE_ACCURATE;
+
+        /**
+         * Holds the decoder profile the model is loaded with.
+         */
+        DecoderProfile _decoder_profile = DECODER_PROFILE_DEFAULT;
+
+        /**
+         * Guards the copies of the model loaded for other decoder profiles, and the replacement of the loaded model,
+         * which they belong to.
+         */
+        mutable std::mutex _variants_mutex;
+
+        /**
+         * Holds, by decoder profile, the handles of the copies of the model loaded for recognizers that decode with a
+         * profile other than the model's own, or zero where none has been loaded.
+         */
+        mutable std::array<std::uint64_t, DECODER_PROFILE_ACCURATE + 1> _variant_handles {};
 
         /**
-         * Holds the underlying pointer to the model.
+         * Holds, by decoder profile, whether a copy of the model could not be loaded, so it isn't retried.
          */
-        ::VoskModel* _model = nullptr;
+        mutable std::array<bool, DECODER_PROFILE_ACCURATE + 1> _variant_failures {};
+
+        /**
+         * Holds, by decoder profile, the latest load of a copy of the model in the background; for the default
+         * profile, that of the model itself, after it was evicted.
+         */
+        mutable std::array<std::shared_future<void>, DECODER_PROFILE_ACCURATE + 1> _variant_loads;
+
+        mutable std::mutex _vocabulary_mutex;
+
+        /**
+         * Holds the vocabulary of the model, read the first time it's needed.
+         */
+        mutable std::shared_ptr<const core::vocabulary> _vocabulary;
+
+        /**
+         * Holds the native model the vocabulary falls back to for lookups.
+         */
+        mutable ::VoskModel* _vocabulary_model = nullptr;
 
     public:
         /**
@@ -38,6 +176,36 @@ namespace gdvosk
          */
         [[nodiscard]] int find_word(const godot::String& word) const;
 
+        /**
+         * Searches the model for several words at once.
+         * @param words The words to search for.
+         * @return The symbol in the model for each word, in order, or -1 for words that do not exist in the model.
+         */
+        [[nodiscard]] godot::PackedInt32Array find_words(const godot::PackedStringArray& words) const;
+
+        /**
+         * Gets the words the model can recognize. The vocabulary is read from the model's symbol table, which small
+         * models may not ship; their vocabulary can only be searched.
+         * @return The words, in symbol order, or an empty array if the model has no readable symbol table.
+         */
+        [[nodiscard]] godot::PackedStringArray get_vocabulary() const;
+
+        /**
+         * Filters a grammar down to the phrases the model can recognize. Vosk silently drops unknown words from a
+         * grammar, which turns the phrases containing them into different phrases; this drops the phrases instead.
+         * The unknown word marker "[unk]" is kept.
+         * @param grammar The grammar.
+         * @return The phrases made up of known words only, in order.
+         */
+        [[nodiscard]] godot::PackedStringArray filter_grammar(const godot::PackedStringArray& grammar) const;
+
+        /**
+         * Validates a grammar against the model.
+         * @param grammar The grammar.
+         * @return The words of the grammar the model does not know, each once, in order of first appearance.
+         */
+        [[nodiscard]] godot::PackedStringArray find_unknown_words(const godot::PackedStringArray& grammar) const;
+
         /**
          * Loads a model from the given path. Vosk only supports on-disk models as a tree of model files, and as such
          * this path must either be an absolute filesystem path or a user:// resource URI.
@@ -46,16 +214,233 @@ namespace gdvosk
          */
         godot::Error load(const godot::String& path);
 
+        /**
+         * Loads a model with the components of a load profile. Profiles that leave components out load a copy of the
+         * model without them, which is made in user://gdvosk/models the first time the model is loaded with the
+         * profile and reused after that.
+         * @param path The path to the model; either a directory, as for load, or a .vosk archive, which is extracted
+         * into user://gdvosk/models.
+         * @param profile The profile.
+         * @param decoder_profile The decoder profile to load the model with.
+         * @return The result of the operation.
+         */
+        godot::Error load_with_profile
+        (
+            const godot::String& path,
+            LoadProfile profile,
+            DecoderProfile decoder_profile = DECODER_PROFILE_DEFAULT
+        );
+
+        /**
+         * Gets the profile the model was loaded with.
+         * @return The profile.
+         */
+        [[nodiscard]] LoadProfile get_load_profile() const;
+
+        /**
+         * Gets the size of each component of the loaded model on disk, which is roughly the memory it takes up once
+         * loaded.
+         * @return A dictionary mapping the name of each top-level directory and file of the model to its size, in
+         * bytes, or an empty dictionary if no model has been loaded.
+         */
+        [[nodiscard]] godot::Dictionary get_component_sizes() const;
+
+        /**
+         * Gets the components a load profile leaves out.
+         * @param profile The profile.
+         * @return The names of the top-level directories and files of a model that are left out.
+         */
+        [[nodiscard]] static godot::PackedStringArray get_skipped_components(LoadProfile profile);
+
+        /**
+         * Sets the decoder profile the model is loaded with, loading it again if it has been loaded already. Vosk only
+         * reads the search parameters while loading a model, so this takes as long as the first load did.
+         * Recognizers created from then on decode with the profile, while existing ones keep the previous one.
+         * @param decoder_profile The profile.
+         * @return The result of the operation.
+         */
+        godot::Error set_decoder_profile(DecoderProfile decoder_profile);
+        [[nodiscard]] DecoderProfile get_decoder_profile() const;
+
+        /**
+         * Loads the copy of the model that recognizers with the given decoder profile decode with, ahead of their
+         * first use. Each profile other than the model's own needs a copy of its own, which takes up as much memory
+         * as the model itself and is subject to the memory budget like any other model. This may take a while and can
+         * be called from a background thread.
+         * @param decoder_profile The profile.
+         * @return ERR_UNCONFIGURED if no model has been loaded, ERR_FILE_CORRUPT if the copy could not be loaded, and
+         * OK otherwise.
+         */
+        godot::Error prepare_decoder_profile(DecoderProfile decoder_profile);
+
+        /**
+         * Loads the native model again ahead of its next use if it was evicted to stay within the memory budget, so
+         * that the next recognizer set up with it doesn't wait for it. This may take a while and can be called from a
+         * background thread.
+         * @return ERR_UNCONFIGURED if no model has been loaded, ERR_FILE_CORRUPT if the model could not be loaded
+         * again, and OK otherwise.
+         */
+        godot::Error ensure_resident();
+
+        /**
+         * Gets a value indicating whether the native model is loaded, rather than evicted.
+         * @return true if the model is resident; otherwise, false.
+         */
+        [[nodiscard]] bool is_resident() const;
+
+        /**
+         * Gets statistics about the residency of the model.
+         * @return A dictionary with the keys "resident", "size" (the estimated memory the native model takes up while
+         * loaded, in bytes, based on the size of its files), "evictions", "reloads" and "recognizers" (the number of
+         * native recognizers alive for the model).
+         */
+        [[nodiscard]] godot::Dictionary get_memory_statistics() const;
+
+        /**
+         * Sets the memory the resident models may take up together. When they take up more, the least recently used
+         * models that have been idle for the idle eviction delay and have no recognizers decoding with them are
+         * freed, and loaded again on their next use. Idle recognizers kept in the shared pool for an evicted model are
+         * destroyed along with it.
+         * @param budget The budget, in bytes, or zero for no limit.
+         */
+        static void set_memory_budget(int64_t budget);
+
+        /**
+         * Gets the memory the resident models may take up together.
+         * @return The budget, in bytes, or zero for no limit.
+         */
+        [[nodiscard]] static int64_t get_memory_budget();
+
+        /**
+         * Sets the time a model must go unused before it may be evicted.
+         * @param delay The delay, in seconds; at least one.
+         */
+        static void set_idle_eviction_delay(double delay);
+
+        /**
+         * Gets the time a model must go unused before it may be evicted.
+         * @return The delay, in seconds.
+         */
+        [[nodiscard]] static double get_idle_eviction_delay();
+
+        /**
+         * Gets the estimated memory the resident models take up together.
+         * @return The size, in bytes.
+         */
+        [[nodiscard]] static int64_t get_resident_memory();
+
+        /**
+         * Evicts idle models until the resident ones fit the memory budget. This happens by itself whenever a model
+         * is loaded or used, but models only become idle with time.
+         * @return The number of models evicted.
+         */
+        static int trim_models();
+
     protected:
         static void _bind_methods();
 
     private:
         /**
-         * Gets the underlying pointer to the model.
-         * @return The pointer.
+         * Gets the underlying pointer to the model, loading the model again if it was evicted, and marks it as used.
+         * @return The pointer, or nullptr if no model has been loaded or it could not be loaded again.
          */
         [[nodiscard]] ::VoskModel* get_ptr() const;
+
+        /**
+         * Gets the underlying pointer to the model to decode with the given decoder profile, loading a copy of the
+         * model with the profile if it differs from the model's own, and marks it as used.
+         * @param decoder_profile The profile.
+         * @return The pointer, or nullptr if no model has been loaded or it could not be loaded with the profile.
+         */
+        [[nodiscard]] ::VoskModel* get_ptr(DecoderProfile decoder_profile) const;
+
+        /**
+         * Gets the underlying pointer to the model to decode with the given decoder profile like get_ptr, and keeps
+         * the model from being evicted for as long as the returned lease lives. Recognizers must only be created from
+         * a leased model.
+         * @param decoder_profile The profile.
+         * @return The lease, which is empty if no model has been loaded or it could not be loaded with the profile.
+         */
+        [[nodiscard]] core::model_lease lease(DecoderProfile decoder_profile = DECODER_PROFILE_DEFAULT) const;
+
+        /**
+         * Leases the model to decode with the given decoder profile like lease, but without waiting for the model, or
+         * the copy of it with the profile, to be loaded. If it isn't resident, because it was evicted or hasn't been
+         * loaded yet, it's loaded in the background instead, and is leased by a later call once it is. Safe to call
+         * from threads that mustn't block, such as the background thread of a SpeechRecognizer.
+         * @param decoder_profile The profile.
+         * @return The lease, which is empty if no model has been loaded, the copy isn't resident yet, or it could not
+         * be loaded.
+         */
+        [[nodiscard]] core::model_lease lease_if_ready(DecoderProfile decoder_profile) const;
+
+        /**
+         * Gets the handle of the model to decode with the given decoder profile in the shared model registry, loading
+         * a copy of the model with the profile if it differs from the model's own, and waiting for it to be loaded.
+         * @param decoder_profile The profile.
+         * @return The handle, or zero if no model has been loaded or it could not be loaded with the profile.
+         */
+        [[nodiscard]] std::uint64_t get_handle(DecoderProfile decoder_profile) const;
+
+        /**
+         * Starts loading the copy of a model for a decoder profile in the background, or loading it again if it was
+         * evicted, unless that is already under way. Must be called with the variants mutex held.
+         * @param decoder_profile The profile, or the default one to load the model itself again.
+         * @param loaded The model to load a copy of.
+         * @return The load.
+         */
+        std::shared_future<void> start_variant_load
+        (
+            DecoderProfile decoder_profile,
+            std::shared_ptr<const loaded_model> loaded
+        ) const;
+
+        /**
+         * Loads the copy of a model for a decoder profile, or loads it again if it was evicted. The variants mutex is
+         * not held while loading, and a copy of a model that has since been replaced is discarded.
+         * @param decoder_profile The profile, or the default one to load the model itself again.
+         * @param loaded The model to load a copy of.
+         */
+        void load_variant(DecoderProfile decoder_profile, const std::shared_ptr<const loaded_model>& loaded) const;
+
+        /**
+         * Loads the model in the given directory with the current decoder profile, replacing the loaded one.
+         * @param globalized_path The absolute filesystem path to the model.
+         * @return The result of the operation.
+         */
+        godot::Error load_directory(const godot::String& globalized_path);
+
+        /**
+         * Loads a model with the components of a load profile and the current decoder profile. See load_with_profile.
+         * @param path The path to the model.
+         * @param profile The profile.
+         * @return The result of the operation.
+         */
+        godot::Error load_components(const godot::String& path, LoadProfile profile);
+
+        /**
+         * Replaces the loaded model, freeing the previous one along with the copies of it loaded for other decoder
+         * profiles.
+         * @param loaded The model, or nullptr to only free the previous one.
+         */
+        void publish_model(std::shared_ptr<const loaded_model> loaded);
+
+        /**
+         * Gets the loaded model.
+         * @return The model, or nullptr if no model has been loaded.
+         */
+        [[nodiscard]] std::shared_ptr<const loaded_model> get_loaded_model() const;
+
+
+        /**
+         * Gets the vocabulary of the model, reading it if it hasn't been yet.
+         * @return The vocabulary, or nullptr if no model has been loaded.
+         */
+        [[nodiscard]] std::shared_ptr<const core::vocabulary> get_vocabulary_snapshot() const;
     };
 }
 
+VARIANT_ENUM_CAST(gdvosk::VoskModel::LoadProfile);
+VARIANT_ENUM_CAST(gdvosk::VoskModel::DecoderProfile);
+
 #endif //VOSKMODEL_H
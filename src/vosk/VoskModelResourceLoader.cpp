@@ -2,15 +2,49 @@
 // SPDX-License-Identifier: MIT
 
 #include <godot_cpp/classes/dir_access.hpp>
-#include <godot_cpp/classes/zip_reader.hpp>
-#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/project_settings.hpp>
 #include "VoskModelResourceLoader.h"
 #include "VoskModel.h"
 #include "VoskSpeakerModel.h"
+#include "../helpers/model_files.h"
 
 using namespace godot;
 using namespace gdvosk;
 
+namespace
+{
+    /**
+     * Registers an enumerated project setting, so it shows up in the editor.
+     */
+    void register_enum_setting(const String& name, int64_t default_value, const String& hint_string)
+    {
+        auto* settings = ProjectSettings::get_singleton();
+        if (!settings->has_setting(name))
+        {
+            settings->set_setting(name, default_value);
+        }
+
+        settings->set_initial_value(name, default_value);
+
+        Dictionary property_info;
+        property_info["name"] = name;
+        property_info["type"] = Variant::INT;
+        property_info["hint"] = PROPERTY_HINT_ENUM;
+        property_info["hint_string"] = hint_string;
+
+        settings->add_property_info(property_info);
+    }
+
+    /**
+     * Gets the value of an enumerated project setting, falling back to the default if it is out of range.
+     */
+    int64_t get_enum_setting(const String& name, int64_t default_value, int64_t max_value)
+    {
+        auto value = static_cast<int64_t>(ProjectSettings::get_singleton()->get_setting(name, default_value));
+        return value >= 0 && value <= max_value ? value : default_value;
+    }
+}
+
 PackedStringArray gdvosk::VoskModelResourceLoader::_get_recognized_extensions() const
 {
     return { "vosk", "voskspk" };
@@ -39,78 +73,41 @@ Variant gdvosk::VoskModelResourceLoader::_load
     int32_t p_cache_mode
 ) const
 {
-    auto extracted_models_root = String("user://gdvosk/models");
-
-    auto make_root_dir = DirAccess::make_dir_recursive_absolute(extracted_models_root);
-    if (make_root_dir != OK)
-    {
-        return make_root_dir;
-    }
-
-    auto model_name = p_path.get_file().replace("." + p_path.get_extension(), "");
-    auto extracted_model_path = extracted_models_root.path_join(model_name);
-
-    auto extracted_model_dir = DirAccess::open(extracted_model_path);
-    if (!extracted_model_dir.is_valid())
-    {
-        // extract resource
-        Ref<ZIPReader> reader;
-        reader.instantiate();
-
-        auto open = reader->open(p_path);
-        if (open != OK)
-        {
-            return open;
-        }
-
-        auto files = reader->get_files();
-        for (const auto& file : files)
-        {
-            if (file.ends_with("/"))
-            {
-                // just a folder, ignore
-                continue;
-            }
-
-            auto output_path = extracted_models_root.path_join(file);
-            if (FileAccess::file_exists(output_path))
-            {
-                continue;
-            }
-
-            auto output_folder = output_path.get_base_dir();
-
-            auto make_output_folder = DirAccess::make_dir_recursive_absolute(output_folder);
-            if (make_output_folder != OK)
-            {
-                return make_output_folder;
-            }
-
-            auto bytes = reader->read_file(file);
-            auto output_file = FileAccess::open(output_path, FileAccess::ModeFlags::WRITE);
-            if (!output_file.is_valid() || !output_file->is_open())
-            {
-                return ERR_FILE_CANT_WRITE;
-            }
-
-            output_file->store_buffer(bytes);
-            output_file->close();
-        }
-    }
-
     auto type = p_path.get_extension();
     if (type == "vosk")
     {
         Ref<gdvosk::VoskModel> model;
         model.instantiate();
 
-        model->load(extracted_model_path);
+        // as before profiles, a model Vosk can't load still yields an empty resource rather than failing the load
+        auto load = model->load_with_profile(p_path, get_default_load_profile(), get_default_decoder_profile());
+        if (load != OK && load != ERR_FILE_CORRUPT)
+        {
+            return load;
+        }
 
         return model;
     }
 
     if (type == "voskspk")
     {
+        auto extracted_models_root = String("user://gdvosk/models");
+
+        auto make_root_dir = DirAccess::make_dir_recursive_absolute(extracted_models_root);
+        if (make_root_dir != OK)
+        {
+            return make_root_dir;
+        }
+
+        auto model_name = p_path.get_file().get_basename();
+        auto extracted_model_path = extracted_models_root.path_join(model_name);
+
+        auto extract = extract_model(p_path, extracted_model_path, PackedStringArray());
+        if (extract != OK)
+        {
+            return extract;
+        }
+
         Ref<gdvosk::VoskSpeakerModel> model;
         model.instantiate();
 
@@ -122,6 +119,43 @@ Variant gdvosk::VoskModelResourceLoader::_load
     return ResourceFormatLoader::_load(p_path, p_original_path, p_use_sub_threads, p_cache_mode);
 }
 
+void gdvosk::VoskModelResourceLoader::register_settings()
+{
+    register_enum_setting(load_profile_setting, gdvosk::VoskModel::LOAD_PROFILE_ACCURATE, "Accurate,Fast");
+    register_enum_setting
+    (
+        decoder_profile_setting,
+        gdvosk::VoskModel::DECODER_PROFILE_DEFAULT,
+        "Default,Fast,Fastest,Accurate"
+    );
+}
+
+gdvosk::VoskModel::LoadProfile gdvosk::VoskModelResourceLoader::get_default_load_profile()
+{
+    return static_cast<gdvosk::VoskModel::LoadProfile>
+    (
+        get_enum_setting
+        (
+            load_profile_setting,
+            gdvosk::VoskModel::LOAD_PROFILE_ACCURATE,
+            gdvosk::VoskModel::LOAD_PROFILE_FAST
+        )
+    );
+}
+
+gdvosk::VoskModel::DecoderProfile gdvosk::VoskModelResourceLoader::get_default_decoder_profile()
+{
+    return static_cast<gdvosk::VoskModel::DecoderProfile>
+    (
+        get_enum_setting
+        (
+            decoder_profile_setting,
+            gdvosk::VoskModel::DECODER_PROFILE_DEFAULT,
+            gdvosk::VoskModel::DECODER_PROFILE_ACCURATE
+        )
+    );
+}
+
 void gdvosk::VoskModelResourceLoader::_bind_methods()
 {
 }
@@ -6,6 +6,8 @@
 
 #include <godot_cpp/classes/resource_format_loader.hpp>
 
+#include "VoskModel.h"
+
 namespace gdvosk
 {
     /**
@@ -15,12 +17,43 @@ namespace gdvosk
      * When a model is loaded, it is unpacked into user://gdvosk/models/<filename> to allow Vosk filesystem-level access
      * to the data in the model. Subsequent loads of the same resource do not overwrite the files unless they're
      * missing. Care should be taken to
+     *
+     * Language models are loaded with the profiles in the "gdvosk/models/load_profile" and
+     * "gdvosk/models/decoder_profile" project settings. Load profiles that leave components out are extracted into a
+     * directory of their own, user://gdvosk/models/<filename>@<profile>.
      */
     class VoskModelResourceLoader final : public godot::ResourceFormatLoader
     {
         GDCLASS(VoskModelResourceLoader, godot::ResourceFormatLoader)
 
+        /**
+         * Holds the name of the project setting that selects the profile language models are loaded with.
+         */
+        static constexpr const char* load_profile_setting = "gdvosk/models/load_profile";
+
+        /**
+         * Holds the name of the project setting that selects the decoder profile language models are loaded with.
+         */
+        static constexpr const char* decoder_profile_setting = "gdvosk/models/decoder_profile";
+
     public:
+        /**
+         * Registers the project settings of the loader, so they show up in the editor.
+         */
+        static void register_settings();
+
+        /**
+         * Gets the profile language models are loaded with, as selected in the project settings.
+         * @return The profile.
+         */
+        [[nodiscard]] static VoskModel::LoadProfile get_default_load_profile();
+
+        /**
+         * Gets the decoder profile language models are loaded with, as selected in the project settings.
+         * @return The profile.
+         */
+        [[nodiscard]] static VoskModel::DecoderProfile get_default_decoder_profile();
+
         [[nodiscard]] godot::PackedStringArray _get_recognized_extensions() const override;
 
         [[nodiscard]] bool _handles_type(const godot::StringName& p_type) const override;
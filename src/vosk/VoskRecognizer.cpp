@@ -2,12 +2,35 @@
 // SPDX-License-Identifier: MIT
 
 #include "VoskRecognizer.h"
+#include "../helpers/frame_view.h"
+#include "../helpers/result_conversion.h"
+#include "../helpers/string_conversion.h"
 
-#include <godot_cpp/classes/json.hpp>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <string>
+
+#include <godot_cpp/classes/dir_access.hpp>
+#include <godot_cpp/classes/project_settings.hpp>
 
 using namespace godot;
 using namespace gdvosk;
 
+namespace
+{
+    /**
+     * Holds the version of the recognizer output format cached transcripts were produced with. Bump it whenever the
+     * way results are produced changes, so that stale persisted transcripts are no longer found.
+     */
+    constexpr std::uint64_t transcript_format_version = 1;
+}
+
+gdvosk::VoskRecognizer::~VoskRecognizer()
+{
+    release_recognizer();
+}
+
 Error gdvosk::VoskRecognizer::setup
 (
     const Ref<VoskModel>& model,
@@ -15,25 +38,35 @@ Error gdvosk::VoskRecognizer::setup
     const Ref<VoskSpeakerModel>& speaker_model
 )
 {
-    if (_recognizer != nullptr)
-    {
-        vosk_recognizer_free(_recognizer);
-        _recognizer = nullptr;
-    }
+    release_recognizer();
 
     _model = model;
     _speaker_model = speaker_model;
+    _grammar.clear();
+
+    if (_model == nullptr)
+    {
+        return ERR_INVALID_PARAMETER;
+    }
 
-    _recognizer = speaker_model != nullptr
-            ? vosk_recognizer_new_spk(_model->get_ptr(), sample_rate, _speaker_model->get_ptr())
-            : vosk_recognizer_new(_model->get_ptr(), sample_rate);
+    // the model must stay resident until the recognizers are created from it
+    auto model_lease = _model->lease(_decoder_profile);
+
+    _key = core::recognizer_key();
+    _key.model = model_lease.get();
+    _key.speaker_model = _speaker_model != nullptr ? _speaker_model->get_ptr() : nullptr;
+    _key.sample_rate = sample_rate;
+
+    _recognizer = core::recognizer_pool::shared().acquire(_key);
 
     if (_recognizer == nullptr)
     {
         return FAILED;
     }
 
+    update_channel_recognizers();
     update_recognizer_parameters();
+    set_fresh(true);
 
     return OK;
 }
@@ -45,29 +78,78 @@ Error gdvosk::VoskRecognizer::setup_with_grammar
     const godot::PackedStringArray& grammar
 )
 {
-    if (_recognizer != nullptr)
-    {
-        vosk_recognizer_free(_recognizer);
-        _recognizer = nullptr;
-    }
+    release_recognizer();
 
     _model = model;
     _speaker_model.unref();
+    _grammar = grammar;
 
-    auto json = JSON::stringify(grammar);
+    if (_model == nullptr)
+    {
+        return ERR_INVALID_PARAMETER;
+    }
 
-    _recognizer = vosk_recognizer_new_grm(_model->get_ptr(), sample_rate, json.ascii());
+    auto model_lease = _model->lease(_decoder_profile);
+
+    _key = core::recognizer_key();
+    _key.model = model_lease.get();
+    _key.sample_rate = sample_rate;
+    _key.grammar = core::grammar_cache::shared().get(to_utf8(grammar));
+
+    _recognizer = core::recognizer_pool::shared().acquire(_key);
 
     if (_recognizer == nullptr)
     {
         return FAILED;
     }
 
+    update_channel_recognizers();
     update_recognizer_parameters();
+    set_fresh(true);
 
     return OK;
 }
 
+Error gdvosk::VoskRecognizer::set_grammar(const PackedStringArray& grammar)
+{
+    if (_recognizer == nullptr)
+    {
+        return ERR_UNCONFIGURED;
+    }
+
+    auto key = _key;
+    key.grammar = core::grammar_cache::shared().get(to_utf8(grammar));
+
+    if (key == _key)
+    {
+        _grammar = grammar;
+        return OK;
+    }
+
+    auto recognizer = core::recognizer_pool::shared().acquire(key);
+    if (recognizer == nullptr)
+    {
+        return FAILED;
+    }
+
+    release_recognizer();
+
+    _recognizer = std::move(recognizer);
+    _key = key;
+    _grammar = grammar;
+
+    update_channel_recognizers();
+    update_recognizer_parameters();
+    set_fresh(true);
+
+    return OK;
+}
+
+PackedStringArray gdvosk::VoskRecognizer::get_grammar() const
+{
+    return _grammar;
+}
+
 Ref<VoskSpeakerModel> gdvosk::VoskRecognizer::get_speaker_model() const
 {
     return _speaker_model;
@@ -77,9 +159,12 @@ void gdvosk::VoskRecognizer::set_speaker_model(const Ref<VoskSpeakerModel>& spea
 {
     _speaker_model = speaker_model;
 
-    if (_recognizer != nullptr)
+    if (_recognizer != nullptr && _speaker_model != nullptr)
     {
-        vosk_recognizer_set_spk_model(_recognizer, _speaker_model->get_ptr());
+        update_recognizer_parameters();
+
+        // the native recognizers now carry the speaker model, so they must go back to the pool under that key
+        _key.speaker_model = _speaker_model->get_ptr();
     }
 }
 
@@ -92,10 +177,7 @@ void gdvosk::VoskRecognizer::set_max_alternatives(int max_alternatives)
 {
     _max_alternatives = max_alternatives;
 
-    if (_recognizer != nullptr)
-    {
-        vosk_recognizer_set_max_alternatives(_recognizer, _max_alternatives);
-    }
+    update_recognizer_parameters();
 }
 
 bool gdvosk::VoskRecognizer::get_include_words_in_output() const
@@ -107,10 +189,7 @@ void gdvosk::VoskRecognizer::set_include_words_in_output(bool include_words_in_o
 {
     _include_words_in_output = include_words_in_output;
 
-    if (_recognizer != nullptr)
-    {
-        vosk_recognizer_set_words(_recognizer, _include_words_in_output ? 1 : 0);
-    }
+    update_recognizer_parameters();
 }
 
 bool gdvosk::VoskRecognizer::get_include_words_in_partial_output() const
@@ -122,10 +201,7 @@ void gdvosk::VoskRecognizer::set_include_words_in_partial_output(bool include_wo
 {
     _include_words_in_partial_output = include_words_in_partial_output;
 
-    if (_recognizer != nullptr)
-    {
-        vosk_recognizer_set_partial_words(_recognizer, _include_words_in_partial_output ? 1 : 0);
-    }
+    update_recognizer_parameters();
 }
 
 bool gdvosk::VoskRecognizer::get_use_nlsml_output() const
@@ -137,176 +213,740 @@ void gdvosk::VoskRecognizer::set_use_nlsml_output(bool use_nlsml_output)
 {
     _use_nlsml_output = use_nlsml_output;
 
-    if (_recognizer != nullptr)
+    update_recognizer_parameters();
+}
+
+gdvosk::VoskRecognizer::ChannelMode gdvosk::VoskRecognizer::get_channel_mode() const
+{
+    return _channel_mode;
+}
+
+void gdvosk::VoskRecognizer::set_channel_mode(ChannelMode channel_mode)
+{
+    _channel_mode = channel_mode;
+
+    update_channel_recognizers();
+    update_recognizer_parameters();
+}
+
+int gdvosk::VoskRecognizer::get_chunk_size() const
+{
+    return _chunk_size;
+}
+
+gdvosk::VoskModel::DecoderProfile gdvosk::VoskRecognizer::get_decoder_profile() const
+{
+    return _decoder_profile;
+}
+
+void gdvosk::VoskRecognizer::set_decoder_profile(VoskModel::DecoderProfile decoder_profile)
+{
+    if (decoder_profile == _decoder_profile)
+    {
+        return;
+    }
+
+    _decoder_profile = decoder_profile;
+
+    if (_recognizer == nullptr)
+    {
+        return;
+    }
+
+    auto model_lease = _model->lease(_decoder_profile);
+
+    auto key = _key;
+    key.model = model_lease.get();
+
+    if (key.model == nullptr || key == _key)
     {
-        vosk_recognizer_set_nlsml(_recognizer, use_nlsml_output ? 1 : 0);
+        return;
+    }
+
+    auto recognizer = core::recognizer_pool::shared().acquire(key);
+    if (recognizer == nullptr)
+    {
+        return;
     }
+
+    release_recognizer();
+
+    _recognizer = std::move(recognizer);
+    _key = key;
+
+    update_channel_recognizers();
+    update_recognizer_parameters();
+    set_fresh(true);
+}
+
+void gdvosk::VoskRecognizer::set_chunk_size(int chunk_size)
+{
+    _chunk_size = Math::max(chunk_size, 0);
+}
+
+Ref<VoskCancellationToken> gdvosk::VoskRecognizer::get_cancellation_token() const
+{
+    return _cancellation_token;
+}
+
+void gdvosk::VoskRecognizer::set_cancellation_token(const Ref<VoskCancellationToken>& cancellation_token)
+{
+    _cancellation_token = cancellation_token;
+}
+
+bool gdvosk::VoskRecognizer::get_use_transcript_cache() const
+{
+    return _use_transcript_cache;
+}
+
+void gdvosk::VoskRecognizer::set_use_transcript_cache(bool use_transcript_cache)
+{
+    _use_transcript_cache = use_transcript_cache;
 }
 
 void gdvosk::VoskRecognizer::update_recognizer_parameters()
 {
-    if (_recognizer == nullptr)
+    // whatever is being captured was produced under the previous output settings
+    _transcript.reset();
+
+    for (auto* recognizer : { _recognizer.get(), _right_recognizer.get() })
     {
-        return;
+        if (recognizer == nullptr)
+        {
+            continue;
+        }
+
+        if (_speaker_model != nullptr)
+        {
+            recognizer->set_speaker_model(_speaker_model->get_ptr());
+        }
+
+        recognizer->set_max_alternatives(_max_alternatives);
+        recognizer->set_words(_include_words_in_output);
+        recognizer->set_partial_words(_include_words_in_partial_output);
+        recognizer->set_nlsml(_use_nlsml_output);
     }
+}
 
-    if (_speaker_model != nullptr)
+void gdvosk::VoskRecognizer::update_channel_recognizers()
+{
+    auto needs_right_recognizer = _recognizer != nullptr && _channel_mode == CHANNEL_MODE_SPLIT;
+    if (needs_right_recognizer && _right_recognizer == nullptr)
+    {
+        // the right channel shares the configuration (and thereby the model) of the left one
+        _right_recognizer = core::recognizer_pool::shared().acquire(_key);
+    }
+    else if (!needs_right_recognizer && _right_recognizer != nullptr)
     {
-        vosk_recognizer_set_spk_model(_recognizer, _speaker_model->get_ptr());
+        core::recognizer_pool::shared().release(_key, std::move(_right_recognizer));
     }
+}
 
-    vosk_recognizer_set_max_alternatives(_recognizer, _max_alternatives);
-    vosk_recognizer_set_words(_recognizer, _include_words_in_output);
-    vosk_recognizer_set_partial_words(_recognizer, _include_words_in_partial_output);
-    vosk_recognizer_set_nlsml(_recognizer, _use_nlsml_output);
+core::recognizer* gdvosk::VoskRecognizer::get_channel_recognizer(int channel) const
+{
+    switch (channel)
+    {
+        case 0:
+        {
+            return _recognizer.get();
+        }
+        case 1:
+        {
+            return _right_recognizer.get();
+        }
+        default:
+        {
+            return nullptr;
+        }
+    }
 }
 
-godot::Error gdvosk::VoskRecognizer::accept_stream(const Ref<godot::AudioStreamWAV>& stream)
+Dictionary gdvosk::VoskRecognizer::to_channel_result(const char* json, int channel) const
 {
-    auto data = stream->is_stereo()
-        ? mix_stereo_to_mono(stream->get_data())
-        : stream->get_data();
+    auto result = parse_result_dictionary(json);
+    if (_channel_mode == CHANNEL_MODE_SPLIT)
+    {
+        result["channel"] = channel;
+    }
 
-    auto* ptr = reinterpret_cast<const char*>(data.ptr());
+    return result;
+}
 
-    auto result = vosk_recognizer_accept_waveform(_recognizer, ptr, static_cast<int>(data.size()));
-    if (result >= 1)
+std::optional<core::transcript_key> gdvosk::VoskRecognizer::get_transcript_key
+(
+    const PackedByteArray& data,
+    bool is_stereo
+) const
+{
+    // speaker vectors depend on a model with no stable identity, and a cached transcript can't replay the
+    // intermediate results of chunked decoding, so neither is ever cached
+    auto loaded = _model != nullptr ? _model->get_loaded_model() : nullptr;
+    if (loaded == nullptr || _speaker_model != nullptr || _chunk_size > 0)
     {
-        return OK;
+        return std::nullopt;
     }
 
-    if (result == 0)
+    // the path alone doesn't tell a model apart from an older version of it that was replaced in place
+    auto configuration = to_utf8(loaded->path)
+        + "\n" + loaded->fingerprint
+        + "\n" + std::to_string(transcript_format_version)
+        + "\n" + std::to_string(_key.sample_rate)
+        + "\n" + std::to_string(_key.grammar_hash())
+        + "\n" + std::to_string(get_effective_decoder_profile())
+        + "\n" + std::to_string(_max_alternatives)
+        + "\n" + std::to_string(_include_words_in_output)
+        + "\n" + std::to_string(_include_words_in_partial_output)
+        + "\n" + std::to_string(_use_nlsml_output)
+        + "\n" + std::to_string(get_channel_count())
+        + "\n" + std::to_string(is_stereo);
+
+    auto audio = core::span<const std::uint8_t>(data.ptr(), static_cast<std::size_t>(data.size()));
+    auto config = core::span<const std::uint8_t>
+    (
+        reinterpret_cast<const std::uint8_t*>(configuration.data()),
+        configuration.size()
+    );
+
+    core::transcript_key key;
+    key.audio_hash = core::hash_data(audio);
+    key.audio_size = audio.size();
+    key.config_hash = core::hash_data(config);
+
+    return key;
+}
+
+gdvosk::VoskModel::DecoderProfile gdvosk::VoskRecognizer::get_effective_decoder_profile() const
+{
+    if (_decoder_profile != VoskModel::DECODER_PROFILE_DEFAULT || _model == nullptr)
     {
-        // this is a bit of a hack... it's not really an error, but the recognizer is busy decoding the current
-        // utterance and you should continue giving it data until it either says OK or FAILED. You can retrieve the
-        // current best guess using partial_result if ERR_BUSY is returned.
-        return ERR_BUSY;
+        return _decoder_profile;
     }
 
-    return FAILED;
+    return _model->get_decoder_profile();
 }
 
-godot::Error gdvosk::VoskRecognizer::accept_samples(const PackedVector2Array& samples)
+void gdvosk::VoskRecognizer::set_fresh(bool is_fresh)
 {
-    auto data = mix_stereo_to_mono(samples);
+    _is_fresh = is_fresh;
+    _transcript.reset();
+}
 
-    auto result = vosk_recognizer_accept_waveform_f(_recognizer, data.ptr(), static_cast<int>(data.size()));
-    if (result >= 1)
+void gdvosk::VoskRecognizer::finish_transcript_channel(int channel)
+{
+    if (!_transcript.has_value() || channel < 0 || static_cast<std::size_t>(channel) >= get_channel_count())
     {
-        return OK;
+        return;
     }
 
-    if (result == 0)
+    _transcript->is_finished[channel] = true;
+    for (std::size_t i = 0; i < get_channel_count(); ++i)
     {
-        // this is a bit of a hack... it's not really an error, but the recognizer is busy decoding the current
-        // utterance and you should continue giving it data until it either says OK or FAILED. You can retrieve the
-        // current best guess using partial_result if ERR_BUSY is returned.
-        return ERR_BUSY;
+        if (!_transcript->is_finished[i])
+        {
+            return;
+        }
     }
 
-    return FAILED;
+    if (!_transcript->is_cached)
+    {
+        core::transcript_cache::shared().put(_transcript->key, std::move(_transcript->value));
+    }
+
+    _transcript.reset();
+}
+
+std::size_t gdvosk::VoskRecognizer::get_channel_count() const
+{
+    return _right_recognizer != nullptr ? 2 : 1;
 }
 
-godot::PackedByteArray gdvosk::VoskRecognizer::mix_stereo_to_mono(const PackedByteArray& data)
+template <typename T>
+std::array<core::accept_status, 2> gdvosk::VoskRecognizer::accept_channels(core::span<const T> interleaved)
 {
-    if (data.size() % 4 != 0)
+    _channel_helpers.configure(core::get_current_thread_settings());
+    return core::accept_channels(_channel_helpers, { _recognizer.get(), _right_recognizer.get() }, interleaved);
+}
+
+template <typename Decode>
+std::optional<std::array<core::accept_status, 2>> gdvosk::VoskRecognizer::decode_in_chunks
+(
+    std::size_t frames,
+    Decode&& decode
+)
+{
+    auto is_chunked = _chunk_size > 0;
+    auto chunk_size = is_chunked ? static_cast<std::size_t>(_chunk_size) : frames;
+
+    std::array<core::accept_status, 2> statuses { core::accept_status::failed, core::accept_status::failed };
+
+    std::size_t offset = 0;
+    do
     {
-        PackedByteArray silent;
-        silent.resize(24);
+        if (_cancellation_token != nullptr && _cancellation_token->is_cancelled())
+        {
+            // whatever was decoded so far stays in the recognizers, so the partial transcript can still be retrieved
+            return std::nullopt;
+        }
+
+        auto count = std::min(chunk_size, frames - offset);
+        statuses = decode(offset, count);
+        offset += count;
+
+        if (!is_chunked)
+        {
+            break;
+        }
+
+        // the result of the last chunk is left for the caller, just as if the input had been accepted in one call
+        if (offset < frames)
+        {
+            for (std::size_t channel = 0; channel < get_channel_count(); ++channel)
+            {
+                if (statuses[channel] != core::accept_status::result_ready)
+                {
+                    continue;
+                }
+
+                auto* recognizer = get_channel_recognizer(static_cast<int>(channel));
+                auto result = to_channel_result(recognizer->result_json(), static_cast<int>(channel));
+
+                emit_signal("intermediate_result", result);
+            }
+        }
+
+        emit_signal("progress", static_cast<int64_t>(offset), static_cast<int64_t>(frames));
+    }
+    while (offset < frames);
+
+    return statuses;
+}
 
-        return silent;
+godot::Error gdvosk::VoskRecognizer::accept_stream(const Ref<godot::AudioStreamWAV>& stream)
+{
+    if (_recognizer == nullptr || stream == nullptr)
+    {
+        return FAILED;
     }
 
-    PackedByteArray output;
-    output.resize(data.size() / 2);
+    auto data = stream->get_data();
+    auto is_stereo = stream->is_stereo();
+
+    auto key = _use_transcript_cache && _is_fresh ? get_transcript_key(data, is_stereo) : std::nullopt;
+    set_fresh(false);
 
-    auto output_index = 0;
-    for (auto i = 0; i < data.size(); i += 4)
+    if (key.has_value())
     {
-        const auto left_channel = *reinterpret_cast<const int16_t*>(&data.ptr()[i]);
-        const auto right_channel = *reinterpret_cast<const int16_t*>(&data.ptr()[i + 2]);
+        auto cached = core::transcript_cache::shared().get(*key);
+        if (cached.has_value() && cached->channels.size() == get_channel_count())
+        {
+            std::array<core::accept_status, 2> statuses { core::accept_status::failed, core::accept_status::failed };
+            for (std::size_t i = 0; i < cached->channels.size(); ++i)
+            {
+                statuses[i] = cached->channels[i].status;
+            }
+
+            _transcript = stream_transcript { *key, std::move(*cached), true };
+            return to_error(statuses);
+        }
+    }
+
+    auto samples = core::span<const int16_t>
+    (
+        reinterpret_cast<const int16_t*>(data.ptr()),
+        static_cast<std::size_t>(data.size()) / sizeof(int16_t)
+    );
+
+    std::size_t channels = is_stereo ? 2 : 1;
+    auto decoded = decode_in_chunks
+    (
+        samples.size() / channels,
+        [&](std::size_t offset, std::size_t count)
+        {
+            auto chunk = samples.subspan(offset * channels, count * channels);
+
+            std::array<core::accept_status, 2> statuses { core::accept_status::failed, core::accept_status::failed };
+            if (!is_stereo)
+            {
+                statuses[0] = _recognizer->accept(chunk);
+            }
+            else if (_right_recognizer != nullptr)
+            {
+                statuses = accept_channels(chunk);
+            }
+            else
+            {
+                statuses[0] = _recognizer->accept_stereo(chunk);
+            }
+
+            return statuses;
+        }
+    );
 
-        const auto mixed = (int32_t(left_channel) + right_channel) / 2;
+    if (!decoded.has_value())
+    {
+        return ERR_SKIP;
+    }
 
-        reinterpret_cast<int16_t*>(output.ptrw())[output_index] = static_cast<int16_t>(mixed);
-        output_index += 1;
+    auto statuses = *decoded;
+    if (key.has_value())
+    {
+        // the results are captured as they're retrieved, and cached once every final result has been
+        stream_transcript captured { *key, { }, false };
+        captured.value.channels.resize(get_channel_count());
+        for (std::size_t i = 0; i < captured.value.channels.size(); ++i)
+        {
+            captured.value.channels[i].status = statuses[i];
+        }
+
+        _transcript = std::move(captured);
     }
 
-    return output;
+    return to_error(statuses);
 }
 
-godot::PackedFloat32Array gdvosk::VoskRecognizer::mix_stereo_to_mono(const PackedVector2Array& data)
+godot::Error gdvosk::VoskRecognizer::accept_samples(const PackedVector2Array& samples)
 {
-    PackedFloat32Array output;
-    output.resize(data.size());
+    if (_recognizer == nullptr)
+    {
+        return FAILED;
+    }
+
+    set_fresh(false);
 
-    for (auto i = 0; i < data.size(); ++i)
+    frame_view frames(samples);
+    auto decoded = decode_in_chunks
+    (
+        static_cast<std::size_t>(samples.size()),
+        [&](std::size_t offset, std::size_t count)
+        {
+            auto chunk = frames.samples().subspan(offset * 2, count * 2);
+            if (_right_recognizer != nullptr)
+            {
+                return accept_channels(chunk);
+            }
+
+            return std::array { _recognizer->accept_stereo(chunk), core::accept_status::failed };
+        }
+    );
+
+    return decoded.has_value() ? to_error(*decoded) : ERR_SKIP;
+}
+
+godot::Error gdvosk::VoskRecognizer::accept_pcm16(const PackedByteArray& data)
+{
+    if (_recognizer == nullptr)
+    {
+        return FAILED;
+    }
+
+    // the data is read in place, so it must be laid out exactly as Vosk reads it
+    const auto* bytes = data.ptr();
+    auto size = static_cast<std::size_t>(data.size());
+    if (size % sizeof(int16_t) != 0 || reinterpret_cast<std::uintptr_t>(bytes) % alignof(int16_t) != 0)
     {
-        auto& sample = data[i];
-        auto mixed = Math::clamp((sample.x + sample.y) / 2.0f, -1.0f, 1.0f);
+        return ERR_INVALID_DATA;
+    }
 
-        // vosk expects -32768 to 32768, not -1 to 1
-        output[i] = mixed * 32768;
+    if (size / sizeof(int16_t) > static_cast<std::size_t>(INT_MAX))
+    {
+        return ERR_INVALID_DATA;
     }
 
-    return output;
+    set_fresh(false);
+
+    auto samples = core::span<const int16_t>(reinterpret_cast<const int16_t*>(bytes), size / sizeof(int16_t));
+    auto decoded = decode_in_chunks
+    (
+        samples.size(),
+        [&](std::size_t offset, std::size_t count)
+        {
+            return std::array { _recognizer->accept(samples.subspan(offset, count)), core::accept_status::failed };
+        }
+    );
+
+    return decoded.has_value() ? to_error(*decoded) : ERR_SKIP;
 }
 
-godot::Dictionary gdvosk::VoskRecognizer::get_result()
+godot::Error gdvosk::VoskRecognizer::accept_pcm_float(const PackedFloat32Array& samples)
 {
-    auto result = vosk_recognizer_result(_recognizer);
-    if (result == nullptr)
+    if (_recognizer == nullptr)
     {
-        return { };
+        return FAILED;
+    }
+
+    if (static_cast<std::size_t>(samples.size()) > static_cast<std::size_t>(INT_MAX))
+    {
+        return ERR_INVALID_DATA;
     }
 
-    return parse_json_as_dictionary(result);
+    set_fresh(false);
+
+    auto view = core::span<const float>(samples.ptr(), static_cast<std::size_t>(samples.size()));
+    auto decoded = decode_in_chunks
+    (
+        view.size(),
+        [&](std::size_t offset, std::size_t count)
+        {
+            return std::array { _recognizer->accept(view.subspan(offset, count)), core::accept_status::failed };
+        }
+    );
+
+    return decoded.has_value() ? to_error(*decoded) : ERR_SKIP;
 }
 
-godot::Dictionary gdvosk::VoskRecognizer::get_partial_result()
+godot::Error gdvosk::VoskRecognizer::to_error(core::accept_status status)
 {
-    auto result = vosk_recognizer_partial_result(_recognizer);
-    if (result == nullptr)
+    switch (status)
     {
-        return { };
+        case core::accept_status::result_ready:
+        {
+            return OK;
+        }
+        case core::accept_status::partial_ready:
+        {
+            // this is a bit of a hack... it's not really an error, but the recognizer is busy decoding the current
+            // utterance and you should continue giving it data until it either says OK or FAILED. You can retrieve the
+            // current best guess using partial_result if ERR_BUSY is returned.
+            return ERR_BUSY;
+        }
+        case core::accept_status::failed:
+        default:
+        {
+            return FAILED;
+        }
+    }
+}
+
+godot::Error gdvosk::VoskRecognizer::to_error(const std::array<core::accept_status, 2>& statuses)
+{
+    // report the most advanced state of either channel; the per-channel results tell them apart
+    for (auto status : { core::accept_status::result_ready, core::accept_status::partial_ready })
+    {
+        if (statuses[0] == status || statuses[1] == status)
+        {
+            return to_error(status);
+        }
     }
 
-    return parse_json_as_dictionary(result);
+    return FAILED;
 }
 
-godot::Dictionary gdvosk::VoskRecognizer::get_final_result()
+godot::Dictionary gdvosk::VoskRecognizer::get_result(int channel)
 {
-    auto result = vosk_recognizer_final_result(_recognizer);
-    if (result == nullptr)
+    auto* recognizer = get_channel_recognizer(channel);
+    if (recognizer == nullptr)
     {
         return { };
     }
 
-    return parse_json_as_dictionary(result);
+    if (_transcript.has_value() && static_cast<std::size_t>(channel) < _transcript->value.channels.size())
+    {
+        auto& captured = _transcript->value.channels[channel];
+        if (!_transcript->is_cached)
+        {
+            captured.result_json = recognizer->result_json();
+        }
+
+        if (!captured.result_json.empty())
+        {
+            return to_channel_result(captured.result_json.c_str(), channel);
+        }
+    }
+
+    return to_channel_result(recognizer->result_json(), channel);
 }
 
-godot::Dictionary gdvosk::VoskRecognizer::parse_json_as_dictionary(const godot::String& data)
+godot::Dictionary gdvosk::VoskRecognizer::get_partial_result(int channel)
 {
-    Ref<JSON> parsed;
-    parsed.instantiate();
-
-    auto parse_result = parsed->parse(String(data));
-    if (parse_result != OK)
+    auto* recognizer = get_channel_recognizer(channel);
+    if (recognizer == nullptr)
     {
         return { };
     }
 
-    if (parsed->get_data().get_type() != Variant::DICTIONARY)
+    return to_channel_result(recognizer->partial_result_json(), channel);
+}
+
+godot::Dictionary gdvosk::VoskRecognizer::get_final_result(int channel)
+{
+    auto* recognizer = get_channel_recognizer(channel);
+    if (recognizer == nullptr)
     {
         return { };
     }
 
-    return parsed->get_data();
+    if (_transcript.has_value() && static_cast<std::size_t>(channel) < _transcript->value.channels.size())
+    {
+        auto& captured = _transcript->value.channels[channel];
+        if (!_transcript->is_cached)
+        {
+            captured.final_json = recognizer->final_result_json();
+        }
+
+        auto result = to_channel_result(captured.final_json.c_str(), channel);
+        finish_transcript_channel(channel);
+
+        return result;
+    }
+
+    return to_channel_result(recognizer->final_result_json(), channel);
 }
 
 void gdvosk::VoskRecognizer::reset()
 {
-    vosk_recognizer_reset(_recognizer);
+    for (auto* recognizer : { _recognizer.get(), _right_recognizer.get() })
+    {
+        if (recognizer != nullptr)
+        {
+            recognizer->reset();
+        }
+    }
+
+    set_fresh(_recognizer != nullptr);
+}
+
+void gdvosk::VoskRecognizer::release()
+{
+    release_recognizer();
+}
+
+void gdvosk::VoskRecognizer::release_recognizer()
+{
+    set_fresh(false);
+
+    if (_recognizer == nullptr)
+    {
+        return;
+    }
+
+    core::recognizer_pool::shared().release(_key, std::move(_right_recognizer));
+    core::recognizer_pool::shared().release(_key, std::move(_recognizer));
+    _key = core::recognizer_key();
+}
+
+void gdvosk::VoskRecognizer::set_pool_warm_spares(int warm_spares)
+{
+    core::recognizer_pool::shared().set_warm_spares(static_cast<std::size_t>(Math::max(warm_spares, 0)));
+}
+
+int gdvosk::VoskRecognizer::get_pool_warm_spares()
+{
+    return static_cast<int>(core::recognizer_pool::shared().get_warm_spares());
+}
+
+void gdvosk::VoskRecognizer::set_pool_max_idle(int max_idle)
+{
+    core::recognizer_pool::shared().set_max_idle(static_cast<std::size_t>(Math::max(max_idle, 0)));
+}
+
+int gdvosk::VoskRecognizer::get_pool_max_idle()
+{
+    return static_cast<int>(core::recognizer_pool::shared().get_max_idle());
+}
+
+int gdvosk::VoskRecognizer::prewarm_pool
+(
+    const Ref<VoskModel>& model,
+    float sample_rate,
+    const PackedStringArray& grammar
+)
+{
+    if (model == nullptr)
+    {
+        return 0;
+    }
+
+    auto model_lease = model->lease();
+
+    core::recognizer_key key;
+    key.model = model_lease.get();
+    key.sample_rate = sample_rate;
+    key.grammar = core::grammar_cache::shared().get(to_utf8(grammar));
+
+    return static_cast<int>(core::recognizer_pool::shared().prewarm(key));
+}
+
+Dictionary gdvosk::VoskRecognizer::get_pool_statistics()
+{
+    auto statistics = core::recognizer_pool::shared().get_statistics();
+
+    Dictionary dictionary;
+    dictionary["hits"] = static_cast<int64_t>(statistics.hits);
+    dictionary["misses"] = static_cast<int64_t>(statistics.misses);
+    dictionary["idle"] = static_cast<int64_t>(statistics.idle);
+
+    return dictionary;
+}
+
+void gdvosk::VoskRecognizer::clear_pool()
+{
+    core::recognizer_pool::shared().clear();
+}
+
+void gdvosk::VoskRecognizer::set_transcript_cache_max_entries(int max_entries)
+{
+    core::transcript_cache::shared().set_max_entries(static_cast<std::size_t>(Math::max(max_entries, 0)));
+}
+
+int gdvosk::VoskRecognizer::get_transcript_cache_max_entries()
+{
+    return static_cast<int>(core::transcript_cache::shared().get_max_entries());
+}
+
+void gdvosk::VoskRecognizer::set_transcript_cache_max_size(int64_t max_size)
+{
+    core::transcript_cache::shared().set_max_size(static_cast<std::size_t>(Math::max<int64_t>(max_size, 0)));
+}
+
+int64_t gdvosk::VoskRecognizer::get_transcript_cache_max_size()
+{
+    return static_cast<int64_t>(core::transcript_cache::shared().get_max_size());
+}
+
+Error gdvosk::VoskRecognizer::set_transcript_cache_directory(const String& directory)
+{
+    if (directory.is_empty())
+    {
+        core::transcript_cache::shared().set_directory({ });
+        return OK;
+    }
+
+    auto globalized_directory = ProjectSettings::get_singleton()->globalize_path(directory);
+    if (globalized_directory == "")
+    {
+        return ERR_FILE_BAD_PATH;
+    }
+
+    if (DirAccess::make_dir_recursive_absolute(globalized_directory) != OK)
+    {
+        return ERR_CANT_CREATE;
+    }
+
+    core::transcript_cache::shared().set_directory(to_utf8(globalized_directory));
+    return OK;
+}
+
+String gdvosk::VoskRecognizer::get_transcript_cache_directory()
+{
+    return String::utf8(core::transcript_cache::shared().get_directory().c_str());
+}
+
+Dictionary gdvosk::VoskRecognizer::get_transcript_cache_statistics()
+{
+    auto statistics = core::transcript_cache::shared().get_statistics();
+
+    Dictionary dictionary;
+    dictionary["hits"] = static_cast<int64_t>(statistics.hits);
+    dictionary["misses"] = static_cast<int64_t>(statistics.misses);
+    dictionary["entries"] = static_cast<int64_t>(statistics.entries);
+    dictionary["size"] = static_cast<int64_t>(statistics.size);
+
+    return dictionary;
+}
+
+void gdvosk::VoskRecognizer::clear_transcript_cache()
+{
+    core::transcript_cache::shared().clear();
 }
 
 void gdvosk::VoskRecognizer::_bind_methods()
@@ -324,16 +964,142 @@ void gdvosk::VoskRecognizer::_bind_methods()
         &VoskRecognizer::setup_with_grammar
     );
 
+    ClassDB::bind_method(D_METHOD("set_grammar", "grammar"), &VoskRecognizer::set_grammar);
+    ClassDB::bind_method(D_METHOD("get_grammar"), &VoskRecognizer::get_grammar);
     ClassDB::bind_method(D_METHOD("accept_stream", "stream"), &VoskRecognizer::accept_stream);
     ClassDB::bind_method(D_METHOD("accept_samples", "samples"), &VoskRecognizer::accept_samples);
-    ClassDB::bind_method(D_METHOD("get_result"), &VoskRecognizer::get_result);
-    ClassDB::bind_method(D_METHOD("get_partial_result"), &VoskRecognizer::get_partial_result);
-    ClassDB::bind_method(D_METHOD("get_final_result"), &VoskRecognizer::get_final_result);
+    ClassDB::bind_method(D_METHOD("accept_pcm16", "data"), &VoskRecognizer::accept_pcm16);
+    ClassDB::bind_method(D_METHOD("accept_pcm_float", "samples"), &VoskRecognizer::accept_pcm_float);
+    ClassDB::bind_method(D_METHOD("get_result", "channel"), &VoskRecognizer::get_result, DEFVAL(0));
+    ClassDB::bind_method(D_METHOD("get_partial_result", "channel"), &VoskRecognizer::get_partial_result, DEFVAL(0));
+    ClassDB::bind_method(D_METHOD("get_final_result", "channel"), &VoskRecognizer::get_final_result, DEFVAL(0));
     ClassDB::bind_method(D_METHOD("reset"), &VoskRecognizer::reset);
+    ClassDB::bind_method(D_METHOD("release"), &VoskRecognizer::release);
+
+    ClassDB::bind_static_method
+    (
+        get_class_static(),
+        D_METHOD("set_pool_warm_spares", "warm_spares"),
+        &VoskRecognizer::set_pool_warm_spares
+    );
+
+    ClassDB::bind_static_method
+    (
+        get_class_static(),
+        D_METHOD("get_pool_warm_spares"),
+        &VoskRecognizer::get_pool_warm_spares
+    );
+
+    ClassDB::bind_static_method
+    (
+        get_class_static(),
+        D_METHOD("set_pool_max_idle", "max_idle"),
+        &VoskRecognizer::set_pool_max_idle
+    );
+
+    ClassDB::bind_static_method(get_class_static(), D_METHOD("get_pool_max_idle"), &VoskRecognizer::get_pool_max_idle);
+
+    ClassDB::bind_static_method
+    (
+        get_class_static(),
+        D_METHOD("prewarm_pool", "model", "sample_rate", "grammar"),
+        &VoskRecognizer::prewarm_pool,
+        DEFVAL(PackedStringArray())
+    );
+
+    ClassDB::bind_static_method
+    (
+        get_class_static(),
+        D_METHOD("get_pool_statistics"),
+        &VoskRecognizer::get_pool_statistics
+    );
+
+    ClassDB::bind_static_method(get_class_static(), D_METHOD("clear_pool"), &VoskRecognizer::clear_pool);
+
+    ClassDB::bind_static_method
+    (
+        get_class_static(),
+        D_METHOD("set_transcript_cache_max_entries", "max_entries"),
+        &VoskRecognizer::set_transcript_cache_max_entries
+    );
+
+    ClassDB::bind_static_method
+    (
+        get_class_static(),
+        D_METHOD("get_transcript_cache_max_entries"),
+        &VoskRecognizer::get_transcript_cache_max_entries
+    );
+
+    ClassDB::bind_static_method
+    (
+        get_class_static(),
+        D_METHOD("set_transcript_cache_max_size", "max_size"),
+        &VoskRecognizer::set_transcript_cache_max_size
+    );
+
+    ClassDB::bind_static_method
+    (
+        get_class_static(),
+        D_METHOD("get_transcript_cache_max_size"),
+        &VoskRecognizer::get_transcript_cache_max_size
+    );
+
+    ClassDB::bind_static_method
+    (
+        get_class_static(),
+        D_METHOD("set_transcript_cache_directory", "directory"),
+        &VoskRecognizer::set_transcript_cache_directory
+    );
+
+    ClassDB::bind_static_method
+    (
+        get_class_static(),
+        D_METHOD("get_transcript_cache_directory"),
+        &VoskRecognizer::get_transcript_cache_directory
+    );
+
+    ClassDB::bind_static_method
+    (
+        get_class_static(),
+        D_METHOD("get_transcript_cache_statistics"),
+        &VoskRecognizer::get_transcript_cache_statistics
+    );
+
+    ClassDB::bind_static_method
+    (
+        get_class_static(),
+        D_METHOD("clear_transcript_cache"),
+        &VoskRecognizer::clear_transcript_cache
+    );
 
     REGISTER_GODOT_PROPERTY_WITH_HINT(Variant::OBJECT, speaker_model, PROPERTY_HINT_RESOURCE_TYPE, "VoskSpeakerModel")
     REGISTER_GODOT_PROPERTY(Variant::INT, max_alternatives)
     REGISTER_GODOT_PROPERTY(Variant::BOOL, include_words_in_output)
     REGISTER_GODOT_PROPERTY(Variant::BOOL, include_words_in_partial_output)
     REGISTER_GODOT_PROPERTY(Variant::BOOL, use_nlsml_output)
+    REGISTER_GODOT_PROPERTY_WITH_HINT(Variant::INT, channel_mode, PROPERTY_HINT_ENUM, "Mix,Split")
+    REGISTER_GODOT_PROPERTY(Variant::BOOL, use_transcript_cache)
+    REGISTER_GODOT_PROPERTY_WITH_HINT(Variant::INT, chunk_size, PROPERTY_HINT_RANGE, "0,1048576,1,or_greater")
+    REGISTER_GODOT_PROPERTY(Variant::OBJECT, cancellation_token)
+    REGISTER_GODOT_PROPERTY_WITH_HINT
+    (
+        Variant::INT,
+        decoder_profile,
+        PROPERTY_HINT_ENUM,
+        "Default,Fast,Fastest,Accurate"
+    )
+
+    BIND_ENUM_CONSTANT(CHANNEL_MODE_MIX)
+    BIND_ENUM_CONSTANT(CHANNEL_MODE_SPLIT)
+
+    ADD_SIGNAL(MethodInfo("intermediate_result", PropertyInfo(Variant::DICTIONARY, "data")));
+    ADD_SIGNAL
+    (
+        MethodInfo
+        (
+            "progress",
+            PropertyInfo(Variant::INT, "processed_frames"),
+            PropertyInfo(Variant::INT, "total_frames")
+        )
+    );
 }
@@ -6,12 +6,21 @@
 
 #include "VoskModel.h"
 
+#include <array>
+#include <memory>
+#include <optional>
+
 #include "../helpers/auto_property.h"
 #include <godot_cpp/classes/ref_counted.hpp>
 #include <vosk_api.h>
 #include <godot_cpp/classes/audio_stream_wav.hpp>
+#include <godot_cpp/variant/packed_float32_array.hpp>
 
+#include "VoskCancellationToken.h"
 #include "VoskSpeakerModel.h"
+#include "core/recognizer.h"
+#include "core/recognizer_pool.h"
+#include "core/transcript_cache.h"
 
 namespace gdvosk
 {
@@ -22,16 +31,86 @@ namespace gdvosk
     {
         GDCLASS(VoskRecognizer, godot::RefCounted)
 
+    public:
+        /**
+         * Represents the ways stereo audio can be decoded.
+         */
+        enum ChannelMode
+        {
+            /**
+             * Mix both channels to mono and decode them as one stream.
+             */
+            CHANNEL_MODE_MIX,
+
+            /**
+             * Decode the left and right channels as separate streams, on separate recognizers sharing one model.
+             */
+            CHANNEL_MODE_SPLIT,
+        };
+
+    private:
+        /**
+         * Represents the transcript of a stream while its results are being retrieved; either one served from the
+         * transcript cache, or one being captured for it.
+         */
+        struct stream_transcript
+        {
+            core::transcript_key key;
+            core::transcript value;
+
+            /**
+             * Holds a value indicating whether the transcript came from the cache, rather than being captured.
+             */
+            bool is_cached = false;
+
+            /**
+             * Holds, per channel, a value indicating whether the final result has been retrieved.
+             */
+            std::array<bool, 2> is_finished = { };
+        };
+
+        /**
+         * Holds the underlying recognizer. In split channel mode, this recognizer decodes the left channel.
+         */
+        std::unique_ptr<core::recognizer> _recognizer;
+
+        /**
+         * Holds the recognizer for the right channel in split channel mode.
+         */
+        std::unique_ptr<core::recognizer> _right_recognizer;
+
         /**
-         * Holds the underlying pointer to the recognizer.
+         * Holds the helper thread the right channel is decoded on in split channel mode, which is started the first
+         * time it's needed and scheduled like the thread passing the audio in.
          */
-        ::VoskRecognizer* _recognizer = nullptr;
+        core::decode_helpers _channel_helpers;
+
+        /**
+         * Holds the configuration the current recognizer was acquired from the shared pool with.
+         */
+        core::recognizer_key _key;
+
+        /**
+         * Holds the grammar the current recognizer is restricted to, or an empty array for none.
+         */
+        godot::PackedStringArray _grammar;
 
         /**
          * Holds the Vosk model currently in use.
          */
         godot::Ref<VoskModel> _model = nullptr;
 
+        /**
+         * Holds a value indicating whether the native recognizers have not been fed any audio since they were set up or
+         * reset, which is the only state a cached transcript is valid from.
+         */
+        bool _is_fresh = false;
+
+        /**
+         * Holds the transcript of the last accepted stream, if it is cached or being captured.
+         */
+        std::optional<stream_transcript> _transcript;
+
         /**
          * Gets or sets the Vosk speaker model to use, if any.
          */
@@ -57,9 +136,50 @@ namespace gdvosk
          */
         GODOT_PROPERTY(bool, use_nlsml_output, false)
 
+        /**
+         * Gets or sets how stereo audio is decoded. In split mode, results are available per channel and carry a
+         * "channel" key.
+         */
+        GODOT_PROPERTY(ChannelMode, channel_mode, CHANNEL_MODE_MIX)
+
+        /**
+         * Gets or sets a value indicating whether streams are looked up in the shared transcript cache before they are
+         * decoded. Only the first stream accepted after setup or reset is cached, and only without a speaker model,
+         * since that is the only case where the results depend on nothing but the audio and the configuration.
+         */
+        GODOT_PROPERTY(bool, use_transcript_cache, false)
+
+        /**
+         * Gets or sets the number of frames audio is fed to the native recognizers in, or zero to feed every call's
+         * audio at once. Between chunks, the cancellation token is checked, progress is reported and completed
+         * utterances are emitted as intermediate results, which keeps long inputs responsive and abortable.
+         */
+        GODOT_PROPERTY(int, chunk_size, 0)
+
+        /**
+         * Gets or sets the token that aborts decoding between chunks when cancelled, if any. Accepting audio returns
+         * ERR_SKIP when aborted; the audio decoded until then remains in the recognizer, so the partial transcript can
+         * still be retrieved.
+         */
+        GODOT_PROPERTY(godot::Ref<VoskCancellationToken>, cancellation_token, nullptr)
+
+        /**
+         * Gets or sets the decoder profile to decode with, trading accuracy for speed; by default, the one the model
+         * was loaded with. Other profiles decode on a copy of the model loaded with them, which is loaded on first use
+         * unless prepared with VoskModel.prepare_decoder_profile. Changing the profile of a set up recognizer starts
+         * a new stream, as set_grammar does.
+         */
+        GODOT_PROPERTY(VoskModel::DecoderProfile, decoder_profile, VoskModel::DECODER_PROFILE_DEFAULT)
+
     public:
         /**
-         * Sets up the recognizer with the given model, sample rate, and an optional speaker model.
+         * Destroys an instance of the VoskRecognizer class, returning its native recognizer to the shared pool.
+         */
+        ~VoskRecognizer() override;
+
+        /**
+         * Sets up the recognizer with the given model, sample rate, and an optional speaker model. A reset recognizer
+         * with the same configuration is taken from the shared pool if one is available.
          * @param model The language model.
          * @param sample_rate The sample rate of audio to be processed.
          * @param speaker_model The speaker model.
@@ -74,7 +194,8 @@ namespace gdvosk
 
         /**
          * Sets up the recognizer with the given model, sample rate, and an optional set of words expected to be
-         * recognized by the recognizer.
+         * recognized by the recognizer. A reset recognizer with the same configuration is taken from the shared pool if
+         * one is available, which avoids compiling the grammar again.
          * @param model The language model.
          * @param sample_rate The sample rate of audio to be processed.
          * @param grammar The grammar.
@@ -87,12 +208,31 @@ namespace gdvosk
             const godot::PackedStringArray& grammar
         );
 
+        /**
+         * Switches the grammar of a set-up recognizer. Recognizers for recently used grammars are kept in the shared
+         * pool, so switching back and forth between a few vocabularies does not compile them again. The utterance in
+         * progress is discarded; retrieve it with get_final_result first if it is needed.
+         * @param grammar The grammar, or an empty array to remove the restriction.
+         * @return ERR_UNCONFIGURED if the recognizer has not been set up, FAILED if no recognizer could be constructed
+         * for the grammar (in which case the previous grammar remains active), and OK otherwise.
+         */
+        godot::Error set_grammar(const godot::PackedStringArray& grammar);
+
+        /**
+         * Gets the grammar the recognizer is restricted to.
+         * @return The grammar, or an empty array for none.
+         */
+        [[nodiscard]] godot::PackedStringArray get_grammar() const;
+
         /**
          * Accepts a stream of audio data, transcribing the audio within it. The audio is expected to be in 16-bit
          * signed PCM format and can be either mono or stereo. Stereo audio will be mixed to mono before processing.
+         * If the transcript cache is in use and holds the stream, nothing is decoded; get_result and get_final_result
+         * return the cached results instead.
          * @param stream The stream.
          * @return OK if a complete sentence was recognized and a final result is available, ERR_BUSY if the audio was
-         * accepted and a partial result is available, and FAILED if the audio was not accepted.
+         * accepted and a partial result is available, ERR_SKIP if decoding was cancelled, and FAILED if the audio was
+         * not accepted.
          */
         godot::Error accept_stream(const godot::Ref<godot::AudioStreamWAV>& stream);
 
@@ -102,46 +242,252 @@ namespace gdvosk
          * processing.
          * @param samples The audio samples.
          * @return OK if a complete sentence was recognized and a final result is available, ERR_BUSY if the audio was
-         * accepted and a partial result is available, and FAILED if the audio was not accepted.
+         * accepted and a partial result is available, ERR_SKIP if decoding was cancelled, and FAILED if the audio was
+         * not accepted.
          */
         godot::Error accept_samples(const godot::PackedVector2Array& samples);
 
+        /**
+         * Accepts mono 16-bit signed little-endian PCM, at the sample rate the recognizer was set up with. The data is
+         * handed to Vosk where it lies, without being copied or converted, so this is the cheapest way to feed audio
+         * that is already decoded, such as voice chat packets. In split channel mode, only the left channel's
+         * recognizer is fed.
+         * @param data The PCM data.
+         * @return ERR_INVALID_DATA if the data is not a whole number of aligned samples, and otherwise the same as
+         * accept_samples.
+         */
+        godot::Error accept_pcm16(const godot::PackedByteArray& data);
+
+        /**
+         * Accepts mono floating-point samples, at the sample rate the recognizer was set up with. The samples are
+         * handed to Vosk where they lie, without being copied or converted, so they must already be in the range of
+         * 16-bit samples (-32768 to 32767) rather than normalized. In split channel mode, only the left channel's
+         * recognizer is fed.
+         * @param samples The samples.
+         * @return ERR_INVALID_DATA if there are more samples than Vosk accepts in one call, and otherwise the same as
+         * accept_samples.
+         */
+        godot::Error accept_pcm_float(const godot::PackedFloat32Array& samples);
+
         /**
          * Gets the result of the current transcription. If no result is available yet, this method will block until a
          * set amount of silence has been detected.
+         * @param channel The channel to get the result of in split channel mode; 0 for left and 1 for right.
          * @return A dictionary containing the parsed results.
          */
-        godot::Dictionary get_result();
+        godot::Dictionary get_result(int channel = 0);
 
         /**
          * Gets the result of the current transcription. If no result is available yet, this method will return the
          * current best guess at what's being said.
+         * @param channel The channel to get the result of in split channel mode; 0 for left and 1 for right.
          * @return A dictionary containing the parsed results.
          */
-        godot::Dictionary get_partial_result();
+        godot::Dictionary get_partial_result(int channel = 0);
 
         /**
          * Gets the result of the current transcription. If no result is available yet, this method will block and flush
          * the remaining audio through the processor.
+         * @param channel The channel to get the result of in split channel mode; 0 for left and 1 for right.
          * @return A dictionary containing the parsed results.
          */
-        godot::Dictionary get_final_result();
+        godot::Dictionary get_final_result(int channel = 0);
 
         /**
          * Resets the recognizer so transcription can continue from scratch.
          */
         void reset();
 
+        /**
+         * Returns the native recognizer to the shared pool, where it can be reused by another recognizer with the same
+         * configuration. The recognizer must be set up again before further use.
+         */
+        void release();
+
+        /**
+         * Sets the number of idle native recognizers the shared pool keeps for each configuration.
+         * @param warm_spares The number of spares.
+         */
+        static void set_pool_warm_spares(int warm_spares);
+
+        /**
+         * Gets the number of idle native recognizers the shared pool keeps for each configuration.
+         * @return The number of spares.
+         */
+        [[nodiscard]] static int get_pool_warm_spares();
+
+        /**
+         * Sets the maximum number of idle native recognizers the shared pool keeps in total.
+         * @param max_idle The maximum.
+         */
+        static void set_pool_max_idle(int max_idle);
+
+        /**
+         * Gets the maximum number of idle native recognizers the shared pool keeps in total.
+         * @return The maximum.
+         */
+        [[nodiscard]] static int get_pool_max_idle();
+
+        /**
+         * Constructs idle native recognizers for the given configuration ahead of time, so that later calls to setup
+         * or setup_with_grammar return immediately. This may take a while and can be called from a background thread.
+         * @param model The language model.
+         * @param sample_rate The sample rate of audio to be processed.
+         * @param grammar The grammar, or an empty array for none.
+         * @return The number of idle recognizers available for the configuration.
+         */
+        static int prewarm_pool
+        (
+            const godot::Ref<VoskModel>& model,
+            float sample_rate,
+            const godot::PackedStringArray& grammar
+        );
+
+        /**
+         * Gets statistics about the shared pool.
+         * @return A dictionary with the keys "hits", "misses" and "idle".
+         */
+        [[nodiscard]] static godot::Dictionary get_pool_statistics();
+
+        /**
+         * Destroys every idle native recognizer held by the shared pool.
+         */
+        static void clear_pool();
+
+        /**
+         * Sets the maximum number of transcripts the shared transcript cache keeps in memory.
+         * @param max_entries The maximum.
+         */
+        static void set_transcript_cache_max_entries(int max_entries);
+
+        /**
+         * Gets the maximum number of transcripts the shared transcript cache keeps in memory.
+         * @return The maximum.
+         */
+        [[nodiscard]] static int get_transcript_cache_max_entries();
+
+        /**
+         * Sets the maximum memory, in bytes, the transcripts kept in memory by the shared transcript cache may take up.
+         * @param max_size The maximum.
+         */
+        static void set_transcript_cache_max_size(int64_t max_size);
+
+        /**
+         * Gets the maximum memory, in bytes, the transcripts kept in memory by the shared transcript cache may take up.
+         * @return The maximum.
+         */
+        [[nodiscard]] static int64_t get_transcript_cache_max_size();
+
+        /**
+         * Sets the directory the shared transcript cache persists transcripts in, creating it if needed. Persisted
+         * transcripts survive restarts, and are looked up when they're not in memory.
+         * @param directory The directory, or an empty string to keep transcripts in memory only.
+         * @return ERR_CANT_CREATE if the directory could not be created, and OK otherwise.
+         */
+        static godot::Error set_transcript_cache_directory(const godot::String& directory);
+
+        /**
+         * Gets the directory the shared transcript cache persists transcripts in.
+         * @return The directory, or an empty string for none.
+         */
+        [[nodiscard]] static godot::String get_transcript_cache_directory();
+
+        /**
+         * Gets statistics about the shared transcript cache.
+         * @return A dictionary with the keys "hits", "misses", "entries" and "size".
+         */
+        [[nodiscard]] static godot::Dictionary get_transcript_cache_statistics();
+
+        /**
+         * Drops every transcript the shared transcript cache keeps in memory. Persisted transcripts are left alone.
+         */
+        static void clear_transcript_cache();
+
     protected:
         static void _bind_methods();
 
     private:
         void update_recognizer_parameters();
+        void update_channel_recognizers();
+        void release_recognizer();
+
+        /**
+         * Gets the recognizer decoding the given channel.
+         * @param channel The channel.
+         * @return The recognizer, or nullptr if there is none for the channel.
+         */
+        [[nodiscard]] core::recognizer* get_channel_recognizer(int channel) const;
+
+        /**
+         * Parses a result produced by the recognizer of the given channel, tagging it with the channel in split mode.
+         * @param json The JSON result.
+         * @param channel The channel.
+         * @return The parsed result.
+         */
+        [[nodiscard]] godot::Dictionary to_channel_result(const char* json, int channel) const;
+
+        /**
+         * Computes the transcript cache key of a stream under the current configuration.
+         * @param data The audio data.
+         * @param is_stereo Whether the audio is stereo.
+         * @return The key, or nothing if the results of the stream can't be cached.
+         */
+        [[nodiscard]] std::optional<core::transcript_key> get_transcript_key
+        (
+            const godot::PackedByteArray& data,
+            bool is_stereo
+        ) const;
+
+        /**
+         * Gets the decoder profile the native recognizers decode with, resolving the default to the model's own.
+         * @return The profile.
+         */
+        [[nodiscard]] VoskModel::DecoderProfile get_effective_decoder_profile() const;
+
+        /**
+         * Marks the native recognizers as fresh or not, dropping the transcript of the last stream.
+         * @param is_fresh Whether the native recognizers are fresh.
+         */
+        void set_fresh(bool is_fresh);
+
+        /**
+         * Records that the final result of a channel has been retrieved, caching the captured transcript once every
+         * channel's has.
+         * @param channel The channel.
+         */
+        void finish_transcript_channel(int channel);
+
+        /**
+         * Gets the number of channels results are produced for.
+         */
+        [[nodiscard]] std::size_t get_channel_count() const;
+
+        /**
+         * Decodes audio chunk by chunk, as configured by the chunk size. Between chunks, the cancellation token is
+         * checked, completed utterances are emitted as intermediate results, and progress is reported.
+         * @param frames The number of frames of audio.
+         * @param decode Decodes a chunk, given the offset and number of its frames, and returns the status per
+         * channel.
+         * @return The statuses of the last chunk, or nothing if decoding was cancelled.
+         */
+        template <typename Decode>
+        std::optional<std::array<core::accept_status, 2>> decode_in_chunks(std::size_t frames, Decode&& decode);
 
-        static godot::PackedByteArray mix_stereo_to_mono(const godot::PackedByteArray& data);
-        static godot::PackedFloat32Array mix_stereo_to_mono(const godot::PackedVector2Array& data);
-        static godot::Dictionary parse_json_as_dictionary(const godot::String& data);
+        /**
+         * Decodes each channel of interleaved stereo samples on its own recognizer, in split channel mode. The right
+         * channel is decoded on the helper thread, which is first brought in line with the calling thread's
+         * scheduling constraints.
+         * @param interleaved The samples.
+         * @return The outcome for each channel, in order.
+         */
+        template <typename T>
+        std::array<core::accept_status, 2> accept_channels(core::span<const T> interleaved);
+
+        static godot::Error to_error(core::accept_status status);
+        static godot::Error to_error(const std::array<core::accept_status, 2>& statuses);
     };
 }
 
+VARIANT_ENUM_CAST(gdvosk::VoskRecognizer::ChannelMode);
+
 #endif //VOSKRECOGNIZER_H
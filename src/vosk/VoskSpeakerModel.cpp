@@ -3,6 +3,7 @@
 
 
 #include "VoskSpeakerModel.h"
+#include "core/recognizer_pool.h"
 
 #include <godot_cpp/classes/project_settings.hpp>
 
@@ -13,6 +14,7 @@ VoskSpeakerModel::~VoskSpeakerModel()
 {
     if (_model != nullptr)
     {
+        core::recognizer_pool::shared().evict(_model);
         vosk_spk_model_free(_model);
     }
 }
@@ -33,6 +35,7 @@ Error VoskSpeakerModel::load(const String& path)
 
     if (_model != nullptr)
     {
+        core::recognizer_pool::shared().evict(_model);
         vosk_spk_model_free(_model);
     }
 
@@ -10,6 +10,8 @@
 
 namespace gdvosk
 {
+    class SpeechRecognizer;
+
     /**
      * Represents a Vosk speaker model as a Godot resource.
      */
@@ -18,6 +20,7 @@ namespace gdvosk
         GDCLASS(VoskSpeakerModel, godot::Resource)
 
         friend class VoskRecognizer;
+        friend class gdvosk::SpeechRecognizer;
 
         /**
          * Holds the underlying pointer to the model.
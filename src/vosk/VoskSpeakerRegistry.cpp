@@ -0,0 +1,152 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#include "VoskSpeakerRegistry.h"
+#include "helpers/string_conversion.h"
+
+#include <algorithm>
+
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+
+using namespace gdvosk;
+using namespace godot;
+
+Error VoskSpeakerRegistry::enroll(const String& id, const PackedFloat32Array& speaker_vector)
+{
+    core::span<const float> vector(speaker_vector.ptr(), static_cast<std::size_t>(speaker_vector.size()));
+    if (!_registry->enroll(to_utf8(id), vector))
+    {
+        return ERR_INVALID_PARAMETER;
+    }
+
+    return OK;
+}
+
+Error VoskSpeakerRegistry::enroll_result(const String& id, const Dictionary& result)
+{
+    if (!result.has("spk"))
+    {
+        return ERR_INVALID_DATA;
+    }
+
+    Array elements = result["spk"];
+
+    PackedFloat32Array speaker_vector;
+    speaker_vector.resize(elements.size());
+    for (int64_t i = 0; i < elements.size(); ++i)
+    {
+        speaker_vector[i] = static_cast<float>(static_cast<double>(elements[i]));
+    }
+
+    return enroll(id, speaker_vector);
+}
+
+bool VoskSpeakerRegistry::remove_speaker(const String& id)
+{
+    return _registry->remove(to_utf8(id));
+}
+
+void VoskSpeakerRegistry::clear()
+{
+    _registry->clear();
+}
+
+bool VoskSpeakerRegistry::has_speaker(const String& id) const
+{
+    return _registry->contains(to_utf8(id));
+}
+
+PackedStringArray VoskSpeakerRegistry::get_speaker_ids() const
+{
+    PackedStringArray ids;
+    for (const auto& id : _registry->get_ids())
+    {
+        ids.append(String::utf8(id.c_str()));
+    }
+
+    return ids;
+}
+
+int64_t VoskSpeakerRegistry::get_speaker_count() const
+{
+    return static_cast<int64_t>(_registry->size());
+}
+
+Array VoskSpeakerRegistry::identify(const PackedFloat32Array& speaker_vector, int max_results) const
+{
+    core::span<const float> vector(speaker_vector.ptr(), static_cast<std::size_t>(speaker_vector.size()));
+
+    Array matches;
+    for (const auto& match : _registry->match(vector, static_cast<std::size_t>(std::max(max_results, 0))))
+    {
+        Dictionary entry;
+        entry["id"] = String::utf8(match.id.c_str());
+        entry["score"] = match.score;
+
+        matches.append(entry);
+    }
+
+    return matches;
+}
+
+Error VoskSpeakerRegistry::save(const String& path) const
+{
+    auto data = _registry->serialize();
+
+    PackedByteArray buffer;
+    buffer.resize(static_cast<int64_t>(data.size()));
+    std::copy(data.begin(), data.end(), buffer.ptrw());
+
+    auto file = FileAccess::open(path, FileAccess::WRITE);
+    if (file.is_null())
+    {
+        return FileAccess::get_open_error();
+    }
+
+    file->store_buffer(buffer);
+    return file->get_error();
+}
+
+Error VoskSpeakerRegistry::load(const String& path)
+{
+    auto file = FileAccess::open(path, FileAccess::READ);
+    if (file.is_null())
+    {
+        return FileAccess::get_open_error();
+    }
+
+    auto buffer = file->get_buffer(static_cast<int64_t>(file->get_length()));
+
+    core::span<const std::uint8_t> data(buffer.ptr(), static_cast<std::size_t>(buffer.size()));
+    if (!_registry->deserialize(data))
+    {
+        return ERR_FILE_CORRUPT;
+    }
+
+    return OK;
+}
+
+std::shared_ptr<const core::speaker_registry> VoskSpeakerRegistry::get_registry() const
+{
+    return _registry;
+}
+
+void VoskSpeakerRegistry::_bind_methods()
+{
+    ClassDB::bind_method(D_METHOD("enroll", "id", "speaker_vector"), &VoskSpeakerRegistry::enroll);
+    ClassDB::bind_method(D_METHOD("enroll_result", "id", "result"), &VoskSpeakerRegistry::enroll_result);
+    ClassDB::bind_method(D_METHOD("remove_speaker", "id"), &VoskSpeakerRegistry::remove_speaker);
+    ClassDB::bind_method(D_METHOD("clear"), &VoskSpeakerRegistry::clear);
+    ClassDB::bind_method(D_METHOD("has_speaker", "id"), &VoskSpeakerRegistry::has_speaker);
+    ClassDB::bind_method(D_METHOD("get_speaker_ids"), &VoskSpeakerRegistry::get_speaker_ids);
+    ClassDB::bind_method(D_METHOD("get_speaker_count"), &VoskSpeakerRegistry::get_speaker_count);
+    ClassDB::bind_method
+    (
+        D_METHOD("identify", "speaker_vector", "max_results"),
+        &VoskSpeakerRegistry::identify,
+        DEFVAL(1)
+    );
+    ClassDB::bind_method(D_METHOD("save", "path"), &VoskSpeakerRegistry::save);
+    ClassDB::bind_method(D_METHOD("load", "path"), &VoskSpeakerRegistry::load);
+}
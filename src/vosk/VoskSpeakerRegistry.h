@@ -0,0 +1,104 @@
+// Copyright (C) 2024 Jarl Gullberg
+// SPDX-License-Identifier: MIT
+
+#ifndef VOSKSPEAKERREGISTRY_H
+#define VOSKSPEAKERREGISTRY_H
+
+#include <memory>
+
+#include <godot_cpp/classes/resource.hpp>
+#include <godot_cpp/variant/array.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/packed_float32_array.hpp>
+#include <godot_cpp/variant/packed_string_array.hpp>
+
+#include "core/speaker_registry.h"
+
+namespace gdvosk
+{
+    class SpeechRecognizer;
+
+    /**
+     * Represents a set of known speakers, identified by the speaker vectors Vosk produces when a speaker model is
+     * attached to a recognizer.
+     */
+    class VoskSpeakerRegistry final : public godot::Resource
+    {
+        GDCLASS(VoskSpeakerRegistry, godot::Resource)
+
+        friend class gdvosk::SpeechRecognizer;
+
+        /**
+         * Holds the underlying registry. Shared with the background threads of any recognizers using it.
+         */
+        std::shared_ptr<core::speaker_registry> _registry = std::make_shared<core::speaker_registry>();
+
+    public:
+        /**
+         * Enrols a speaker vector for a speaker, adding the speaker if they are not known yet. Enrolling vectors from
+         * several utterances makes identification more reliable.
+         * @param id The speaker's identifier.
+         * @param speaker_vector The speaker vector; the "spk" array of a result.
+         * @return The result of the operation.
+         */
+        godot::Error enroll(const godot::String& id, const godot::PackedFloat32Array& speaker_vector);
+
+        /**
+         * Enrols the speaker vector of a recognition result for a speaker.
+         * @param id The speaker's identifier.
+         * @param result The result. Must have been produced by a recognizer with a speaker model.
+         * @return The result of the operation.
+         */
+        godot::Error enroll_result(const godot::String& id, const godot::Dictionary& result);
+
+        /**
+         * Removes a speaker.
+         * @param id The speaker's identifier.
+         * @return true if the speaker was known; otherwise, false.
+         */
+        bool remove_speaker(const godot::String& id);
+
+        /**
+         * Removes every speaker.
+         */
+        void clear();
+
+        [[nodiscard]] bool has_speaker(const godot::String& id) const;
+        [[nodiscard]] godot::PackedStringArray get_speaker_ids() const;
+        [[nodiscard]] int64_t get_speaker_count() const;
+
+        /**
+         * Finds the known speakers whose voices are closest to a speaker vector.
+         * @param speaker_vector The speaker vector; the "spk" array of a result.
+         * @param max_results The maximum number of matches to return.
+         * @return The matches, best first, as dictionaries with an "id" and a "score" between -1 and 1.
+         */
+        [[nodiscard]] godot::Array identify(const godot::PackedFloat32Array& speaker_vector, int max_results) const;
+
+        /**
+         * Saves the registry to a file.
+         * @param path The path to the file.
+         * @return The result of the operation.
+         */
+        godot::Error save(const godot::String& path) const;
+
+        /**
+         * Loads the registry from a file, replacing its contents.
+         * @param path The path to the file.
+         * @return The result of the operation.
+         */
+        godot::Error load(const godot::String& path);
+
+    protected:
+        static void _bind_methods();
+
+    private:
+        /**
+         * Gets the underlying registry.
+         * @return The registry.
+         */
+        [[nodiscard]] std::shared_ptr<const core::speaker_registry> get_registry() const;
+    };
+}
+
+#endif //VOSKSPEAKERREGISTRY_H